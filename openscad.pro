@@ -341,12 +341,14 @@ HEADERS += src/version_check.h \
            src/builtin.h \
            src/calc.h \
            src/context.h \
+           src/Symbol.h \
            src/modcontext.h \
            src/evalcontext.h \
            src/csgops.h \
            src/CSGTreeNormalizer.h \
            src/CSGTreeEvaluator.h \
            src/dxfdata.h \
+           src/Decimal.h \
            src/dxfdim.h \
            src/export.h \
            src/stackcheck.h \
@@ -366,6 +368,9 @@ HEADERS += src/version_check.h \
            src/cgaladvnode.h \
            src/importnode.h \
            src/import.h \
+           src/MappedFile.h \
+           src/MeshFormat.h \
+           src/TextScanner.h \
            src/transformnode.h \
            src/colornode.h \
            src/rendernode.h \
@@ -373,6 +378,7 @@ HEADERS += src/version_check.h \
            src/openscad.h \
            src/handle_dep.h \
            src/Geometry.h \
+           src/TransformedGeometry.h \
            src/Polygon2d.h \
            src/clipper-utils.h \
            src/GeometryUtils.h \
@@ -380,12 +386,15 @@ HEADERS += src/version_check.h \
            src/polyset.h \
            src/PolyMesh.h \
            src/printutils.h \
+           src/Profiler.h \
            src/fileutils.h \
            src/value.h \
            src/progress.h \
            src/editor.h \
            src/NodeVisitor.h \
            src/ThreadedNodeVisitor.h \
+           src/WorkStealingPool.h \
+           src/ParallelFormat.h \
 		   src/spinlock_pool_multi.h \
            src/CGAL_Handle_for_atomic_shared_ptr.h \
            src/Profile_counterx.h \
@@ -398,6 +407,8 @@ HEADERS += src/version_check.h \
            src/nodedumper.h \
            src/ModuleCache.h \
            src/GeometryCache.h \
+           src/DiskCache.h \
+           src/MemoryBudget.h \
            src/GeometryEvaluator.h \
            src/Tree.h \
            src/DrawingCallback.h \
@@ -459,12 +470,14 @@ SOURCES += \
            src/node.cc \
 		   src/FactoryNode.cc \
            src/context.cc \
+           src/Symbol.cc \
            src/modcontext.cc \
            src/evalcontext.cc \
            src/csgnode.cc \
            src/CSGTreeNormalizer.cc \
            src/CSGTreeEvaluator.cc \
            src/Geometry.cc \
+           src/TransformedGeometry.cc \
            src/Polygon2d.cc \
            src/clipper-utils.cc \
            src/polyset-utils.cc \
@@ -488,6 +501,7 @@ SOURCES += \
            src/linearextrude.cc \
            src/rotateextrude.cc \
            src/printutils.cc \
+           src/Profiler.cc \
            src/fileutils.cc \
            src/progress.cc \
            src/parsersettings.cc \
@@ -499,8 +513,11 @@ SOURCES += \
            src/nodedumper.cc \
            src/NodeVisitor.cc \
            src/ThreadedNodeVisitor.cc \
+           src/WorkStealingPool.cc \
            src/ModuleCache.cc \
            src/GeometryCache.cc \
+           src/DiskCache.cc \
+           src/MemoryBudget.cc \
            src/Tree.cc \
 	   src/DrawingCallback.cc \
 	   src/FreetypeRenderer.cc \
@@ -526,7 +543,9 @@ SOURCES += \
            src/export.cc \
            src/export_stl.cc \
            src/export_amf.cc \
+           src/export_3mf.cc \
            src/export_off.cc \
+           src/export_mesh.cc \
            src/export_dxf.cc \
            src/export_svg.cc \
            src/export_nef.cc \
@@ -537,6 +556,9 @@ SOURCES += \
            src/import_off.cc \
            src/import_svg.cc \
            src/import_amf.cc \
+           src/MappedFile.cc \
+           src/MeshFormat.cc \
+           src/import_mesh.cc \
            src/renderer.cc \
            src/colormap.cc \
            src/ThrownTogetherRenderer.cc \
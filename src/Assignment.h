@@ -7,20 +7,22 @@
 #include "AST.h"
 #include "expression.h"
 #include "memory.h"
+#include "Symbol.h"
 
 class Assignment : public ASTNode
 {
 public:
 	Assignment(std::string name, const Location &loc)
-		: ASTNode(loc), name(name) { }
+		: ASTNode(loc), name(name), symbol(Symbols::intern(name)) { }
 	Assignment(std::string name,
 		shared_ptr<Expression> expr = nullptr,
 		const Location &loc = Location::NONE)
-		: ASTNode(loc), name(name), expr(expr) { }
+		: ASTNode(loc), name(name), symbol(Symbols::intern(name)), expr(expr) { }
 
 	std::string name;
+	SymbolId symbol;
 	shared_ptr<Expression> expr;
 };
 
 typedef std::vector<Assignment> AssignmentList;
-typedef std::unordered_map<std::string, const Expression*> AssignmentMap;
+typedef std::unordered_map<SymbolId, const Expression*> AssignmentMap;
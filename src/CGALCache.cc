@@ -1,4 +1,5 @@
 #include "CGALCache.h"
+#include "DiskCache.h"
 #include "printutils.h"
 #include "CGAL_Nef_polyhedron.h"
 
@@ -6,43 +7,68 @@ CGALCache *CGALCache::inst = NULL;
 
 CGALCache::CGALCache(size_t limit) : cache(limit)
 {
+	// entries dropped to make room can be read back from disk
+	cache.setEvictionHandler([](const NodeId &id, cache_entry &entry) {
+		DiskCache::instance()->spillNEF(id, entry.N);
+	});
+	MemoryBudget::instance()->registerCache(this);
 }
 
-shared_ptr<const Geometry> CGALCache::get(const std::string &id) const
+bool CGALCache::contains(const NodeId &id) const
+{
+	if (this->cache.contains(id)) return true;
+	if (shared_ptr<const CGAL_Nef_polyhedron> N = DiskCache::instance()->getNEF(id)) {
+		uint64_t tick = CacheClock::now();
+		cache_entry *entry = new cache_entry(N);
+		if (DiskCache::instance()->persistent()) entry->postfixTime = DiskCache::instance()->getPostfixTime(id);
+		bool inserted = this->cache.insert(id, entry, N->memsize());
+		MemoryBudget::instance()->enforce(tick);
+		return inserted;
+	}
+	return false;
+}
+
+shared_ptr<const Geometry> CGALCache::get(const NodeId &id) const
 {
 	return getNEF(id);
 }
 
-shared_ptr<const CGAL_Nef_polyhedron> CGALCache::getNEF(const std::string &id) const
+shared_ptr<const CGAL_Nef_polyhedron> CGALCache::getNEF(const NodeId &id) const
 {
 	const shared_ptr<const CGAL_Nef_polyhedron> &N = this->cache[id]->N;
 #ifdef DEBUG
-	PRINTB("CGAL Cache hit: %s (%d bytes)", id.substr(0, 40) % (N ? N->memsize() : 0));
+	PRINTB("CGAL Cache hit: %s (%d bytes)", id % (N ? N->memsize() : 0));
 #endif
 	return N;
 }
 
-bool CGALCache::insert(const std::string &id, const shared_ptr<const Geometry> &N)
+bool CGALCache::insert(const NodeId &id, const shared_ptr<const Geometry> &N)
 {
 	return insertNEF(id, dynamic_pointer_cast<const CGAL_Nef_polyhedron>(N));
 }
 
-bool CGALCache::insertNEF(const std::string &id, const shared_ptr<const CGAL_Nef_polyhedron> &N)
+bool CGALCache::insertNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N)
 {
-	bool inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0);
+	uint64_t tick = CacheClock::now();
+	// a replaced entry keeps its time
+	cache_entry *entry = new cache_entry(N);
+	entry->postfixTime = postfixTime(id);
+	bool inserted = this->cache.insert(id, entry, N ? N->memsize() : 0);
+	if (DiskCache::instance()->persistent()) DiskCache::instance()->insertNEF(id, N);
+	MemoryBudget::instance()->enforce(tick);
 #ifdef DEBUG
-	if (inserted) PRINTB("CGAL Cache insert: %s (%d bytes)", id.substr(0, 40) % (N ? N->memsize() : 0));
-	else PRINTB("CGAL Cache insert failed: %s (%d bytes)", id.substr(0, 40) % (N ? N->memsize() : 0));
+	if (inserted) PRINTB("CGAL Cache insert: %s (%d bytes)", id % (N ? N->memsize() : 0));
+	else PRINTB("CGAL Cache insert failed: %s (%d bytes)", id % (N ? N->memsize() : 0));
 #endif
 	return inserted;
 }
 
-bool CGALCache::remove(const std::string &id)
+bool CGALCache::remove(const NodeId &id)
 {
 	if (cache_entry *entry = this->cache[id]) {
 		shared_ptr<const CGAL_Nef_polyhedron> geom = entry->N;
 #ifdef DEBUG
-		PRINTDB("Geometry Cache remove: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
+		PRINTDB("Geometry Cache remove: %s (%d bytes)", id % (geom ? geom->memsize() : 0));
 #endif
 		this->cache.remove(id);
 		return true;
@@ -65,6 +91,22 @@ void CGALCache::clear()
 	cache.clear();
 }
 
+double CGALCache::postfixTime(const NodeId &id) const
+{
+	const cache_entry *entry = this->cache.peek(id);
+	return entry ? entry->postfixTime : 0;
+}
+
+bool CGALCache::setPostfixTime(const NodeId &id, double ms)
+{
+	cache_entry *entry = this->cache.peek(id);
+	if (!entry) return false;
+	if (ms <= entry->postfixTime) return true;
+	entry->postfixTime = ms;
+	if (DiskCache::instance()->persistent()) DiskCache::instance()->insertPostfixTime(id, ms);
+	return true;
+}
+
 void CGALCache::print() const
 {
 	PRINTB("CGAL Polyhedrons in cache: %d", this->cache.size());
@@ -72,7 +114,13 @@ void CGALCache::print() const
 }
 
 CGALCache::cache_entry::cache_entry(const shared_ptr<const CGAL_Nef_polyhedron> &N)
-	: N(N)
+	: N(N), postfixTime(0)
 {
+	MemoryBudget::instance()->acquire(N.get());
 	if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
+
+CGALCache::cache_entry::~cache_entry()
+{
+	MemoryBudget::instance()->release(N.get());
+}
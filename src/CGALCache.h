@@ -6,33 +6,41 @@
 
 /*!
 */
-class CGALCache : public IGeometryCache
+class CGALCache : public IGeometryCache, public MemoryBudget::Evictable
 {
 public:	
 	CGALCache(size_t limit = 100*1024*1024);
 
 	static CGALCache *instance() { if (!inst) inst = new CGALCache; return inst; }
 
-	virtual bool contains(const std::string &id) const { return this->cache.contains(id); }
-	virtual shared_ptr<const class Geometry> get(const std::string &id) const;
-	shared_ptr<const class CGAL_Nef_polyhedron> getNEF(const std::string &id) const;
-	virtual bool insert(const std::string &id, const shared_ptr<const Geometry> &N);
-	virtual bool insertNEF(const std::string &id, const shared_ptr<const CGAL_Nef_polyhedron> &N);
-	virtual bool remove(const std::string &id);
+	virtual bool contains(const NodeId &id) const;
+	virtual shared_ptr<const class Geometry> get(const NodeId &id) const;
+	shared_ptr<const class CGAL_Nef_polyhedron> getNEF(const NodeId &id) const;
+	virtual bool insert(const NodeId &id, const shared_ptr<const Geometry> &N);
+	virtual bool insertNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N);
+	virtual bool remove(const NodeId &id);
 	virtual size_t maxSize() const;
 	virtual void setMaxSize(size_t limit);
 	virtual void clear();
 	virtual void print() const;
+	virtual double postfixTime(const NodeId &id) const;
+	virtual bool setPostfixTime(const NodeId &id, double ms);
+
+	virtual uint64_t oldestUse() const { return cache.oldestUse(); }
+	virtual void evictOldest() { cache.evictOldest(); }
 
 private:
 	static CGALCache *inst;
 
+	// holds its Nef against the MemoryBudget
 	struct cache_entry {
 		shared_ptr<const CGAL_Nef_polyhedron> N;
 		std::string msg;
+		double postfixTime;
 		cache_entry(const shared_ptr<const CGAL_Nef_polyhedron> &N);
-		~cache_entry() { }
+		~cache_entry();
 	};
 
-	Cache<std::string, cache_entry> cache;
+	// mutable since contains() promotes entries from the disk tier
+	mutable Cache<NodeId, cache_entry> cache;
 };
@@ -23,8 +23,14 @@
 // Author(s)     : Stefan Schirra, Sylvain Pion
 
 // This is an adaptation of CGAL's Handle_for.h for OpenSCAD
-// It re-implements Handle_for using std::shared_ptr and its std::atomic 
-// overloads to perform consistent reference counting across multiple threads
+// It re-implements Handle_for with an intrusive std::atomic reference count
+// so handles can be copied and destroyed concurrently from multiple threads.
+//
+// The referenced representation is treated as immutable once it is shared:
+// number types only mutate their rep in place when unique() is true and
+// otherwise build a new rep and swap it in (copy-on-write). This makes
+// per-operation locking unnecessary; as with any value type, a single
+// handle object must still not be written while another thread reads it.
 
 // Note: A compiler error will be issued if CGAL's Handle_for.h is included 
 // before this file. This is to ensure the CGAL headers and classes use this 
@@ -44,9 +50,9 @@
 #include <CGAL/config.h>
 #include <boost/config.hpp>
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
-
-#include "spinlock_pool_multi.h"
+#include <utility>
 
 #if defined(BOOST_MSVC)
 #  pragma warning(push)
@@ -57,15 +63,27 @@ namespace CGAL {
 template <class T>
 class Handle_for
 {
-	std::shared_ptr<T> ptr_;
+	struct RefCounted
+	{
+		T t;
+		std::atomic<unsigned int> count;
 
-	class scoped_lock : public Handle_for_lock_pool::scoped_lock {
-	public:
-		scoped_lock(const std::shared_ptr<T> &p) : Handle_for_lock_pool::scoped_lock(p.get()) { }
-		scoped_lock(const std::shared_ptr<T> &p1, const std::shared_ptr<T> &p2) : 
-			Handle_for_lock_pool::scoped_lock(p1.get(), p2.get()) { }
+		RefCounted() : t(), count(1) { }
+		template < typename... Args >
+		RefCounted(Args && ... args) : t(std::forward<Args>(args)...), count(1) { }
 	};
 
+	RefCounted *ptr_;
+
+	// drops this handle's reference, deleting the rep with the last one
+	void release()
+	{
+		// acq_rel so the deleting thread sees all writes made through other handles
+		if (ptr_ && ptr_->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete ptr_;
+		ptr_ = nullptr;
+	}
+
 public:
 
     typedef T element_type;
@@ -73,113 +91,112 @@ public:
     typedef std::ptrdiff_t Id_type ;
 
     Handle_for()
+		: ptr_(new RefCounted())
     {
-		// init a new shared pointer
-		ptr_ = std::make_shared<T>();
     }
 
 	Handle_for(const Handle_for& h)
 	{
-		scoped_lock lock(h.ptr_);
 #ifndef CGAL_HANDLE_FOR_NO_REFCOUNT
 		ptr_ = h.ptr_;
+		// a new reference is only created from an existing one, so no ordering is needed
+		if (ptr_) ptr_->count.fetch_add(1, std::memory_order_relaxed);
 #else
-		ptr_ = std::make_shared<T>(*h.ptr_);
+		ptr_ = new RefCounted(h.ptr_->t);
 #endif
 	}
 
     Handle_for(const element_type& t)
+		: ptr_(new RefCounted(t))
     {
-		// make a shared pointer via t's copy constructor
-		ptr_ = std::make_shared<T>(t);
     }
 
 #ifndef CGAL_CFG_NO_CPP0X_RVALUE_REFERENCE
-	Handle_for(Handle_for && h)
+	Handle_for(Handle_for && h) noexcept
+		: ptr_(h.ptr_)
 	{
-		scoped_lock lock(h.ptr_);
-		ptr_ = std::move(h.ptr_);
+		h.ptr_ = nullptr;
 	}
 	
     Handle_for(element_type && t)
+		: ptr_(new RefCounted(std::move(t)))
     {
-		// make a shared pointer via t's copy constructor
-		ptr_ = std::make_shared<T>(std::forward<element_type>(t));
     }
 #endif
 
 #if !defined CGAL_CFG_NO_CPP0X_VARIADIC_TEMPLATES && !defined CGAL_CFG_NO_CPP0X_RVALUE_REFERENCE
 	template < typename T1, typename T2, typename... Args >
 	Handle_for(T1 && t1, T2 && t2, Args && ... args)
+		: ptr_(new RefCounted(std::forward<T1>(t1), std::forward<T2>(t2), std::forward<Args>(args)...))
 	{
-		ptr_ = std::make_shared<T>(std::forward<T1>(t1), std::forward<T2>(t2), std::forward<Args>(args)...);
 	}
 #else
 	template < typename T1, typename T2 >
 	Handle_for(const T1& t1, const T2& t2)
+		: ptr_(new RefCounted(t1, t2))
 	{
-		ptr_ = std::make_shared<T>(t1, t2);
 	}
 
 	template < typename T1, typename T2, typename T3 >
 	Handle_for(const T1& t1, const T2& t2, const T3& t3)
+		: ptr_(new RefCounted(t1, t2, t3))
 	{
-		ptr_ = std::make_shared<T>(t1, t2, t3);
 	}
 
 	template < typename T1, typename T2, typename T3, typename T4 >
 	Handle_for(const T1& t1, const T2& t2, const T3& t3, const T4& t4)
+		: ptr_(new RefCounted(t1, t2, t3, t4))
 	{
-		ptr_ = std::make_shared<T>(t1, t2, t3, t4);
 	}
 #endif // CGAL_CFG_NO_CPP0X_VARIADIC_TEMPLATES
 
     Handle_for&
     operator=(const Handle_for& h)
     {
-		// copy h's shared pointer
-		scoped_lock lock(ptr_, h.ptr_);
-#ifndef CGAL_HANDLE_FOR_NO_REFCOUNT
-		ptr_ = h.ptr_;
-#else
-		ptr_ = std::make_shared<T>(*h.ptr_);
-#endif
+		Handle_for tmp(h);
+		swap(tmp);
         return *this;
     }
 
     Handle_for&
     operator=(const element_type &t)
     {
-		// make a shared pointer via t's copy constructor
-		//std::shared_ptr<T> tmp = std::make_shared<T>(t);
-		scoped_lock lock(ptr_);
-		*ptr_ = t;
+		// never write through a shared rep
+		if (is_shared()) {
+			Handle_for tmp(t);
+			swap(tmp);
+		}
+		else {
+			ptr_->t = t;
+		}
         return *this;
     }
 
 #ifndef CGAL_CFG_NO_CPP0X_RVALUE_REFERENCE
     Handle_for&
-    operator=(Handle_for && h)
+    operator=(Handle_for && h) noexcept
     {
-		scoped_lock lock(ptr_, h.ptr_);
-		ptr_ = std::move(h.ptr_);
+		swap(h);
         return *this;
     }
 
     Handle_for&
     operator=(element_type && t)
     {
-		// make a shared pointer via t's copy constructor
-		//std::shared_ptr<T> tmp = std::make_shared<T>(std::forward<element_type>(t));
-		scoped_lock lock(ptr_);
-		*ptr_ = std::move(t);
+		if (is_shared()) {
+			Handle_for tmp(std::move(t));
+			swap(tmp);
+		}
+		else {
+			ptr_->t = std::move(t);
+		}
         return *this;
     }
 #endif
 
     ~Handle_for()
     {
-		ptr_.reset();
+		release();
     }
 
     Id_type id() const { return Ptr() - static_cast<T const*>(0); }
@@ -187,38 +204,35 @@ public:
     bool identical(const Handle_for& h) const { return Ptr() == h.Ptr(); }
 
     // Ptr() is the "public" access to the pointer to the object.
-    // The non-const version asserts that the instance is not shared.
     const element_type *
     Ptr() const
     {
-       return ptr_.get();
+       return ptr_ ? &ptr_->t : nullptr;
     }
 
     bool
     is_shared() const
     {
-		return ptr_.use_count() != 1;
+		return use_count() != 1;
     }
 
     bool
     unique() const
     {
-		return ptr_.use_count() == 1;
+		return use_count() == 1;
     }
 
     long
     use_count() const
     {
-		return ptr_.use_count();
+		// acquire pairs with the release in release() so a unique rep is safe to mutate
+		return ptr_ ? (long)ptr_->count.load(std::memory_order_acquire) : 0;
     }
 
     void
-    swap(Handle_for& h)
+    swap(Handle_for& h) noexcept
     {
-		scoped_lock lock(ptr_, h.ptr_);
-		std::shared_ptr<T> tmp = h.ptr_;
-		h.ptr_ = ptr_;
-		ptr_ = tmp;
+		std::swap(ptr_, h.ptr_);
     }
 
 protected:
@@ -226,27 +240,26 @@ protected:
     void
     copy_on_write()
     {
-		scoped_lock lock(ptr_);
 		if (ptr_ && is_shared())
 		{
 			// make a new copy of the data via its copy constructor
-			ptr_ = std::make_shared<T>(*ptr_.get());
+			Handle_for tmp(ptr_->t);
+			swap(tmp);
 		}
     }
 
     // ptr() is the protected access to the pointer.  Both const and non-const.
-    // Redundant with Ptr().
+    // Redundant with Ptr(). Callers must only write through it when unique().
     element_type *
 	ptr()
 	{
-		//copy_on_write();
-		return ptr_.get();
+		return ptr_ ? &ptr_->t : nullptr;
 	}
 
     const element_type *
 	ptr() const
 	{
-		return ptr_.get();
+		return Ptr();
 	}
 };
 
@@ -8,6 +8,8 @@
 #include "svg.h"
 #include "spinlock_pool_multi.h"
 
+#include <unordered_set>
+
 typedef CGAL::spinlock_pool_multi<2> NefPolyhedron_lock_pool;
 typedef NefPolyhedron_lock_pool::scoped_lock NefPolyhedron_scoped_lock;
 
@@ -156,12 +158,64 @@ CGAL_Nef_polyhedron *CGAL_Nef_polyhedron::minkowski(const CGAL_Nef_polyhedron &o
 //	return *this;
 //}
 
+namespace {
+	/*
+		The exact numbers of a Nef polyhedron live outside of its SNC structure,
+		so bytes() misses them. Gmpq is reference counted and vertices, edges
+		and facets share numbers; count each representation once, with the GMP
+		limbs it has allocated.
+	*/
+	class NumberBytes
+	{
+	public:
+		NumberBytes() : total(0) { }
+
+		void add(const NT3 &q) {
+			if (!seen.insert((const void *)q.mpq()).second) return;
+			total += sizeof(CGAL::Gmpq_rep) + sizeof(size_t);
+			total += (mpq_numref(q.mpq())->_mp_alloc + mpq_denref(q.mpq())->_mp_alloc) * sizeof(mp_limb_t);
+		}
+		template <typename Point> void addPoint(const Point &p) {
+			add(p.x()); add(p.y()); add(p.z());
+		}
+		template <typename Plane> void addPlane(const Plane &p) {
+			add(p.a()); add(p.b()); add(p.c()); add(p.d());
+		}
+
+		size_t total;
+
+	private:
+		std::unordered_set<const void *> seen;
+	};
+
+	size_t numberBytes(const CGAL_Nef_polyhedron3 &N)
+	{
+		NumberBytes bytes;
+		CGAL_Nef_polyhedron3::Vertex_const_iterator v;
+		CGAL_forall_vertices(v, N) bytes.addPoint(v->point());
+		CGAL_Nef_polyhedron3::Halfedge_const_iterator e;
+		CGAL_forall_halfedges(e, N) bytes.addPoint(e->point());
+		CGAL_Nef_polyhedron3::Halffacet_const_iterator f;
+		CGAL_forall_halffacets(f, N) bytes.addPlane(f->plane());
+		CGAL_Nef_polyhedron3::SHalfedge_const_iterator se;
+		CGAL_forall_shalfedges(se, N) bytes.addPlane(se->circle());
+		CGAL_Nef_polyhedron3::SHalfloop_const_iterator sl;
+		CGAL_forall_shalfloops(sl, N) bytes.addPlane(sl->circle());
+		return bytes.total;
+	}
+}
+
 size_t CGAL_Nef_polyhedron::memsize() const
 {
 	if (this->isEmpty()) return 0;
 
-	size_t memsize = sizeof(CGAL_Nef_polyhedron);
-	memsize += this->p3->bytes();
+	size_t memsize = this->measuredBytes;
+	if (memsize == 0) {
+		memsize = sizeof(CGAL_Nef_polyhedron);
+		memsize += this->p3->bytes();
+		memsize += numberBytes(*this->p3);
+		this->measuredBytes = memsize;
+	}
 	return memsize;
 }
 
@@ -244,6 +298,7 @@ void CGAL_Nef_polyhedron::transform( const Transform3d &matrix )
 				matrix(2,0), matrix(2,1), matrix(2,2), matrix(2,3), matrix(3,3));
 			p3->transform(t);
 			data.reset(this);
+			this->measuredBytes = 0;
 		}
 	}
 }
@@ -4,8 +4,11 @@
 #include "cgal.h"
 #include "memory.h"
 #include <string>
+#include <atomic>
 #include "linalg.h"
 
+class PolySet;
+
 /*
 	Geometry derived class to wrap CGAL_Nef_polyhedron3
 */
@@ -28,7 +31,7 @@ public:
 	virtual bool isEmpty() const;
 	virtual Geometry *copy() const { return new CGAL_Nef_polyhedron(*this); }
 
-	void reset(CGAL_Nef_polyhedron3 *p3 = nullptr) { this->p3.reset(p3); }
+	void reset(CGAL_Nef_polyhedron3 *p3 = nullptr) { this->p3.reset(p3); this->measuredBytes = 0; }
 
 	CGAL_Nef_polyhedron3 *get() const noexcept { return p3.get(); }
 
@@ -44,9 +47,23 @@ public:
 	//CGAL_Nef_polyhedron &operator-=(const CGAL_Nef_polyhedron &other);
 	//CGAL_Nef_polyhedron &minkowski(const CGAL_Nef_polyhedron &other);
 
+	// the PolySet of this Nef polyhedron, see CGALUtils::getPolySet()
+	ConvertedGeometry<PolySet> polySetConversion;
+
 	void transform( const Transform3d &matrix );
 	void resize(const Vector3d &newsize, const Eigen::Matrix<bool,3,1> &autosize);
 
 private:
+	// memsize() walks all the numbers of the Nef, so it is measured once and
+	// kept until transform(), resize() or reset() change it; 0 until measured
+	struct MeasuredBytes : std::atomic<size_t>
+	{
+		MeasuredBytes() : std::atomic<size_t>(0) { }
+		MeasuredBytes(const MeasuredBytes &) : std::atomic<size_t>(0) { }
+		MeasuredBytes &operator=(const MeasuredBytes &) { store(0); return *this; }
+		using std::atomic<size_t>::operator=;
+	};
+
 	shared_ptr<CGAL_Nef_polyhedron3> p3;
+	mutable MeasuredBytes measuredBytes;
 };
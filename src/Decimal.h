@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+
+/*!
+	A number rounded to the 6 significant digits written by the text mesh
+	exporters. Vertices are compared after rounding, so facets which would be
+	degenerate in the file are detected without formatting them first.
+	write() formats like printf("%g"), independent of the locale.
+*/
+class Decimal
+{
+public:
+	Decimal(double x)
+		: digits(0), exp(0), negative(std::signbit(x)), special(0)
+	{
+		if (std::isnan(x)) { special = NAN_VALUE; return; }
+		if (std::isinf(x)) { special = INF_VALUE; return; }
+		if (x == 0) return;
+		x = std::fabs(x);
+		exp = (int)std::floor(std::log10(x));
+		// the scaling below needs an exact power of ten, even after correcting
+		// exp by one
+		if (exp < -16 || exp > 26) { round_printf(x); return; }
+		digits = round_scaled(x, 5 - exp);
+		// log10 and the rounding can be off by one digit
+		if (digits >= 1000000) {
+			exp++;
+			digits = round_scaled(x, 5 - exp);
+		}
+		else if (digits < 100000) {
+			exp--;
+			digits = round_scaled(x, 5 - exp);
+		}
+	}
+
+	bool operator==(const Decimal &other) const {
+		return digits == other.digits && exp == other.exp && negative == other.negative && special == other.special;
+	}
+	bool operator!=(const Decimal &other) const { return !(*this == other); }
+	size_t hash() const { return (size_t(digits) * 1000 + exp) * 8 + negative * 4 + special; }
+
+	//! The double nearest to the written number
+	double value() const
+	{
+		if (special == NAN_VALUE) return std::nan("");
+		if (special == INF_VALUE) return negative ? -HUGE_VAL : HUGE_VAL;
+		int e = exp - 5;
+		double v = std::abs(e) > 22 ? digits * std::pow(10.0, e) : e >= 0 ? digits * pow10(e) : digits / pow10(-e);
+		return negative ? -v : v;
+	}
+
+	// writes at most 13 chars
+	char *write(char *out) const
+	{
+		if (negative && special != NAN_VALUE) *out++ = '-';
+		if (special == NAN_VALUE) return copy(out, "nan");
+		if (special == INF_VALUE) return copy(out, "inf");
+		if (digits == 0) { *out++ = '0'; return out; }
+
+		char d[6];
+		uint32_t v = digits;
+		for (int i = 5; i >= 0; --i) { d[i] = '0' + v % 10; v /= 10; }
+		int last = 5; // last significant digit
+		while (d[last] == '0') --last;
+
+		if (exp < -4 || exp >= 6) {
+			*out++ = d[0];
+			if (last > 0) {
+				*out++ = '.';
+				for (int i = 1; i <= last; ++i) *out++ = d[i];
+			}
+			*out++ = 'e';
+			*out++ = exp < 0 ? '-' : '+';
+			int e = std::abs(exp);
+			if (e >= 100) *out++ = '0' + e / 100;
+			*out++ = '0' + e / 10 % 10;
+			*out++ = '0' + e % 10;
+		}
+		else if (exp >= 0) {
+			for (int i = 0; i <= exp; ++i) *out++ = d[i];
+			if (last > exp) {
+				*out++ = '.';
+				for (int i = exp + 1; i <= last; ++i) *out++ = d[i];
+			}
+		}
+		else {
+			*out++ = '0';
+			*out++ = '.';
+			for (int i = -1; i > exp; --i) *out++ = '0';
+			for (int i = 0; i <= last; ++i) *out++ = d[i];
+		}
+		return out;
+	}
+
+private:
+	enum { NAN_VALUE = 1, INF_VALUE = 2 };
+
+	static double pow10(int e)
+	{
+		static const double table[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		return table[e];
+	}
+
+	// round(x * 10^e) with ties to even, like printf, for |e| <= 22
+	static uint32_t round_scaled(double x, int e)
+	{
+		// the powers are exact, so the error of the product or quotient
+		// tells which way a rounded tie really goes
+		double p = pow10(std::abs(e));
+		double scaled = e >= 0 ? x * p : x / p;
+		double error = e >= 0 ? std::fma(x, p, -scaled) : -std::fma(scaled, p, -x);
+		double down = std::floor(scaled);
+		double frac = scaled - down;
+		if (frac > 0.5 || (frac == 0.5 && (error > 0 || (error == 0 && std::fmod(down, 2) != 0))))
+			down += 1;
+		return (uint32_t)down;
+	}
+
+	// rounds through printf, for numbers too small or large to scale exactly
+	void round_printf(double x)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.5e", x);
+		// the decimal point depends on the locale, the digits don't
+		const char *p = text;
+		for (; *p && *p != 'e'; ++p)
+			if (*p >= '0' && *p <= '9') digits = digits * 10 + (*p - '0');
+		exp = *p ? std::atoi(p + 1) : 0;
+	}
+
+	static char *copy(char *out, const char *str)
+	{
+		while (*str) *out++ = *str++;
+		return out;
+	}
+
+	uint32_t digits; // 6 significant digits, 0 for zero
+	int exp;
+	bool negative;
+	char special;
+};
+
+//! Writes x like printf("%u"), for the vertex indices of mesh formats
+inline char *write_unsigned(char *out, size_t x)
+{
+	char text[20];
+	char *p = text + sizeof(text);
+	do { *--p = '0' + x % 10; x /= 10; } while (x);
+	while (p != text + sizeof(text)) *out++ = *p++;
+	return out;
+}
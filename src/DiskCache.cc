@@ -0,0 +1,404 @@
+#include "DiskCache.h"
+#include "printutils.h"
+#include "WorkStealingPool.h"
+#include "polyset.h"
+#include "Polygon2d.h"
+#include "TransformedGeometry.h"
+
+#ifdef ENABLE_CGAL
+#include "CGAL_Nef_polyhedron.h"
+#include "cgal.h"
+#include <CGAL/IO/Nef_polyhedron_iostream_3.h>
+#endif
+
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <boost/filesystem.hpp>
+namespace fs = boost::filesystem;
+
+namespace {
+	// bumped whenever the binary layout changes; old entries are then ignored
+	const uint32_t formatVersion = 2;
+	const char polySetMagic[4] = { 'O', 'S', 'P', 'S' };
+	const char polygon2dMagic[4] = { 'O', 'S', 'P', '2' };
+	const char postfixTimeMagic[4] = { 'O', 'S', 'P', 'T' };
+
+	template <typename T>
+	void put(std::ostream &out, const T &value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool get(std::istream &in, T &value)
+	{
+		return (bool)in.read(reinterpret_cast<char *>(&value), sizeof(T));
+	}
+
+	void putHeader(std::ostream &out, const char magic[4])
+	{
+		out.write(magic, 4);
+		put(out, formatVersion);
+	}
+
+	// returns the magic of the entry if its header is valid for this build
+	bool getHeader(std::istream &in, char magic[4])
+	{
+		uint32_t version;
+		return in.read(magic, 4) && get(in, version) && version == formatVersion;
+	}
+
+	void writePolySet(std::ostream &out, const PolySet &ps)
+	{
+		putHeader(out, polySetMagic);
+		put(out, (uint32_t)ps.getDimension());
+		put(out, (int32_t)ps.getConvexity());
+		boost::tribool convex = ps.convexValue();
+		put(out, (int8_t)(convex ? 1 : !convex ? 0 : 2));
+		// the shared vertex buffer, then each polygon as vertex indices
+		const std::vector<Vector3d> &vertices = ps.getVertices();
+		put(out, (uint64_t)vertices.size());
+		out.write(reinterpret_cast<const char *>(vertices.data()), vertices.size() * sizeof(Vector3d));
+		put(out, (uint64_t)ps.numPolygons());
+		for (const auto &poly : ps.getPolygons()) {
+			put(out, (uint32_t)poly.size());
+			put(out, (uint8_t)poly.open);
+			out.write(reinterpret_cast<const char *>(poly.indices()), poly.size() * sizeof(int));
+		}
+	}
+
+	PolySet *readPolySet(std::istream &in)
+	{
+		uint32_t dim;
+		int32_t convexity;
+		int8_t convex;
+		uint64_t numVertices;
+		if (!get(in, dim) || !get(in, convexity) || !get(in, convex) || !get(in, numVertices)) return nullptr;
+
+		std::unique_ptr<PolySet> ps(new PolySet(dim, convex == 1 ? boost::tribool(true) : convex == 0 ? boost::tribool(false) : boost::tribool(unknown)));
+		ps->setConvexity(convexity);
+		ps->reserve_vertices(numVertices);
+		Vector3d v;
+		for (uint64_t i = 0; i < numVertices; i++) {
+			if (!in.read(reinterpret_cast<char *>(v.data()), sizeof(Vector3d))) return nullptr;
+			ps->add_vertex(v);
+		}
+
+		uint64_t numPolygons;
+		if (!get(in, numPolygons)) return nullptr;
+		ps->reserve(numPolygons);
+		IndexedFace face;
+		for (uint64_t i = 0; i < numPolygons; i++) {
+			uint32_t size;
+			uint8_t open;
+			if (!get(in, size) || !get(in, open)) return nullptr;
+			face.resize(size);
+			if (!in.read(reinterpret_cast<char *>(face.data()), size * sizeof(int))) return nullptr;
+			for (int idx : face) {
+				if (idx < 0 || uint64_t(idx) >= numVertices) return nullptr;
+			}
+			ps->append_face(face, open != 0);
+		}
+		return ps.release();
+	}
+
+	void writePolygon2d(std::ostream &out, const Polygon2d &poly)
+	{
+		putHeader(out, polygon2dMagic);
+		put(out, (int32_t)poly.getConvexity());
+		put(out, (uint8_t)poly.isSanitized());
+		put(out, (uint64_t)poly.outlines().size());
+		for (const auto &outline : poly.outlines()) {
+			put(out, (uint8_t)outline.positive);
+			put(out, (uint8_t)outline.open);
+			put(out, (uint32_t)outline.vertices.size());
+			for (const auto &v : outline.vertices) {
+				put(out, v[0]);
+				put(out, v[1]);
+			}
+		}
+	}
+
+	Polygon2d *readPolygon2d(std::istream &in)
+	{
+		int32_t convexity;
+		uint8_t sanitized;
+		uint64_t numOutlines;
+		if (!get(in, convexity) || !get(in, sanitized) || !get(in, numOutlines)) return nullptr;
+
+		std::unique_ptr<Polygon2d> poly(new Polygon2d);
+		poly->setConvexity(convexity);
+		poly->setSanitized(sanitized != 0);
+		poly->outlines().resize(numOutlines);
+		for (auto &outline : poly->outlines()) {
+			uint8_t positive, open;
+			uint32_t numVertices;
+			if (!get(in, positive) || !get(in, open) || !get(in, numVertices)) return nullptr;
+			outline.positive = positive != 0;
+			outline.open = open != 0;
+			outline.vertices.resize(numVertices);
+			for (auto &v : outline.vertices) {
+				if (!get(in, v[0]) || !get(in, v[1])) return nullptr;
+			}
+		}
+		return poly.release();
+	}
+}
+
+bool DiskCache::setDirectory(const std::string &dir)
+{
+	std::lock_guard<std::mutex> lock(setupMutex);
+	if (this->spillOnly) removeSpillDirectory();
+	this->active = false;
+	this->dir.clear();
+	this->spillOnly = false;
+	if (dir.empty()) return true;
+
+	boost::system::error_code ec;
+	fs::create_directories(dir, ec);
+	if (!fs::is_directory(dir, ec)) {
+		PRINTB("WARNING: Can't use cache directory '%s', the persistent cache is disabled.", dir);
+		return false;
+	}
+	this->dir = fs::absolute(dir).generic_string();
+	this->active = true;
+	return true;
+}
+
+/*!
+	Entries are sharded into subdirectories named after the first byte of the
+	id to keep directory sizes reasonable for large caches.
+ */
+std::string DiskCache::path(const NodeId &id, const char *suffix) const
+{
+	std::string name = id.toString();
+	return (fs::path(this->dir) / name.substr(0, 2) / (name + suffix)).generic_string();
+}
+
+/*!
+	Moves a completely written temporary file into its final place. Losing a
+	race against another process writing the same entry is fine since both
+	files have the same content.
+ */
+bool DiskCache::commit(const std::string &tmpname, const std::string &filename) const
+{
+	boost::system::error_code ec;
+	fs::rename(tmpname, filename, ec);
+	if (ec) {
+		fs::remove(tmpname, ec);
+		return fs::exists(filename, ec);
+	}
+	return true;
+}
+
+bool DiskCache::containsGeometry(const NodeId &id) const
+{
+	boost::system::error_code ec;
+	return enabled() && fs::exists(path(id, ".geom"), ec);
+}
+
+shared_ptr<const Geometry> DiskCache::getGeometry(const NodeId &id) const
+{
+	if (!enabled()) return shared_ptr<const Geometry>();
+
+	std::ifstream in(path(id, ".geom").c_str(), std::ios::in | std::ios::binary);
+	if (!in.good()) return shared_ptr<const Geometry>();
+
+	Geometry *geom = nullptr;
+	char magic[4];
+	if (getHeader(in, magic)) {
+		if (std::equal(magic, magic + 4, polySetMagic)) geom = readPolySet(in);
+		else if (std::equal(magic, magic + 4, polygon2dMagic)) geom = readPolygon2d(in);
+	}
+	if (!geom) {
+		PRINTDB("Disk Cache: ignoring unreadable entry %s", id);
+		return shared_ptr<const Geometry>();
+	}
+	PRINTDB("Disk Cache hit: %s (%d bytes)", id % geom->memsize());
+	return shared_ptr<const Geometry>(geom);
+}
+
+bool DiskCache::insertGeometry(const NodeId &id, const shared_ptr<const Geometry> &geom) const
+{
+	if (!enabled() || !geom) return false;
+	// lazy transforms are stored as the geometry they stand for
+	shared_ptr<const Geometry> concrete = TransformedGeometry::materialize(geom);
+	const PolySet *ps = dynamic_cast<const PolySet *>(concrete.get());
+	const Polygon2d *poly = dynamic_cast<const Polygon2d *>(concrete.get());
+	if (!ps && !poly) {
+		PRINTDB("Disk Cache: not storing %s, unsupported geometry type", id);
+		return false;
+	}
+
+	std::string filename = path(id, ".geom");
+	boost::system::error_code ec;
+	if (fs::exists(filename, ec)) return true;
+	fs::create_directories(fs::path(filename).parent_path(), ec);
+
+	std::string tmpname = filename + fs::unique_path(".%%%%-%%%%-%%%%.tmp").string();
+	{
+		std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (ps) writePolySet(out, *ps);
+		else writePolygon2d(out, *poly);
+		if (!out.good()) {
+			out.close();
+			fs::remove(tmpname, ec);
+			PRINTDB("Disk Cache insert failed: %s", id);
+			return false;
+		}
+	}
+	return commit(tmpname, filename);
+}
+
+double DiskCache::getPostfixTime(const NodeId &id) const
+{
+	if (!enabled()) return 0;
+
+	std::ifstream in(path(id, ".time").c_str(), std::ios::in | std::ios::binary);
+	if (!in.good()) return 0;
+
+	char magic[4];
+	double ms;
+	if (!getHeader(in, magic) || !std::equal(magic, magic + 4, postfixTimeMagic) || !get(in, ms)) return 0;
+	return ms;
+}
+
+/*!
+	Unlike geometry, a time entry is replaced, since a node's postfix time
+	is only updated when it took longer than recorded.
+ */
+bool DiskCache::insertPostfixTime(const NodeId &id, double ms) const
+{
+	if (!enabled()) return false;
+
+	std::string filename = path(id, ".time");
+	boost::system::error_code ec;
+	fs::create_directories(fs::path(filename).parent_path(), ec);
+
+	std::string tmpname = filename + fs::unique_path(".%%%%-%%%%-%%%%.tmp").string();
+	{
+		std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		putHeader(out, postfixTimeMagic);
+		put(out, ms);
+		if (!out.good()) {
+			out.close();
+			fs::remove(tmpname, ec);
+			PRINTDB("Disk Cache insert failed: %s", id);
+			return false;
+		}
+	}
+	return commit(tmpname, filename);
+}
+
+#ifdef ENABLE_CGAL
+bool DiskCache::containsNEF(const NodeId &id) const
+{
+	boost::system::error_code ec;
+	return enabled() && fs::exists(path(id, ".nef3"), ec);
+}
+
+shared_ptr<const CGAL_Nef_polyhedron> DiskCache::getNEF(const NodeId &id) const
+{
+	if (!enabled()) return shared_ptr<const CGAL_Nef_polyhedron>();
+
+	std::ifstream in(path(id, ".nef3").c_str(), std::ios::in | std::ios::binary);
+	if (!in.good()) return shared_ptr<const CGAL_Nef_polyhedron>();
+
+	CGAL_Nef_polyhedron *N = new CGAL_Nef_polyhedron;
+	N->reset(new CGAL_Nef_polyhedron3);
+	in >> **N;
+	if (in.fail()) {
+		PRINTDB("Disk Cache: ignoring unreadable entry %s", id);
+		delete N;
+		return shared_ptr<const CGAL_Nef_polyhedron>();
+	}
+	PRINTDB("Disk Cache hit: %s (%d bytes)", id % N->memsize());
+	return shared_ptr<const CGAL_Nef_polyhedron>(N);
+}
+
+bool DiskCache::insertNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N) const
+{
+	// empty Nefs are cheaper to rebuild than to read back
+	if (!enabled() || !N || !N->get()) return false;
+
+	std::string filename = path(id, ".nef3");
+	boost::system::error_code ec;
+	if (fs::exists(filename, ec)) return true;
+	fs::create_directories(fs::path(filename).parent_path(), ec);
+
+	std::string tmpname = filename + fs::unique_path(".%%%%-%%%%-%%%%.tmp").string();
+	{
+		std::ofstream out(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out << **N;
+		if (!out.good()) {
+			out.close();
+			fs::remove(tmpname, ec);
+			PRINTDB("Disk Cache insert failed: %s", id);
+			return false;
+		}
+	}
+	return commit(tmpname, filename);
+}
+#endif
+
+bool DiskCache::startSpilling()
+{
+	if (enabled()) return true;
+	// concurrent evictions set up one directory; the losers see it enabled
+	std::lock_guard<std::mutex> lock(setupMutex);
+	if (enabled()) return true;
+	if (this->spillLimit == 0) return false;
+	boost::system::error_code ec;
+	fs::path spilldir = fs::temp_directory_path(ec) / fs::unique_path("openscad-spill-%%%%-%%%%-%%%%");
+	if (ec || !fs::create_directories(spilldir, ec)) {
+		PRINT("WARNING: Can't create a spill directory, evicted geometry will be recomputed.");
+		this->spillLimit = 0;
+		return false;
+	}
+	this->dir = spilldir.generic_string();
+	this->spillOnly = true;
+	this->active = true;
+	static std::once_flag registered;
+	std::call_once(registered, [] { std::atexit(removeSpillDirectory); });
+	return true;
+}
+
+void DiskCache::removeSpillDirectory()
+{
+	DiskCache *cache = instance();
+	if (!cache->spillOnly || !cache->enabled()) return;
+	boost::system::error_code ec;
+	fs::remove_all(cache->dir, ec);
+	// background spills still running find no directory and fail quietly
+	cache->spillLimit = 0;
+}
+
+/*!
+	Spilled entries are written on the worker pool, so the thread which
+	evicted them doesn't wait for the disk. A lookup before the file is
+	complete misses and recomputes the entry.
+ */
+void DiskCache::spillGeometry(const NodeId &id, const shared_ptr<const Geometry> &geom)
+{
+	if (!geom || persistent() || spilledBytes >= spillLimit || !startSpilling()) return;
+	WorkStealingPool::instance()->submit([this, id, geom](int) {
+		if (spilledBytes >= spillLimit || !insertGeometry(id, geom)) return;
+		boost::system::error_code ec;
+		auto size = fs::file_size(path(id, ".geom"), ec);
+		if (!ec) spilledBytes += size;
+	});
+}
+
+#ifdef ENABLE_CGAL
+void DiskCache::spillNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N)
+{
+	if (!N || persistent() || spilledBytes >= spillLimit || !startSpilling()) return;
+	WorkStealingPool::instance()->submit([this, id, N](int) {
+		if (spilledBytes >= spillLimit || !insertNEF(id, N)) return;
+		boost::system::error_code ec;
+		auto size = fs::file_size(path(id, ".nef3"), ec);
+		if (!ec) spilledBytes += size;
+	});
+}
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "memory.h"
+#include "hash.h"
+
+class Geometry;
+class CGAL_Nef_polyhedron;
+
+/*!
+	Persistent, content addressed geometry store used as the second tier of
+	GeometryCache and CGALCache.
+
+	Each entry is one file named after the structural NodeId of the node which
+	produced it, so entries are valid across runs and between processes.
+	PolySets and Polygon2ds are stored in a compact binary format, Nef
+	polyhedrons through the CGAL Nef iostream (the same format as .nef3 export).
+
+	Files are written to a temporary name in the target directory and renamed
+	into place, so several processes can share one cache directory and readers
+	never see a partially written entry.
+
+	The store is disabled until a directory is set (--cache-dir). Without
+	one, entries which the memory caches evict are spilled to a private
+	directory in the temp directory, which is removed at exit. In both cases
+	evicted entries are read back instead of being recomputed.
+
+	Next to the geometry, the persistent cache keeps the postfix time of each
+	node, which the threaded traversal uses to schedule the slowest nodes
+	first in later runs.
+*/
+class DiskCache
+{
+public:
+	static DiskCache *instance() { static DiskCache *cache = new DiskCache; return cache; }
+
+	// sets the cache directory, creating it if needed; an empty path disables
+	// the cache. Not to be called while the pool may be spilling.
+	bool setDirectory(const std::string &dir);
+	const std::string &directory() const { return dir; }
+	bool enabled() const { return active; }
+	// the directory was set with --cache-dir, so every insert is written through
+	bool persistent() const { return enabled() && !spillOnly; }
+
+	// limits the bytes spilled to the private directory
+	void setSpillLimit(uint64_t bytes) { spillLimit = bytes; }
+	// writes entries evicted from memory in the background, unless they're
+	// already in the persistent cache
+	void spillGeometry(const NodeId &id, const shared_ptr<const Geometry> &geom);
+#ifdef ENABLE_CGAL
+	void spillNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N);
+#endif
+
+	// PolySet and Polygon2d entries
+	bool containsGeometry(const NodeId &id) const;
+	shared_ptr<const Geometry> getGeometry(const NodeId &id) const;
+	bool insertGeometry(const NodeId &id, const shared_ptr<const Geometry> &geom) const;
+
+	// postfix times in ms; 0 if unknown
+	double getPostfixTime(const NodeId &id) const;
+	bool insertPostfixTime(const NodeId &id, double ms) const;
+
+#ifdef ENABLE_CGAL
+	// Nef polyhedron entries
+	bool containsNEF(const NodeId &id) const;
+	shared_ptr<const CGAL_Nef_polyhedron> getNEF(const NodeId &id) const;
+	bool insertNEF(const NodeId &id, const shared_ptr<const CGAL_Nef_polyhedron> &N) const;
+#endif
+
+private:
+	DiskCache() : active(false), spillOnly(false), spillLimit(UINT64_MAX), spilledBytes(0) { }
+
+	// switches to a private spill directory if no directory is set; false if there's none.
+	// Called from eviction handlers on any thread.
+	bool startSpilling();
+	static void removeSpillDirectory();
+
+	std::string path(const NodeId &id, const char *suffix) const;
+	bool commit(const std::string &tmpname, const std::string &filename) const;
+
+	// guards setting up the directory; dir is only written while active is false,
+	// and active publishes it to the threads reading entries
+	std::mutex setupMutex;
+	std::string dir;
+	std::atomic<bool> active;
+	std::atomic<bool> spillOnly;
+	std::atomic<uint64_t> spillLimit;
+	std::atomic<uint64_t> spilledBytes;
+};
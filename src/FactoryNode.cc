@@ -30,6 +30,7 @@
 #include "Assignment.h"
 #include "ModuleInstantiation.h"
 #include "Geometry.h"
+#include "TransformedGeometry.h"
 #include "value.h"
 #include "progress.h"
 #include "modcontext.h"
@@ -128,7 +129,17 @@ ResultObject FactoryNode::createGeometry(const NodeGeometries &children) const
 		}
 		PRINT(str.str());
 	}
-	ResultObject processed = processChildren(children);
+	ResultObject processed;
+	if (!acceptsTransformed()) {
+		// everything else needs the actual coordinates
+		NodeGeometries materialized;
+		materialized.reserve(children.size());
+		for (const auto &child : children)
+			materialized.push_back(NodeGeometry(child.first, TransformedGeometry::materialize(child.second)));
+		processed = processChildren(materialized);
+	}
+	else
+		processed = processChildren(children);
 	// simplify groups with <=1 objects
 	ResultObject result = GeomUtils::simplify(processed);
 	return result;
@@ -157,10 +168,18 @@ ResultObject ConstGeometryVisitor::visitChild(const GeometryGroupHandle &child)
 	return visitChildren(child->getChildren()); 
 }
 
+ResultObject ConstGeometryVisitor::visitChild(const shared_ptr<const TransformedGeometry> &child) const
+{
+	// visit the transformed geometry
+	return visitChild(child->get());
+}
+
 ResultObject ConstGeometryVisitor::visitChild(const GeometryHandle &child) const
 {
 	if (auto cc = dynamic_pointer_cast<const GeometryGroup>(child))
 		return visitChild(cc);
+	if (auto cc = dynamic_pointer_cast<const TransformedGeometry>(child))
+		return visitChild(cc);
 	if (auto cc = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(child))
 		return visitChild(cc);
 	if (auto cc = dynamic_pointer_cast<const PolySet>(child))
@@ -218,10 +237,18 @@ ResultObject GeometryVisitor::visitChild(const GeometryGroupHandle &child)
 	return visitChildren(child->getChildren());
 }
 
+ResultObject GeometryVisitor::visitChild(const shared_ptr<const TransformedGeometry> &child)
+{
+	// visit the transformed geometry
+	return visitChild(child->get());
+}
+
 ResultObject GeometryVisitor::visitChild(const GeometryHandle &child) 
 {
 	if (auto cc = dynamic_pointer_cast<const GeometryGroup>(child))
 		return visitChild(cc);
+	if (auto cc = dynamic_pointer_cast<const TransformedGeometry>(child))
+		return visitChild(cc);
 	if (auto cc = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(child))
 		return visitChild(cc);
 	if (auto cc = dynamic_pointer_cast<const PolySet>(child))
@@ -266,7 +293,7 @@ ResultObject NefNode::processChildren(const NodeGeometries &children) const
 
 ResultObject NefNode::visitChild(const ConstPolySetHandle &child) const
 {
-	if (auto nef = CGALUtils::createNefPolyhedronFromGeometry(*child))
+	if (auto nef = CGALUtils::getNefPolyhedron(child))
 		return ResultObject(nef);
 	return ResultObject(new EmptyGeometry());
 }
@@ -284,7 +311,7 @@ ResultObject PolyNode::processChildren(const NodeGeometries &children) const
 
 ResultObject PolyNode::visitChild(const ConstNefHandle &child) const
 {
-	if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*child))
+	if (auto ps = CGALUtils::getPolySet(child))
 		return ResultObject(ps);
 	return ResultObject(new EmptyGeometry());
 }
@@ -15,6 +15,7 @@ class GeometryGroup;
 class CGAL_Nef_polyhedron;
 class PolySet;
 class Polygon2d;
+class TransformedGeometry;
 
 class ConstGeometryVisitor
 {
@@ -23,6 +24,7 @@ public:
 	virtual ResultObject visitChild(const ConstPolySetHandle &child) const;
 	virtual ResultObject visitChild(const Polygon2dHandle &child) const;
 	virtual ResultObject visitChild(const GeometryGroupHandle &child) const;
+	virtual ResultObject visitChild(const shared_ptr<const TransformedGeometry> &child) const;
 	virtual ResultObject visitChild(const GeometryHandle &child) const;
 	virtual ResultObject visitChildren(const NodeGeometries &gg, class CpuProgress *progress = nullptr) const;
 	void recurseChildren(const NodeGeometries &gg) const;
@@ -35,6 +37,7 @@ public:
 	virtual ResultObject visitChild(const ConstPolySetHandle &child);
 	virtual ResultObject visitChild(const Polygon2dHandle &child);
 	virtual ResultObject visitChild(const GeometryGroupHandle &child);
+	virtual ResultObject visitChild(const shared_ptr<const TransformedGeometry> &child);
 	virtual ResultObject visitChild(const GeometryHandle &child);
 	virtual ResultObject visitChildren(const NodeGeometries &gg, class CpuProgress *progress = nullptr);
 	void recurseChildren(const NodeGeometries &gg);
@@ -85,6 +88,8 @@ public:
 
 	virtual bool preferNef() const { return false; }
 	virtual bool preferPoly() const { return false; }
+	// return true to receive TransformedGeometry children as they are instead of materialized
+	virtual bool acceptsTransformed() const { return false; }
 
 	// all factory nodes support convexity
 	int convexity;
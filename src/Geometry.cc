@@ -2,12 +2,19 @@
 #include "node.h"
 #include "Geometry.h"
 #include "Polygon2d.h"
+#include "polyset.h"
+#include "CGAL_Nef_polyhedron.h"
+#include "TransformedGeometry.h"
 
 #include "cgalutils.h"
 #include "clipper-utils.h"
+#include "printutils.h"
+#include "Reindexer.h"
 
 #include "maybe_const.h"
 
+#include <algorithm>
+
 namespace GeomUtils
 {
 	template<typename Base, typename T>
@@ -27,6 +34,143 @@ namespace GeomUtils
 	template <typename Out, typename In, typename = _Derived<In, Out>>
 	Out *_convertPointer(const shared_ptr<In> &src) { return dynamic_pointer_cast<Out>(src).get(); }
 
+	/*!
+		Groups the operands into clusters whose bounding boxes overlap,
+		directly or through other operands. Touching boxes overlap. Returns
+		the operand indices of each cluster, in operand order.
+	*/
+	std::vector<std::vector<size_t>> _overlapClusters(const std::vector<BoundingBox> &boxes)
+	{
+		std::vector<size_t> parent(boxes.size());
+		for (size_t i = 0; i < parent.size(); i++) parent[i] = i;
+		auto find = [&parent](size_t i) {
+			while (parent[i] != i) i = parent[i] = parent[parent[i]];
+			return i;
+		};
+
+		// sweep along x, only the boxes still open at a box's start can overlap it
+		std::vector<size_t> order(boxes.size());
+		for (size_t i = 0; i < order.size(); i++) order[i] = i;
+		std::sort(order.begin(), order.end(), [&boxes](size_t a, size_t b) {
+			return boxes[a].min()[0] < boxes[b].min()[0];
+		});
+		std::vector<size_t> open;
+		for (size_t i : order) {
+			open.erase(std::remove_if(open.begin(), open.end(), [&boxes, i](size_t j) {
+				return boxes[j].max()[0] < boxes[i].min()[0];
+			}), open.end());
+			for (size_t j : open)
+				if (boxes[i].intersects(boxes[j])) parent[find(i)] = find(j);
+			open.push_back(i);
+		}
+
+		std::vector<std::vector<size_t>> clusters;
+		std::unordered_map<size_t, size_t> clusterOf;
+		for (size_t i = 0; i < boxes.size(); i++) {
+			auto found = clusterOf.emplace(find(i), clusters.size());
+			if (found.second) clusters.emplace_back();
+			clusters[found.first->second].push_back(i);
+		}
+		return clusters;
+	}
+
+	/*!
+		Returns whether every edge of the PolySet joins two of its polygons,
+		once in each direction, i.e. the mesh is closed, manifold and
+		consistently oriented. Vertices are matched by position.
+		Self-intersections aren't detected.
+	*/
+	bool _isClosedMesh(const PolySet &ps)
+	{
+		Reindexer<Vector3d> positions;
+		std::unordered_map<uint64_t, int> edges;
+		auto key = [](int a, int b) { return (uint64_t(a) << 32) | uint32_t(b); };
+		for (const auto &poly : ps.getPolygons()) {
+			if (poly.open || poly.size() < 3) return false;
+			int first = positions.lookup(poly.front());
+			int prev = first;
+			for (size_t i = 1; i <= poly.size(); i++) {
+				int v = i < poly.size() ? positions.lookup(poly[i]) : first;
+				if (v == prev || ++edges[key(prev, v)] > 1) return false;
+				prev = v;
+			}
+		}
+		for (const auto &edge : edges) {
+			auto opposite = edges.find(key(int(edge.first & 0xffffffff), int(edge.first >> 32)));
+			if (opposite == edges.end()) return false;
+		}
+		return true;
+	}
+
+	/*!
+		Unions 3D operands. Clusters of operands that don't overlap any other
+		are independent, so only the clusters with several operands go through
+		the Nef polyhedra; the results are appended into one PolySet.
+
+		A lone PolySet keeps its mesh unless it isn't closed and manifold (see
+		_isClosedMesh()), e.g. a broken polyhedron(), which goes through the Nef
+		to be normalised like before. Self-intersecting meshes are kept as they
+		are.
+	*/
+	GeometryHandle _applyUnion3D(const GeometryHandles &flat)
+	{
+		std::vector<BoundingBox> boxes;
+		boxes.reserve(flat.size());
+		for (const auto &geom : flat) boxes.push_back(geom->getBoundingBox());
+		auto clusters = _overlapClusters(boxes);
+		if (clusters.size() < 2)
+			return GeometryHandle(CGALUtils::applyOperator(flat, OPENSCAD_UNION));
+
+		PRINTDB("Union of %d operands in %d disjoint clusters", flat.size() % clusters.size());
+		auto result = make_shared<PolySet>(3);
+		unsigned int convexity = 1;
+		for (const auto &cluster : clusters) {
+			GeometryHandle part;
+			auto lone = dynamic_pointer_cast<const PolySet>(flat[cluster.front()]);
+			if (cluster.size() == 1 && (!lone || _isClosedMesh(*lone))) {
+				part = flat[cluster.front()];
+			}
+			else {
+				GeometryHandles operands;
+				for (size_t i : cluster) operands.push_back(flat[i]);
+				part.reset(CGALUtils::applyOperator(operands, OPENSCAD_UNION));
+				// a CGAL error, which applyOperator has reported
+				if (!part) return nullptr;
+			}
+			convexity = std::max(convexity, part->getConvexity());
+			if (auto ps = dynamic_pointer_cast<const PolySet>(part)) {
+				result->append(*ps);
+			}
+			else if (auto N = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(part)) {
+				if (N->isEmpty()) continue;
+				auto ps = CGALUtils::getPolySet(N);
+				if (!ps) return nullptr;
+				result->append(*ps);
+			}
+		}
+		result->setConvexity(convexity);
+		return result;
+	}
+
+	/*!
+		Subtracts the 3D operands from the first one, skipping the ones whose
+		bounding boxes don't overlap it.
+	*/
+	GeometryHandle _applyDifference3D(const GeometryHandles &flat)
+	{
+		if (flat.empty()) return nullptr;
+		BoundingBox box = flat.front()->getBoundingBox();
+		GeometryHandles operands;
+		operands.push_back(flat.front());
+		for (size_t i = 1; i < flat.size(); i++)
+			if (box.intersects(flat[i]->getBoundingBox())) operands.push_back(flat[i]);
+		if (operands.size() < flat.size())
+			PRINTDB("Difference skips %d disjoint operands", (flat.size() - operands.size()));
+		if (operands.size() == 1)
+			return operands.front();
+		return GeometryHandle(CGALUtils::applyOperator(operands, OPENSCAD_DIFFERENCE));
+	}
+
 	GeometryHandle _apply(const GeometryHandles &flat, OpenSCADOperator op, int dim)
 	{
 		if (dim == 2) {
@@ -39,8 +183,11 @@ namespace GeomUtils
 			ClipperUtils utils;
 			return GeometryHandle(utils.apply(pp, ct));
 		}
-		if (dim == 3)
+		if (dim == 3) {
+			if (op == OPENSCAD_UNION) return _applyUnion3D(flat);
+			if (op == OPENSCAD_DIFFERENCE) return _applyDifference3D(flat);
 			return GeometryHandle(CGALUtils::applyOperator(flat, op));
+		}
 		return nullptr;
 	}
 
@@ -66,7 +213,7 @@ namespace GeomUtils
 			return nullptr;
 		if (child.second->isEmpty())
 			return nullptr;
-		return child.second;
+		return TransformedGeometry::materialize(child.second);
 	}
 
 	GeometryHandle _checkChild(const GeometryHandle &child)
@@ -75,7 +222,7 @@ namespace GeomUtils
 			return nullptr;
 		if (child->isEmpty())
 			return nullptr;
-		return child;
+		return TransformedGeometry::materialize(child);
 	}
 
 	const Geometry *_checkChild(const Geometry *child)
@@ -84,6 +231,9 @@ namespace GeomUtils
 			return nullptr;
 		if (child->isEmpty())
 			return nullptr;
+		// the materialized geometry is owned by the TransformedGeometry
+		if (auto tg = dynamic_cast<const TransformedGeometry*>(child))
+			return tg->get().get();
 		return child;
 	}
 
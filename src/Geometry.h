@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <mutex>
 
 #include "linalg.h"
 #include "memory.h"
@@ -13,6 +14,7 @@
 #include "maybe_const.h"
 
 #include "Handles.h"
+#include "MemoryBudget.h"
 
 namespace GeomUtils
 {
@@ -112,6 +114,52 @@ protected:
 	std::string type;
 };
 
+/*!
+	Another representation of a geometry, converted on first use and kept
+	with it, so every consumer of a shared geometry gets the same conversion.
+	The conversion runs once even when several threads ask for it at once;
+	if it throws, the next call tries again.
+
+	The converted geometry is held against the MemoryBudget for as long as
+	its source lives. The budget isn't enforced here, since the caches it
+	evicts from may be in use on this thread; the next cache insert evicts
+	for the conversion. A copy of the source starts without a conversion,
+	and the source must not change once it has been converted.
+
+	A conversion is seeded with its source, so converting it back returns
+	the source while that lives rather than converting again.
+*/
+template <class T>
+class ConvertedGeometry
+{
+public:
+	ConvertedGeometry() { }
+	ConvertedGeometry(const ConvertedGeometry &) { }
+	ConvertedGeometry &operator=(const ConvertedGeometry &) { return *this; }
+	~ConvertedGeometry() { MemoryBudget::instance()->release(converted.get()); }
+
+	// makes get() return source while it lives; called on a new conversion
+	// before it is shared
+	void seed(const shared_ptr<const T> &source) { this->source = source; }
+
+	// convert returns a new T, or nullptr if the conversion failed
+	template <class Convert>
+	shared_ptr<const T> get(Convert convert) const {
+		if (auto s = source.lock()) return s;
+		std::call_once(once, [this, &convert] {
+			converted.reset(convert());
+			MemoryBudget::instance()->acquire(converted.get());
+		});
+		return converted;
+	}
+
+private:
+	mutable std::once_flag once;
+	mutable shared_ptr<const T> converted;
+	// weak, the source holds its conversion
+	std::weak_ptr<const T> source;
+};
+
 class EmptyGeometry : public Geometry
 {
 public:
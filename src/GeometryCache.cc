@@ -1,4 +1,5 @@
 #include "GeometryCache.h"
+#include "DiskCache.h"
 #include "printutils.h"
 #include "Geometry.h"
 #ifdef DEBUG
@@ -10,21 +11,44 @@
 
 GeometryCache *GeometryCache::inst = NULL;
 
-shared_ptr<const Geometry> GeometryCache::get(const std::string &id) const
+GeometryCache::GeometryCache(size_t memorylimit) : cache(memorylimit)
+{
+	// entries dropped to make room can be read back from disk
+	cache.setEvictionHandler([](const NodeId &id, cache_entry &entry) {
+		DiskCache::instance()->spillGeometry(id, entry.geom);
+	});
+	MemoryBudget::instance()->registerCache(this);
+}
+
+bool GeometryCache::contains(const NodeId &id) const
+{
+	if (this->cache.contains(id)) return true;
+	if (shared_ptr<const Geometry> geom = DiskCache::instance()->getGeometry(id)) {
+		uint64_t tick = CacheClock::now();
+		cache_entry *entry = new cache_entry(geom);
+		if (DiskCache::instance()->persistent()) entry->postfixTime = DiskCache::instance()->getPostfixTime(id);
+		bool inserted = this->cache.insert(id, entry, geom->memsize());
+		MemoryBudget::instance()->enforce(tick);
+		return inserted;
+	}
+	return false;
+}
+
+shared_ptr<const Geometry> GeometryCache::get(const NodeId &id) const
 {
 	const shared_ptr<const Geometry> &geom = this->cache[id]->geom;
 #ifdef DEBUG
-	PRINTDB("Geometry Cache hit: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
+	PRINTDB("Geometry Cache hit: %s (%d bytes)", id % (geom ? geom->memsize() : 0));
 #endif
 	return geom;
 }
 
-bool GeometryCache::remove(const std::string &id)
+bool GeometryCache::remove(const NodeId &id)
 {
 	if (cache_entry *entry = this->cache[id]) {
 		shared_ptr<const Geometry> geom = entry->geom;
 #ifdef DEBUG
-		PRINTDB("Geometry Cache remove: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
+		PRINTDB("Geometry Cache remove: %s (%d bytes)", id % (geom ? geom->memsize() : 0));
 #endif
 		this->cache.remove(id);
 		return true;
@@ -32,15 +56,21 @@ bool GeometryCache::remove(const std::string &id)
 	return false;
 }
 
-bool GeometryCache::insert(const std::string &id, const shared_ptr<const Geometry> &geom)
+bool GeometryCache::insert(const NodeId &id, const shared_ptr<const Geometry> &geom)
 {
-	bool inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+	uint64_t tick = CacheClock::now();
+	// a replaced entry keeps its time
+	cache_entry *entry = new cache_entry(geom);
+	entry->postfixTime = postfixTime(id);
+	bool inserted = this->cache.insert(id, entry, geom ? geom->memsize() : 0);
+	if (DiskCache::instance()->persistent()) DiskCache::instance()->insertGeometry(id, geom);
+	MemoryBudget::instance()->enforce(tick);
 #ifdef DEBUG
 	assert(!dynamic_cast<const CGAL_Nef_polyhedron*>(geom.get()));
 	if (inserted) PRINTDB("Geometry Cache insert: %s (%d bytes)", 
-                         id.substr(0, 40) % (geom ? geom->memsize() : 0));
+                         id % (geom ? geom->memsize() : 0));
 	else PRINTDB("Geometry Cache insert failed: %s (%d bytes)",
-                id.substr(0, 40) % (geom ? geom->memsize() : 0));
+                id % (geom ? geom->memsize() : 0));
 #endif
 	return inserted;
 }
@@ -55,6 +85,22 @@ void GeometryCache::setMaxSize(size_t limit)
 	this->cache.setMaxCost(limit);
 }
 
+double GeometryCache::postfixTime(const NodeId &id) const
+{
+	const cache_entry *entry = this->cache.peek(id);
+	return entry ? entry->postfixTime : 0;
+}
+
+bool GeometryCache::setPostfixTime(const NodeId &id, double ms)
+{
+	cache_entry *entry = this->cache.peek(id);
+	if (!entry) return false;
+	if (ms <= entry->postfixTime) return true;
+	entry->postfixTime = ms;
+	if (DiskCache::instance()->persistent()) DiskCache::instance()->insertPostfixTime(id, ms);
+	return true;
+}
+
 void GeometryCache::print() const
 {
 	PRINTB("Geometries in cache: %d", this->cache.size());
@@ -62,7 +108,8 @@ void GeometryCache::print() const
 }
 
 GeometryCache::cache_entry::cache_entry(const shared_ptr<const Geometry> &geom)
-	: geom(geom)
+	: geom(geom), postfixTime(0)
 {
+	MemoryBudget::instance()->acquire(geom.get());
 	if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
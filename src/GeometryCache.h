@@ -3,45 +3,59 @@
 #include "cache.h"
 #include "memory.h"
 #include "Geometry.h"
+#include "hash.h"
+#include "MemoryBudget.h"
 
 class IGeometryCache
 {
 public:
-	virtual bool contains(const std::string &id) const = 0;
-	virtual shared_ptr<const class Geometry> get(const std::string &id) const = 0;
+	virtual bool contains(const NodeId &id) const = 0;
+	virtual shared_ptr<const class Geometry> get(const NodeId &id) const = 0;
 	virtual size_t maxSize() const = 0;
-	virtual bool insert(const std::string &id, const shared_ptr<const Geometry> &geom) = 0;
-	virtual bool remove(const std::string &id) = 0;
+	virtual bool insert(const NodeId &id, const shared_ptr<const Geometry> &geom) = 0;
+	virtual bool remove(const NodeId &id) = 0;
 	virtual void setMaxSize(size_t limit) = 0;
 	virtual void clear() = 0;
 	virtual void print() const = 0;
+	// the longest postfix time recorded with the node's entry in ms, 0 if unknown
+	virtual double postfixTime(const NodeId &id) const = 0;
+	// records a postfix time with the node's entry; false if it has none
+	virtual bool setPostfixTime(const NodeId &id, double ms) = 0;
 };
 
-class GeometryCache : public IGeometryCache
+class GeometryCache : public IGeometryCache, public MemoryBudget::Evictable
 {
 public:	
-	GeometryCache(size_t memorylimit = 100*1024*1024) : cache(memorylimit) {}
+	GeometryCache(size_t memorylimit = 100*1024*1024);
 
 	static GeometryCache *instance() { if (!inst) inst = new GeometryCache; return inst; }
 
-	virtual bool contains(const std::string &id) const { return this->cache.contains(id); }
-	virtual shared_ptr<const class Geometry> get(const std::string &id) const;
+	virtual bool contains(const NodeId &id) const;
+	virtual shared_ptr<const class Geometry> get(const NodeId &id) const;
 	virtual size_t maxSize() const;
-	virtual bool insert(const std::string &id, const shared_ptr<const Geometry> &geom);
-	virtual bool remove(const std::string &id);
+	virtual bool insert(const NodeId &id, const shared_ptr<const Geometry> &geom);
+	virtual bool remove(const NodeId &id);
 	virtual void setMaxSize(size_t limit);
 	virtual void clear() { cache.clear(); }
 	virtual void print() const;
+	virtual double postfixTime(const NodeId &id) const;
+	virtual bool setPostfixTime(const NodeId &id, double ms);
+
+	virtual uint64_t oldestUse() const { return cache.oldestUse(); }
+	virtual void evictOldest() { cache.evictOldest(); }
 
 private:
 	static GeometryCache *inst;
 
+	// holds its geometry against the MemoryBudget
 	struct cache_entry {
 		shared_ptr<const class Geometry> geom;
 		std::string msg;
+		double postfixTime;
 		cache_entry(const shared_ptr<const Geometry> &geom);
-		~cache_entry() { }
+		~cache_entry() { MemoryBudget::instance()->release(geom.get()); }
 	};
 
-	Cache<std::string, cache_entry> cache;
+	// mutable since contains() promotes entries from the disk tier
+	mutable Cache<NodeId, cache_entry> cache;
 };
@@ -7,6 +7,7 @@
 #include "module.h"
 #include "state.h"
 #include "FactoryNode.h"
+#include "TransformedGeometry.h"
 #include "transformnode.h"
 #include "csgnode.h"
 #include "csgops.h"
@@ -24,6 +25,7 @@
 #include "grid.h"
 #include "PathHelpers.h"
 #include "ModuleInstantiation.h"
+#include "Profiler.h"
 
 #include <algorithm>
 
@@ -92,8 +94,8 @@ void sortGeometries(const AbstractNode &parent, const NodeGeometries &children,
 GeometryHandle preferNef(const GeometryHandle &geom)
 {
 	if (auto ps = dynamic_pointer_cast<const PolySet>(geom)) {
-		if (auto nef = CGALUtils::createNefPolyhedronFromGeometry(*ps))
-			return GeometryHandle(nef);
+		if (auto nef = CGALUtils::getNefPolyhedron(ps))
+			return nef;
 		// TODO: error converting polyset to nef
 		return nullptr;
 	}
@@ -110,8 +112,8 @@ GeometryHandle preferNef(const GeometryHandle &geom)
 GeometryHandle preferPoly(const GeometryHandle &geom)
 {
 	if (auto nef = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*nef))
-			return GeometryHandle(ps);
+		if (auto ps = CGALUtils::getPolySet(nef))
+			return ps;
 		// TODO: error converting nef to polyset
 		return nullptr;
 	}
@@ -137,16 +139,16 @@ GeometryEvaluator::GeometryEvaluator(const class Tree &tree, Progress &progress,
 */
 shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNode &node)
 {
-	std::string idString = this->tree.getIdString(node);
+	const NodeId &id = this->tree.getId(node);
 	shared_ptr<const Geometry> result;
 	{
 		boost::detail::spinlock::scoped_lock lock(cacheLock);
 		IGeometryCache *primaryLookup = allowNef ? (IGeometryCache*)CGALCache::instance() : GeometryCache::instance();
 		IGeometryCache *secondaryLookup = !allowNef ? (IGeometryCache*)CGALCache::instance() : GeometryCache::instance();
-		if (primaryLookup->contains(idString))
-			result = primaryLookup->get(idString);
-		else if (secondaryLookup->contains(idString))
-			result = secondaryLookup->get(idString);
+		if (primaryLookup->contains(id))
+			result = primaryLookup->get(id);
+		else if (secondaryLookup->contains(id))
+			result = secondaryLookup->get(id);
 	}
 
 	// If not found in any caches, we need to evaluate the geometry
@@ -159,6 +161,9 @@ shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNod
 		result = this->root;
 	}
 
+	// consumers outside the evaluator expect concrete geometry
+	result = TransformedGeometry::materialize(result);
+
 	// if NEFs aren't allowed, convert them to PolySets
 	if (!allowNef)
 		result = preferPoly(result);
@@ -198,11 +203,11 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode &node,
 		return;
 	if (ThreadedNodeVisitor::smartCacheInsert(node, geom))
 		return;
-	const std::string &key = this->tree.getIdString(node);
+	const NodeId &key = this->tree.getId(node);
 	return smartCacheInsert(key, geom);
 }
 
-void GeometryEvaluator::smartCacheInsert(const std::string &key,
+void GeometryEvaluator::smartCacheInsert(const NodeId &key,
 	const shared_ptr<const Geometry> &geom)
 {
 	boost::detail::spinlock::scoped_lock lock(cacheLock);
@@ -232,11 +237,11 @@ bool GeometryEvaluator::isSmartCached(const AbstractNode &node)
 	shared_ptr<const Geometry> temp;
 	if (ThreadedNodeVisitor::checkSmartCache(node, temp))
 		return true;
-	const std::string &key = this->tree.getIdString(node);
+	const NodeId &key = this->tree.getId(node);
 	return isSmartCached(key);
 }
 
-bool GeometryEvaluator::isSmartCached(const std::string &key)
+bool GeometryEvaluator::isSmartCached(const NodeId &key)
 {
 	boost::detail::spinlock::scoped_lock lock(cacheLock);
 	bool result = (GeometryCache::instance()->contains(key) ||
@@ -249,11 +254,11 @@ shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const AbstractNode &
 	shared_ptr<const Geometry> temp;
 	if (ThreadedNodeVisitor::checkSmartCache(node, temp))
 		return temp;
-	const std::string &key = this->tree.getIdString(node);
+	const NodeId &key = this->tree.getId(node);
 	return smartCacheGet(key, preferNef);
 }
 
-shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const std::string &key, bool preferNef)
+shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const NodeId &key, bool preferNef)
 {
 	boost::detail::spinlock::scoped_lock lock(cacheLock);
 	shared_ptr<const Geometry> geom;
@@ -269,11 +274,11 @@ bool GeometryEvaluator::checkSmartCache(const AbstractNode &node, bool preferNef
 	if (ThreadedNodeVisitor::checkSmartCache(node, geom)) {
 		return true;
 	}
-	const std::string &key = this->tree.getIdString(node);
+	const NodeId &key = this->tree.getId(node);
 	return checkSmartCache(key, preferNef, geom);
 }
 
-bool GeometryEvaluator::checkSmartCache(const std::string &key, bool preferNef, shared_ptr<const Geometry> &geom)
+bool GeometryEvaluator::checkSmartCache(const NodeId &key, bool preferNef, shared_ptr<const Geometry> &geom)
 {
 	boost::detail::spinlock::scoped_lock lock(cacheLock);
 	bool hasgeom = GeometryCache::instance()->contains(key);
@@ -302,6 +307,7 @@ void GeometryEvaluator::addToParent(const State &state,
 	const AbstractNode &node,
 	const shared_ptr<const Geometry> &g)
 {
+	if (Profiler::enabled() && g) Profiler::setGeometryBytes(g->memsize());
 	// convert to the parent's preferred geometry type
 	GeometryHandle geom =
 		//state.parentPreferNef() ? preferNef(g) :
@@ -42,10 +42,10 @@ private:
 	bool checkSmartCache(const AbstractNode &node, bool preferNef, shared_ptr<const Geometry> &geom);
 	bool isSmartCached(const AbstractNode &node);
 
-	void smartCacheInsert(const std::string &key, const shared_ptr<const Geometry> &geom);
-	shared_ptr<const Geometry> smartCacheGet(const std::string &key, bool preferNef);
-	bool checkSmartCache(const std::string &key, bool preferNef, shared_ptr<const Geometry> &geom);
-	bool isSmartCached(const std::string &key);
+	void smartCacheInsert(const NodeId &key, const shared_ptr<const Geometry> &geom);
+	shared_ptr<const Geometry> smartCacheGet(const NodeId &key, bool preferNef);
+	bool checkSmartCache(const NodeId &key, bool preferNef, shared_ptr<const Geometry> &geom);
+	bool isSmartCached(const NodeId &key);
 
 	void addToParent(const State &state, const AbstractNode &node, const shared_ptr<const Geometry> &geom);
 	const NodeGeometries &getVisitedChildren(const AbstractNode &node);
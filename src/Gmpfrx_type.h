@@ -291,7 +291,6 @@ class Gmpfr:
         Gmpfr(const Gmpzf &f,
               std::float_round_style r,
               Gmpfr::Precision_type p=Gmpfr::get_default_precision()){
-				Gmp_lock lock(&f);
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
                 mpfr_init2(fr(),p);
                 mpfr_set_z(fr(),f.man(),_gmp_rnd(r));
@@ -299,7 +298,6 @@ class Gmpfr:
         }
 
         Gmpfr(const Gmpzf &f,Gmpfr::Precision_type p){
-				Gmp_lock lock(&f);
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
                 mpfr_init2(fr(),p);
                 mpfr_set_z(fr(),f.man(),mpfr_get_default_rounding_mode());
@@ -310,7 +308,6 @@ class Gmpfr:
         }
 
         Gmpfr(const Gmpzf &f){
-				Gmp_lock lock(&f);
                 mpfr_init2(fr(),
                            static_cast<Gmpfr::Precision_type>(
                                    mpz_sizeinbase(f.man(),2)<MPFR_PREC_MIN?
@@ -329,7 +326,6 @@ class Gmpfr:
               Gmpfr::Precision_type p=Gmpfr::get_default_precision()){
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
                 mpfr_init2(fr(),p);
-				Gmp_lock lock(&intexp.first);
                 mpfr_set_z(fr(),intexp.first.mpz(),_gmp_rnd(r));
                 mpfr_mul_2si(fr(),fr(),intexp.second,_gmp_rnd(r));
         }
@@ -337,7 +333,6 @@ class Gmpfr:
         Gmpfr(const std::pair<Gmpz,long> &intexp,Gmpfr::Precision_type p){
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
                 mpfr_init2(fr(),p);
-				Gmp_lock lock(&intexp.first);
                 mpfr_set_z(fr(),
                            intexp.first.mpz(),
                            mpfr_get_default_rounding_mode());
@@ -397,19 +392,16 @@ class Gmpfr:
               Gmpfr::Precision_type p=Gmpfr::get_default_precision()){ \
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX); \
                 mpfr_init2(fr(),p); \
-				Gmp_lock lock(&x); \
                 _fun(fr(),x._member,_gmp_rnd(r)); \
         } \
         Gmpfr(const _class &x,Gmpfr::Precision_type p){ \
                 CGAL_assertion(p<=MPFR_PREC_MAX); \
                 mpfr_init2(fr(),MPFR_PREC_MIN<p?p:MPFR_PREC_MIN); \
-				Gmp_lock lock(&x); \
                 _fun(fr(),x._member,mpfr_get_default_rounding_mode()); \
         } \
         Gmpfr(const _class &x){ \
                 Gmpfr::Precision_type p=(_preccode); \
                 mpfr_init2(fr(),MPFR_PREC_MIN<p?p:MPFR_PREC_MIN); \
-				Gmp_lock lock(&x); \
                 _fun(fr(),x._member,MPFR_RNDN); \
         }
 
@@ -425,14 +417,12 @@ class Gmpfr:
         // operator and the copy constructor from Handle_for.
 #ifdef CGAL_GMPFR_NO_REFCOUNT
         Gmpfr& operator=(const Gmpfr &a){
-				Gmp_lock lock(this, &a);
                 mpfr_set_prec(fr(),a.get_precision());
                 mpfr_set(fr(),a.fr(),mpfr_get_default_rounding_mode());
                 return *this;
         }
 
         Gmpfr(const Gmpfr &a){
-				Gmp_lock lock(&a);
                 mpfr_init2(fr(),a.get_precision());
                 mpfr_set(fr(),a.fr(),MPFR_RNDN);
         }
@@ -442,7 +432,6 @@ class Gmpfr:
               std::float_round_style r,
               Gmpfr::Precision_type p=Gmpfr::get_default_precision()){
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
-				Gmp_lock lock(&a);
 #ifndef CGAL_GMPFR_NO_REFCOUNT
                 if(p==a.get_precision()){
                         Gmpfr temp(a);
@@ -460,7 +449,6 @@ class Gmpfr:
 
         Gmpfr(const Gmpfr &a,Gmpfr::Precision_type p){
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
-				Gmp_lock lock(&a);
 #ifndef CGAL_GMPFR_NO_REFCOUNT
                 if(p==a.get_precision()){
                         Gmpfr temp(a);
@@ -626,14 +614,12 @@ Gmpfr::Precision_type Gmpfr::set_default_precision(Gmpfr::Precision_type prec){
 
 inline
 Gmpfr::Precision_type Gmpfr::get_precision()const{
-	Gmp_lock lock(this);
     return mpfr_get_prec(fr());
 }
 
 inline
 Gmpfr Gmpfr::round(Gmpfr::Precision_type p,std::float_round_style r)const{
         CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
-		Gmp_lock lock(this);
         return Gmpfr(*this,r,p);
 }
 
@@ -678,7 +664,6 @@ Gmpfr Gmpfr::operator+()const{
 
 inline
 Gmpfr Gmpfr::operator-()const{
-		Gmp_lock lock(this);
         Gmpfr result(0,get_precision());
         mpfr_neg(result.fr(),fr(),MPFR_RNDN);
         return result;
@@ -713,7 +698,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_OBJECT_BINARY_OPERATOR(_op,_class,_member,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(const _class &b){ \
-				Gmp_lock lock(this, &b); \
                 if(get_precision()>=Gmpfr::get_default_precision()) { \
                         _fun(fr(), \
                              fr(), \
@@ -733,7 +717,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_OBJECT_BINARY_OPERATOR(_op,_class,_member,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(const _class &b){ \
-				Gmp_lock lock(this, &b); \
                 if(unique()){ \
                         if(get_precision()>Gmpfr::get_default_precision()) { \
                                 _fun(fr(), \
@@ -768,7 +751,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_GMPFR_BINARY_OPERATOR(_op,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(const Gmpfr &b){ \
-				Gmp_lock lock(this, &b); \
                 Gmpfr::Precision_type _p=CGAL_GMPFR_MEMBER_PREC_2(b); \
                 if(_p==get_precision()) { \
                         _fun(fr(), \
@@ -789,7 +771,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_GMPFR_BINARY_OPERATOR(_op,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(const Gmpfr &b){ \
-				Gmp_lock lock(this, &b); \
                 Gmpfr::Precision_type _p=CGAL_GMPFR_MEMBER_PREC_2(b); \
                 if(unique()&&(_p==get_precision())){ \
                         _fun(fr(), \
@@ -815,7 +796,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_TYPE_BINARY_OPERATOR(_op,_type,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(_type x){ \
-				Gmp_lock lock(this); \
                 if(get_precision()>=Gmpfr::get_default_precision()) { \
                         _fun(fr(),fr(),x,mpfr_get_default_rounding_mode()); \
                 }else{ \
@@ -832,7 +812,6 @@ Gmpfr Gmpfr::operator-()const{
 #define CGAL_GMPFR_TYPE_BINARY_OPERATOR(_op,_type,_fun) \
         inline \
         Gmpfr& Gmpfr::_op(_type x){ \
-				Gmp_lock lock(this); \
                 if(unique()){ \
                         if(get_precision()>Gmpfr::get_default_precision()) { \
                                 _fun(fr(), \
@@ -869,7 +848,6 @@ CGAL_GMPFR_GMPFR_BINARY_OPERATOR(operator%=,mpfr_remainder)
 //#  warning "Gmpfr::operator%= is optimized in MPFR 2.3.0."
 inline
 Gmpfr& Gmpfr::operator%=(const Gmpfr &b){
-		Gmp_lock lock(this, &b);
         Gmpfr::Precision_type _p=CGAL_GMPFR_MEMBER_PREC_2(b);
         Gmpfr result(*this,_p);
         result/=b;
@@ -919,7 +897,6 @@ CGAL_GMPFR_OBJECT_BINARY_OPERATOR(operator/=,Gmpz,mpz(),mpfr_div_z)
 #define CGAL_GMPFR_ARITHMETIC_FUNCTION(_name,_fun) \
         inline \
         Gmpfr Gmpfr::_name (std::float_round_style r)const{ \
-				Gmp_lock lock(this); \
                 Gmpfr result(0,CGAL_GMPFR_MEMBER_PREC()); \
                 _fun(result.fr(),fr(),_gmp_rnd(r)); \
                 return result; \
@@ -929,7 +906,6 @@ CGAL_GMPFR_OBJECT_BINARY_OPERATOR(operator/=,Gmpz,mpz(),mpfr_div_z)
                             std::float_round_style r)const{ \
                 CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX); \
                 Gmpfr result(0,p); \
-				Gmp_lock lock(this); \
                 _fun(result.fr(),fr(),_gmp_rnd(r)); \
                 return result; \
         }
@@ -940,7 +916,6 @@ CGAL_GMPFR_ARITHMETIC_FUNCTION(cbrt,mpfr_cbrt)
 
 inline
 Gmpfr Gmpfr::kthroot(int k,std::float_round_style r)const{
-		Gmp_lock lock(this);
         Gmpfr result(0,CGAL_GMPFR_MEMBER_PREC());
         mpfr_root(result.fr(),fr(),k,_gmp_rnd(r));
         return result;
@@ -952,7 +927,6 @@ Gmpfr Gmpfr::kthroot(int k,
                      std::float_round_style r)const{
         CGAL_assertion(p>=MPFR_PREC_MIN&&p<=MPFR_PREC_MAX);
         Gmpfr result(0,p);
-		Gmp_lock lock(this);
         mpfr_root(result.fr(),fr(),k,_gmp_rnd(r));
         return result;
 }
@@ -967,44 +941,37 @@ CGAL_GMPFR_ARITHMETIC_FUNCTION(square,mpfr_sqr)
 
 inline
 bool Gmpfr::is_zero()const{
-		Gmp_lock lock(this);
         return mpfr_zero_p(fr())!=0;
 }
 
 inline
 bool Gmpfr::is_one()const{
-		Gmp_lock lock(this);
         return mpfr_cmp_ui(fr(),1)==0;
 }
 
 inline
 bool Gmpfr::is_nan()const{
-		Gmp_lock lock(this);
         return mpfr_nan_p(fr())!=0;
 }
 
 inline
 bool Gmpfr::is_inf()const{
-		Gmp_lock lock(this);
         return mpfr_inf_p(fr())!=0;
 }
 
 inline
 bool Gmpfr::is_number()const{
-		Gmp_lock lock(this);
         return mpfr_number_p(fr())!=0;
 }
 
 inline
 Sign Gmpfr::sign()const{
-		Gmp_lock lock(this);
         int s=mpfr_sgn(fr());
         return(s==0?ZERO:(s>0?POSITIVE:NEGATIVE));
 }
 
 inline
 bool Gmpfr::is_square()const{
-		Gmp_lock lock(this);
         Sign s=sign();
         if(s==NEGATIVE)
                 return false;
@@ -1018,7 +985,6 @@ bool Gmpfr::is_square()const{
 
 inline
 bool Gmpfr::is_square(Gmpfr &y)const{
-		Gmp_lock lock(&y);
         bool ret=is_square();
         if(ret)
                 y=sqrt();
@@ -1027,7 +993,6 @@ bool Gmpfr::is_square(Gmpfr &y)const{
 
 inline
 Comparison_result Gmpfr::compare(const Gmpfr& b)const{
-		Gmp_lock lock(this, &b);
         int c=mpfr_cmp(fr(),b.fr());
         return(c?(c>0?LARGER:SMALLER):EQUAL);
 }
@@ -1036,13 +1001,11 @@ Comparison_result Gmpfr::compare(const Gmpfr& b)const{
 
 inline
 double Gmpfr::to_double(std::float_round_style r)const{
-		Gmp_lock lock(this);
         return mpfr_get_d(fr(),_gmp_rnd(r));
 }
 
 inline
 std::pair<double,double>Gmpfr::to_interval()const{
-		Gmp_lock lock(this);
         return std::make_pair(
                         mpfr_get_d(fr(),MPFR_RNDD),
                         mpfr_get_d(fr(),MPFR_RNDU));
@@ -1050,7 +1013,6 @@ std::pair<double,double>Gmpfr::to_interval()const{
 
 inline
 std::pair<double,long> Gmpfr::to_double_exp(std::float_round_style r)const{
-		Gmp_lock lock(this);
         long e;
         double d=mpfr_get_d_2exp(&e,fr(),_gmp_rnd(r));
         return std::make_pair(d,e);
@@ -1058,7 +1020,6 @@ std::pair<double,long> Gmpfr::to_double_exp(std::float_round_style r)const{
 
 inline
 std::pair<std::pair<double,double>,long> Gmpfr::to_interval_exp()const{
-		Gmp_lock lock(this);
         long e1,e2;
         double d_low=mpfr_get_d_2exp(&e1,fr(),MPFR_RNDD);
         double d_upp=mpfr_get_d_2exp(&e2,fr(),MPFR_RNDU);
@@ -1068,7 +1029,6 @@ std::pair<std::pair<double,double>,long> Gmpfr::to_interval_exp()const{
 
 inline
 std::pair<Gmpz,long> Gmpfr::to_integer_exp()const{
-		Gmp_lock lock(this);
         if(this->is_zero())
                 return std::make_pair(Gmpz(0),long(0));
 
@@ -1099,7 +1059,6 @@ std::pair<Gmpz,long> Gmpfr::to_integer_exp()const{
 // of the numbers.
 inline
 std::istream& operator>>(std::istream& is,Gmpfr &f){
-		Gmp_lock lock(&f);
         std::istream::int_type c;
         std::ios::fmtflags old_flags = is.flags();
 
@@ -1230,7 +1189,6 @@ std::istream& operator>>(std::istream& is,Gmpfr &f){
 
 inline
 std::ostream& operator<<(std::ostream& os,const Gmpfr &a){
-		Gmp_lock lock(&a);
         if(a.is_nan())
                 return os<<"nan";
         if(a.is_inf())
@@ -1284,85 +1242,71 @@ std::ostream& operator<<(std::ostream& os,const Gmpfr &a){
 
 inline
 bool operator<(const Gmpfr &a,const Gmpfr &b){
-		Gmp_lock lock(&a, &b);
         return mpfr_less_p(a.fr(),b.fr())!=0;
 }
 
 inline
 bool operator==(const Gmpfr &a,const Gmpfr &b){
-		Gmp_lock lock(&a, &b);
         return mpfr_equal_p(a.fr(),b.fr())!=0;
 }
 
 inline
 bool operator<(const Gmpfr &a,long b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_si(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,long b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_si(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,long b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_si(a.fr(),b);
 }
 
 inline
 bool operator<(const Gmpfr &a,unsigned long b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_ui(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,unsigned long b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_ui(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,unsigned long b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_ui(a.fr(),b);
 }
 
 inline
 bool operator<(const Gmpfr &a,int b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_si(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,int b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_si(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,int b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_si(a.fr(),b);
 }
 
 inline
 bool operator<(const Gmpfr &a,double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_d(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_d(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,double b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_d(a.fr(),b);
 }
 
@@ -1370,56 +1314,47 @@ bool operator==(const Gmpfr &a,double b){
 #ifdef _MSC_VER
 inline
 bool operator<(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_d(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_d(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_d(a.fr(),b);
 }
 #else
 inline
 bool operator<(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_ld(a.fr(),b)<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return(mpfr_cmp_ld(a.fr(),b)>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,long double b){
-		Gmp_lock lock(&a);
         return !mpfr_cmp_ld(a.fr(),b);
 }
 #endif
 
 inline
 bool operator<(const Gmpfr &a,const Gmpz &b){
-		Gmp_lock lock(&a, &b);
         return(mpfr_cmp_z(a.fr(),b.mpz())<0);
 }
 
 inline
 bool operator>(const Gmpfr &a,const Gmpz &b){
-		Gmp_lock lock(&a, &b);
         return(mpfr_cmp_z(a.fr(),b.mpz())>0);
 }
 
 inline
 bool operator==(const Gmpfr &a,const Gmpz &b){
-		Gmp_lock lock(&a, &b);
         return !mpfr_cmp_z(a.fr(),b.mpz());
 }
 
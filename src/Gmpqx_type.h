@@ -43,14 +43,10 @@
 #include <vector>
 
 #include <boost/operators.hpp>
-#include <boost/smart_ptr/detail/spinlock.hpp>
-#include <boost/smart_ptr/detail/spinlock_pool.hpp>
 
 #include <CGAL/Handle_for.h>
 #include "Profile_counterx.h"
 
-#include "spinlock_pool_multi.h"
-
 #if defined(BOOST_MSVC)
 #  pragma warning(push)
 #  pragma warning(disable:4146)
@@ -109,19 +105,16 @@ public:
 #ifdef CGAL_GMPQ_NO_REFCOUNT
   Gmpq(const Gmpq &q) : Gmpq_rep()
   {
-	  Gmp_lock lock(&q);
 	  mpq_set(mpq(), q.mpq());
   }
 
   Gmpq& operator=(const Gmpq &q)
   {
-	  Gmp_lock lock(this, &q);
 	  mpq_set(mpq(), q.mpq());
 	  return *this;
   }
 
   void swap(Gmpq &q) {
-	  Gmp_lock lock(this, &q);
 	  mpq_swap(mpq(), q.mpq());
   }
 
@@ -176,7 +169,6 @@ public:
 
   Gmpq(const Gmpz& n)
   {
-	  Gmp_lock lock(&n);
 	  mpq_set_z(mpq(), n.mpz()); 
   }
 
@@ -204,7 +196,6 @@ public:
 
   Gmpq(const Gmpz& n, const Gmpz& d)
   {
-	Gmp_lock lock(&n, &d);
     mpz_set(mpq_numref(mpq()), n.mpz());
     mpz_set(mpq_denref(mpq()), d.mpz());
     mpq_canonicalize(mpq());
@@ -218,7 +209,6 @@ public:
 
   Gmpq(const Gmpfr &f)
   {
-	Gmp_lock lock(&f);
     std::pair<Gmpz,long> intexp=f.to_integer_exp();
     if(intexp.second<0){
             mpz_set(mpq_numref(mpq()),intexp.first.mpz());
@@ -255,7 +245,6 @@ public:
   // Gives the memory size in bytes. (not documented yet)
   std::size_t size() const
   {
-	Gmp_lock lock(this);
     std::size_t s_num = mpz_size(mpq_numref(mpq())) * (mp_bits_per_limb/8);
     std::size_t s_den = mpz_size(mpq_denref(mpq())) * (mp_bits_per_limb/8);
     return s_num + s_den;
@@ -263,13 +252,11 @@ public:
 
   Gmpz numerator() const
   {
-	  Gmp_lock lock(this); 
 	  return Gmpz(mpq_numref(mpq())); 
   }
 
   Gmpz denominator() const
   {
-	  Gmp_lock lock(this); 
 	  return Gmpz(mpq_denref(mpq())); 
   }
 
@@ -282,11 +269,9 @@ public:
   Gmpq& operator/=(const Gmpq &q);
 
   bool operator==(const Gmpq &q) const {
-	  Gmp_lock lock(this, &q);
 	  return mpq_equal(this->mpq(), q.mpq()) != 0;
   }
   bool operator< (const Gmpq &q) const {
-	  Gmp_lock lock(this, &q);
 	  return mpq_cmp(this->mpq(), q.mpq()) < 0; 
   }
 
@@ -320,15 +305,12 @@ public:
   Gmpq& operator*=(int z);
   Gmpq& operator/=(int z);
   bool  operator==(int z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) == 0;
   }
   bool  operator< (int z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) < 0;
   }
   bool  operator> (int z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) > 0;
   }
 
@@ -338,15 +320,12 @@ public:
   Gmpq& operator*=(long z);
   Gmpq& operator/=(long z);
   bool  operator==(long z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) == 0;
   }
   bool  operator< (long z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) < 0;
   }
   bool  operator> (long z) const {
-	  Gmp_lock lock(this);
 	  return mpq_cmp_si(mpq(), z, 1) > 0;
   }
 
@@ -383,15 +362,12 @@ public:
   Gmpq& operator*=(const Gmpfr &f);
   Gmpq& operator/=(const Gmpfr &f);
   bool  operator==(const Gmpfr &f) const {
-	  Gmp_lock lock(this, &f);
 	  return mpfr_cmp_q(f.fr(), mpq()) == 0;
   }
   bool  operator< (const Gmpfr &f) const {
-	  Gmp_lock lock(this, &f);
 	  return mpfr_cmp_q(f.fr(), mpq()) > 0;
   }
   bool  operator> (const Gmpfr &f) const {
-	  Gmp_lock lock(this, &f);
 	  return mpfr_cmp_q(f.fr(), mpq()) < 0;
   }
 };
@@ -401,7 +377,6 @@ Gmpq
 Gmpq::operator-() const
 {
 	Gmpq Res;
-	Gmp_lock lock(this);
     mpq_neg(Res.mpq(), mpq());
     return Res;
 }
@@ -410,7 +385,6 @@ inline
 Gmpq
 Gmpq::operator+() const
 {
-	Gmp_lock lock(this);
 	return Gmpq(mpq());
 }
 
@@ -419,7 +393,6 @@ Gmpq
 operator+(const Gmpq &x, const Gmpq &y)
 {
 	Gmpq Res;
-	Gmp_lock lock(&x, &y);
     mpq_add(Res.mpq(), x.mpq(), y.mpq());
     return Res;
 }
@@ -429,7 +402,6 @@ Gmpq&
 Gmpq::operator+=(const Gmpq &z)
 {
 	Gmpq Res;
-	Gmp_lock lock(this, &z);
 	mpq_add(Res.mpq(), mpq(), z.mpq());
     Res.swap(*this);
     return *this;
@@ -440,7 +412,6 @@ Gmpq
 operator-(const Gmpq &x, const Gmpq &y)
 {
 	Gmpq Res;
-	Gmp_lock lock(&x, &y);
     mpq_sub(Res.mpq(), x.mpq(), y.mpq());
     return Res;
 }
@@ -450,7 +421,6 @@ Gmpq&
 Gmpq::operator-=(const Gmpq &z)
 {
 	Gmpq Res;
-	Gmp_lock lock(this, &z);
 	mpq_sub(Res.mpq(), mpq(), z.mpq());
     Res.swap(*this);
     return *this;
@@ -461,7 +431,6 @@ Gmpq
 operator*(const Gmpq &x, const Gmpq &y)
 {
 	Gmpq Res;
-	Gmp_lock lock(&x, &y);
     mpq_mul(Res.mpq(), x.mpq(), y.mpq());
     return Res;
 }
@@ -471,7 +440,6 @@ Gmpq&
 Gmpq::operator*=(const Gmpq &z)
 {
 	Gmpq Res;
-	Gmp_lock lock(this, &z);
 	mpq_mul(Res.mpq(), mpq(), z.mpq());
     Res.swap(*this);
     return *this;
@@ -483,7 +451,6 @@ operator/(const Gmpq &x, const Gmpq &y)
 {
 	CGAL_precondition(y != 0);
 	Gmpq Res;
-	Gmp_lock lock(&x, &y);
     mpq_div(Res.mpq(), x.mpq(), y.mpq());
     return Res;
 }
@@ -494,7 +461,6 @@ Gmpq::operator/=(const Gmpq &y)
 {
 	CGAL_precondition(y != 0);
 	Gmpq Res;
-	Gmp_lock lock(this, &y);
 	mpq_div(Res.mpq(), mpq(), y.mpq());
     Res.swap(*this);
     return *this;
@@ -502,147 +468,126 @@ Gmpq::operator/=(const Gmpq &y)
 
 inline
 Gmpq& Gmpq::operator+=(int z) {
-	Gmp_lock lock(this);
 	*this += Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator-=(int z) {
-	Gmp_lock lock(this);
 	*this -= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator*=(int z) {
-	Gmp_lock lock(this);
 	*this *= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator/=(int z) {
-	Gmp_lock lock(this);
 	*this /= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator+=(long z) {
-	Gmp_lock lock(this);
 	*this += Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator-=(long z) {
-	Gmp_lock lock(this);
 	*this -= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator*=(long z) {
-	Gmp_lock lock(this);
 	*this *= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator/=(long z) {
-	Gmp_lock lock(this);
 	*this /= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator+=(long long z) {
-	Gmp_lock lock(this);
 	*this += Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator-=(long long z) {
-	Gmp_lock lock(this);
 	*this -= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator*=(long long z) {
-	Gmp_lock lock(this);
 	*this *= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator/=(long long z) {
-	Gmp_lock lock(this);
 	*this /= Gmpq(z);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator+=(double d) {
-	Gmp_lock lock(this);
 	*this += Gmpq(d);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator-=(double d) {
-	Gmp_lock lock(this);
 	*this -= Gmpq(d);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator*=(double d) {
-	Gmp_lock lock(this);
 	*this *= Gmpq(d);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator/=(double d) {
-	Gmp_lock lock(this);
 	*this /= Gmpq(d);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator+=(const Gmpfr &f) {
-	Gmp_lock lock(this, &f);
 	*this += Gmpq(f);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator-=(const Gmpfr &f) {
-	Gmp_lock lock(this, &f);
 	*this -= Gmpq(f);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator*=(const Gmpfr &f) {
-	Gmp_lock lock(this, &f);
 	*this *= Gmpq(f);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator/=(const Gmpfr &f) {
-	Gmp_lock lock(this, &f);
 	*this /= Gmpq(f);
 	return *this;
 }
 
 inline
 Gmpq& Gmpq::operator+=(const Gmpz &z) {
-	Gmp_lock lock(this, &z);
 	if (unique()) {
 		mpz_addmul(mpq_numref(mpq()), mpq_denref(mpq()), z.mpz());
 	}
@@ -662,7 +607,6 @@ Gmpq& Gmpq::operator+=(const Gmpz &z) {
 
 inline
 Gmpq& Gmpq::operator-=(const Gmpz &z) {
-	Gmp_lock lock(this, &z);
 	if (unique()) {
 		mpz_submul(mpq_numref(mpq()), mpq_denref(mpq()), z.mpz());
 	}
@@ -682,7 +626,6 @@ Gmpq& Gmpq::operator-=(const Gmpz &z) {
 
 inline
 Gmpq& Gmpq::operator*=(const Gmpz &z) {
-	Gmp_lock lock(this, &z);
 	if (unique()) {
 		mpz_mul(mpq_numref(mpq()), mpq_numref(mpq()), z.mpz());
 		mpq_canonicalize(mpq());
@@ -699,7 +642,6 @@ Gmpq& Gmpq::operator*=(const Gmpz &z) {
 
 inline
 Gmpq& Gmpq::operator/=(const Gmpz &z) {
-	Gmp_lock lock(this, &z);
 	if (unique()) {
 		mpz_mul(mpq_denref(mpq()), mpq_denref(mpq()), z.mpz());
 		mpq_canonicalize(mpq());
@@ -717,14 +659,12 @@ Gmpq& Gmpq::operator/=(const Gmpz &z) {
 inline
 double
 Gmpq::to_double() const {
-	Gmp_lock lock(this); 
 	return mpq_get_d(mpq()); 
 }
 
 inline
 Sign
 Gmpq::sign() const {
-	Gmp_lock lock(this); 
 	return static_cast<Sign>(mpq_sgn(mpq())); 
 }
 
@@ -732,7 +672,6 @@ inline
 std::ostream&
 operator<<(std::ostream& os, const Gmpq &z)
 {
-  Gmp_lock lock(&z);
   os << z.numerator() << "/" << z.denominator();
   return os;
 }
@@ -796,7 +735,6 @@ inline
 std::istream&
 operator>>(std::istream& is, Gmpq &z)
 {
-  Gmp_lock lock(&z);
   // reads rational and floating point literals.
   const std::istream::char_type zero = '0';
   std::istream::int_type c;
@@ -151,21 +151,18 @@ public:
 	  : Gmpzf_rep()
 	  , e(0)
   {
-	  Gmp_lock lock(&z);
 	  mpz_init_set(man(), z.man());
 	  canonicalize();
   }
 
   Gmpzf &operator=(const Gmpzf &z)
   {
-	  Gmp_lock lock(this, &z);
 	  mpz_set(man(), z.man());
 	  canonicalize();
 	  return *this;
   }
 
   void swap(Gmpzf &z) {
-	  Gmp_lock lock(this, &z);
 	  mpz_swap(man(), z.man());
   }
 #endif
@@ -181,7 +178,6 @@ public:
   Gmpzf(const Gmpz& n )
     : e(0)
   {
-	Gmp_lock lock(&n);
     mpz_init_set(man(), n.mpz());
     canonicalize();
   }
@@ -269,7 +265,6 @@ inline
 Gmpzf Gmpzf::operator-() const
 {
   Gmpzf result;
-  Gmp_lock lock(this);
   mpz_neg (result.man(), man());
   result.e = exp();
   CGAL_postcondition(is_canonical());
@@ -279,7 +274,6 @@ Gmpzf Gmpzf::operator-() const
 inline
 Gmpzf& Gmpzf::operator+=( const Gmpzf& b)
 {
-  Gmp_lock lock(this, &b);
   if (!b.is_zero()) { // important in sparse contexts
 	  Gmpzf result;
 	  const mpz_t *a_aligned, *b_aligned;
@@ -294,14 +288,12 @@ Gmpzf& Gmpzf::operator+=( const Gmpzf& b)
 inline
 Gmpzf& Gmpzf::operator+=( int i)
 {
-  Gmp_lock lock(this);
   return operator+=(Gmpzf (i));   // could be optimized, but why?
 }
 
 inline
 Gmpzf& Gmpzf::operator-=( const Gmpzf& b)
 {
-  Gmp_lock lock(this, &b);
   if (!b.is_zero()) { // important in sparse contexts
 	  Gmpzf result;
 	  const mpz_t *a_aligned, *b_aligned;
@@ -316,7 +308,6 @@ Gmpzf& Gmpzf::operator-=( const Gmpzf& b)
 inline
 Gmpzf& Gmpzf::operator-=( int i)
 {
-  Gmp_lock lock(this);
   return operator-=(Gmpzf (i));   // could be optimized, but why?
 }
 
@@ -324,7 +315,6 @@ inline
 Gmpzf& Gmpzf::operator*=( const Gmpzf& b)
 {
   Gmpzf result;
-  Gmp_lock lock(this, &b);
   mpz_mul(result.man(), man(), b.man());
   e += b.exp();
   swap (result);
@@ -337,7 +327,6 @@ inline
 Gmpzf& Gmpzf::operator*=( int i)
 {
   Gmpzf result;
-  Gmp_lock lock(this);
   mpz_mul_si(result.man(), man(), i);
   swap (result);
   canonicalize();
@@ -355,7 +344,6 @@ Gmpzf& Gmpzf::div(const Gmpzf& b)
   CGAL_precondition(!b.is_zero());
   Gmpzf result;
   const mpz_t *a_aligned, *b_aligned;
-  Gmp_lock lock(this, &b);
   align (a_aligned, b_aligned, e, *this, b);
   mpz_tdiv_q (result.man(), *a_aligned, *b_aligned); // round towards zero
   e = 0;
@@ -370,7 +358,6 @@ Gmpzf& Gmpzf::operator%= (const Gmpzf& b)
   CGAL_precondition(!b.is_zero());
   Gmpzf result;
   const mpz_t *a_aligned, *b_aligned;
-  Gmp_lock lock(this, &b);
   align (a_aligned, b_aligned, e, *this, b);
   mpz_tdiv_r (result.man(), *a_aligned, *b_aligned);
   swap(result);
@@ -393,14 +380,12 @@ Gmpzf& Gmpzf::operator%= (int i)
 inline
 bool Gmpzf::is_zero() const
 {
-  Gmp_lock lock(this);
   return mpz_sgn( man()) == 0;
 }
 
 inline
 Sign Gmpzf::sign() const
 {
-  Gmp_lock lock(this);
   return static_cast<Sign>(mpz_sgn( man()));
 }
 
@@ -408,7 +393,6 @@ inline
 Gmpzf Gmpzf::integral_division(const Gmpzf& b) const
 {
   Gmpzf result;
-  Gmp_lock lock(this, &b);
   mpz_divexact(result.man(), man(), b.man());
   result.e = exp()-b.exp();
   result.canonicalize();
@@ -420,7 +404,6 @@ inline
 Gmpzf Gmpzf::gcd (const Gmpzf& b) const
 {
   Gmpzf result;
-  Gmp_lock lock(this, &b);
   mpz_gcd (result.man(), man(), b.man()); // exponent is 0
   result.canonicalize();
   return result;
@@ -433,7 +416,6 @@ Gmpzf approximate_sqrt(const Gmpzf &f)
   // following: write *this as m * 2 ^ e with e even, and
   // then return sqrt(m) * 2 ^ (e/2)
   Gmpzf result;
-  Gmp_lock lock(&f);
   // make exponent even
   if (f.exp() % 2 == 0) {
     mpz_set (result.man(), f.man());
@@ -451,7 +433,6 @@ Comparison_result Gmpzf::compare (const Gmpzf &b) const
 {
   const mpz_t *a_aligned, *b_aligned;
   Exponent rexp; // ignored
-  Gmp_lock lock(this, &b);
   align (a_aligned, b_aligned, rexp, *this, b);
   int c = mpz_cmp(*a_aligned, *b_aligned);
   if (c < 0) return SMALLER;
@@ -463,7 +444,6 @@ inline
 double Gmpzf::to_double() const
 {
   Exponent k;                                 // exponent
-  Gmp_lock lock(this);
   double l = mpz_get_d_2exp (&k, man());      // mantissa in [0.5,1)
   return std::ldexp(l, k+exp());
 }
@@ -475,7 +455,6 @@ inline
 std::pair<double, long> Gmpzf::to_double_exp() const
 {
   Exponent k = 0;
-  Gmp_lock lock(this);
   double l = mpz_get_d_2exp (&k, man());
   return std::pair<double, long>(l, k+exp());
 }
@@ -487,7 +466,6 @@ std::pair<std::pair<double, double>, long> Gmpzf::to_interval_exp() const
   // first get mantissa in the form l*2^k, with 0.5 <= d < 1;
   // truncation is guaranteed to go towards zero
   long k = 0;
-  Gmp_lock lock(this);
   double l = mpz_get_d_2exp (&k, man());
   // l = +/- 0.1*...*
   //           ------
@@ -520,7 +498,6 @@ std::pair<double, double> Gmpzf::to_interval() const
 inline
 void Gmpzf::canonicalize()
 {
-  Gmp_lock::assert_locked(this);
   if (!is_zero()) {
     // chop off trailing zeros in m
     unsigned long zeros = mpz_scan1(man(), 0);
@@ -537,7 +514,6 @@ void Gmpzf::canonicalize()
 inline
 bool Gmpzf::is_canonical() const
 {
-  Gmp_lock::assert_locked(this);
   return (is_zero() && e==0) || mpz_odd_p (man());
 }
 
@@ -553,7 +529,6 @@ void Gmpzf::align ( const mpz_t*& a_aligned,
 			   Exponent& rexp,
 			   const Gmpzf& a, const Gmpzf& b) {
   static thread_local Gmpz s;
-  Gmp_lock::assert_locked(&a, &b);
   switch (CGAL_NTS compare (b.exp(), a.exp())) {
   case SMALLER:
     {
@@ -600,7 +575,6 @@ std::ostream& operator<< (std::ostream& os, const Gmpzf& a)
 inline
 std::ostream& print (std::ostream& os, const Gmpzf& a)
 {
-  Gmp_lock lock(&a);
   return os << a.man() << "*2^" << a.exp();
 }
 
@@ -627,7 +601,6 @@ bool operator<(const Gmpzf &a, const Gmpzf &b)
 inline
 bool operator==(const Gmpzf &a, const Gmpzf &b)
 {
-  Gmp_lock lock(&a, &b);
   return ( (mpz_cmp(a.man(), b.man()) == 0) && a.exp() == b.exp() );
 }
 
@@ -42,8 +42,6 @@
 #include <string>
 #include <locale>
 
-#include "spinlock_pool_multi.h"
-
 namespace CGAL {
 
 // TODO : benchmark without ref-counting, and maybe give the possibility
@@ -104,19 +102,16 @@ public:
 #ifdef CGAL_GMPZ_NO_REFCOUNT
   Gmpz(const Gmpz &z) : Gmpz_rep()
   {
-	  Gmp_lock lock(&z);
 	  mpz_init_set(mpz(), z.mpz());
   }
   
   Gmpz &operator=(const Gmpz &z)
   {
-	  Gmp_lock lock(this, &z);
 	  mpz_set(mpz(), z.mpz());
 	  return *this;
   }
 
   void swap(Gmpz &z) {
-	  Gmp_lock lock(this, &z);
 	  mpz_swap(mpz(), z.mpz());
   }
 
@@ -149,28 +144,23 @@ public:
 
   // returns the number of bits used to represent this number
   size_t bit_size() const {
-	  Gmp_lock lock(this);
 	  return mpz_sizeinbase(mpz(), 2);
   }
 
   // returns the memory size in bytes
   size_t size() const {
-	  Gmp_lock lock(this);
 	  return mpz_size(mpz()) / (mp_bits_per_limb / 8);
   }
 
   // returns the number of decimal digits needed to represent this number
   size_t approximate_decimal_length() const {
-	  Gmp_lock lock(this);
 	  return mpz_sizeinbase(mpz(), 10);
   }
 
   double to_double() const {
-	  Gmp_lock lock(this);
 	  return mpz_get_d(mpz());
   }
   Sign sign() const {
-	  Gmp_lock lock(this);
 	  return static_cast<Sign>(mpz_sgn(mpz()));
   }
 
@@ -198,7 +188,6 @@ public:
 #define CGAL_GMPZ_OBJECT_OPERATOR(_op,_class,_fun)    \
   Gmpz& _op(const _class& z){                        \
     Gmpz Res;                                         \
-	Gmp_lock lock(this, &z);                          \
     _fun(Res.mpz(), mpz(), z.mpz());                  \
     swap(Res);                                        \
     return *this;                                     \
@@ -216,48 +205,40 @@ public:
 
   bool operator<(const Gmpz &b) const
   {
-	  Gmp_lock lock(this, &b);
 	  return mpz_cmp(this->mpz(), b.mpz()) < 0;
   }
   bool operator==(const Gmpz &b) const
   {
-	  Gmp_lock lock(this, &b);
 	  return mpz_cmp(this->mpz(), b.mpz()) == 0;
   }
 
 
   Gmpz operator+() const {
-	  Gmp_lock lock(this);
 	  return Gmpz(mpz());
   }
   Gmpz operator-() const {
     Gmpz Res;
-	Gmp_lock lock(this);
     mpz_neg(Res.mpz(), mpz());
     return Res;
   }
 
   Gmpz& operator <<= (const unsigned long& i){
     Gmpz Res;
-	Gmp_lock lock(this);
     mpz_mul_2exp(Res.mpz(),this->mpz(), i);
     swap(Res);
     return *this;
   }
   Gmpz& operator >>= (const unsigned long& i){
     Gmpz Res;
-	Gmp_lock lock(this);
     mpz_tdiv_q_2exp(Res.mpz(),this->mpz(), i);
     swap(Res);
     return *this;
   }
 
   Gmpz& operator++() {
-	  Gmp_lock lock(this);
 	  return *this += 1;
   }
   Gmpz& operator--() {
-	  Gmp_lock lock(this);
 	  return *this -= 1;
   }
 
@@ -268,15 +249,12 @@ public:
   Gmpz& operator*=(int i);
   Gmpz& operator/=(int i);
   bool  operator==(int i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) == 0;
   }
   bool  operator< (int i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) < 0;
   }
   bool  operator> (int i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) > 0;
   }
 
@@ -286,15 +264,12 @@ public:
   Gmpz& operator*=(long i);
   Gmpz& operator/=(long i);
   bool  operator==(long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) == 0;
   }
   bool  operator< (long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) < 0;
   }
   bool  operator> (long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_si(this->mpz(), i) > 0;
   }
 
@@ -304,15 +279,12 @@ public:
   Gmpz& operator*=(unsigned long i);
   Gmpz& operator/=(unsigned long i);
   bool  operator==(unsigned long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_ui(this->mpz(), i) == 0;
   }
   bool  operator< (unsigned long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_ui(this->mpz(), i) < 0;
   }
   bool  operator> (unsigned long i) const {
-	  Gmp_lock lock(this);
 	  return mpz_cmp_ui(this->mpz(), i) > 0;
   }
 };
@@ -322,7 +294,6 @@ public:
 #define CGAL_GMPZ_SCALAR_OPERATOR(_op,_type,_fun)   \
   inline Gmpz& Gmpz::_op(_type z) {                 \
     Gmpz Res;                                       \
-	Gmp_lock lock(this);                            \
     _fun(Res.mpz(), mpz(), z);                      \
     swap(Res);                                      \
     return *this;                                   \
@@ -341,7 +312,6 @@ CGAL_GMPZ_SCALAR_OPERATOR(operator/=,unsigned long,mpz_tdiv_q_ui)
 inline Gmpz& Gmpz::operator+=(int i)
 {
   Gmpz Res;
-  Gmp_lock lock(this);
   if (i >= 0)
     mpz_add_ui(Res.mpz(), mpz(), i);
   else
@@ -353,7 +323,6 @@ inline Gmpz& Gmpz::operator+=(int i)
 inline Gmpz& Gmpz::operator+=(long i)
 {
   Gmpz Res;
-  Gmp_lock lock(this);
   if (i >= 0)
     mpz_add_ui(Res.mpz(), mpz(), i);
   else
@@ -365,16 +334,13 @@ inline Gmpz& Gmpz::operator+=(long i)
 
 
 inline Gmpz& Gmpz::operator-=(int  i) {
-	Gmp_lock lock(this);
 	return *this += -i;
 }
 inline Gmpz& Gmpz::operator-=(long i) {
-	Gmp_lock lock(this);
 	return *this += -i;
 }
 
 inline Gmpz& Gmpz::operator/=(int b) {
-  Gmp_lock lock(this);
   if (b>0) {
     Gmpz Res;
     mpz_tdiv_q_ui(Res.mpz(), mpz(), b);
@@ -385,7 +351,6 @@ inline Gmpz& Gmpz::operator/=(int b) {
 }
 
 inline Gmpz& Gmpz::operator/=(long b) {
-  Gmp_lock lock(this);
   if (b>0) {
     Gmpz Res;
     mpz_tdiv_q_ui(Res.mpz(), mpz(), b);
@@ -399,7 +364,6 @@ inline
 std::ostream&
 operator<<(std::ostream& os, const Gmpz &z)
 {
-  Gmp_lock lock(&z);
   char *str = new char [mpz_sizeinbase(z.mpz(),10) + 2];
   str = mpz_get_str(str, 10, z.mpz());
   os << str ;
@@ -433,7 +397,6 @@ inline
 std::istream &
 gmpz_new_read(std::istream &is, Gmpz &z)
 {
-  Gmp_lock lock(&z);
   bool negative = false;
   const std::istream::char_type zero = '0';
   std::istream::int_type c;
@@ -556,7 +519,6 @@ inline
 std::istream&
 operator>>(std::istream& is, Gmpz &z)
 {
-  Gmp_lock lock(&z);
   return gmpz_new_read(is, z);
 }
 
@@ -566,7 +528,6 @@ struct Split_double<Gmpz>
   void operator()(double d, Gmpz &num, Gmpz &den) const
   {
     std::pair<double, double> p = split_numerator_denominator(d);
-	Gmp_lock lock(&num, &den);
     num = Gmpz(p.first);
     den = Gmpz(p.second);
   }
@@ -202,6 +202,7 @@ private slots:
 	void actionExportSTL();
 	void actionExportOFF();
 	void actionExportAMF();
+	void actionExport3MF();
 	void actionExportDXF();
 	void actionExportSVG();
 	void actionExportCSG();
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filename)
+	: valid(false), data(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr)
+{
+	HANDLE f = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+												 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (f == INVALID_HANDLE_VALUE) return;
+	this->file = f;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(f, &size)) return;
+	this->length = size_t(size.QuadPart);
+	this->valid = true;
+	// empty files can't be mapped
+	if (this->length == 0) return;
+
+	HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m) {
+		this->valid = false;
+		return;
+	}
+	this->mapping = m;
+	this->data = static_cast<const char *>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+	if (!this->data) this->valid = false;
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->data) UnmapViewOfFile(this->data);
+	if (this->mapping) CloseHandle(this->mapping);
+	if (this->file != INVALID_HANDLE_VALUE) CloseHandle(this->file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &filename)
+	: valid(false), data(nullptr), length(0)
+{
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		this->length = size_t(st.st_size);
+		this->valid = true;
+		// empty files can't be mapped
+		if (this->length > 0) {
+			void *p = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED) {
+				this->valid = false;
+				this->length = 0;
+			}
+			else {
+				madvise(p, this->length, MADV_SEQUENTIAL);
+				this->data = static_cast<const char *>(p);
+			}
+		}
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->data) munmap(const_cast<char *>(this->data), this->length);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/*!
+	A read-only view of a whole file.
+
+	The file is memory mapped where the platform supports it, so importers can
+	tokenize it in place without copying it through an ifstream. The contents
+	are not NUL-terminated; use begin() and end().
+*/
+class MappedFile
+{
+public:
+	MappedFile(const std::string &filename);
+	~MappedFile();
+
+	bool isOpen() const { return this->valid; }
+	const char *begin() const { return this->data; }
+	const char *end() const { return this->data + this->length; }
+	size_t size() const { return this->length; }
+
+private:
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool valid;
+	const char *data;
+	size_t length;
+#ifdef _WIN32
+	void *file;
+	void *mapping;
+#endif
+};
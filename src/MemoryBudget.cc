@@ -0,0 +1,130 @@
+#include "MemoryBudget.h"
+#include "Geometry.h"
+#include "PlatformUtils.h"
+#include "printutils.h"
+
+#include <algorithm>
+
+MemoryBudget *MemoryBudget::inst = NULL;
+
+void MemoryBudget::setLimit(uint64_t bytes)
+{
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		maxBytes = bytes;
+	}
+	enforce(UINT64_MAX);
+}
+
+uint64_t MemoryBudget::used() const
+{
+	boost::mutex::scoped_lock lock(mutex);
+	return usedBytes;
+}
+
+uint64_t MemoryBudget::peak() const
+{
+	boost::mutex::scoped_lock lock(mutex);
+	return peakBytes;
+}
+
+void MemoryBudget::registerCache(Evictable *cache)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	caches.push_back(cache);
+}
+
+void MemoryBudget::acquire(const Geometry *geom)
+{
+	if (!geom) return;
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		auto found = held.find(geom);
+		if (found != held.end()) {
+			found->second.refs++;
+			return;
+		}
+	}
+	// measured outside the lock, memsize() of a Nef walks all its numbers
+	uint64_t bytes = geom->isEmpty() ? 0 : geom->memsize();
+	boost::mutex::scoped_lock lock(mutex);
+	Held &h = held[geom];
+	if (h.refs++ == 0) {
+		h.bytes = bytes;
+		usedBytes += bytes;
+		peakBytes = std::max(peakBytes, usedBytes);
+	}
+}
+
+void MemoryBudget::release(const Geometry *geom)
+{
+	if (!geom) return;
+	boost::mutex::scoped_lock lock(mutex);
+	auto found = held.find(geom);
+	if (found == held.end()) return;
+	if (--found->second.refs == 0) {
+		usedBytes -= found->second.bytes;
+		held.erase(found);
+	}
+}
+
+void MemoryBudget::charge(int64_t bytes)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	usedBytes += bytes;
+	peakBytes = std::max(peakBytes, usedBytes);
+}
+
+void MemoryBudget::remeasure(const Geometry *geom)
+{
+	if (!geom) return;
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		if (held.find(geom) == held.end()) return;
+	}
+	uint64_t bytes = geom->isEmpty() ? 0 : geom->memsize();
+	boost::mutex::scoped_lock lock(mutex);
+	auto found = held.find(geom);
+	if (found == held.end()) return;
+	usedBytes = usedBytes - found->second.bytes + bytes;
+	found->second.bytes = bytes;
+	peakBytes = std::max(peakBytes, usedBytes);
+}
+
+void MemoryBudget::enforce(uint64_t usedBefore)
+{
+	while (true) {
+		Evictable *oldest = nullptr;
+		uint64_t oldestUse = usedBefore;
+		uint64_t usedBeforeEviction;
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if (maxBytes == 0 || usedBytes <= maxBytes) return;
+			usedBeforeEviction = usedBytes;
+			for (auto cache : caches) {
+				uint64_t use = cache->oldestUse();
+				if (use < oldestUse) {
+					oldest = cache;
+					oldestUse = use;
+				}
+			}
+		}
+		// nothing old enough is left; the rest is in use
+		if (!oldest) return;
+		// releases the entry's geometry, which takes the lock
+		oldest->evictOldest();
+		// the geometry is still held elsewhere, e.g. by the traverse cache
+		// during a traversal; evicting more would flush the caches for nothing
+		boost::mutex::scoped_lock lock(mutex);
+		if (usedBytes >= usedBeforeEviction) return;
+	}
+}
+
+void MemoryBudget::print() const
+{
+	boost::mutex::scoped_lock lock(mutex);
+	PRINTB("Cached geometry: %s, peak %s, budget %s",
+		PlatformUtils::toMemorySizeString(usedBytes, 2) %
+		PlatformUtils::toMemorySizeString(peakBytes, 2) %
+		(maxBytes ? PlatformUtils::toMemorySizeString(maxBytes, 2) : std::string("unlimited")));
+}
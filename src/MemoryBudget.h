@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <boost/thread/mutex.hpp>
+
+class Geometry;
+
+/*!
+	Accounts the memory of the geometry held by GeometryCache, CGALCache and
+	the traverse cache of ThreadedNodeVisitor, and of the cached convex
+	decompositions of Minkowski operands, against one budget.
+
+	The caches report each geometry they hold with acquire() and release().
+	A geometry held by several caches is counted once, with the size
+	reported by its memsize(). When the total is over the budget, enforce()
+	makes the registered caches evict their least recently used entries,
+	oldest across all caches first, until it fits or an eviction frees
+	nothing because the geometry is still held elsewhere. Evicted entries are
+	spilled to the DiskCache rather than dropped. The traverse cache only
+	counts; its entries are needed until the traversal finishes.
+
+	A budget of 0 is unlimited.
+*/
+class MemoryBudget
+{
+public:
+	class Evictable
+	{
+	public:
+		virtual ~Evictable() { }
+		// the use tick (see CacheClock) of the least recently used entry, UINT64_MAX if empty
+		virtual uint64_t oldestUse() const = 0;
+		// evicts the least recently used entry
+		virtual void evictOldest() = 0;
+	};
+
+	static MemoryBudget *instance() { if (!inst) inst = new MemoryBudget; return inst; }
+
+	void setLimit(uint64_t bytes);
+	uint64_t limit() const { return maxBytes; }
+	uint64_t used() const;
+	uint64_t peak() const;
+
+	void registerCache(Evictable *cache);
+
+	void acquire(const Geometry *geom);
+	void release(const Geometry *geom);
+	// counts bytes held outside of geometry, e.g. convex decompositions;
+	// negative to give them back
+	void charge(int64_t bytes);
+	// measures a held geometry again after its memsize() changed; the next
+	// enforce() evicts for any growth
+	void remeasure(const Geometry *geom);
+
+	// evicts entries last used before the given tick until the total fits;
+	// called with the caches locked
+	void enforce(uint64_t usedBefore);
+
+	void print() const;
+
+private:
+	MemoryBudget() : maxBytes(0), usedBytes(0), peakBytes(0) { }
+
+	struct Held
+	{
+		size_t refs;
+		uint64_t bytes;
+		Held() : refs(0), bytes(0) { }
+	};
+
+	static MemoryBudget *inst;
+
+	uint64_t maxBytes;
+	uint64_t usedBytes;
+	uint64_t peakBytes;
+	mutable boost::mutex mutex;
+	std::unordered_map<const Geometry *, Held> held;
+	std::vector<Evictable *> caches;
+};
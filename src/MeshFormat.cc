@@ -0,0 +1,208 @@
+#include "MeshFormat.h"
+#include "polyset.h"
+#include "Reindexer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <boost/detail/endian.hpp>
+
+namespace {
+	const char magic[8] = { 'O', 'S', 'M', 'E', 'S', 'H', 0, 0 };
+	const size_t CHUNK_BYTES = 1 << 16;
+
+	template <typename T>
+	T swapBytes(T value)
+	{
+#ifdef BOOST_BIG_ENDIAN
+		char bytes[sizeof(T)];
+		memcpy(bytes, &value, sizeof(T));
+		std::reverse(bytes, bytes + sizeof(T));
+		memcpy(&value, bytes, sizeof(T));
+#endif
+		return value;
+	}
+
+	template <typename T>
+	void put(char *out, T value)
+	{
+		value = swapBytes(value);
+		memcpy(out, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T get(const char *in)
+	{
+		T value;
+		memcpy(&value, in, sizeof(T));
+		return swapBytes(value);
+	}
+
+	//! Writes count values in file byte order
+	template <typename T>
+	void putArray(std::ostream &output, const T *values, size_t count)
+	{
+#ifdef BOOST_BIG_ENDIAN
+		std::vector<char> buffer(CHUNK_BYTES);
+		while (count > 0) {
+			size_t n = std::min(count, CHUNK_BYTES / sizeof(T));
+			for (size_t i = 0; i < n; i++) put(&buffer[i * sizeof(T)], values[i]);
+			output.write(buffer.data(), n * sizeof(T));
+			values += n;
+			count -= n;
+		}
+#else
+		output.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+#endif
+	}
+
+	size_t padded(size_t bytes)
+	{
+		return (bytes + 7) & ~size_t(7);
+	}
+
+	size_t verticesOffset() { return MeshFormat::HEADER_SIZE; }
+
+	size_t offsetsOffset(const MeshFormat::Header &h)
+	{
+		return verticesOffset() + h.numVertices * 3 * sizeof(double);
+	}
+
+	size_t indicesOffset(const MeshFormat::Header &h)
+	{
+		size_t offsets = (h.flags & MeshFormat::TRIANGLES) ? 0 : (h.numFaces + 1) * sizeof(uint64_t);
+		return offsetsOffset(h) + offsets;
+	}
+}
+
+size_t MeshFormat::Header::exactOffset() const
+{
+	return indicesOffset(*this) + padded(this->numIndices * sizeof(uint32_t));
+}
+
+bool MeshFormat::write(std::ostream &output, const PolySet &ps, const std::string &exact)
+{
+	// merge each shared vertex once, then remap the face indices
+	Reindexer<Vector3d> vertices;
+	std::vector<int> vertexMap(ps.getVertices().size(), -1);
+	std::vector<uint32_t> indices;
+	std::vector<uint64_t> offsets;
+	bool triangles = true;
+	const PolygonsView polygons = ps.getPolygons();
+	offsets.reserve(polygons.size() + 1);
+	indices.reserve(ps.getIndices().size());
+	for (const auto &poly : polygons) {
+		offsets.push_back(indices.size());
+		triangles &= poly.size() == 3;
+		for (size_t i = 0; i < poly.size(); i++) {
+			int &idx = vertexMap[poly.index(i)];
+			if (idx < 0) idx = vertices.lookup(poly[i]);
+			indices.push_back(uint32_t(idx));
+		}
+	}
+	offsets.push_back(indices.size());
+	if (vertices.size() > UINT32_MAX) return false;
+
+	Header h;
+	h.flags = (triangles ? TRIANGLES : 0) | (exact.empty() ? 0 : EXACT);
+	h.dim = ps.getDimension();
+	h.convexity = ps.getConvexity();
+	boost::tribool convex = ps.convexValue();
+	h.convex = convex ? 1 : !convex ? 0 : 2;
+	h.numVertices = vertices.size();
+	h.numFaces = polygons.size();
+	h.numIndices = indices.size();
+	h.numExactBytes = exact.size();
+
+	char header[HEADER_SIZE] = { 0 };
+	memcpy(header, magic, sizeof(magic));
+	put(header + 8, version);
+	put(header + 12, h.flags);
+	put(header + 16, h.dim);
+	put(header + 20, h.convexity);
+	put(header + 24, h.convex);
+	put(header + 32, h.numVertices);
+	put(header + 40, h.numFaces);
+	put(header + 48, h.numIndices);
+	put(header + 56, h.numExactBytes);
+	output.write(header, sizeof(header));
+
+	// Vector3d is three packed doubles
+	if (h.numVertices > 0) putArray(output, vertices.getArray()->data(), h.numVertices * 3);
+	if (!triangles) putArray(output, offsets.data(), offsets.size());
+	putArray(output, indices.data(), indices.size());
+	if (indices.size() % 2) {
+		const char zero[sizeof(uint32_t)] = { 0 };
+		output.write(zero, sizeof(zero));
+	}
+	output.write(exact.data(), exact.size());
+	return true;
+}
+
+bool MeshFormat::readHeader(const char *data, size_t size, Header &h)
+{
+	if (size < HEADER_SIZE || memcmp(data, magic, sizeof(magic)) != 0) return false;
+	if (get<uint32_t>(data + 8) != version) return false;
+	h.flags = get<uint32_t>(data + 12);
+	h.dim = get<uint32_t>(data + 16);
+	h.convexity = get<int32_t>(data + 20);
+	h.convex = get<int32_t>(data + 24);
+	h.numVertices = get<uint64_t>(data + 32);
+	h.numFaces = get<uint64_t>(data + 40);
+	h.numIndices = get<uint64_t>(data + 48);
+	h.numExactBytes = get<uint64_t>(data + 56);
+	if (h.dim != 2 && h.dim != 3) return false;
+
+	// bound the counts by the file size before computing section sizes
+	if (h.numVertices > size / 24 || h.numFaces > size / 4 || h.numIndices > size / 4 ||
+			h.numExactBytes > size) return false;
+	if ((h.flags & TRIANGLES) && h.numIndices != h.numFaces * 3) return false;
+	if (h.exactOffset() + h.numExactBytes > size) return false;
+
+	if (!(h.flags & TRIANGLES)) {
+		// the faces must tile the indices: starting at 0, increasing, ending at numIndices
+		const char *offsets = data + offsetsOffset(h);
+		if (get<uint64_t>(offsets) != 0) return false;
+		uint64_t prev = 0;
+		for (uint64_t i = 0; i <= h.numFaces; i++) {
+			uint64_t offset = get<uint64_t>(offsets + i * sizeof(uint64_t));
+			if (offset < prev || offset > h.numIndices) return false;
+			prev = offset;
+		}
+		if (prev != h.numIndices) return false;
+	}
+	const char *indices = data + indicesOffset(h);
+	for (uint64_t i = 0; i < h.numIndices; i++) {
+		if (get<uint32_t>(indices + i * sizeof(uint32_t)) >= h.numVertices) return false;
+	}
+	return true;
+}
+
+PolySet *MeshFormat::readPolySet(const char *data, const Header &h)
+{
+	PolySet *ps = new PolySet(h.dim, h.convex == 1 ? boost::tribool(true) : h.convex == 0 ? boost::tribool(false) : boost::tribool(unknown));
+	ps->setConvexity(h.convexity);
+	ps->reserve(h.numFaces, h.numIndices);
+	ps->reserve_vertices(h.numVertices);
+
+	// the file is already indexed, so vertices and faces are copied as they are
+	const char *vertices = data + verticesOffset();
+	for (uint64_t i = 0; i < h.numVertices; i++, vertices += 3 * sizeof(double)) {
+		ps->add_vertex(Vector3d(get<double>(vertices), get<double>(vertices + 8), get<double>(vertices + 16)));
+	}
+
+	const char *offsets = data + offsetsOffset(h);
+	const char *indices = data + indicesOffset(h);
+	IndexedFace face;
+	uint64_t begin = 0;
+	for (uint64_t i = 0; i < h.numFaces; i++) {
+		uint64_t end = (h.flags & TRIANGLES) ? begin + 3 : get<uint64_t>(offsets + (i + 1) * sizeof(uint64_t));
+		face.clear();
+		for (uint64_t j = begin; j < end; j++) {
+			face.push_back(int(get<uint32_t>(indices + j * sizeof(uint32_t))));
+		}
+		ps->append_face(face);
+		begin = end;
+	}
+	return ps;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+class PolySet;
+
+/*!
+	OpenSCAD's native binary mesh format (.osmesh).
+
+	An indexed mesh with float64 vertices and uint32 vertex indices. All
+	values are little-endian and every section starts 8-byte aligned, so a
+	memory mapped file can be used in place:
+
+	  header    64 bytes, see Header
+	  vertices  double[numVertices][3]
+	  offsets   uint64[numFaces + 1], start of each face in indices;
+	            omitted when all faces are triangles (TRIANGLES)
+	  indices   uint32[numIndices], zero padded to a multiple of 8 bytes
+	  exact     numExactBytes of CGAL Nef polyhedron text (EXACT), which
+	            keeps the exact rational coordinates of a Nef export
+*/
+namespace MeshFormat {
+	const uint32_t version = 1;
+	const size_t HEADER_SIZE = 64;
+
+	enum Flags {
+		TRIANGLES = 1,
+		EXACT = 2
+	};
+
+	struct Header {
+		uint32_t flags;
+		uint32_t dim;
+		int32_t convexity;
+		int32_t convex; // 0 = false, 1 = true, 2 = unknown
+		uint64_t numVertices;
+		uint64_t numFaces;
+		uint64_t numIndices;
+		uint64_t numExactBytes;
+
+		size_t exactOffset() const;
+	};
+
+	/*!
+		Writes ps, followed by the given exact representation if not empty.
+		Returns false if the mesh has too many vertices for 32-bit indices.
+	*/
+	bool write(std::ostream &output, const PolySet &ps, const std::string &exact = std::string());
+
+	/*!
+		Validates the header and section sizes of a file image of the given
+		size, including all vertex indices.
+	*/
+	bool readHeader(const char *data, size_t size, Header &header);
+
+	//! Builds a PolySet from a file image validated by readHeader()
+	PolySet *readPolySet(const char *data, const Header &header);
+}
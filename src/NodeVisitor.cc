@@ -1,5 +1,6 @@
 #include "NodeVisitor.h"
 #include "state.h"
+#include "Profiler.h"
 
 State NodeVisitor::nullstate(nullptr);
 
@@ -9,7 +10,7 @@ Response NodeVisitor::traverse(const AbstractNode &node, const State &state)
 	nodeState.setNumChildren(node.getChildren().size());
 	nodeState.setPrefix(true);
 	
-	Response response = node.accept(nodeState, *this);
+	Response response = accept(nodeState, node);
 
 	// Pruned traversals mean don't traverse children
 	if (response == ContinueTraversal) {
@@ -25,7 +26,7 @@ Response NodeVisitor::traverse(const AbstractNode &node, const State &state)
 	// Postfix is executed for all non-aborted traversals
 	if (response != AbortTraversal) {
 		nodeState.setPostfix(true);
-		response = node.accept(nodeState, *this);
+		response = accept(nodeState, node);
 	}
 
 	// continue traversing siblings if not aborted
@@ -34,3 +35,11 @@ Response NodeVisitor::traverse(const AbstractNode &node, const State &state)
 
 	return response;
 }
+
+Response NodeVisitor::accept(State &state, const AbstractNode &node)
+{
+	if (!this->profiled || !Profiler::enabled())
+		return node.accept(state, *this);
+	Profiler::Span span(state.isPrefix() ? "prefix" : "postfix", node);
+	return node.accept(state, *this);
+}
@@ -22,7 +22,7 @@ class NodeVisitor :
 	public Visitor<class FactoryNode>
 {
 public:
-  NodeVisitor() {}
+  NodeVisitor() : profiled(false) {}
   virtual ~NodeVisitor() {}
   
 	Response traverse(const AbstractNode &node, const class State &state = NodeVisitor::nullstate);
@@ -71,4 +71,9 @@ public:
 
 protected:
 	static State nullstate;
+	// records a profiler span for each prefix and postfix visit
+	bool profiled;
+
+private:
+	Response accept(State &state, const AbstractNode &node);
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "WorkStealingPool.h"
+
+/*!
+	Writes the text of the items [0, count) of an export, formatted on the
+	worker pool.
+
+	The range is split into chunks of chunkSize items, and
+	format(begin, end, text) appends the text of the items [begin, end) to
+	text. It is called concurrently for different chunks, so it may only read
+	shared state. The chunks are written in order, which makes the output
+	the same as formatting the whole range on the calling thread; the
+	parallelexporttest tests compare the exports of 1 and 4 workers.
+
+	Chunks are formatted in batches of two per worker, and a batch is
+	written while the next one is formatted, so at most two batches of text
+	are held at a time.
+*/
+template <typename Format>
+void write_formatted(std::ostream &output, size_t count, size_t chunkSize, const Format &format)
+{
+	WorkStealingPool *pool = WorkStealingPool::instance();
+	size_t numChunks = (count + chunkSize - 1) / chunkSize;
+	if (numChunks <= 1 || pool->size() <= 1) {
+		std::string text;
+		for (size_t begin = 0; begin < count; begin += chunkSize) {
+			text.clear();
+			format(begin, std::min(count, begin + chunkSize), text);
+			output.write(text.data(), text.size());
+		}
+		return;
+	}
+
+	size_t batchChunks = 2 * pool->size();
+	std::vector<std::string> texts[2] = {
+		std::vector<std::string>(batchChunks), std::vector<std::string>(batchChunks)
+	};
+	shared_ptr<WorkStealingPool::TaskGroup> groups[2];
+	auto start = [&](size_t firstChunk, int buffer) {
+		groups[buffer] = std::make_shared<WorkStealingPool::TaskGroup>(pool);
+		size_t lastChunk = std::min(numChunks, firstChunk + batchChunks);
+		for (size_t c = firstChunk; c < lastChunk; c++) {
+			std::string &text = texts[buffer][c - firstChunk];
+			groups[buffer]->run([&format, &text, c, chunkSize, count] {
+				text.clear();
+				size_t begin = c * chunkSize;
+				format(begin, std::min(count, begin + chunkSize), text);
+			});
+		}
+	};
+
+	start(0, 0);
+	for (size_t firstChunk = 0, batch = 0; firstChunk < numChunks; firstChunk += batchChunks, batch++) {
+		int buffer = batch % 2;
+		groups[buffer]->wait();
+		if (firstChunk + batchChunks < numChunks) start(firstChunk + batchChunks, 1 - buffer);
+		size_t lastChunk = std::min(numChunks, firstChunk + batchChunks);
+		for (size_t c = firstChunk; c < lastChunk; c++) {
+			const std::string &text = texts[buffer][c - firstChunk];
+			output.write(text.data(), text.size());
+		}
+	}
+}
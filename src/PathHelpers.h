@@ -86,7 +86,11 @@ public:
 		if (!inputPoints->isDefinedAs(Value::ValueType::VECTOR))
 			return false;
 
-		auto pathVec = inputPoints->toVector();
+		// a packed list of number vectors
+		if (auto packed = inputPoints->toNumericVector())
+			return packed->isMatrix();
+
+		auto &pathVec = inputPoints->toVector();
 		// bail if it is empty
 		if (pathVec.empty())
 			return false;
@@ -107,17 +111,12 @@ public:
 
 	static bool pointsFromValuePtr(const ValuePtr &inputPoints, std::vector<CGAL_Point_3> &points)
 	{
-		if (!isPoints(inputPoints))
+		std::vector<Vector3d> vertices;
+		if (!pointsFromValuePtr(inputPoints, vertices))
 			return false;
 
-		auto pathVec = inputPoints->toVector();
-		for (auto pathPoint : pathVec)
-		{
-			double x, y, z;
-			pathPoint->getVec3(x, y, z);
-			CGAL_Point_3 pt(x, y, z);
-			points.push_back(pt);
-		}
+		for (const auto &v : vertices)
+			points.push_back(CGAL_Point_3(v[0], v[1], v[2]));
 		return true;
 	}
 
@@ -126,7 +125,20 @@ public:
 		if (!isPoints(inputPoints))
 			return false;
 
-		auto pathVec = inputPoints->toVector();
+		if (auto packed = inputPoints->toNumericVector())
+		{
+			// read the contiguous buffer, 2D points are placed at z = 0
+			const size_t columns = packed->columns();
+			points.reserve(points.size() + packed->size());
+			for (size_t i = 0; i < packed->size(); ++i)
+			{
+				const double *p = packed->row(i);
+				points.push_back(Vector3d(p[0], columns > 1 ? p[1] : 0, columns > 2 ? p[2] : 0));
+			}
+			return true;
+		}
+
+		auto &pathVec = inputPoints->toVector();
 		for (auto pathPoint : pathVec)
 		{
 			double x, y, z;
@@ -480,7 +492,7 @@ struct PolygonCaps
 		std::vector<CapFace> sideFaces;
 		if (true) {
 			/* add faces for capsPolyset at correct height
-			for (const auto &cap : capsPolyset->polygons) {
+			for (const auto &cap : capsPolyset->getPolygons()) {
 				CapFace face;
 				size_t c = cap.size();
 				for (size_t i = 0; i < c; ++i) {
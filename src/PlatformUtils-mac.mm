@@ -39,6 +39,14 @@ unsigned long PlatformUtils::stackLimit()
   return STACK_LIMIT_DEFAULT;
 }
 
+uint64_t PlatformUtils::physicalMemory()
+{
+  int64_t physical_memory = 0;
+  size_t length64 = sizeof(int64_t);
+  if (sysctlbyname("hw.memsize", &physical_memory, &length64, NULL, 0) != 0) return 0;
+  return physical_memory;
+}
+
 std::string PlatformUtils::sysinfo(bool extended)
 {
   std::string result;
@@ -137,6 +137,16 @@ static std::string detectDistribution()
     return "";
 }
 
+uint64_t PlatformUtils::physicalMemory()
+{
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pagesize = sysconf(_SC_PAGE_SIZE);
+    if ((pages > 0) && (pagesize > 0)) {
+        return (uint64_t)pages * pagesize;
+    }
+    return 0;
+}
+
 std::string PlatformUtils::sysinfo(bool extended)
 {
     std::string result;
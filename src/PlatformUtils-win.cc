@@ -100,6 +100,16 @@ unsigned long PlatformUtils::stackLimit()
     return STACK_LIMIT_DEFAULT;
 }
 
+uint64_t PlatformUtils::physicalMemory()
+{
+    MEMORYSTATUSEX memoryinfo;
+    memoryinfo.dwLength = sizeof(memoryinfo);
+    if (GlobalMemoryStatusEx(&memoryinfo) != 0) {
+        return memoryinfo.ullTotalPhys;
+    }
+    return 0;
+}
+
 typedef BOOL (WINAPI *LPFN_ISWOW64PROCESS) (HANDLE, PBOOL);
 
 // see http://msdn.microsoft.com/en-us/library/windows/desktop/ms684139%28v=vs.85%29.aspx
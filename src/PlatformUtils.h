@@ -67,6 +67,13 @@ namespace PlatformUtils {
          * @return maximum stack size in bytes.
          */
         unsigned long stackLimit();
+
+        /**
+         * Return the size of the installed physical memory.
+         *
+         * @return physical memory in bytes, 0 if it can't be determined.
+         */
+        uint64_t physicalMemory();
         
 	/**
 	 * Single character separating path specifications in a list
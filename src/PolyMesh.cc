@@ -100,7 +100,7 @@ void PolyMesh::finishCreate()
 	size_t psvc = grid.db.size();
 
 	if (false && poly_dim() != 3) {
-		PRINTB("Tesselating %d faces (poly_dim=%d)", polygons.size() % poly_dim());
+		PRINTB("Tesselating %d faces (poly_dim=%d)", numPolygons() % poly_dim());
 		PolysetUtils::tessellate_faces(*this, *this);
 	}
 
@@ -108,8 +108,8 @@ void PolyMesh::finishCreate()
 	for (size_t i = 0; i < psvc; ++i)
 		mesh.add_vertex(Point(psv[i][0], psv[i][1], psv[i][2]));
 
-	PRINTB("Building mesh: adding %d faces", polygons.size());
-	for (const auto &p : polygons) {
+	PRINTB("Building mesh: adding %d faces", numPolygons());
+	for (const auto &p : getPolygons()) {
 		std::vector<Mesh::Vertex_index> pp;
 		for (const auto &v : p) {
 			pp.push_back(Mesh::Vertex_index(grid.data(v)));
@@ -205,7 +205,7 @@ bool PolyMesh::validate()
 		if (intersecting) {
 			std::vector<std::pair<face_descriptor, face_descriptor> > intersected_tris;
 			PMP::self_intersections(mesh, std::back_inserter(intersected_tris));
-			PRINTB("    %d intersecting pairs (%d total)", intersected_tris.size() % polygons.size());
+			PRINTB("    %d intersecting pairs (%d total)", intersected_tris.size() % numPolygons());
 			if (true) {
 				const auto &pm = get(CGAL::vertex_point, mesh);
 				int i = 0;
@@ -538,15 +538,18 @@ PolySet *Polygon2d::tessellate() const
 	// To extract triangles which is part of our polygon, we need to filter away
 	// triangles inside holes.
 	mark_domains(cdt);
+	// the triangles share the CDT's vertices; a vertex's id is its PolySet index
 	Polygon2DCGAL::CDT::Finite_faces_iterator fit = cdt.finite_faces_begin();
 	for (; fit != cdt.finite_faces_end(); ++fit) {
 		if (fit->info().in_domain()) {
-			polyset->append_poly();
-			for (int i = 0; i < 3; i++)
-				polyset->append_vertex(
-					fit->vertex(i)->point()[0],
-					fit->vertex(i)->point()[1],
-					0);
+			int idx[3];
+			for (int i = 0; i < 3; i++) {
+				auto vh = fit->vertex(i);
+				if (vh->info().id < 0)
+					vh->info().id = polyset->add_vertex(Vector3d(vh->point()[0], vh->point()[1], 0));
+				idx[i] = vh->info().id;
+			}
+			polyset->append_face(idx[0], idx[1], idx[2]);
 		}
 	}
 	return polyset;
@@ -671,8 +674,7 @@ public:
 		if (true)
 		{
 			auto psBot = child->tessellate();
-			for (auto &tri : psBot->getPolygons())
-				std::reverse(tri.begin(), tri.end());
+			psBot->reverse_faces();
 			ps->append(*psBot);
 			delete psBot;
 		}
@@ -0,0 +1,263 @@
+#include "Profiler.h"
+#include "node.h"
+#include "printutils.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+std::atomic<bool> Profiler::on(false);
+
+namespace {
+	// plain thread-local counters need no initialization, so operator new can use them
+	thread_local uint64_t threadAllocations = 0;
+	thread_local uint64_t threadAllocatedBytes = 0;
+	thread_local Profiler::Span *currentSpan = nullptr;
+
+	// CPU time of the calling thread in microseconds
+	uint64_t threadCpuTime()
+	{
+#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+		uint64_t k = (uint64_t(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+		uint64_t u = (uint64_t(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+		return (k + u) / 10;
+#else
+		timespec ts;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+		return uint64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+	}
+
+	std::string jsonString(const std::string &str)
+	{
+		std::string result = "\"";
+		for (char c : str) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			}
+			else if ((unsigned char)c < 0x20) {
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				result += escaped;
+			}
+			else result += c;
+		}
+		return result + "\"";
+	}
+}
+
+void Profiler::countAllocation(size_t bytes)
+{
+	if (enabled()) {
+		threadAllocations++;
+		threadAllocatedBytes += bytes;
+	}
+}
+
+Profiler::Span::Span(const char *phase, const std::string &name) : active(Profiler::enabled())
+{
+	if (!active) return;
+	record.name = name.empty() ? phase : name;
+	record.nodeIndex = -1;
+	begin(phase);
+}
+
+Profiler::Span::Span(const char *phase, const AbstractNode &node) : active(Profiler::enabled())
+{
+	if (!active) return;
+	record.name = node.name();
+	record.nodeIndex = int(node.index());
+	begin(phase);
+}
+
+void Profiler::Span::begin(const char *phase)
+{
+	record.phase = phase;
+	record.thread = WorkStealingPool::currentWorkerId() + 1;
+	record.start = Profiler::instance()->now();
+	record.allocations = threadAllocations;
+	record.allocatedBytes = threadAllocatedBytes;
+	record.geometryBytes = 0;
+	startCpu = threadCpuTime();
+	outer = currentSpan;
+	currentSpan = this;
+}
+
+Profiler::Span::~Span()
+{
+	if (!active) return;
+	currentSpan = outer;
+	record.wall = Profiler::instance()->now() - record.start;
+	record.cpu = int64_t(threadCpuTime() - startCpu);
+	record.allocations = threadAllocations - record.allocations;
+	record.allocatedBytes = threadAllocatedBytes - record.allocatedBytes;
+	Profiler::instance()->add(std::move(record));
+}
+
+Profiler::Span *Profiler::Span::current()
+{
+	return currentSpan;
+}
+
+int64_t Profiler::now() const
+{
+	auto t = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::microseconds>(t).count() - startTime;
+}
+
+void Profiler::add(Record &&record)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	records.push_back(std::move(record));
+}
+
+void Profiler::start(const std::string &filename, Format format)
+{
+	this->filename = filename;
+	this->format = format;
+	this->records.clear();
+	this->startTime = 0;
+	this->startTime = now();
+	on = true;
+}
+
+bool Profiler::finish()
+{
+	if (!enabled()) return true;
+	on = false;
+	std::ofstream output(filename);
+	if (!output.is_open()) {
+		PRINTB("Can't open file \"%s\" for the profile", filename);
+		return false;
+	}
+	boost::mutex::scoped_lock lock(mutex);
+	// spans are recorded as they end; sort them by start, outer spans first
+	std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+		return a.start < b.start || (a.start == b.start && a.wall > b.wall);
+	});
+	if (format == FLAT) writeFlat(output);
+	else writeTrace(output);
+	return output.good();
+}
+
+/*!
+	Writes Chrome trace events, which chrome://tracing and Perfetto show as a
+	timeline per thread.
+*/
+void Profiler::writeTrace(std::ostream &output) const
+{
+	output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	int threads = 0;
+	for (const auto &r : records) threads = std::max(threads, r.thread + 1);
+	for (int t = 0; t < threads; t++) {
+		output << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t
+					 << ", \"args\": {\"name\": \"" << (t == 0 ? std::string("main") : "worker " + std::to_string(t - 1)) << "\"}},\n";
+	}
+	bool first = true;
+	for (const auto &r : records) {
+		if (!first) output << ",\n";
+		first = false;
+		output << "{\"name\": " << jsonString(r.name) << ", \"cat\": \"" << r.phase
+					 << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << r.thread
+					 << ", \"ts\": " << r.start << ", \"dur\": " << r.wall
+					 << ", \"args\": {\"cpu_us\": " << r.cpu
+					 << ", \"allocations\": " << r.allocations
+					 << ", \"allocated_bytes\": " << r.allocatedBytes
+					 << ", \"geometry_bytes\": " << r.geometryBytes;
+		if (r.nodeIndex >= 0) output << ", \"node_index\": " << r.nodeIndex;
+		if (!r.nodePath.empty()) output << ", \"node_path\": \"" << r.nodePath << "\"";
+		output << "}}";
+	}
+	output << "\n]}\n";
+}
+
+/*!
+	Writes a summary per phase and name, followed by every span.
+*/
+void Profiler::writeFlat(std::ostream &output) const
+{
+	struct Summary {
+		size_t count = 0;
+		int64_t wall = 0, cpu = 0;
+		uint64_t allocations = 0, allocatedBytes = 0;
+		size_t peakGeometryBytes = 0;
+	};
+	std::map<std::pair<std::string, std::string>, Summary> summaries;
+	for (const auto &r : records) {
+		Summary &s = summaries[std::make_pair(std::string(r.phase), r.name)];
+		s.count++;
+		s.wall += r.wall;
+		s.cpu += r.cpu;
+		s.allocations += r.allocations;
+		s.allocatedBytes += r.allocatedBytes;
+		s.peakGeometryBytes = std::max(s.peakGeometryBytes, r.geometryBytes);
+	}
+
+	output << "{\n\"summary\": [\n";
+	bool first = true;
+	for (const auto &entry : summaries) {
+		const Summary &s = entry.second;
+		if (!first) output << ",\n";
+		first = false;
+		output << "{\"phase\": \"" << entry.first.first << "\", \"name\": " << jsonString(entry.first.second)
+					 << ", \"count\": " << s.count << ", \"wall_us\": " << s.wall << ", \"cpu_us\": " << s.cpu
+					 << ", \"allocations\": " << s.allocations << ", \"allocated_bytes\": " << s.allocatedBytes
+					 << ", \"peak_geometry_bytes\": " << s.peakGeometryBytes << "}";
+	}
+	output << "\n],\n\"spans\": [\n";
+	first = true;
+	for (const auto &r : records) {
+		if (!first) output << ",\n";
+		first = false;
+		output << "{\"phase\": \"" << r.phase << "\", \"name\": " << jsonString(r.name)
+					 << ", \"thread\": " << r.thread << ", \"start_us\": " << r.start
+					 << ", \"wall_us\": " << r.wall << ", \"cpu_us\": " << r.cpu
+					 << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocatedBytes
+					 << ", \"geometry_bytes\": " << r.geometryBytes;
+		if (r.nodeIndex >= 0) output << ", \"node_index\": " << r.nodeIndex;
+		if (!r.nodePath.empty()) output << ", \"node_path\": \"" << r.nodePath << "\"";
+		output << "}";
+	}
+	output << "\n]\n}\n";
+}
+
+// counts allocations for the spans; the other forms of new and delete use these
+void *operator new(size_t size)
+{
+	Profiler::countAllocation(size);
+	if (void *p = malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	Profiler::countAllocation(size);
+	if (void *p = malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+/*!
+	Records the wall time, CPU time, allocations and geometry size of the
+	phases of a run, enabled with --profile.
+
+	A Profiler::Span measures the scope it lives in. Spans nest per thread;
+	the worker pool threads are told apart by their worker ids. When
+	profiling is off, a span costs the check of a flag.
+
+	Allocations are the operator new calls on the span's thread. Geometry
+	bytes are the memsize() of the geometry the span produced, so the flat
+	summary's peak is the largest geometry of each phase.
+*/
+class Profiler
+{
+public:
+	enum Format { TRACE, FLAT };
+
+	struct Record
+	{
+		const char *phase;
+		std::string name;		// the node name for node spans, else the phase
+		int nodeIndex;			// -1 if the span isn't about a node
+		std::string nodePath;	// the indices from the root, for threaded traversal
+		int thread;				// 0 for the main thread, worker id + 1 for pool threads
+		int64_t start;			// microseconds since the profiler started
+		int64_t wall;
+		int64_t cpu;
+		uint64_t allocations;
+		uint64_t allocatedBytes;
+		size_t geometryBytes;
+	};
+
+	class Span
+	{
+	public:
+		Span(const char *phase, const std::string &name = std::string());
+		// a span named by the node's name and index
+		Span(const char *phase, const class AbstractNode &node);
+		~Span();
+
+		void setNodePath(const std::string &path) { if (active) record.nodePath = path; }
+		void setGeometryBytes(size_t bytes) { if (active) record.geometryBytes = bytes; }
+
+		// the innermost span of the calling thread, or nullptr
+		static Span *current();
+
+	private:
+		void begin(const char *phase);
+
+		bool active;
+		Record record;
+		uint64_t startCpu;
+		Span *outer;
+	};
+
+	static Profiler *instance() { static Profiler *profiler = new Profiler; return profiler; }
+	static bool enabled() { return on.load(std::memory_order_relaxed); }
+
+	// starts recording; the file is written by finish()
+	void start(const std::string &filename, Format format);
+	// stops recording and writes the file; returns false if it can't be written
+	bool finish();
+
+	// sets the geometry bytes of the calling thread's innermost span
+	static void setGeometryBytes(size_t bytes) {
+		if (enabled())
+			if (auto span = Span::current()) span->setGeometryBytes(bytes);
+	}
+
+	// counts operator new calls, see Profiler.cc
+	static void countAllocation(size_t bytes);
+
+private:
+	Profiler() : startTime(0), format(TRACE) { }
+
+	void add(Record &&record);
+	int64_t now() const;
+	void writeTrace(std::ostream &output) const;
+	void writeFlat(std::ostream &output) const;
+
+	static std::atomic<bool> on;
+
+	int64_t startTime;
+	std::string filename;
+	Format format;
+	boost::mutex mutex;
+	std::vector<Record> records;
+};
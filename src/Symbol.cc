@@ -0,0 +1,35 @@
+#include "Symbol.h"
+
+Symbols::Symbols()
+{
+	boost::detail::spinlock init = BOOST_DETAIL_SPINLOCK_INIT;
+	this->lock = init;
+	this->names.push_back("");
+	this->ids[""] = 0;
+}
+
+SymbolId Symbols::intern(const std::string &name)
+{
+	if (name.empty()) return 0;
+
+	Symbols *symbols = instance();
+	boost::detail::spinlock::scoped_lock lock(symbols->lock);
+	auto found = symbols->ids.find(name);
+	if (found != symbols->ids.end()) return found->second;
+
+	// $children is not a config_variable. config_variables have dynamic scope,
+	// meaning they are passed down the call chain implicitly.
+	// $children is simply misnamed and shouldn't have included the '$'.
+	bool config = name[0] == '$' && name != "$children";
+	SymbolId id = (SymbolId)(symbols->names.size() << 1) | (config ? 1 : 0);
+	symbols->names.push_back(name);
+	symbols->ids[name] = id;
+	return id;
+}
+
+const std::string &Symbols::name(SymbolId id)
+{
+	Symbols *symbols = instance();
+	boost::detail::spinlock::scoped_lock lock(symbols->lock);
+	return symbols->names[index(id)];
+}
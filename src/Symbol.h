@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <boost/smart_ptr/detail/spinlock.hpp>
+
+/*!
+	An interned identifier.
+
+	The lowest bit marks $-variables (config variables), which have dynamic
+	scope, so that Context can tell them apart without looking at the name.
+	The empty name is always 0.
+*/
+typedef uint32_t SymbolId;
+
+/*!
+	Interns identifiers to SymbolIds.
+
+	Identifiers are interned once at parse time by the Lookup expressions and
+	Assignments which use them, names used from C++ (e.g. by builtin modules)
+	on first use. Context stores and looks up variables by id instead of
+	comparing strings. Ids are never released.
+*/
+class Symbols
+{
+public:
+	static SymbolId intern(const std::string &name);
+	static const std::string &name(SymbolId id);
+
+	// $-variables, except $children which isn't passed down the call chain
+	static bool isConfig(SymbolId id) { return id & 1; }
+	// dense index of the symbol, for tables indexed by symbol
+	static size_t index(SymbolId id) { return id >> 1; }
+
+private:
+	// never destroyed, names may be needed during static destruction
+	static Symbols *instance() { static Symbols *inst = new Symbols; return inst; }
+	Symbols();
+
+	boost::detail::spinlock lock;
+	std::unordered_map<std::string, SymbolId> ids;
+	std::deque<std::string> names; // by index
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <locale>
+
+/*!
+	A cursor over in-memory text, used by the mesh importers.
+
+	Numbers are parsed in place, without temporary strings or locale lookups.
+	Decimal numbers whose digits fit in a double are converted exactly; anything
+	else falls back to the classic-locale stream parser.
+*/
+class TextScanner
+{
+public:
+	TextScanner(const char *begin, const char *end) : pos(begin), first(begin), stop(end) { }
+
+	bool atEnd() const { return pos == stop; }
+	const char *position() const { return pos; }
+
+	static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; }
+	static bool isSpace(char c) { return isBlank(c) || c == '\n'; }
+	static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+	//! Skips whitespace within the current line
+	void skipBlanks() {
+		while (pos != stop && isBlank(*pos)) ++pos;
+	}
+
+	//! Skips whitespace, including line breaks
+	void skipSpace() {
+		while (pos != stop && isSpace(*pos)) ++pos;
+	}
+
+	//! True at a line break, a '#' comment or the end of the text
+	bool atEol() const {
+		return pos == stop || *pos == '\n' || *pos == '#';
+	}
+
+	//! Moves to the start of the next line
+	void nextLine() {
+		const char *nl = static_cast<const char *>(memchr(pos, '\n', stop - pos));
+		pos = nl ? nl + 1 : stop;
+	}
+
+	//! Consumes word if it is the next whole token
+	bool keyword(const char *word) {
+		size_t len = strlen(word);
+		if (size_t(stop - pos) < len || memcmp(pos, word, len) != 0) return false;
+		if (pos + len != stop && !isSpace(pos[len])) return false;
+		pos += len;
+		return true;
+	}
+
+	//! Consumes and returns the next run of non-whitespace characters
+	std::string token() {
+		const char *start = pos;
+		while (pos != stop && !isSpace(*pos)) ++pos;
+		return std::string(start, pos);
+	}
+
+	//! The text of the line containing the cursor, for messages
+	std::string line() const {
+		const char *b = pos;
+		while (b != first && b[-1] != '\n') --b;
+		const char *e = b;
+		while (e != stop && *e != '\n' && *e != '\r') ++e;
+		return std::string(b, e);
+	}
+
+	//! Parses an optionally signed decimal integer
+	bool parseInt(long &out) {
+		const char *p = pos;
+		bool neg = false;
+		if (p != stop && (*p == '-' || *p == '+')) neg = *p++ == '-';
+		if (p == stop || !isDigit(*p)) return false;
+		long value = 0;
+		for (; p != stop && isDigit(*p); ++p) value = value * 10 + (*p - '0');
+		out = neg ? -value : value;
+		pos = p;
+		return true;
+	}
+
+	/*!
+		Parses a floating point number, which must be followed by whitespace
+		or the end of the text.
+	*/
+	bool parseDouble(double &out) {
+		const char *p = pos;
+		bool neg = false;
+		if (p != stop && (*p == '-' || *p == '+')) neg = *p++ == '-';
+
+		uint64_t mantissa = 0;
+		int digits = 0, exp10 = 0;
+		bool any = false;
+		for (; p != stop && isDigit(*p); ++p) {
+			any = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa) ++digits;
+			}
+			else ++exp10;
+		}
+		if (p != stop && *p == '.') {
+			for (++p; p != stop && isDigit(*p); ++p) {
+				any = true;
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (*p - '0');
+					if (mantissa) ++digits;
+					--exp10;
+				}
+			}
+		}
+		if (!any) return false;
+		if (p != stop && (*p == 'e' || *p == 'E')) {
+			const char *q = p + 1;
+			bool eneg = false;
+			if (q != stop && (*q == '-' || *q == '+')) eneg = *q++ == '-';
+			if (q != stop && isDigit(*q)) {
+				int e = 0;
+				for (; q != stop && isDigit(*q); ++q) {
+					if (e < 100000) e = e * 10 + (*q - '0');
+				}
+				exp10 += eneg ? -e : e;
+				p = q;
+			}
+		}
+		if (p != stop && !isSpace(*p)) return false;
+
+		if (mantissa == 0) {
+			out = neg ? -0.0 : 0.0;
+		}
+		else if (mantissa <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+			// both operands are exact, so the single rounding is correct
+			double m = double(mantissa);
+			out = exp10 < 0 ? m / pow10(-exp10) : m * pow10(exp10);
+			if (neg) out = -out;
+		}
+		else {
+			std::istringstream in(std::string(pos, p));
+			in.imbue(std::locale::classic());
+			in >> out;
+			if (in.fail()) return false;
+		}
+		pos = p;
+		return true;
+	}
+
+private:
+	static double pow10(int e) {
+		static const double table[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		return table[e];
+	}
+
+	const char *pos;
+	const char *first;
+	const char *stop;
+};
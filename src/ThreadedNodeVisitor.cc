@@ -5,10 +5,12 @@
 #include "feature.h"
 #include "printutils.h"
 #include <algorithm>
+#include <cmath>
 
 #include <boost/thread.hpp>
 #include <stack>
 #include <map>
+#include <unordered_map>
 #include <string>
 
 #include "Tree.h"
@@ -16,6 +18,10 @@
 #include "cgalutils.h"
 #include "CGALCache.h"
 #include "GeometryCache.h"
+#include "DiskCache.h"
+#include "MemoryBudget.h"
+#include "WorkStealingPool.h"
+#include "Profiler.h"
 
 #define QT_STATIC
 #include <QTime>
@@ -61,6 +67,124 @@ std::string timeStr(double t)
 	return str.str();
 }
 
+/*!
+	Estimates how long the postfix of a node takes, so the scheduler can start
+	the runners on the longest path to the root first.
+
+	A node which ran before is estimated by the longest time it took; the
+	largest rather than the last time, since a later run may have been a cache
+	hit. The times are kept with the node's entry in the geometry caches, and
+	with --cache-dir in the DiskCache, so they outlive the session. A history
+	of recent times covers the nodes whose geometry isn't cached.
+
+	Otherwise the estimate is the size of the node's input geometry times a
+	rate for its operation: CGAL booleans, including the implicit union of
+	several children, and minkowski dwarf hulls, transforms and groups of a
+	single child.
+*/
+class TraverseCostModel
+{
+public:
+	// milliseconds of bookkeeping for any node
+	static constexpr double BASE_COST = 0.05;
+
+	// estimates the postfix time in milliseconds from the sizes of the
+	// children's geometries, and the size of the node's geometry
+	static double estimate(const NodeId &id, const AbstractNode &node, const std::vector<size_t> &inputs, size_t &outputBytes)
+	{
+		size_t total = 0, smallest = inputs.empty() ? 0 : inputs.front();
+		for (auto bytes : inputs) {
+			total += bytes;
+			smallest = std::min(smallest, bytes);
+		}
+		const std::string op = node.name();
+		double msPerMB;
+		outputBytes = total;
+		if (op == "minkowski") {
+			msPerMB = MINKOWSKI_RATE;
+			outputBytes = 2 * total;
+		}
+		else if (op == "hull") {
+			msPerMB = HULL_RATE;
+			outputBytes = total / 4;
+		}
+		else if (op == "difference") {
+			msPerMB = BOOLEAN_RATE;
+			outputBytes = inputs.empty() ? 0 : inputs.front();
+		}
+		else if (op == "intersection") {
+			msPerMB = BOOLEAN_RATE;
+			outputBytes = smallest;
+		}
+		else if (inputs.size() > 1 || op == "render" || op == "projection" || op == "resize") {
+			msPerMB = BOOLEAN_RATE;
+		}
+		else {
+			msPerMB = COPY_RATE;
+		}
+		double result = BASE_COST + msPerMB * total / (1024.0 * 1024.0);
+
+		double past = pastTime(id);
+		return past > 0 ? past : result;
+	}
+
+	// records the postfix time of a node in milliseconds
+	static void record(const NodeId &id, double ms)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		if (double *recorded = history.object(id))
+			*recorded = std::max(*recorded, ms);
+		else
+			history.insert(id, new double(ms));
+	}
+
+	// the time recorded in this session, 0 if none; doesn't touch the
+	// geometry caches, so it can be called with the cache lock held
+	static double recorded(const NodeId &id)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		const double *ms = history.peek(id);
+		return ms ? *ms : 0;
+	}
+
+private:
+	// milliseconds per MB of input geometry
+	static constexpr double BOOLEAN_RATE = 2000;
+	static constexpr double MINKOWSKI_RATE = 20000;
+	static constexpr double HULL_RATE = 50;
+	static constexpr double COPY_RATE = 5;
+	static const size_t MAX_HISTORY = 100000;
+
+	// the longest time of the node in this or an earlier session, 0 if unknown
+	static double pastTime(const NodeId &id)
+	{
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if (const double *ms = history.object(id))
+				return *ms;
+		}
+		double ms;
+		{
+			boost::detail::spinlock::scoped_lock lock(ThreadedNodeVisitor::cacheLock);
+			ms = std::max(CGALCache::instance()->postfixTime(id), GeometryCache::instance()->postfixTime(id));
+		}
+		if (ms == 0 && DiskCache::instance()->persistent())
+			ms = DiskCache::instance()->getPostfixTime(id);
+		// unknown nodes are remembered too, so they aren't looked up again
+		boost::mutex::scoped_lock lock(mutex);
+		if (!history.contains(id))
+			history.insert(id, new double(ms));
+		return ms;
+	}
+
+	static boost::mutex mutex;
+	// an LRU of node ids to their longest time; each entry costs 1
+	static Cache<NodeId, double> history;
+};
+
+boost::mutex TraverseCostModel::mutex;
+Cache<NodeId, double> TraverseCostModel::history(TraverseCostModel::MAX_HISTORY);
+
 class TraverseData
 {
 	enum TraverseDataState
@@ -70,9 +194,8 @@ class TraverseData
 		RUNNING,
 		FINISHED
 	};
-	boost::thread *thread;
 	TraverseData *parent;
-	std::string idString;
+	NodeId id;
 	int cpuId;
 	const AbstractNode *node;
 	State state;
@@ -80,13 +203,16 @@ class TraverseData
 	Response response;
 	TraverseDataState dataState;
 	double elapsed;
+	double cost;		// estimated postfix time in ms
+	double priority;	// estimated time from the start of this node until the root finishes
+	size_t sequence;	// depth-first order, breaks ties between equal priorities
+	std::atomic<size_t> unfinishedChildren;
 	std::list<TraverseData*> children;
 
 public:
-	TraverseData(const std::string &idString, const AbstractNode *node, const State &state, size_t depth)
-		: thread(nullptr)
-		, parent(NULL)
-		, idString(idString)
+	TraverseData(const NodeId &id, const AbstractNode *node, const State &state, size_t depth)
+		: parent(NULL)
+		, id(id)
 		, cpuId(0)
 		, node(node)
 		, state(state)
@@ -94,19 +220,21 @@ public:
 		, response(ContinueTraversal)
 		, dataState(NONE)
 		, elapsed(0)
+		, cost(0)
+		, priority(0)
+		, sequence(0)
+		, unfinishedChildren(0)
 	{
 	}
 
 	~TraverseData()
 	{
-		if (thread)
-			delete thread;
 		for (auto child : children)
 			delete child;
 	}
 
 	TraverseData *getParent() const { return parent; }
-	const std::string &getIdString() const { return idString; }
+	const NodeId &getNodeId() const { return id; }
 	int getCpuId() const { return cpuId; }
 	const AbstractNode *getNode() const { return node; }
 	const State &getState() const { return state; }
@@ -115,6 +243,8 @@ public:
 	size_t getDepth() const { return depth; }
 	Response getResponse() const { return response; }
 	double getElapsed() const { return elapsed; }
+	double getPriority() const { return priority; }
+	size_t getSequence() const { return sequence; }
 
 	void addChild(TraverseData *data)
 	{
@@ -122,57 +252,87 @@ public:
 		children.push_back(data);
 	}
 
-	TraverseData *getRunner(ThreadedNodeVisitor *traverser,
-		const std::map<std::string, TraverseData*> &running, 
-		bool &lastLeaf)
+	// estimates the postfix times of the subtree, bottom-up, from the sizes
+	// of the geometries in the traverse cache; returns the estimated size of
+	// this node's geometry
+	size_t estimateCosts(ThreadedNodeVisitor &visitor)
 	{
-		TraverseData *result = NULL;
-		lastLeaf = false;
-		if (dataState < RUNNING)
-		{
-			bool hasUnfinishedChild = false;
-			for (auto child : children)
-			{
-				if (child->dataState != FINISHED)
-					hasUnfinishedChild = true;
-				bool dummy = false;
-				result = child->getRunner(traverser, running, dummy);
-				if (result != NULL)
-					break;
-			}
-			if (!hasUnfinishedChild && result == NULL)
-			{
-				//PRINTB(" No unfinished children: %s", toString());
-				if (running.find(idString) == running.end())
-				{
-					//PRINTB("++ Creating runner: %s", toString());
-					dataState = RUNNING;
-					result = this;
-					lastLeaf = true;
-				}
-			}
+		if (children.empty()) {
+			// leaves create their geometry in prefix, and pruned nodes are cached
+			cost = TraverseCostModel::BASE_COST;
+			return visitor.cachedGeometryBytes(*node);
 		}
-		return result;
+		std::vector<size_t> inputs;
+		inputs.reserve(children.size());
+		for (auto child : children)
+			inputs.push_back(child->estimateCosts(visitor));
+		size_t outputBytes;
+		cost = TraverseCostModel::estimate(id, *node, inputs, outputBytes);
+		return outputBytes;
 	}
 
-	void startThread(ThreadedNodeVisitor &visitor, int cpuId)
+	// re-estimates the postfix time from the actual sizes of the children's
+	// geometries, once they've all finished
+	void refineCost(ThreadedNodeVisitor &visitor)
 	{
-		auto f = [this, &visitor]
-		{
-			try {
-				// set the current thread's progress object
-				CpuProgress progress(&visitor.getProgress(), this->cpuId, this->node->name());
-				//PRINTB("  (%d) Running postfix", data->getId());
-				this->accept(true, visitor);
-			}
-			catch (const ProgressCancelException &c) {
-				// eat it...
-			}
-			visitor.finishRunner(this);
-			//PRINTB("  (%d) Finished postfix: %s", data->getId() % ResponseStr[data->getResponse()]);
-		};
-		this->cpuId = cpuId;
-		this->thread = new boost::thread(f);
+		if (children.empty())
+			return;
+		std::vector<size_t> inputs;
+		inputs.reserve(children.size());
+		for (auto child : children)
+			inputs.push_back(visitor.cachedGeometryBytes(*child->node));
+		size_t outputBytes;
+		cost = TraverseCostModel::estimate(id, *node, inputs, outputBytes);
+		priority = cost + (parent ? parent->priority : 0);
+	}
+
+	// resets the unfinished child counts, sets the priorities top-down and
+	// collects the nodes without children
+	void collectLeaves(std::list<TraverseData*> &leaves, size_t &nextSequence)
+	{
+		unfinishedChildren = children.size();
+		priority = cost + (parent ? parent->priority : 0);
+		sequence = nextSequence++;
+		if (children.empty())
+			leaves.push_back(this);
+		for (auto child : children)
+			child->collectLeaves(leaves, nextSequence);
+	}
+
+	// the longest chain of postfix times from a leaf to this node
+	double criticalPath() const
+	{
+		double longest = 0;
+		for (auto child : children)
+			longest = std::max(longest, child->criticalPath());
+		return longest + elapsed;
+	}
+
+	// called when a child finished; returns true if this node is ready to run
+	bool childFinished()
+	{
+		return --unfinishedChildren == 0;
+	}
+
+	// runs the postfix on a pool worker
+	void run(ThreadedNodeVisitor &visitor, int workerId)
+	{
+		this->cpuId = workerId;
+		try {
+			// set the current thread's progress object
+			CpuProgress progress(&visitor.getProgress(), this->cpuId, this->node->name());
+			//PRINTB("  (%d) Running postfix", data->getId());
+			this->dataState = RUNNING;
+			this->accept(true, visitor);
+			if (this->response != AbortTraversal && !children.empty())
+				TraverseCostModel::record(this->id, this->elapsed);
+		}
+		catch (const ProgressCancelException &c) {
+			// eat it...
+			this->response = AbortTraversal;
+		}
+		visitor.finishRunner(this);
+		//PRINTB("  (%d) Finished postfix: %s", data->getId() % ResponseStr[data->getResponse()]);
 	}
 
 	size_t countUnprunedLeaves() const
@@ -198,6 +358,8 @@ public:
 	{
 		QTime qTimer;
 		qTimer.start();
+		Profiler::Span span(postfix ? "postfix" : "prefix", *node);
+		if (Profiler::enabled()) span.setNodePath(toNodeIdString());
 		try
 		{
 			if (response != AbortTraversal)
@@ -255,7 +417,7 @@ class TraverseCache
 {
 	struct CacheItem
 	{
-		std::string idString;
+		NodeId id;
 		size_t totalRefs;
 		size_t deadRefs;
 		size_t insertedRefs;
@@ -270,18 +432,22 @@ class TraverseCache
 		}
 
 		// sets the geometry; return the memory size delta
-		int setGeom(shared_ptr<const Geometry> geom)
+		int64_t setGeom(shared_ptr<const Geometry> geom)
 		{
 			if (this->geom == geom)
 				return 0;
 			size_t geomSize = geom->isEmpty() ? 0 : geom->memsize();
-			int result = (int)geomSize;
+			int64_t result = (int64_t)geomSize;
 			if (insertedRefs > 0)
 			{
 				PRINTB("Replacing cached geometry with something else: new size=%1%, size=%2%, refs=%3%, total=%4%, dead=%5%, pruned=%6%",
 					commas(geomSize) % commas(memorySize) % insertedRefs % totalRefs % deadRefs % prunedRefs);
-				result -= (int)memorySize;
+				result -= (int64_t)memorySize;
 			}
+			// held against the global budget, which may evict from the other caches
+			MemoryBudget::instance()->acquire(geom.get());
+			if (this->geom)
+				MemoryBudget::instance()->release(this->geom.get());
 			this->geom = geom;
 			this->memorySize = geomSize;
 			this->insertedRefs++;
@@ -309,8 +475,8 @@ class TraverseCache
 			return insertedRefs > 0 && (deadRefs + prunedRefs) != totalRefs;
 		}
 
-		CacheItem(std::string _idString)
-			: idString(_idString)
+		CacheItem(const NodeId &_id)
+			: id(_id)
 			, totalRefs(0)
 			, deadRefs(0)
 			, insertedRefs(0)
@@ -323,20 +489,23 @@ class TraverseCache
 		{
 			if (geom)
 			{
+				MemoryBudget::instance()->release(geom.get());
 				shared_ptr<const CGAL_Nef_polyhedron> cgalgeom = 
 					dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom);
-				if (cgalgeom)
-					CGALCache::instance()->insert(idString, cgalgeom);
-				else
-					GeometryCache::instance()->insert(idString, geom);
+				IGeometryCache *target = cgalgeom ? (IGeometryCache*)CGALCache::instance() : GeometryCache::instance();
+				target->insert(id, geom);
+				// the postfix time goes with the entry, which outlives the session's history
+				double ms = TraverseCostModel::recorded(id);
+				if (ms > 0)
+					target->setPostfixTime(id, ms);
 				geom.reset();
 			}
 		}
 	};
 
-	size_t prune(const std::string &idString)
+	size_t prune(const NodeId &id)
 	{
-		auto iter = cache.find(idString);
+		auto iter = cache.find(id);
 		assert(iter != cache.end());
 		CacheItem *item = iter->second;
 		size_t delta = item->pruneRef();
@@ -345,19 +514,19 @@ class TraverseCache
 			pruneMemory += delta;
 			pruneCount++;
 			delete item;
-			cache.erase(idString);
+			cache.erase(id);
 		}
 		pruneTotal++;
 		return delta;
 	}
 
-	void add(const std::string &idString)
+	void add(const NodeId &id)
 	{
-		auto iter = cache.find(idString);
+		auto iter = cache.find(id);
 		if (iter == cache.end())
 		{
-			cache.insert(std::make_pair(idString, new CacheItem(idString)));
-			iter = cache.find(idString);
+			cache.insert(std::make_pair(id, new CacheItem(id)));
+			iter = cache.find(id);
 		}
 		iter->second->addRef();
 		totalRefs++;
@@ -365,12 +534,12 @@ class TraverseCache
 
 	void addNode(const Tree &tree, const AbstractNode &node)
 	{
-		const std::string &idString = tree.getIdString(node);
-		add(idString);
-		if (CGALCache::instance()->contains(idString))
+		const NodeId &id = tree.getId(node);
+		add(id);
+		if (CGALCache::instance()->contains(id))
 		{
-			shared_ptr<const Geometry> cached = CGALCache::instance()->get(idString);
-			int size = insert(idString, cached);
+			shared_ptr<const Geometry> cached = CGALCache::instance()->get(id);
+			int64_t size = insert(id, cached);
 			if (size != 0)
 			{
 				precacheCount++;
@@ -378,10 +547,10 @@ class TraverseCache
 			}
 			precacheTotal++;
 		}
-		//else if (GeometryCache::instance()->contains(idString))
+		//else if (GeometryCache::instance()->contains(id))
 		//{
-		//	shared_ptr<const Geometry> cached = GeometryCache::instance()->get(idString);
-		//	int size = insert(idString, cached);
+		//	shared_ptr<const Geometry> cached = GeometryCache::instance()->get(id);
+		//	int size = insert(id, cached);
 		//	if (size != 0)
 		//	{
 		//		precacheCount++;
@@ -398,7 +567,7 @@ class TraverseCache
 			totalLeafs++;
 	}
 
-	std::map<std::string, CacheItem*> cache;
+	std::unordered_map<NodeId, CacheItem*> cache;
 	size_t memorySize;
 	size_t pruneMemorySize;
 	size_t peakMemorySize;
@@ -436,7 +605,7 @@ public:
 			{
 				auto cc = item.second;
 				PRINTDB("Traverse cache living object: size=%1%, refs=%2%, total=%3%, dead=%4%: %5%",
-					commas(cc->memorySize) % cc->insertedRefs % cc->totalRefs % cc->deadRefs % cc->idString.substr(0, 80));
+					commas(cc->memorySize) % cc->insertedRefs % cc->totalRefs % cc->deadRefs % cc->id);
 			}
 			delete item.second;
 		}
@@ -475,53 +644,55 @@ public:
 		for (auto child : node->getChildren())
 		{
 			pruneChildren(tree, child.get());
-			std::string idString = tree.getIdString(*child);
-			size_t delta = prune(idString);
+			const NodeId &id = tree.getId(*child);
+			size_t delta = prune(id);
 			if (delta != 0)
 			{
 				pruneMemorySize += delta;
-				PRINTDB("Traverse cache prune: %1%, total=%2%: %3%", commas(delta) % commas(pruneMemorySize) % idString.substr(0, 80));
+				PRINTDB("Traverse cache prune: %1%, total=%2%: %3%", commas(delta) % commas(pruneMemorySize) % id);
 			}
 		}
 	}
 
-	int insert(const std::string &idString, shared_ptr<const Geometry> geom)
+	int64_t insert(const NodeId &id, shared_ptr<const Geometry> geom)
 	{
-		auto iter = cache.find(idString);
+		auto iter = cache.find(id);
 		assert(iter != cache.end());
-		int delta = iter->second->setGeom(geom);
+		uint64_t tick = CacheClock::now();
+		int64_t delta = iter->second->setGeom(geom);
+		MemoryBudget::instance()->enforce(tick);
 		if (delta != 0)
 		{
 			memorySize += delta;
-			PRINTDB("Traverse cache insert: %1%, total=%2%: %3%", commas(delta) % commas(memorySize) % idString.substr(0, 80));
+			PRINTDB("Traverse cache insert: %1%, total=%2%: %3%", commas(delta) % commas(memorySize) % id);
 		}
 		if (memorySize > peakMemorySize)
 			peakMemorySize = memorySize;
 		return delta;
 	}
 
-	void release(const std::string &idString)
+	void release(const NodeId &id)
 	{
-		auto iter = cache.find(idString);
+		auto iter = cache.find(id);
 		assert(iter != cache.end());
 		size_t delta = iter->second->releaseRef();
 		if (delta != 0)
 		{
 			delete iter->second;
-			cache.erase(idString);
+			cache.erase(id);
 			memorySize -= delta;
-			PRINTDB("Traverse cache release: %1%, total=%2%: %3%", commas(delta) % commas(memorySize) % idString.substr(0, 80));
+			PRINTDB("Traverse cache release: %1%, total=%2%: %3%", commas(delta) % commas(memorySize) % id);
 		}
 	}
 
-	bool get(const std::string &idString, shared_ptr<const Geometry> &geom) const
+	bool get(const NodeId &id, shared_ptr<const Geometry> &geom) const
 	{
-		auto iter = cache.find(idString);
+		auto iter = cache.find(id);
 		assert(iter != cache.end());
 		if (iter->second->isAlive())
 		{
 			geom = iter->second->geom;
-			PRINTDB("Traverse cache hit: %s", idString.substr(0, 80));
+			PRINTDB("Traverse cache hit: %s", id);
 			return true;
 		}
 		return false;
@@ -535,7 +706,7 @@ bool ThreadedNodeVisitor::checkSmartCache(const AbstractNode &node, shared_ptr<c
 	if (cache != NULL)
 	{
 		boost::detail::spinlock::scoped_lock lock(cacheLock);
-		result = cache->get(tree.getIdString(node), geom);
+		result = cache->get(tree.getId(node), geom);
 	}
 #endif
 	return result;
@@ -547,7 +718,7 @@ bool ThreadedNodeVisitor::smartCacheInsert(const AbstractNode &node, shared_ptr<
 	if (cache != NULL)
 	{
 		boost::detail::spinlock::scoped_lock lock(cacheLock);
-		cache->insert(tree.getIdString(node), geom);
+		cache->insert(tree.getId(node), geom);
 		return true;
 	}
 #endif
@@ -565,8 +736,8 @@ Response ThreadedNodeVisitor::traverseThreaded(const AbstractNode &node)
 	State state(nullptr);
 	state.setNumChildren(node.getChildren().size());
 
-	std::string idString = tree.getIdString(node);
-	TraverseData nodeData(idString, &node, state, 0);
+	const NodeId &id = tree.getId(node);
+	TraverseData nodeData(id, &node, state, 0);
 
 	// get the updated node state;
 	State nodeState = nodeData.getState();
@@ -616,7 +787,7 @@ Response ThreadedNodeVisitor::traverseThreaded(const AbstractNode &node)
 	response = waitForIt(&nodeData);
 
 #ifdef ENABLE_TRAVERSE_CACHE
-	cache->release(nodeData.getIdString());
+	cache->release(nodeData.getNodeId());
 	cache->print();
 #endif
 
@@ -631,8 +802,8 @@ Response ThreadedNodeVisitor::runPrefix(const AbstractNode &node, const State &p
 	State state = parentState;
 	state.setNumChildren(node.getChildren().size());
 
-	std::string idString = tree.getIdString(node);
-	TraverseData *nodeData = new TraverseData(idString, &node, state, currentDepth);
+	const NodeId &id = tree.getId(node);
+	TraverseData *nodeData = new TraverseData(id, &node, state, currentDepth);
 	parentData->addChild(nodeData);
 
 	Response response = nodeData->accept(false, *this);
@@ -674,145 +845,157 @@ Response ThreadedNodeVisitor::runPrefix(const AbstractNode &node, const State &p
 	return ContinueTraversal;
 }
 
-// start runners using the available cores and wait for them to finish
+// schedule the leaves on the worker pool and wait for the root to finish
 Response ThreadedNodeVisitor::waitForIt(TraverseData *nodeData)
 {
-	Response response = ContinueTraversal;
 	// lock CGAL errors on the main thread
-	// this allows the spawned threads to catch their CGAL exceptions and not crash the whole app
+	// this allows the pool threads to catch their CGAL exceptions and not crash the whole app
 	// Response::AbortTraversal is "bubbled-up" when it occurs
 	CGALUtils::ErrorLocker locker;
-	size_t maxThreads = boost::thread::hardware_concurrency();
+	Profiler::Span span("traverse");
+	WorkStealingPool *pool = WorkStealingPool::instance();
 	size_t leafCount = nodeData->countUnprunedLeaves();
 	progress.setCount((int)leafCount);
-	PRINTB("Threaded traversal phase 2: Spawning %d threads on %d logical CPUs", leafCount % maxThreads);
-	size_t leafCounter = 0;
+	PRINTB("Threaded traversal phase 2: Scheduling %d nodes on %d worker threads", leafCount % pool->size());
 	size_t totalJoinCount = 0;
-	std::map<std::string, TraverseData*> running;
-	std::vector<TraverseData*> usedCpus;
-	usedCpus.resize(maxThreads);
-	bool lastLeaf = false;
 	double threadTime = 0;
 	QTime qTimer;
 	qTimer.start();
-	// wait loop
+	// every node waits on an atomic count of its unfinished children;
+	// the last child to finish schedules its parent from the worker thread
+	nodeData->estimateCosts(*this);
+	std::list<TraverseData*> leaves;
+	size_t sequence = 0;
+	nodeData->collectLeaves(leaves, sequence);
+	aborted = false;
+	for (auto leaf : leaves)
+		scheduleRunner(leaf);
+	// wait loop: housekeeping for finished runners until nothing is in flight
+	bool idle = false;
 	do
 	{
-		// step 1: start runners unless aborted or found the last leaf or enough are running
-		if (response != AbortTraversal && !lastLeaf && running.size() < maxThreads)
-		{
-			while (!lastLeaf && running.size() < maxThreads)
-			{
-				TraverseData *runner = nodeData->getRunner(this, running, lastLeaf);
-				if (runner == NULL)
-				{
-					assert(!lastLeaf && "Why doesn't the last leaf have data???");
-					// we get here when a single parent is waiting on one or more children to complete
-					break;
-				}
-				leafCounter++;
-				if (lastLeaf)
-				{
-					//PRINTB("That's the last leaf (erm, the root)!!! counted=%d, count=%d", leafCounter % leafCount);
-					assert(leafCount == leafCounter && "Why don't the leaf counts match???");
-					assert(nodeData == runner && "Why isn't the last leaf its own data???");
-				}
-				// find the first available "cpu" [for UI]
-				int cpuId = 0;
-				for (int i = 0; i < usedCpus.size(); ++i) {
-					if (!usedCpus[i]) {
-						cpuId = i;
-						usedCpus[i] = runner;
-						break;
-					}
-				}
-				// put the runner into the running map
-				running[runner->getIdString()] = runner;
-				// start the thread
-				runner->startThread(*this, cpuId);
-			}
-		}
-		// if running is empty, no threads are running and no new threads were added = done!
-		if (running.empty())
-		{
-			//PRINT("No more pending children");
-			assert(totalJoinCount == leafCounter && "Why weren't as many threads joined as started???");
-			break;
-		}
-		// step 2: wait for any children to finish and do housekeeping
 		//PRINT("Waiting for finished children");
 		std::list<TraverseData*> finished;
-		waitForAny(finished);
-		size_t joinCount = 0;
+		idle = waitForAny(finished);
 		for (auto runner : finished)
 		{
-			// reset the cpu flag
-			usedCpus[runner->getCpuId()] = nullptr;
-			// check for abort
-			if (runner->getResponse() == AbortTraversal)
-				response = AbortTraversal;
 #ifdef ENABLE_TRAVERSE_CACHE
 			// release cached references for the node's children
 			{
 				boost::detail::spinlock::scoped_lock lock(cacheLock);
 				for (auto child : runner->getChildren()) {
-					cache->release(child->getIdString());
+					cache->release(child->getNodeId());
 				}
 			}
 #endif
 			// update the thread time accumulator
 			threadTime += runner->getElapsed() / 1000.0;
-			// pull it from running
-			running.erase(runner->getIdString());
-			// increment the join counts
-			joinCount++;
+			// increment the join count
 			totalJoinCount++;
 			// tick the main progress
 			progress.tick();
 		}
-		/*
-		if (joinCount > 0 && runningCount != 0)
-		{
-			std::stringstream ss;
-			bool first = true;
-			for (auto runner : running)
-			{
-				if (!first)
-					ss << ", ";
-				ss << runner->second.data->getId();
-				first = false;
-			}
-			PRINTB("Joined %d threads (%d/%d), still running: (%d) %s", joinCount % totalJoinCount % leafCount % runningCount % ss.str());
-		}
-		*/
-	} while (true); // wait loop
+	} while (!idle); // wait loop
+
+	assert((aborted || totalJoinCount == leafCount) && "Why weren't all the nodes finished???");
 
 	double totalTime = qTimer.elapsed() / 1000.0;
 	double mult = totalTime == 0 ? 1.0 : threadTime / totalTime;
-	PRINTB("Threaded traversal finished: time in threads=%s / wall time=%s = %1.2fx",
-		timeStr(threadTime) % timeStr(totalTime) % mult);
+	// the wall time can't beat the longest chain of dependent nodes
+	double criticalTime = nodeData->criticalPath() / 1000.0;
+	PRINTB("Threaded traversal finished: time in threads=%s / wall time=%s = %1.2fx, critical path=%s (%d%% of wall time)",
+		timeStr(threadTime) % timeStr(totalTime) % mult % timeStr(criticalTime) %
+		(totalTime == 0 ? 100 : (int)std::round(100 * criticalTime / totalTime)));
 
-	return response;
+	return aborted ? AbortTraversal : ContinueTraversal;
 }
 
+bool ThreadedNodeVisitor::RunnerOrder::operator()(const TraverseData *a, const TraverseData *b) const
+{
+	// priority_queue pops the largest, so a sorts first if it's less urgent
+	if (a->getPriority() != b->getPriority())
+		return a->getPriority() < b->getPriority();
+	return a->getSequence() > b->getSequence();
+}
+
+// queues a runner whose children have all finished and submits a worker task for it
+void ThreadedNodeVisitor::scheduleRunner(TraverseData *runner)
+{
+	// the children's geometries are known now
+	runner->refineCost(*this);
+	{
+		runner_lock::scoped_lock lock(this);
+		auto found = running.find(runner->getNodeId());
+		if (found != running.end()) {
+			// an identical subtree is running; let this one hit the cache when it's done
+			found->second.push_back(runner);
+			return;
+		}
+		running[runner->getNodeId()];
+		ready.push(runner);
+		inFlight++;
+	}
+	// the task doesn't run this runner, but the most urgent ready one; there
+	// is a task for every ready runner, so they all run
+	WorkStealingPool::instance()->submit([this](int workerId) {
+		TraverseData *next;
+		{
+			runner_lock::scoped_lock lock(this);
+			assert(!ready.empty());
+			next = ready.top();
+			ready.pop();
+		}
+		next->run(*this, workerId);
+	});
+}
+
+size_t ThreadedNodeVisitor::cachedGeometryBytes(const AbstractNode &node)
+{
+	shared_ptr<const Geometry> geom;
+	if (checkSmartCache(node, geom) && geom && !geom->isEmpty())
+		return geom->memsize();
+	return 0;
+}
+
+// schedules the runner's parent if it was the last child, then
 // posts ready_event if this is the first and moves it to finished
 // called on the runner thread
 void ThreadedNodeVisitor::finishRunner(TraverseData *runner)
 {
+	std::list<TraverseData*> waiting;
+	{
+		runner_lock::scoped_lock lock(this);
+		auto found = running.find(runner->getNodeId());
+		assert(found != running.end());
+		std::swap(waiting, found->second);
+		running.erase(found);
+	}
+	if (runner->getResponse() == AbortTraversal)
+		aborted = true;
+	if (!aborted) {
+		for (auto other : waiting)
+			scheduleRunner(other);
+		auto parent = runner->getParent();
+		if (parent && parent->childFinished())
+			scheduleRunner(parent);
+	}
 	runner_lock::scoped_lock lock(this);
 	// post ready_event if this is the first runner to finish
 	if (finished.empty())
 		ready_event.post();
 	// move it to finished
 	finished.push_back(runner);
+	inFlight--;
 }
 
 // waits for any runners to finish and fills finished with 'em
+// returns true when nothing is left in flight
 // called on the main thread
-void ThreadedNodeVisitor::waitForAny(std::list<TraverseData*> &finished)
+bool ThreadedNodeVisitor::waitForAny(std::list<TraverseData*> &finished)
 {
 	ready_event.wait();
 	// ready_event was posted; fill the result lists
 	runner_lock::scoped_lock lock(this);
 	std::swap(finished, this->finished);
+	return inFlight == 0;
 }
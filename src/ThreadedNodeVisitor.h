@@ -2,7 +2,9 @@
 
 #include <stdint.h>
 #include <map>
+#include <unordered_map>
 #include <list>
+#include <queue>
 #include <stack>
 #include "NodeVisitor.h"
 #include "Tree.h"
@@ -26,23 +28,39 @@
 class TraverseData;
 // forward declaration: custom cache to ensure geometries aren't deleted prematurely
 class TraverseCache;
+// forward declaration: estimates postfix times for the scheduler
+class TraverseCostModel;
 
 class ThreadedNodeVisitor : public NodeVisitor
 {
+	// looks up recorded postfix times in the geometry caches
+	friend class TraverseCostModel;
+
+	// orders ready runners by their estimated time until the root finishes
+	struct RunnerOrder
+	{
+		bool operator()(const TraverseData *a, const TraverseData *b) const;
+	};
+
 	bool threaded;												// indicates this visitor should actually use threads
 	typedef boost::detail::spinlock_pool<8> runner_lock;		// locks access to the runners
 	boost::interprocess::interprocess_semaphore ready_event;	// set when the first runner has finished
 	std::list<TraverseData*> finished;							// a list of finished runners
+	std::unordered_map<NodeId, std::list<TraverseData*>> running;	// running node ids and the identical runners waiting on them
+	std::priority_queue<TraverseData*, std::vector<TraverseData*>, RunnerOrder> ready;	// runners waiting for a worker, longest path first
+	size_t inFlight;											// runners submitted to the pool but not yet finished
+	std::atomic<bool> aborted;									// set when any runner aborts; stops scheduling
 	TraverseCache *cache;										// custom cache to ensure geometries aren't deleted prematurely
 
 	const Tree &tree;
 	Progress &progress;
 
 	// waits for any runners to finish and fills finished with 'em
+	// returns true when nothing is left in flight
 	// called on the main thread
-	void waitForAny(std::list<TraverseData*> &finished);
+	bool waitForAny(std::list<TraverseData*> &finished);
 
-	// start runners using the available cores and wait for them to finish
+	// schedule the leaves on the worker pool and wait for the root to finish
 	Response waitForIt(TraverseData *nodeData);
 
 protected:
@@ -55,12 +73,22 @@ protected:
 
 public:
   ThreadedNodeVisitor(const Tree &tree, Progress &progress, bool threaded = false)
-	  : threaded(threaded), ready_event(0), cache(NULL), tree(tree), progress(progress) {
+	  : threaded(threaded), ready_event(0), inFlight(0), aborted(false), cache(NULL), tree(tree), progress(progress) {
+		this->profiled = true;
   }
   virtual ~ThreadedNodeVisitor() { }
 
   Response traverseThreaded(const AbstractNode &node);
 
+  // queues a runner whose children have all finished and submits a worker
+  // task for it; the task runs the ready runner with the highest priority
+  // called on the main thread for leaves and on the runner thread for parents
+  void scheduleRunner(TraverseData *runner);
+
+  // the size of the node's geometry in the traverse cache, 0 if it has none
+  size_t cachedGeometryBytes(const AbstractNode &node);
+
+  // schedules the runner's parent if it was the last child, then
   // posts ready_event if this is the first and moves it to finished
   // called on the runner thread
   void finishRunner(TraverseData *runner);
@@ -0,0 +1,119 @@
+#include "TransformedGeometry.h"
+#include "polyset.h"
+#include "Polygon2d.h"
+#include "clipper-utils.h"
+#include "CGAL_Nef_polyhedron.h"
+#include "MemoryBudget.h"
+#include <sstream>
+
+TransformedGeometry::TransformedGeometry(const GeometryHandle &child, const Transform3d &matrix)
+	: child(child)
+	, matrix(matrix)
+	, hasResult(false)
+{
+	type = "TransformedGeometry";
+	this->convexity = child->getConvexity();
+}
+
+GeometryHandle TransformedGeometry::create(const GeometryHandle &child, const Transform3d &matrix)
+{
+	if (auto tg = dynamic_pointer_cast<const TransformedGeometry>(child))
+		return GeometryHandle(new TransformedGeometry(tg->child, matrix * tg->matrix));
+	return GeometryHandle(new TransformedGeometry(child, matrix));
+}
+
+GeometryHandle TransformedGeometry::materialize(const GeometryHandle &geom)
+{
+	if (auto tg = dynamic_pointer_cast<const TransformedGeometry>(geom))
+		return tg->get();
+	if (auto gg = dynamic_pointer_cast<const GeometryGroup>(geom)) {
+		NodeGeometries children;
+		bool changed = false;
+		for (const auto &gc : gg->getChildren()) {
+			GeometryHandle mc = materialize(gc.second);
+			changed |= mc != gc.second;
+			children.push_back(NodeGeometry(gc.first, mc));
+		}
+		if (changed)
+			return GeometryHandle(new GeometryGroup(children));
+	}
+	return geom;
+}
+
+const GeometryHandle &TransformedGeometry::get() const
+{
+	std::call_once(this->materialized, [this] {
+		Geometry *geom = nullptr;
+		if (auto ps = dynamic_pointer_cast<const PolySet>(child)) {
+			PolySet *newps = (PolySet*)ps->copy();
+			newps->transform(this->matrix);
+			geom = newps;
+		}
+		else if (auto N = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(child)) {
+			CGAL_Nef_polyhedron *newN = (CGAL_Nef_polyhedron*)N->copy();
+			newN->transform(this->matrix);
+			geom = newN;
+		}
+		else if (auto poly = dynamic_pointer_cast<const Polygon2d>(child)) {
+			Polygon2d *newpoly = (Polygon2d*)poly->copy();
+			Transform2d mat2;
+			mat2.matrix() <<
+				this->matrix(0, 0), this->matrix(0, 1), this->matrix(0, 3),
+				this->matrix(1, 0), this->matrix(1, 1), this->matrix(1, 3),
+				this->matrix(3, 0), this->matrix(3, 1), this->matrix(3, 3);
+			newpoly->transform(mat2);
+			// a flipped winding order needs to be fixed for sanitized polygons
+			if (newpoly->isSanitized() && mat2.matrix().determinant() <= 0) {
+				ClipperUtils utils;
+				Polygon2d *sanitized = utils.sanitize(*newpoly);
+				delete newpoly;
+				newpoly = sanitized;
+			}
+			geom = newpoly;
+		}
+		if (geom) {
+			geom->setConvexity(this->convexity);
+			this->result.reset(geom);
+		}
+		else if (auto gg = dynamic_pointer_cast<const GeometryGroup>(child)) {
+			// groups are transformed member by member
+			NodeGeometries children;
+			for (const auto &gc : gg->getChildren())
+				if (gc.second)
+					children.push_back(NodeGeometry(gc.first, materialize(create(gc.second, this->matrix))));
+			this->result.reset(new GeometryGroup(children));
+		}
+		else {
+			// nothing to transform
+			this->result = child;
+		}
+		this->hasResult.store(true, std::memory_order_release);
+		// a cache may already hold this object at its lazy size
+		MemoryBudget::instance()->remeasure(this);
+	});
+	return this->result;
+}
+
+size_t TransformedGeometry::memsize() const
+{
+	// the child is shared and accounted for where it is cached; the
+	// materialized copy is ours, unless nothing needed transforming
+	size_t size = sizeof(TransformedGeometry);
+	if (this->hasResult.load(std::memory_order_acquire) && this->result != child)
+		size += this->result->memsize();
+	return size;
+}
+
+BoundingBox TransformedGeometry::getBoundingBox() const
+{
+	return this->matrix * child->getBoundingBox();
+}
+
+std::string TransformedGeometry::dump() const
+{
+	std::stringstream out;
+	out << "TransformedGeometry:"
+			<< "\n matrix: " << this->matrix.matrix()
+			<< "\n child: " << child->dump();
+	return out.str();
+}
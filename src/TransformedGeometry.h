@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include "Geometry.h"
+
+/*!
+	A lazily transformed geometry.
+
+	Holds a shared, untouched child and the affine transform to apply to it.
+	Transforming a TransformedGeometry again only composes the matrices, so a
+	chain of translate/rotate/scale nodes or an array of transformed copies of
+	one cached part costs a matrix each rather than a copy of the geometry.
+
+	The transformed geometry is built on the first call to get(), i.e. when a
+	boolean operation, export or renderer needs the actual coordinates, and is
+	kept for later calls. From then on memsize() includes the kept copy.
+*/
+class TransformedGeometry : public Geometry
+{
+public:
+	// returns child transformed by matrix, composing with an already lazy child
+	static GeometryHandle create(const GeometryHandle &child, const Transform3d &matrix);
+
+	// returns geom with any TransformedGeometry materialized, recursing into groups
+	static GeometryHandle materialize(const GeometryHandle &geom);
+
+	virtual size_t memsize() const;
+	virtual BoundingBox getBoundingBox() const;
+	virtual std::string dump() const;
+	virtual unsigned int getDimension() const { return child->getDimension(); }
+	virtual bool isEmpty() const { return child->isEmpty(); }
+	virtual Geometry *copy() const { return new TransformedGeometry(child, matrix); }
+
+	const GeometryHandle &getChild() const { return child; }
+	const Transform3d &getMatrix() const { return matrix; }
+
+	// the materialized geometry
+	const GeometryHandle &get() const;
+
+private:
+	TransformedGeometry(const GeometryHandle &child, const Transform3d &matrix);
+
+	GeometryHandle child;
+	Transform3d matrix;
+
+	mutable std::once_flag materialized;
+	mutable GeometryHandle result;
+	// set once result is assigned, for readers that don't go through get()
+	mutable std::atomic<bool> hasResult;
+};
+
+typedef shared_ptr<const TransformedGeometry> TransformedGeometryHandle;
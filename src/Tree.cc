@@ -1,6 +1,7 @@
 #include "Tree.h"
 #include "nodedumper.h"
 #include "printutils.h"
+#include "Profiler.h"
 
 #include <assert.h>
 #include <algorithm>
@@ -11,6 +12,8 @@ Tree::~Tree()
 {
 	this->nodecache.clear();
 	this->nodeidcache.clear();
+	this->nodeids.clear();
+	this->idnodecache.clear();
 }
 
 /*!
@@ -21,6 +24,7 @@ const std::string &Tree::getString(const AbstractNode &node) const
 {
 	assert(this->root_node);
 	if (!this->nodecache.contains(node)) {
+		Profiler::Span span("node dump");
 		this->nodecache.clear();
 		this->nodeidcache.clear();
 		NodeDumper dumper(this->nodecache, false);
@@ -38,6 +42,8 @@ const std::string &Tree::getString(const AbstractNode &node) const
 	The difference between this method and getString() is that the ID string
 	is stripped for whitespace. Especially indentation whitespace is important to
 	strip to enable cache hits for equivalent nodes from different scopes.
+
+	The geometry caches are keyed on getId(); this is only used for debug output.
 */
 const std::string &Tree::getIdString(const AbstractNode &node) const
 {
@@ -50,19 +56,59 @@ const std::string &Tree::getIdString(const AbstractNode &node) const
 		boost::sregex_token_iterator i(nodestr.begin(), nodestr.end(), re, 0);
 		std::copy(i, boost::sregex_token_iterator(), std::ostream_iterator<std::string>(sstream));
 
-		const std::string & result = this->nodeidcache.insert(node, sstream.str());
-		PRINTDB("Id Cache MISS: %s", result);
-		this->idnodecache.insert(std::make_pair(result, &node));
-		return result;
-	} else {
-		const std::string & result = this->nodeidcache[node];
-		PRINTDB("Id Cache HIT:  %s", result);
-		return result;
+		return this->nodeidcache.insert(node, sstream.str());
+	}
+	return this->nodeidcache[node];
+}
+
+/*!
+	Returns the structural id of the subtree rooted by \a node.
+	If node is not cached, the ids of the whole tree will be rebuilt.
+
+	The id is a hash of the node's own string and the modifiers and ids of
+	its children, so it's built in linear time and equivalent subtrees from
+	different scopes get equal ids.
+
+	Safe to call from several threads; the id is returned by value since a
+	miss on another thread rebuilds the table.
+*/
+NodeId Tree::getId(const AbstractNode &node) const
+{
+	assert(this->root_node);
+	std::lock_guard<std::mutex> lock(this->idmutex);
+
+	if (this->nodeids.size() <= node.index() || this->nodeids[node.index()].isNull()) {
+		Profiler::Span span("node id");
+		this->nodeids.clear();
+		this->idnodecache.clear();
+		computeId(*this->root_node);
+		assert(this->nodeids.size() > node.index() && !this->nodeids[node.index()].isNull() &&
+					 "Node is not part of the tree");
+		PRINTDB("Id Cache MISS: %s", this->nodeids[node.index()]);
+	}
+	return this->nodeids[node.index()];
+}
+
+NodeId Tree::computeId(const AbstractNode &node) const
+{
+	NodeId id;
+	id.combine(node.toString());
+	for (const auto &child : node.getChildren()) {
+		NodeId childId = computeId(*child);
+		char modifiers[2] = { child->isBackground() ? '%' : ' ', child->isHighlight() ? '#' : ' ' };
+		id.combine(modifiers, sizeof(modifiers));
+		id.combine(childId);
 	}
+	if (this->nodeids.size() <= node.index())
+		this->nodeids.resize(node.index() + 1);
+	this->nodeids[node.index()] = id;
+	this->idnodecache.insert(std::make_pair(id, &node));
+	return id;
 }
 
-const AbstractNode &Tree::getNode(const std::string &id) const
+const AbstractNode &Tree::getNode(const NodeId &id) const
 {
+	std::lock_guard<std::mutex> lock(this->idmutex);
 	auto found = this->idnodecache.find(id);
 	assert(found != this->idnodecache.end());
 	return *found->second;
@@ -75,4 +121,7 @@ void Tree::setRoot(const AbstractNode *root)
 {
 	this->root_node = root; 
 	this->nodecache.clear();
+	this->nodeidcache.clear();
+	this->nodeids.clear();
+	this->idnodecache.clear();
 }
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "nodecache.h"
+#include "hash.h"
 #include <unordered_map>
+#include <mutex>
 
 /*!  
 	For now, just an abstraction of the node tree which keeps a dump
-	cache based on node indices around.
+	cache and a structural id per node based on node indices around.
 
 	Note that since node trees don't survive a recompilation, the tree cannot either.
  */
@@ -20,11 +22,17 @@ public:
 
 	const std::string &getString(const AbstractNode &node) const;
 	const std::string &getIdString(const AbstractNode &node) const;
-	const AbstractNode &getNode(const std::string &id) const;
+	NodeId getId(const AbstractNode &node) const;
+	const AbstractNode &getNode(const NodeId &id) const;
 
 private:
+	NodeId computeId(const AbstractNode &node) const;
+
 	const AbstractNode *root_node;
   mutable NodeCache nodecache;
   mutable NodeCache nodeidcache;
-  mutable std::unordered_map<std::string, const AbstractNode *> idnodecache;
+  mutable std::vector<NodeId> nodeids;
+  mutable std::unordered_map<NodeId, const AbstractNode *> idnodecache;
+  // guards nodeids and idnodecache, which worker threads read while a miss rebuilds them
+  mutable std::mutex idmutex;
 };
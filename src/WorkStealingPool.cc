@@ -0,0 +1,213 @@
+#include "WorkStealingPool.h"
+#include "PlatformUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// the id of the pool worker running on this thread
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(size_t numWorkers)
+	: pending(0)
+	, stopping(false)
+{
+	sharedLock = BOOST_DETAIL_SPINLOCK_INIT;
+	if (numWorkers == 0) {
+		const char *workersEnv = getenv("OPENSCAD_WORKERS");
+		if (workersEnv) numWorkers = std::max(0, atoi(workersEnv));
+	}
+	if (numWorkers == 0)
+		numWorkers = std::max(1u, boost::thread::hardware_concurrency());
+	for (size_t i = 0; i < numWorkers; ++i)
+		workers.push_back(new Worker());
+	// start the threads after all workers exist so stealing never sees a partial list
+	// threaded for loops evaluate as deeply nested modules as the main thread, see StackCheck
+	boost::thread::attributes attrs;
+	attrs.set_stack_size(PlatformUtils::stackLimit() + STACK_BUFFER_SIZE);
+	for (size_t i = 0; i < numWorkers; ++i)
+		workers[i]->thread = new boost::thread(attrs, [this, i] { run(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		boost::mutex::scoped_lock lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCond.notify_all();
+	for (auto worker : workers) {
+		worker->thread->join();
+		delete worker->thread;
+		delete worker;
+	}
+}
+
+int WorkStealingPool::currentWorkerId()
+{
+	return currentWorker;
+}
+
+void WorkStealingPool::submit(const Task &task)
+{
+	int workerId = currentWorkerId();
+	if (workerId >= 0) {
+		Worker *worker = workers[workerId];
+		boost::detail::spinlock::scoped_lock lock(worker->lock);
+		worker->tasks.push_back(task);
+		pending++;
+	}
+	else {
+		boost::detail::spinlock::scoped_lock lock(sharedLock);
+		shared.push_back(task);
+		pending++;
+	}
+	// take the mutex so a worker between checking pending and sleeping can't miss the wakeup
+	{
+		boost::mutex::scoped_lock lock(sleepMutex);
+	}
+	sleepCond.notify_one();
+}
+
+bool WorkStealingPool::popLocal(size_t workerId, Task &task)
+{
+	Worker *worker = workers[workerId];
+	boost::detail::spinlock::scoped_lock lock(worker->lock);
+	if (worker->tasks.empty())
+		return false;
+	task = std::move(worker->tasks.back());
+	worker->tasks.pop_back();
+	pending--;
+	return true;
+}
+
+bool WorkStealingPool::popShared(Task &task)
+{
+	boost::detail::spinlock::scoped_lock lock(sharedLock);
+	if (shared.empty())
+		return false;
+	task = std::move(shared.front());
+	shared.pop_front();
+	pending--;
+	return true;
+}
+
+bool WorkStealingPool::steal(size_t workerId, Task &task)
+{
+	for (size_t i = 1; i < workers.size(); ++i) {
+		Worker *victim = workers[(workerId + i) % workers.size()];
+		boost::detail::spinlock::scoped_lock lock(victim->lock);
+		if (victim->tasks.empty())
+			continue;
+		task = std::move(victim->tasks.front());
+		victim->tasks.pop_front();
+		pending--;
+		return true;
+	}
+	return false;
+}
+
+void WorkStealingPool::run(size_t workerId)
+{
+	currentWorker = (int)workerId;
+	while (true) {
+		Task task;
+		if (popLocal(workerId, task) || popShared(task) || steal(workerId, task)) {
+			task((int)workerId);
+			continue;
+		}
+		boost::mutex::scoped_lock lock(sleepMutex);
+		while (pending == 0 && !stopping)
+			sleepCond.wait(lock);
+		if (stopping)
+			break;
+	}
+}
+
+// ------------------------------------------------------------------------
+// TaskGroup
+// ------------------------------------------------------------------------
+WorkStealingPool::TaskGroup::TaskGroup(WorkStealingPool *pool)
+	: pool(pool)
+	, state(std::make_shared<GroupState>())
+{
+}
+
+WorkStealingPool::TaskGroup::~TaskGroup()
+{
+	try {
+		wait();
+	}
+	catch (...) {
+		// errors are only reported to an explicit wait()
+	}
+}
+
+void WorkStealingPool::TaskGroup::run(const std::function<void()> &task)
+{
+	{
+		boost::detail::spinlock::scoped_lock lock(state->lock);
+		state->queued.push_back(task);
+		state->outstanding++;
+	}
+	// the token keeps the state alive in case wait() already ran the task inline
+	auto groupState = state;
+	pool->submit([groupState](int) { groupState->runOne(); });
+}
+
+bool WorkStealingPool::TaskGroup::GroupState::runOne()
+{
+	std::function<void()> task;
+	bool skip;
+	{
+		boost::detail::spinlock::scoped_lock guard(lock);
+		if (queued.empty())
+			return false;
+		task = std::move(queued.front());
+		queued.pop_front();
+		skip = (bool)error;
+	}
+	if (!skip) {
+		try {
+			task();
+		}
+		catch (...) {
+			boost::detail::spinlock::scoped_lock guard(lock);
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	bool finished;
+	{
+		boost::detail::spinlock::scoped_lock guard(lock);
+		finished = (--outstanding == 0);
+	}
+	if (finished) {
+		boost::mutex::scoped_lock guard(mutex);
+		done.notify_all();
+	}
+	return true;
+}
+
+void WorkStealingPool::TaskGroup::wait()
+{
+	// help out with the tasks nobody has picked up yet
+	while (state->runOne()) { }
+	{
+		boost::mutex::scoped_lock guard(state->mutex);
+		while (true) {
+			{
+				boost::detail::spinlock::scoped_lock lock(state->lock);
+				if (state->outstanding == 0)
+					break;
+			}
+			state->done.wait(guard);
+		}
+	}
+	std::exception_ptr error;
+	{
+		boost::detail::spinlock::scoped_lock lock(state->lock);
+		std::swap(error, state->error);
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include "memory.h"
+
+// MinGW defines sprintf to libintl_sprintf which breaks usage of the
+// Qt sprintf in QString. This is skipped if sprintf and _GL_STDIO_H
+// is already defined, so the workaround defines sprintf as itself.
+#ifdef __MINGW32__
+#define _GL_STDIO_H
+#define sprintf sprintf
+#endif
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/smart_ptr/detail/spinlock.hpp>
+
+/*!
+	A persistent, fixed-size pool of worker threads.
+
+	Each worker owns a deque of tasks. A worker pushes and pops its own tasks
+	at the back (so a parent scheduled by its last child runs next on the same
+	core) and steals from the front of the other workers' deques when it runs
+	dry. Tasks submitted from outside the pool go into a shared queue.
+
+	Worker ids are stable for the lifetime of the pool and range from 0 to
+	size() - 1, so they can be used to index per-cpu state like the
+	CpuProgress slots in Progress.
+*/
+class WorkStealingPool
+{
+public:
+	typedef std::function<void(int workerId)> Task;
+
+	// 0 workers means one per core, or the number in the OPENSCAD_WORKERS
+	// environment variable if set
+	WorkStealingPool(size_t numWorkers = 0);
+	~WorkStealingPool();
+
+	// the shared pool; created on first use, which may be on any thread
+	static WorkStealingPool *instance() { static WorkStealingPool *pool = new WorkStealingPool; return pool; }
+
+	// queues a task; tasks submitted from a worker go to the back of its own deque
+	void submit(const Task &task);
+
+	size_t size() const { return workers.size(); }
+
+	// the id of the calling worker or -1 if not called from a pool thread
+	static int currentWorkerId();
+
+	class TaskGroup;
+
+private:
+	struct Worker
+	{
+		boost::detail::spinlock lock;
+		std::deque<Task> tasks;
+		boost::thread *thread;
+
+		Worker() : thread(nullptr) { lock = BOOST_DETAIL_SPINLOCK_INIT; }
+	};
+
+	bool popLocal(size_t workerId, Task &task);
+	bool popShared(Task &task);
+	bool steal(size_t workerId, Task &task);
+	void run(size_t workerId);
+
+	std::vector<Worker*> workers;
+	boost::detail::spinlock sharedLock;
+	std::deque<Task> shared;
+	std::atomic<size_t> pending;	// queued, not yet taken tasks
+	bool stopping;
+	boost::mutex sleepMutex;
+	boost::condition_variable sleepCond;
+};
+
+/*!
+	A set of tasks which can be waited on.
+
+	Tasks are queued on the group and a token is submitted to the pool for
+	each of them. The thread calling wait() runs any tasks which haven't been
+	picked up by a worker yet, so waiting from inside a pool task cannot
+	deadlock the pool.
+
+	The first exception thrown by a task (including ProgressCancelException)
+	is rethrown by wait(); tasks which haven't started by then are skipped.
+*/
+class WorkStealingPool::TaskGroup
+{
+public:
+	TaskGroup(WorkStealingPool *pool = WorkStealingPool::instance());
+	~TaskGroup();
+
+	void run(const std::function<void()> &task);
+	void wait();
+
+private:
+	struct GroupState
+	{
+		boost::detail::spinlock lock;
+		std::deque<std::function<void()>> queued;
+		size_t outstanding;
+		std::exception_ptr error;
+		boost::mutex mutex;
+		boost::condition_variable done;
+
+		GroupState() : outstanding(0) { lock = BOOST_DETAIL_SPINLOCK_INIT; }
+
+		// runs one queued task; returns false if there was none
+		bool runOne();
+	};
+
+	WorkStealingPool *pool;
+	shared_ptr<GroupState> state;
+};
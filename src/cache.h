@@ -45,26 +45,43 @@
 #pragma once
 
 #include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <boost/format.hpp>
 #include "printutils.h"
 
+/*!
+	A global use counter, so entries of different caches can be compared by
+	how recently they were used.
+*/
+struct CacheClock
+{
+	static uint64_t tick() { return ++counter(); }
+	static uint64_t now() { return counter(); }
+private:
+	static std::atomic<uint64_t> &counter() { static std::atomic<uint64_t> c(0); return c; }
+};
+
 template <class Key, class T>
 class Cache
 {
 	struct Node {
-		inline Node() : keyPtr(0), t(0), c(0), p(0), n(0) {}
-		inline Node(T *data, int cost)
-			: keyPtr(0), t(data), c(cost), p(0), n(0) {}
-		const Key *keyPtr; T *t; int c; Node *p,*n;
+		inline Node() : keyPtr(0), t(0), c(0), used(0), p(0), n(0) {}
+		inline Node(T *data, size_t cost)
+			: keyPtr(0), t(data), c(cost), used(CacheClock::tick()), p(0), n(0) {}
+		const Key *keyPtr; T *t; size_t c; uint64_t used; Node *p,*n;
 	};
 	typedef typename std::unordered_map<Key, Node> map_type;
 	typedef typename map_type::iterator iterator_type;
 	typedef typename map_type::value_type value_type;
+	typedef std::function<void(const Key &key, T &object)> evict_type;
 
 	map_type hash;
 	Node *f, *l;
 	void *unused;
-	int mx, total;
+	size_t mx, total;
+	evict_type evicted;
 
 	inline void unlink(Node &n) {
 		if (n.p) n.p->n = n.n;
@@ -76,11 +93,16 @@ class Cache
 		hash.erase(*n.keyPtr);
 		delete obj;
 	}
+	inline void evict(Node &n) {
+		if (evicted && n.t) evicted(*n.keyPtr, *n.t);
+		unlink(n);
+	}
 	inline T *relink(const Key &key) {
 		iterator_type i = hash.find(key);
 		if (i == hash.end()) return 0;
 
 		Node &n = i->second;
+		n.used = CacheClock::tick();
 		if (f != &n) {
 			if (n.p) n.p->n = n.n;
 			if (n.n) n.n->p = n.p;
@@ -94,32 +116,59 @@ class Cache
 	}
 
 public:
-	inline explicit Cache(int maxCost = 100)
+	inline explicit Cache(size_t maxCost = 100)
 		: f(0), l(0), unused(0), mx(maxCost), total(0) { }
 	inline ~Cache() { clear(); }
 
-	inline int maxCost() const { return mx; }
-	void setMaxCost(int m) { mx = m; trim(mx); }
-	inline int totalCost() const { return total; }
+	inline size_t maxCost() const { return mx; }
+	void setMaxCost(size_t m) { mx = m; trim(mx); }
+	inline size_t totalCost() const { return total; }
 
 	inline int size() const { return hash.size(); }
 	inline bool empty() const { return hash.empty(); }
 
+	// called with entries dropped to make room, before they're deleted
+	void setEvictionHandler(const evict_type &handler) { evicted = handler; }
+
+	// the use tick of the least recently used entry, UINT64_MAX if empty
+	uint64_t oldestUse() const { return l ? l->used : UINT64_MAX; }
+	// evicts the least recently used entry, returns its cost
+	size_t evictOldest() {
+		if (!l) return 0;
+		size_t cost = l->c;
+		evict(*l);
+		return cost;
+	}
+
 	void clear() {
 		while (f) { delete f->t; f = f->n; }
 		hash.clear(); l = 0; total = 0;
 	}
 
-	bool insert(const Key &key, T *object, int cost = 1);
+	bool insert(const Key &key, T *object, size_t cost = 1);
 	T *object(const Key &key) const { return const_cast<Cache<Key,T>*>(this)->relink(key); }
 	inline bool contains(const Key &key) const { return hash.find(key) != hash.end(); }
 	T *operator[](const Key &key) const { return object(key); }
+	// looks up an entry without counting it as a use
+	T *peek(const Key &key) const {
+		auto i = hash.find(key);
+		return i == hash.end() ? 0 : i->second.t;
+	}
 
 	bool remove(const Key &key);
 	T *take(const Key &key);
+	// removes the entries for which pred(key, object) is true
+	template <class Pred> void removeIf(Pred pred) {
+		Node *n = l;
+		while (n) {
+			Node *u = n;
+			n = n->p;
+			if (u->t && pred(*u->keyPtr, *u->t)) unlink(*u);
+		}
+	}
 
 private:
-	void trim(int m);
+	void trim(size_t m);
 };
 
 template <class Key, class T>
@@ -140,7 +189,7 @@ inline T *Cache<Key,T>::take(const Key &key)
 	iterator_type i = hash.find(key);
 	if (i == hash.end()) return 0;
 
-	Node &n = *i;
+	Node &n = i->second;
 	T *t = n.t;
 	n.t = 0;
 	unlink(n);
@@ -148,7 +197,7 @@ inline T *Cache<Key,T>::take(const Key &key)
 }
 
 template <class Key, class T>
-bool Cache<Key,T>::insert(const Key &akey, T *aobject, int acost)
+bool Cache<Key,T>::insert(const Key &akey, T *aobject, size_t acost)
 {
 	remove(akey);
 	if (acost > mx) {
@@ -170,15 +219,15 @@ bool Cache<Key,T>::insert(const Key &akey, T *aobject, int acost)
 }
 
 template <class Key, class T>
-void Cache<Key,T>::trim(int m)
+void Cache<Key,T>::trim(size_t m)
 {
 	Node *n = l;
 	while (n && total > m) {
 		Node *u = n;
 		n = n->p;
 #ifdef DEBUG
-		PRINTB("Trimming cache: %1% (%2% bytes)", u->keyPtr->substr(0, 40) % u->c);
+		PRINTB("Trimming cache: %1% (%2% bytes)", *u->keyPtr % u->c);
 #endif
-		unlink(*u);
+		evict(*u);
 	}
 }
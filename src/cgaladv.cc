@@ -35,7 +35,10 @@
 #include "maybe_const.h"
 #include "PathHelpers.h"
 #include "Handles.h"
+#include "progress.h"
+#include "WorkStealingPool.h"
 #include <CGAL/convex_hull_2.h>
+#include <algorithm>
 #include <sstream>
 #include <assert.h>
 #include <boost/assign/std/vector.hpp>
@@ -111,25 +114,49 @@ public:
 		GeometryHandles finishchildren;
 		if (!paths.empty() && !actualchildren.empty())
 		{
+			// the paths are independent, each runs on the worker pool with its own
+			// progress slot; their messages are captured and printed in path order
 			size_t t = paths.size();
-			auto iter = paths.begin();
-			for (size_t i = 1; iter != paths.end(); ++i, ++iter)
+			finishchildren.resize(t);
+			std::vector<PrintCapture> output(t);
+			CpuProgress *outer = CpuProgress::getCurrent();
+			WorkStealingPool::TaskGroup group;
+			for (size_t i = 0; i < t; i++)
 			{
-				GeometryHandles pathChildren = actualchildren;
-				pathChildren.insert(pathChildren.begin(), *iter);
-				// apply the glide
-				try
-				{
-					PRINTB("Glide: Performing Minkowski on path %d/%d", i % t);
-					GeometryHandle mink(CGALUtils::applyMinkowski(pathChildren));
-					finishchildren.push_back(mink);
-					PRINTB("Glide: Finished Minkowski on path %d/%d", i % t);
-				}
-				catch (const std::exception &ex)
-				{
-					PRINTB("Glide: Caught an exeption: %s", ex.what());
-				}
+				group.run([&paths, &actualchildren, &finishchildren, &output, outer, i, t]() {
+					PrintCapture::Scope capture(output[i]);
+					int workerId = WorkStealingPool::currentWorkerId();
+					std::unique_ptr<CpuProgress> progress;
+					if (outer) {
+						progress.reset(new CpuProgress(outer->progress, workerId < 0 ? outer->cpuId : workerId,
+							str(boost::format("glide path %d/%d") % (i + 1) % t)));
+						progress->update(true);
+					}
+					GeometryHandles pathChildren = actualchildren;
+					pathChildren.insert(pathChildren.begin(), paths[i]);
+					// apply the glide
+					try
+					{
+						PRINTB("Glide: Performing Minkowski on path %d/%d", (i + 1) % t);
+						finishchildren[i].reset(CGALUtils::applyMinkowski(pathChildren));
+						PRINTB("Glide: Finished Minkowski on path %d/%d", (i + 1) % t);
+					}
+					catch (const std::exception &ex)
+					{
+						PRINTB("Glide: Caught an exception: %s", ex.what());
+					}
+				});
+			}
+			// rethrows a cancellation, the paths which haven't started are skipped
+			try {
+				group.wait();
+			}
+			catch (...) {
+				for (const auto &captured : output) captured.replay();
+				throw;
 			}
+			for (const auto &captured : output) captured.replay();
+			finishchildren.erase(std::remove(finishchildren.begin(), finishchildren.end(), nullptr), finishchildren.end());
 		}
 		else if (!actualchildren.empty())
 		{
@@ -153,7 +180,7 @@ public:
 
 		// union the result
 		PRINT("Glide: Unioning result");
-		return ResultObject(CGALUtils::applyOperator(finishchildren, OPENSCAD_UNION));
+		return ResultObject(CGALUtils::applyUnionBalanced(finishchildren));
 	}
 };
 
@@ -32,12 +32,17 @@
 #include "GeometryUtils.h"
 #include "progress.h"
 #include "feature.h"
+#include "WorkStealingPool.h"
+#include "cache.h"
+#include "MemoryBudget.h"
 
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 #include <vector>
 
 #include <atomic>
+#include <future>
 
 // MinGW defines sprintf to libintl_sprintf which breaks usage of the
 // Qt sprintf in QString. This is skipped if sprintf and _GL_STDIO_H
@@ -332,7 +337,7 @@ namespace CGALUtils {
 			auto chN = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(chgeom);
 			if (!chN) {
 				if (auto chps = dynamic_pointer_cast<const PolySet>(chgeom))
-					chN.reset(createNefPolyhedronFromGeometry(*chps));
+					chN = getNefPolyhedron(chps);
 			}
 
 			if (chN && !chN->isEmpty()) {
@@ -392,8 +397,8 @@ namespace CGALUtils {
 				shared_ptr<const CGAL_Nef_polyhedron> chN =
 					dynamic_pointer_cast<const CGAL_Nef_polyhedron>(chgeom);
 				if (!chN) {
-					const PolySet *chps = dynamic_cast<const PolySet*>(chgeom.get());
-					if (chps) chN.reset(createNefPolyhedronFromGeometry(*chps));
+					auto chps = dynamic_pointer_cast<const PolySet>(chgeom);
+					if (chps) chN = getNefPolyhedron(chps);
 				}
 				if (!chN) {
 					// ???
@@ -472,10 +477,8 @@ namespace CGALUtils {
 
 	void getPoints(const PolySet *ps, std::list<K::Point_3> &points)
 	{
-		for (const auto &p : ps->getPolygons()) {
-			for (const auto &v : p) {
-				points.push_back(K::Point_3(v[0], v[1], v[2]));
-			}
+		for (const auto &v : ps->getVertices()) {
+			points.push_back(K::Point_3(v[0], v[1], v[2]));
 		}
 	}
 
@@ -536,216 +539,503 @@ namespace CGALUtils {
 	};
 
 
+	typedef std::vector<CGAL::Epick::Point_3> ConvexPart;
+
 	/*!
-		children cannot contain NULL objects
+		The convex parts of a Minkowski operand, as the vertices of each part.
+		The parts of a skeleton of edges and vertices, like the paths of
+		glide, are its edges and isolated vertices.
 	*/
-	Geometry const * applyMinkowski(const GeometryHandles &children)
+	struct ConvexDecomposition
 	{
-		CGALUtils::ErrorLocker errorLocker;
-		AutoStartTimer t_tot;
-		assert(children.size() >= 2);
-		try {
-			shared_ptr<const Geometry> op0 = children[0];
-			for (size_t i = 1; i < children.size(); ++i)
-			{
-				shared_ptr<const Geometry> op1 = children[i];
-				op0 = shared_ptr<const Geometry>(applyMinkowski(op0.get(), op1.get()));
-			}
-			return op0->copy();
+		std::vector<ConvexPart> parts;
+		bool solid;
+
+		ConvexDecomposition() : solid(true) { }
+
+		size_t memsize() const {
+			size_t bytes = sizeof(*this) + parts.capacity() * sizeof(ConvexPart);
+			for (const auto &part : parts) bytes += part.capacity() * sizeof(CGAL::Epick::Point_3);
+			return bytes;
 		}
-		catch (...) {
-			// If anything throws we simply fall back to Nef Minkowski
-			PRINTD("Minkowski: Falling back to Nef Minkowski");
+	};
 
-			CGAL_Nef_polyhedron *N = applyOperator(children, OPENSCAD_MINKOWSKI);
-			return N;
+	ConvexPart convexPart(const CGAL_Polyhedron &poly)
+	{
+		ConvexPart points;
+		points.reserve(poly.size_of_vertices());
+		for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
+			CGAL_Polyhedron::Point_3 const& p = pi->point();
+			points.push_back(CGAL::Epick::Point_3(to_double(p[0]), to_double(p[1]), to_double(p[2])));
 		}
+		return points;
 	}
 
-	Geometry const* applyMinkowski(const Geometry *a, const Geometry *b)
+	CGAL::Epick::Point_3 hullPoint(const CGAL_Nef_polyhedron3::Point_3 &p)
 	{
-		CGALUtils::ErrorLocker errorLocker;
-		AutoStartTimer t_tot;
-		const Geometry *operands[2] = { a, b };
-		try {
-			typedef CGAL::Epick Hull_kernel;
+		return CGAL::Epick::Point_3(to_double(p.x()), to_double(p.y()), to_double(p.z()));
+	}
 
-			// a and b decomposed into lists of convex polyhedrons
-			std::list<CGAL_Polyhedron> P[2];
-			for (size_t i = 0; i < 2; i++) {
-				AutoStartTimer t;
+	/*!
+		Decomposes a Minkowski operand into convex parts. Throws if it can't,
+		which makes the callers fall back to the Nef Minkowski.
+	*/
+	ConvexDecomposition *createConvexDecomposition(const Geometry *operand)
+	{
+		AutoStartTimer t;
+		std::unique_ptr<ConvexDecomposition> result(new ConvexDecomposition);
+
+		const PolySet * ps = dynamic_cast<const PolySet *>(operand);
+		const CGAL_Nef_polyhedron * nef = dynamic_cast<const CGAL_Nef_polyhedron *>(operand);
+
+		if (nef && !nef->isEmpty() && (*nef)->number_of_halffacets() == 0) {
+			result->solid = false;
+			CGAL_Nef_polyhedron3::Halfedge_const_iterator e;
+			CGAL_forall_halfedges(e, **nef) {
+				// each edge is a pair of twin halfedges
+				if (&*e < &*e->twin())
+					result->parts.push_back({ hullPoint(e->source()->point()), hullPoint(e->twin()->source()->point()) });
+			}
+			CGAL_Nef_polyhedron3::Vertex_const_iterator v;
+			CGAL_forall_vertices(v, **nef) {
+				if (v->svertices_begin() == v->svertices_end())
+					result->parts.push_back({ hullPoint(v->point()) });
+			}
+			PRINTDB("Minkowski: skeleton of %d parts", result->parts.size());
+			return result.release();
+		}
+
+		CGAL_Polyhedron poly;
+		if (ps) 
+			CGALUtils::createPolyhedronFromPolySet(*ps, poly);
+		else if (nef && (*nef)->is_simple()) 
+			nefworkaround::convert_to_Polyhedron<CGAL_Kernel3>(**nef, poly);
+		else
+			throw 0;
+
+		if ((ps && ps->is_convex()) || (!ps && is_weakly_convex(poly))) {
+			PRINTDB("Minkowski: operand is convex %s", (ps ? "PolySet" : "Nef"));
+			result->parts.push_back(convexPart(poly));
+		}
+		else {
+			CGAL_Nef_polyhedron3 decomposed_nef;
+
+			if (ps) {
+				PRINTD("Minkowski: operand is nonconvex PolySet, converting to Nef and decomposing...");
+				auto p = getNefPolyhedron(*ps);
+				if (!p) throw 0;
+				if (!p->isEmpty())
+					decomposed_nef = **p;
+			}
+			else {
+				PRINTD("Minkowski: operand is nonconvex Nef, decomposing...");
+				decomposed_nef = **nef;
+			}
+
+			CGAL::convex_decomposition_3(decomposed_nef);
 
-				CGAL_Polyhedron poly;
+			// the first volume is the outer volume, which ignored in the decomposition
+			CGAL_Nef_polyhedron3::Volume_const_iterator ci = ++decomposed_nef.volumes_begin();
+			for (; ci != decomposed_nef.volumes_end(); ++ci) {
+				if (ci->mark()) {
+					CGAL_Polyhedron poly;
+					decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
+					result->parts.push_back(convexPart(poly));
+				}
+			}
 
-				const PolySet * ps = dynamic_cast<const PolySet *>(operands[i]);
 
-				const CGAL_Nef_polyhedron * nef = dynamic_cast<const CGAL_Nef_polyhedron *>(operands[i]);
+			PRINTDB("Minkowski: decomposed into %d convex parts", result->parts.size());
+			PRINTDB("Minkowski: decomposition took %f s", t.time());
+		}
+		return result.release();
+	}
+
+	/*!
+		Keeps the convex decompositions of recent Minkowski operands, so
+		glide decomposes its children once for all paths, and re-renders
+		reuse them as long as the operand geometry is cached.
+
+		Entries are keyed by the operand's address and hold a weak pointer
+		to it, an entry whose operand is gone is stale and dropped on the
+		next lookup. An entry is added when its decomposition starts, so
+		threads asking for the same operand meanwhile wait for it instead of
+		decomposing it again.
+
+		The decompositions count against the MemoryBudget, which evicts them
+		like the geometry caches.
+	*/
+	class ConvexDecompositionCache : public MemoryBudget::Evictable
+	{
+	public:
+		typedef std::shared_future<shared_ptr<const ConvexDecomposition>> future_type;
 
-				if (ps) 
-					CGALUtils::createPolyhedronFromPolySet(*ps, poly);
-				else if (nef && (*nef)->is_simple()) 
-					nefworkaround::convert_to_Polyhedron<CGAL_Kernel3>(**nef, poly);
-				else
-					throw 0;
+		// glide paths ask for it from several threads at once
+		static ConvexDecompositionCache *instance() { static ConvexDecompositionCache inst; return &inst; }
 
-				if ((ps && ps->is_convex()) || (!ps && is_weakly_convex(poly))) {
-					PRINTDB("Minkowski: child %d is convex %s", i % (ps ? "PolySet" : "Nef"));
-					P[i].push_back(poly);
+		shared_ptr<const ConvexDecomposition> get(const shared_ptr<const Geometry> &geom) {
+			std::promise<shared_ptr<const ConvexDecomposition>> promise;
+			{
+				boost::mutex::scoped_lock lock(mutex);
+				dropStale();
+				auto entry = cache[geom.get()];
+				if (entry) {
+					PRINTD("Minkowski: reusing the convex decomposition of an operand");
+					future_type future = entry->decomposition;
+					account();
+					lock.unlock();
+					return future.get();
 				}
-				else {
-					CGAL_Nef_polyhedron3 decomposed_nef;
-
-					if (ps) {
-						PRINTDB("Minkowski: child %d is nonconvex PolySet, converting to Nef and decomposing...", i);
-						CGAL_Nef_polyhedron *p = createNefPolyhedronFromGeometry(*ps);
-						if (!p->isEmpty())
-							decomposed_nef = **p;
-						delete p;
-					}
-					else {
-						PRINTDB("Minkowski: child %d is nonconvex Nef, decomposing...", i);
-						decomposed_nef = **nef;
-					}
+				// a new entry, the cost is set once the decomposition is known
+				cache.insert(geom.get(), new cache_entry(geom, promise.get_future().share()), 0);
+				account();
+			}
+			try {
+				shared_ptr<const ConvexDecomposition> decomposition(createConvexDecomposition(geom.get()));
+				promise.set_value(decomposition);
+				uint64_t tick = CacheClock::now();
+				{
+					boost::mutex::scoped_lock lock(mutex);
+					auto entry = cache[geom.get()];
+					if (entry && entry->geom.lock() == geom)
+						cache.insert(geom.get(), new cache_entry(*entry), decomposition->memsize());
+					account();
+				}
+				// evicts through evictOldest(), which takes the lock
+				MemoryBudget::instance()->enforce(tick);
+				return decomposition;
+			}
+			catch (...) {
+				promise.set_exception(std::current_exception());
+				boost::mutex::scoped_lock lock(mutex);
+				auto entry = cache[geom.get()];
+				if (entry && entry->geom.lock() == geom) cache.remove(geom.get());
+				account();
+				throw;
+			}
+		}
 
-					CGAL::convex_decomposition_3(decomposed_nef);
+		// called by the MemoryBudget while it holds its own lock, so this
+		// doesn't take ours
+		uint64_t oldestUse() const { return oldest; }
 
-					// the first volume is the outer volume, which ignored in the decomposition
-					CGAL_Nef_polyhedron3::Volume_const_iterator ci = ++decomposed_nef.volumes_begin();
-					for (; ci != decomposed_nef.volumes_end(); ++ci) {
-						if (ci->mark()) {
-							CGAL_Polyhedron poly;
-							decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-							P[i].push_back(poly);
-						}
-					}
+		void evictOldest() {
+			boost::mutex::scoped_lock lock(mutex);
+			cache.evictOldest();
+			account();
+		}
+
+	private:
+		ConvexDecompositionCache() : cache(100 * 1024 * 1024), charged(0), oldest(UINT64_MAX) {
+			MemoryBudget::instance()->registerCache(this);
+		}
+
+		struct cache_entry {
+			std::weak_ptr<const Geometry> geom;
+			future_type decomposition;
+			cache_entry(const shared_ptr<const Geometry> &geom, const future_type &decomposition)
+				: geom(geom), decomposition(decomposition) { }
+		};
+
+		// drops the entries whose operand is gone, called with the lock held
+		void dropStale() {
+			cache.removeIf([](const Geometry *, const cache_entry &entry) { return entry.geom.expired(); });
+		}
 
+		// passes changes of the cached bytes and the LRU order on to the
+		// MemoryBudget, called with the lock held
+		void account() {
+			int64_t delta = int64_t(cache.totalCost()) - int64_t(charged);
+			if (delta) MemoryBudget::instance()->charge(delta);
+			charged = cache.totalCost();
+			oldest = cache.oldestUse();
+		}
+
+		boost::mutex mutex;
+		Cache<const Geometry *, cache_entry> cache;
+		size_t charged;
+		std::atomic<uint64_t> oldest;
+	};
+
+	shared_ptr<const ConvexDecomposition> decompose(const shared_ptr<const Geometry> &geom)
+	{
+		return ConvexDecompositionCache::instance()->get(geom);
+	}
+
+	typedef CGAL::Polyhedron_3<CGAL::Epick> Hull_polyhedron;
 
-					PRINTDB("Minkowski: decomposed into %d convex parts", P[i].size());
-					PRINTDB("Minkowski: decomposition took %f s", t.time());
+	/*!
+		Computes the Minkowski sum of two convex parts, given by their vertices,
+		as the hull of the pairwise sums of the vertices. Returns false if the
+		sum is degenerate.
+	*/
+	bool convexPairSum(const ConvexPart &a, const ConvexPart &b, Hull_polyhedron &result)
+	{
+		typedef CGAL::Epick Hull_kernel;
+		std::vector<Hull_kernel::Point_3> minkowski_points;
+		{
+			AutoStartTimer t;
+			minkowski_points.reserve(a.size() * b.size());
+			for (size_t i = 0; i < a.size(); i++) {
+				for (size_t j = 0; j < b.size(); j++) {
+					minkowski_points.push_back(a[i] + (b[j] - CGAL::ORIGIN));
 				}
 			}
 
-			// sums of convex parts
-			std::list<CGAL::Polyhedron_3<Hull_kernel>> result_parts;
-			for (size_t i = 0; i < P[0].size(); i++) {
-				for (size_t j = 0; j < P[1].size(); j++) {
-					std::vector<Hull_kernel::Point_3> minkowski_points;
-					{
-						AutoStartTimer t;
-						std::vector<Hull_kernel::Point_3> points[2];
+			if (minkowski_points.size() <= 3) {
+				return false;
+			}
 
-						for (int k = 0; k < 2; k++) {
-							std::list<CGAL_Polyhedron>::iterator it = P[k].begin();
-							std::advance(it, k == 0 ? i : j);
+			PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms", a.size() % b.size() % minkowski_points.size() % (t.time() * 1000));
+		}
 
-							CGAL_Polyhedron const& poly = *it;
-							points[k].reserve(poly.size_of_vertices());
+		AutoStartTimer t;
+		CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
 
-							for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
-								CGAL_Polyhedron::Point_3 const& p = pi->point();
-								points[k].push_back(Hull_kernel::Point_3(to_double(p[0]), to_double(p[1]), to_double(p[2])));
-							}
-						}
+		std::vector<Hull_kernel::Point_3> strict_points;
+		strict_points.reserve(minkowski_points.size());
 
-						minkowski_points.clear();
-						minkowski_points.reserve(points[0].size() * points[1].size());
-						for (size_t i = 0; i < points[0].size(); i++) {
-							for (size_t j = 0; j < points[1].size(); j++) {
-								minkowski_points.push_back(points[0][i] + (points[1][j] - CGAL::ORIGIN));
-							}
-						}
+		for (Hull_polyhedron::Vertex_iterator i = result.vertices_begin(); i != result.vertices_end(); ++i) {
+			Hull_kernel::Point_3 const& p = i->point();
 
-						if (minkowski_points.size() <= 3) {
-							continue;
-						}
+			Hull_polyhedron::Vertex::Halfedge_handle h, e;
+			h = i->halfedge();
+			e = h;
+			bool collinear = false;
+			bool coplanar = true;
 
-						PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms", points[0].size() % points[1].size() % minkowski_points.size() % (t.time() * 1000));
+			do {
+				Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
+				if (coplanar && !CGAL::coplanar(p, q,
+					h->next_on_vertex()->opposite()->vertex()->point(),
+					h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
+					coplanar = false;
+				}
+
+
+				for (Hull_polyhedron::Vertex::Halfedge_handle j = h->next_on_vertex();
+					j != h && !collinear && !coplanar;
+					j = j->next_on_vertex()) {
+
+					Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
+					if (CGAL::collinear(p, q, r)) {
+						collinear = true;
 					}
+				}
 
-					{
-						AutoStartTimer t;
-						CGAL::Polyhedron_3<Hull_kernel> result;
-						CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
+				h = h->next_on_vertex();
+			} while (h != e && !collinear);
 
-						std::vector<Hull_kernel::Point_3> strict_points;
-						strict_points.reserve(minkowski_points.size());
+			if (!collinear && !coplanar)
+				strict_points.push_back(p);
+		}
 
-						for (CGAL::Polyhedron_3<Hull_kernel>::Vertex_iterator i = result.vertices_begin(); i != result.vertices_end(); ++i) {
-							Hull_kernel::Point_3 const& p = i->point();
+		result.clear();
+		CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
 
-							CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle h, e;
-							h = i->halfedge();
-							e = h;
-							bool collinear = false;
-							bool coplanar = true;
+		PRINTDB("Minkowski: Computing convex hull took %f s", t.time());
+		return true;
+	}
 
-							do {
-								Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
-								if (coplanar && !CGAL::coplanar(p, q,
-									h->next_on_vertex()->opposite()->vertex()->point(),
-									h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
-									coplanar = false;
-								}
+	/*!
+		Throws ProgressCancelException if the render was canceled. Tasks on the
+		worker pool don't have the CpuProgress of the thread which queued them,
+		so they check the Progress it belongs to.
+	*/
+	void throwIfCanceled(Progress *progress)
+	{
+		if (progress) progress->throwIfCancelled();
+	}
 
+	Progress *currentProgress()
+	{
+		auto progress = CpuProgress::getCurrent();
+		return progress ? progress->progress : nullptr;
+	}
 
-								for (CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle j = h->next_on_vertex();
-									j != h && !collinear && !coplanar;
-									j = j->next_on_vertex()) {
+	/*!
+		Runs the task on the worker pool if threaded unions are enabled, else
+		right away. Its output is captured, to be replayed in order on the
+		calling thread after the group is waited on.
+	*/
+	void runTask(WorkStealingPool::TaskGroup &group, PrintCapture &output, const std::function<void()> &task)
+	{
+		auto captured = [&output, task]() {
+			PrintCapture::Scope capture(output);
+			task();
+		};
+		if (Feature::ExperimentalThreadedUnion.is_enabled())
+			group.run(captured);
+		else
+			captured();
+	}
 
-									Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
-									if (CGAL::collinear(p, q, r)) {
-										collinear = true;
-									}
-								}
+	void replay(const std::vector<PrintCapture> &output)
+	{
+		for (const auto &captured : output)
+			captured.replay();
+	}
 
-								h = h->next_on_vertex();
-							} while (h != e && !collinear);
+	/*!
+		Applies UNION to all children as a balanced tree. With thread-union,
+		the conversions to Nef polyhedra and the unions of each level run in
+		parallel on the worker pool.
+	*/
+	CGAL_Nef_polyhedron *applyUnionBalanced(const GeometryHandles &children)
+	{
+		Progress *progress = currentProgress();
+		std::vector<shared_ptr<const CGAL_Nef_polyhedron>> level(children.size());
+		{
+			std::vector<PrintCapture> output(children.size());
+			WorkStealingPool::TaskGroup group;
+			for (size_t i = 0; i < children.size(); i++) {
+				runTask(group, output[i], [&children, &level, progress, i]() {
+					throwIfCanceled(progress);
+					const shared_ptr<const Geometry> &chgeom = children[i];
+					auto chN = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(chgeom);
+					if (!chN) {
+						if (auto chps = dynamic_pointer_cast<const PolySet>(chgeom))
+							chN = getNefPolyhedron(chps);
+					}
+					if (chN && !chN->isEmpty()) level[i] = chN;
+				});
+			}
+			group.wait();
+			replay(output);
+		}
+		level.erase(std::remove(level.begin(), level.end(), nullptr), level.end());
+		if (level.empty()) return new CGAL_Nef_polyhedron();
 
-							if (!collinear && !coplanar)
-								strict_points.push_back(p);
-						}
+		CGALUtils::ErrorLocker errorLocker;
+		try {
+			while (level.size() > 1) {
+				std::vector<shared_ptr<const CGAL_Nef_polyhedron>> next((level.size() + 1) / 2);
+				std::vector<PrintCapture> output(level.size() / 2);
+				WorkStealingPool::TaskGroup group;
+				for (size_t i = 0; i < level.size() / 2; i++) {
+					runTask(group, output[i], [&level, &next, progress, i]() {
+						throwIfCanceled(progress);
+						next[i].reset(*level[2 * i] + *level[2 * i + 1]);
+					});
+				}
+				// an odd part moves up a level
+				if (level.size() & 1) next.back() = level.back();
+				group.wait();
+				replay(output);
+				level.swap(next);
+				if (auto progress = CpuProgress::getCurrent())
+					progress->tick();
+			}
+		}
+		catch (const CGAL::Failure_exception &e) {
+			PRINTB("ERROR: CGAL error in CGALUtils::applyUnionBalanced: %s", e.what());
+			return nullptr;
+		}
+		return new CGAL_Nef_polyhedron(*level.front());
+	}
 
-						result.clear();
-						CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
-						result_parts.push_back(result);
+	/*!
+		children cannot contain NULL objects
+	*/
+	Geometry const * applyMinkowski(const GeometryHandles &children)
+	{
+		CGALUtils::ErrorLocker errorLocker;
+		AutoStartTimer t_tot;
+		assert(children.size() >= 2);
+		try {
+			shared_ptr<const Geometry> op0 = children[0];
+			for (size_t i = 1; i < children.size(); ++i)
+			{
+				shared_ptr<const Geometry> op1 = children[i];
+				op0 = shared_ptr<const Geometry>(applyMinkowski(op0, op1));
+			}
+			return op0->copy();
+		}
+		catch (const ProgressCancelException &) {
+			throw;
+		}
+		catch (...) {
+			// If anything throws we simply fall back to Nef Minkowski
+			PRINTD("Minkowski: Falling back to Nef Minkowski");
+
+			CGAL_Nef_polyhedron *N = applyOperator(children, OPENSCAD_MINKOWSKI);
+			return N;
+		}
+	}
 
-						PRINTDB("Minkowski: Computing convex hull took %f s", t.time());
+	Geometry const* applyMinkowski(const shared_ptr<const Geometry> &a, const shared_ptr<const Geometry> &b)
+	{
+		CGALUtils::ErrorLocker errorLocker;
+		AutoStartTimer t_tot;
+		shared_ptr<const Geometry> operands[2] = { a, b };
+		const Geometry *result = nullptr;
+		try {
+			// a and b decomposed into convex parts
+			shared_ptr<const ConvexDecomposition> P[2];
+			for (size_t i = 0; i < 2; i++) {
+				P[i] = decompose(operands[i]);
+				PRINTDB("Minkowski: child %d has %d convex parts", i % P[i]->parts.size());
+			}
+			// the sum of two skeletons has no volume
+			if (!P[0]->solid && !P[1]->solid) throw 0;
+			const std::vector<ConvexPart> *points[2] = { &P[0]->parts, &P[1]->parts };
+
+			// sums of convex parts; each pair is independent and, with
+			// thread-union, runs on the worker pool
+			size_t pairs = points[0]->size() * points[1]->size();
+			GeometryHandles result_parts(pairs);
+			{
+				AutoStartTimer t;
+				Progress *progress = currentProgress();
+				std::vector<PrintCapture> output(pairs);
+				WorkStealingPool::TaskGroup group;
+				for (size_t i = 0; i < points[0]->size(); i++) {
+					for (size_t j = 0; j < points[1]->size(); j++) {
+						size_t index = i * points[1]->size() + j;
+						runTask(group, output[index], [&points, &result_parts, progress, i, j, index]() {
+							throwIfCanceled(progress);
+							Hull_polyhedron hull;
+							if (convexPairSum((*points[0])[i], (*points[1])[j], hull)) {
+								PolySet *ps = new PolySet(3, true);
+								createPolySetFromPolyhedron(hull, *ps);
+								result_parts[index].reset(ps);
+							}
+						});
 					}
 				}
+				group.wait();
+				replay(output);
+				PRINTDB("Minkowski: %d convex pair sums took %f s", pairs % t.time());
 			}
+			result_parts.erase(std::remove(result_parts.begin(), result_parts.end(), nullptr), result_parts.end());
 
 			if (result_parts.size() == 1) {
-				PolySet *ps = new PolySet(3, true);
-				createPolySetFromPolyhedron(*result_parts.begin(), *ps);
-				operands[0] = ps;
+				result = result_parts.front()->copy();
 			}
 			else if (!result_parts.empty()) {
 				AutoStartTimer t;
 				PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
-				GeometryHandles fake_children;
-				for (std::list<CGAL::Polyhedron_3<Hull_kernel>>::iterator i = result_parts.begin(); i != result_parts.end(); ++i) {
-					PolySet ps(3, true);
-					createPolySetFromPolyhedron(*i, ps);
-					fake_children.push_back(GeometryHandle(createNefPolyhedronFromGeometry(ps)));
-				}
-				CGAL_Nef_polyhedron *N = CGALUtils::applyOperator(fake_children, OPENSCAD_UNION);
+				CGAL_Nef_polyhedron *N = applyUnionBalanced(result_parts);
 				// FIXME: This hould really never throw.
 				// Assert once we figured out what went wrong with issue #1069?
 				if (!N) throw 0;
 				PRINTDB("Minkowski: Union done: %f s", t.time());
-				operands[0] = N;
+				result = N;
 			}
 			else {
-				operands[0] = new CGAL_Nef_polyhedron();
+				result = new CGAL_Nef_polyhedron();
 			}
 
 			PRINTDB("Minkowski: Total execution time %f s", t_tot.time());
-			return operands[0];
+			return result;
+		}
+		catch (const ProgressCancelException &) {
+			throw;
 		}
 		catch (...) {
 			// If anything throws we simply fall back to Nef Minkowski
 			PRINTD("Minkowski: Falling back to Nef Minkowski");
-			GeometryHandles geom = { GeometryHandle(a->copy()), GeometryHandle(b->copy()) };
+			GeometryHandles geom = { a, b };
 			CGAL_Nef_polyhedron *N = applyOperator(geom, OPENSCAD_MINKOWSKI);
 			return N;
 		}
@@ -11,6 +11,7 @@
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 
 #include <boost/range/adaptor/reversed.hpp>
+#include <unordered_map>
 
 #undef GEN_SURFACE_DEBUG
 namespace /* anonymous */ {
@@ -49,16 +50,22 @@ namespace /* anonymous */ {
 			std::vector<CGALPoint> vertices;
 			std::vector<std::vector<size_t>> indices;
 
-			// Align all vertices to grid and build vertex array in vertices
+			// Align all used vertices to grid and build vertex array in vertices.
+			// Shared vertices are aligned once, on first use.
+			std::vector<int> aligned(ps.getVertices().size(), -1);
+			indices.reserve(ps.numPolygons());
 			for (const auto &p : ps.getPolygons()) {
 				indices.push_back(std::vector<size_t>());
 				indices.back().reserve(p.size());
-				for (auto v : boost::adaptors::reverse(p)) {
-					// align v to the grid; the CGALPoint will receive the aligned vertex
-					size_t idx = grid.align(v);
-					if (idx == vertices.size()) {
-						CGALPoint p(v[0], v[1], v[2]);
-						vertices.push_back(p);
+				for (size_t i = p.size(); i-- > 0; ) {
+					int &idx = aligned[p.index(i)];
+					if (idx < 0) {
+						// align v to the grid; the CGALPoint will receive the aligned vertex
+						Vector3d v = p[i];
+						idx = grid.align(v);
+						if (size_t(idx) == vertices.size()) {
+							vertices.push_back(CGALPoint(v[0], v[1], v[2]));
+						}
 					}
 					indices.back().push_back(idx);
 				}
@@ -122,12 +129,12 @@ namespace /* anonymous */ {
 				std::vector<size_t> indices(3);
 
 				// Estimating same # of vertices as polygons (very rough)
-				B.begin_surface(ps.polygons.size(), ps.polygons.size());
+				B.begin_surface(ps.numPolygons(), ps.numPolygons());
 				int pidx = 0;
 #ifdef GEN_SURFACE_DEBUG
 				printf("polyhedron(faces=[");
 #endif
-				for(const auto &p : ps.polygons) {
+				for(const auto &p : ps.getPolygons()) {
 #ifdef GEN_SURFACE_DEBUG
 					if (pidx++ > 0) printf(",");
 #endif
@@ -281,18 +288,28 @@ namespace CGALUtils {
 		typedef typename Polyhedron::Vertex_const_iterator                  VCI;
 		typedef typename Polyhedron::Facet_const_iterator                   FCI;
 		typedef typename Polyhedron::Halfedge_around_facet_const_circulator HFCC;
-		
+
+		// add each polyhedron vertex once and reference it from its facets
+		std::unordered_map<const Vertex *, int> vertexIndices;
+		ps.reserve_vertices(ps.getVertices().size() + p.size_of_vertices());
+		for (VCI vi = p.vertices_begin(); vi != p.vertices_end(); ++vi) {
+			double x = CGAL::to_double(vi->point().x());
+			double y = CGAL::to_double(vi->point().y());
+			double z = CGAL::to_double(vi->point().z());
+			vertexIndices[&*vi] = ps.add_vertex(Vector3d(x, y, z));
+		}
+
+		ps.reserve(ps.numPolygons() + p.size_of_facets());
+		IndexedFace face;
 		for (FCI fi = p.facets_begin(); fi != p.facets_end(); ++fi) {
 			HFCC hc = fi->facet_begin();
 			HFCC hc_end = hc;
-			ps.append_poly();
+			face.clear();
 			do {
 				Vertex const& v = *((hc++)->vertex());
-				double x = CGAL::to_double(v.point().x());
-				double y = CGAL::to_double(v.point().y());
-				double z = CGAL::to_double(v.point().z());
-				ps.append_vertex(x, y, z);
+				face.push_back(vertexIndices[&v]);
 			} while (hc != hc_end);
+			ps.append_face(face);
 		}
 		return err;
 	}
@@ -31,6 +31,7 @@
 #include "Reindexer.h"
 #include "hash.h"
 #include "GeometryUtils.h"
+#include "Profiler.h"
 
 #include <map>
 #include <queue>
@@ -52,10 +53,8 @@ static CGAL_Nef_polyhedron *createNefPolyhedronFromPolySet(const PolySet &ps)
 		// NB! CGAL's convex_hull_3() doesn't like std::set iterators, so we use a list
 		// instead.
 		std::list<K::Point_3> points;
-		for(const auto &poly : psq.getPolygons()) {
-			for(const auto &p : poly) {
-				points.push_back(vector_convert<K::Point_3>(p));
-			}
+		for(const auto &p : psq.getVertices()) {
+			points.push_back(vector_convert<K::Point_3>(p));
 		}
 
 		if (points.size() <= 3) return new CGAL_Nef_polyhedron();;
@@ -179,7 +178,7 @@ namespace CGALUtils {
 		typedef std::map<Edge, int, VecPairCompare> Edge_to_facet_map;
 		Edge_to_facet_map edge_to_facet_map;
 
-		auto &psp = ps.getPolygons();
+		auto psp = ps.getPolygons();
 
 		std::vector<Plane> facet_planes; facet_planes.reserve(psp.size());
 
@@ -257,17 +256,20 @@ namespace CGALUtils {
 
 	CGAL_Nef_polyhedron *createNefPolyhedronFromGeometry(const Geometry &geom)
 	{
+		Profiler::Span span("cgal conversion", "to Nef");
+		CGAL_Nef_polyhedron *N = NULL;
 		const PolySet *ps = dynamic_cast<const PolySet*>(&geom);
 		if (ps) {
 			PRINT("Creating NEF polyhedron from PolySet");
-			return createNefPolyhedronFromPolySet(*ps);
+			N = createNefPolyhedronFromPolySet(*ps);
 		}
 		else {
 			const Polygon2d *poly2d = dynamic_cast<const Polygon2d*>(&geom);
-			if (poly2d) return createNefPolyhedronFromPolygon2d(*poly2d);
+			if (poly2d) N = createNefPolyhedronFromPolygon2d(*poly2d);
+			else assert(false && "createNefPolyhedronFromGeometry(): Unsupported geometry type");
 		}
-		assert(false && "createNefPolyhedronFromGeometry(): Unsupported geometry type");
-		return NULL;
+		if (N && Profiler::enabled()) span.setGeometryBytes(N->memsize());
+		return N;
 	}
 
 /*
@@ -392,11 +394,15 @@ namespace CGALUtils {
 			PRINTB("Error: Non-manifold triangle mesh created: %d unconnected edges", unconnected2);
 		}
 
+		// 5. Create PolySet, sharing the vertices between triangles
+		int offset = int(ps.getVertices().size());
+		ps.reserve_vertices(offset + allVertices.size());
+		ps.reserve(ps.numPolygons() + allTriangles.size(), ps.getIndices().size() + 3 * allTriangles.size());
+		for (size_t i = 0; i < allVertices.size(); i++) {
+			ps.add_vertex(verts[i].cast<double>());
+		}
 		for(const auto &t : allTriangles) {
-			ps.append_poly();
-			ps.append_vertex(verts[t[0]]);
-			ps.append_vertex(verts[t[1]]);
-			ps.append_vertex(verts[t[2]]);
+			ps.append_face(offset + t[0], offset + t[1], offset + t[2]);
 		}
 
 #if 0 // For debugging
@@ -709,14 +715,45 @@ namespace CGALUtils {
 
 	PolySet *createPolySetFromNefPolyhedron(const CGAL_Nef_polyhedron &N)
 	{
+		Profiler::Span span("cgal conversion", "to PolySet");
 		PolySet *result = new PolySet(3);
 		bool err = createPolySetFromNefPolyhedron3(*N, *result);
-		if (!err)
+		if (!err) {
+			if (Profiler::enabled()) span.setGeometryBytes(result->memsize());
 			return result;
+		}
 		delete result;
 		return nullptr;
 	}
 
+	shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedron(const PolySet &ps)
+	{
+		return ps.nefConversion.get([&ps] { return createNefPolyhedronFromGeometry(ps); });
+	}
+
+	shared_ptr<const PolySet> getPolySet(const CGAL_Nef_polyhedron &N)
+	{
+		return N.polySetConversion.get([&N] { return createPolySetFromNefPolyhedron(N); });
+	}
+
+	shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedron(const shared_ptr<const PolySet> &ps)
+	{
+		return ps->nefConversion.get([&ps] {
+			CGAL_Nef_polyhedron *N = createNefPolyhedronFromGeometry(*ps);
+			if (N) N->polySetConversion.seed(ps);
+			return N;
+		});
+	}
+
+	shared_ptr<const PolySet> getPolySet(const shared_ptr<const CGAL_Nef_polyhedron> &N)
+	{
+		return N->polySetConversion.get([&N] {
+			PolySet *ps = createPolySetFromNefPolyhedron(*N);
+			if (ps) ps->nefConversion.seed(N);
+			return ps;
+		});
+	}
+
 }; // namespace CGALUtils
 
 #endif /* ENABLE_CGAL */
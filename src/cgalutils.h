@@ -26,6 +26,7 @@ namespace CGALUtils {
 
 	bool applyHull(const GeometryHandles &children, PolySet &P);
 	CGAL_Nef_polyhedron *applyOperator(const GeometryHandles &children, OpenSCADOperator op);
+	CGAL_Nef_polyhedron *applyUnionBalanced(const GeometryHandles &children);
 	//FIXME: Old, can be removed:
 	//void applyBinaryOperator(CGAL_Nef_polyhedron &target, const CGAL_Nef_polyhedron &src, OpenSCADOperator op);
 	Polygon2d *project(const CGAL_Nef_polyhedron &N, bool cut);
@@ -33,7 +34,7 @@ namespace CGALUtils {
 	CGAL_Iso_cuboid_3 boundingBox(const CGAL_Nef_polyhedron3 &N);
 	bool is_approximately_convex(const PolySet &ps);
 	Geometry const* applyMinkowski(const GeometryHandles &children);
-	Geometry const* applyMinkowski(const Geometry *a, const Geometry *b);
+	Geometry const* applyMinkowski(const shared_ptr<const Geometry> &a, const shared_ptr<const Geometry> &b);
 
 	template <typename Polyhedron> std::string printPolyhedron(const Polyhedron &p);
 	template <typename Polyhedron> bool createPolySetFromPolyhedron(const Polyhedron &p, PolySet &ps);
@@ -43,6 +44,12 @@ namespace CGALUtils {
 
 	CGAL_Nef_polyhedron *createNefPolyhedronFromGeometry(const class Geometry &geom);
 	PolySet *createPolySetFromNefPolyhedron(const CGAL_Nef_polyhedron &N);
+	// the conversions kept with their source, done once per source
+	shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedron(const PolySet &ps);
+	shared_ptr<const PolySet> getPolySet(const CGAL_Nef_polyhedron &N);
+	// as above, and the conversion converts back to its source
+	shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedron(const shared_ptr<const PolySet> &ps);
+	shared_ptr<const PolySet> getPolySet(const shared_ptr<const CGAL_Nef_polyhedron> &N);
 	//bool createPolySetFromNefPolyhedron3(const CGAL_Nef_polyhedron3 &N, PolySet &ps);
 
 	bool tessellatePolygon(const PolygonK &polygon,
@@ -33,16 +33,10 @@
 #include "ModuleInstantiation.h"
 #include "builtin.h"
 #include "printutils.h"
+#include <algorithm>
 #include <boost/filesystem.hpp>
 namespace fs = boost::filesystem;
 
-// $children is not a config_variable. config_variables have dynamic scope, 
-// meaning they are passed down the call chain implicitly.
-// $children is simply misnamed and shouldn't have included the '$'.
-static bool is_config_variable(const std::string &name) {
-	return name[0] == '$' && name != "$children";
-}
-
 /**
  * This is separated because PRINTB uses quite a lot of stack space
  * and the methods using it evaluate_function() and instantiate_module()
@@ -56,10 +50,16 @@ static void print_ignore_warning(const char *what, const char *name)
 	PRINTB("WARNING: Ignoring unknown %s '%s'.", what % name);
 }
 
+// the stack of the innermost detached context alive on this thread
+static thread_local Context::Stack *detached_stack = nullptr;
+
 /*!
 	Initializes this context. Optionally initializes a context for an 
 	external library. Note that if parent is null, a new stack will be
 	created, and all children will share the root parent's stack.
+	While a detached context is alive on this thread, children join its
+	stack instead, since e.g. user modules and children() are evaluated in
+	contexts which were created before it.
 */
 Context::Context(const Context *parent)
 	: parent(parent)
@@ -67,22 +67,78 @@ Context::Context(const Context *parent)
 	setType<Context>();
 	if (parent) {
 		assert(parent->ctx_stack && "Parent context stack was null!");
-		this->ctx_stack = parent->ctx_stack;
+		this->ctx_stack = detached_stack ? detached_stack : parent->ctx_stack;
 		this->document_path = parent->document_path;
 	}
 	else {
 		this->ctx_stack = new Stack;
 	}
 
-	this->ctx_stack->push_back(this);
+	this->depth = this->ctx_stack->contexts.size();
+	this->ctx_stack->contexts.push_back(this);
+}
+
+Context::Context(const Context *parent, Detach)
+	: parent(parent)
+{
+	setType<Context>();
+	assert(parent && parent->ctx_stack && "Parent context stack was null!");
+	this->document_path = parent->document_path;
+	const Stack *outer = detached_stack ? detached_stack : parent->ctx_stack;
+	this->ctx_stack = new Stack;
+	this->ctx_stack->outer = detached_stack;
+	detached_stack = this->ctx_stack;
+
+	// the outer config values are bound at this context's depth, so setting
+	// one here simply replaces it
+	this->ctx_stack->config.resize(outer->config.size());
+	for (size_t i = 0; i < outer->config.size(); ++i) {
+		if (!outer->config[i].empty())
+			this->ctx_stack->config[i].push_back(Stack::Bindings::value_type(0, outer->config[i].back().second));
+	}
+	this->ctx_stack->modules = outer->modules;
+
+	this->depth = 0;
+	this->ctx_stack->contexts.push_back(this);
 }
 
 Context::~Context()
 {
 	assert(this->ctx_stack && "Context stack is null at destruction!");
-	assert(this->ctx_stack->size() > 0 && "Context stack is empty at destruction!");
-	this->ctx_stack->pop_back();
-	if (!parent) delete this->ctx_stack;
+	assert(this->ctx_stack->contexts.size() > 0 && "Context stack is empty at destruction!");
+	for (const auto &v : this->config_variables) {
+		// contexts are destroyed in reverse order, so this is usually the last binding
+		auto &bindings = this->ctx_stack->config[Symbols::index(v.first)];
+		for (auto it = bindings.end(); it != bindings.begin();) {
+			if ((--it)->first == this->depth) {
+				bindings.erase(it);
+				break;
+			}
+		}
+	}
+	this->ctx_stack->contexts.pop_back();
+	// the root of a stack owns it
+	if (this->depth == 0) {
+		if (this->ctx_stack == detached_stack) detached_stack = this->ctx_stack->outer;
+		delete this->ctx_stack;
+	}
+}
+
+const ValuePtr *Context::ValueMap::find(SymbolId symbol) const
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), symbol,
+		[](const Entries::value_type &entry, SymbolId symbol) { return entry.first < symbol; });
+	if (it != entries.end() && it->first == symbol) return &it->second;
+	return nullptr;
+}
+
+ValuePtr &Context::ValueMap::operator[](SymbolId symbol)
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), symbol,
+		[](const Entries::value_type &entry, SymbolId symbol) { return entry.first < symbol; });
+	if (it == entries.end() || it->first != symbol)
+		it = entries.insert(it, Entries::value_type(symbol, ValuePtr::undefined));
+	return it->second;
 }
 
 /*!
@@ -92,7 +148,7 @@ void Context::setVariables(const AssignmentList &args, const EvalArguments *eval
 {
 	// evaluate any default values in the parent context
 	for (const auto &arg : args)
-		set_variable(arg.name, arg.expr ? arg.expr->evaluate(this->parent) : ValuePtr::undefined);
+		set_variable(arg.symbol, arg.expr ? arg.expr->evaluate(this->parent) : ValuePtr::undefined);
 
 	if (evalargs) {
 		// resolve named/unnamed incoming expressions to the default names
@@ -104,23 +160,39 @@ void Context::setVariables(const AssignmentList &args, const EvalArguments *eval
 	}
 }
 
-void Context::set_variable(const std::string &name, const ValuePtr &value, bool persistent /*= true*/)
+void Context::set_variable(SymbolId symbol, const ValuePtr &value, bool persistent /*= true*/)
 {
-	if (is_config_variable(name)) {
+	if (Symbols::isConfig(symbol)) {
 		// don't undef config variables
-		if (value->isDefined())
-			config_variables[name] = value;
+		if (value->isDefined()) {
+			config_variables[symbol] = value;
+			if (this->ctx_stack) {
+				// bindings are ordered by depth; new ones usually belong to the innermost context
+				auto &config = this->ctx_stack->config;
+				if (config.size() <= Symbols::index(symbol)) config.resize(Symbols::index(symbol) + 1);
+				auto &bindings = config[Symbols::index(symbol)];
+				auto it = bindings.end();
+				while (it != bindings.begin() && (it - 1)->first >= this->depth) --it;
+				if (it != bindings.end() && it->first == this->depth) it->second = value;
+				else bindings.insert(it, Stack::Bindings::value_type(this->depth, value));
+			}
+		}
 	}
 	else {
 		// allow regular variables to be undef so lookup_variable doesn't warn about optional arguments
-		variables[name] = value;
+		variables[symbol] = value;
 	}
 	if (persistent) {
 		// store for persistence
-		persist_variables[name] = value;
+		persist_variables[symbol] = value;
 	}
 }
 
+void Context::set_variable(const std::string &name, const ValuePtr &value, bool persistent /*= true*/)
+{
+	set_variable(Symbols::intern(name), value, persistent);
+}
+
 void Context::set_variable(const std::string &name, const Value &value, bool persistent /*= true*/)
 {
 	set_variable(name, ValuePtr(value), persistent);
@@ -138,37 +210,45 @@ ValuePtr Context::lookup(const std::string &name, bool silent) const
 	return lookup_variable(name, silent);
 }
 
-ValuePtr Context::lookup_variable(const std::string &name, bool silent) const
+ValuePtr Context::lookup_variable(SymbolId symbol, bool silent) const
 {
 	if (!this->ctx_stack) {
 		PRINT("ERROR: Context had null stack in lookup_variable()!!");
 		return ValuePtr::undefined;
 	}
-	if (is_config_variable(name)) {
-		for (int i = this->ctx_stack->size()-1; i >= 0; i--) {
-			const ValueMap &confvars = ctx_stack->at(i)->config_variables;
-			if (confvars.find(name) != confvars.end())
-				return confvars.find(name)->second;
-		}
+	if (Symbols::isConfig(symbol)) {
+		// dynamic scope: the innermost value on the stack this thread evaluates on
+		const auto &config = (detached_stack ? detached_stack : this->ctx_stack)->config;
+		if (Symbols::index(symbol) < config.size() && !config[Symbols::index(symbol)].empty())
+			return config[Symbols::index(symbol)].back().second;
 		return ValuePtr::undefined;
 	}
 	const Context *pp = this;
 	do {
-		auto found = pp->variables.find(name);
-		if (found != pp->variables.end())
-			return found->second;
+		if (auto found = pp->variables.find(symbol))
+			return *found;
 		pp = pp->parent;
 	} while (pp);
 	if (!silent)
-		print_ignore_warning("variable", name.c_str());
+		print_ignore_warning("variable", Symbols::name(symbol).c_str());
 	return ValuePtr::undefined;
 }
 
+ValuePtr Context::lookup_variable(const std::string &name, bool silent) const
+{
+	return lookup_variable(Symbols::intern(name), silent);
+}
+
+bool Context::has_local_variable(SymbolId symbol) const
+{
+	if (Symbols::isConfig(symbol))
+		return config_variables.find(symbol) != nullptr;
+	return variables.find(symbol) != nullptr;
+}
+
 bool Context::has_local_variable(const std::string &name) const
 {
-	if (is_config_variable(name))
-		return config_variables.find(name) != config_variables.end();
-	return variables.find(name) != variables.end();
+	return has_local_variable(Symbols::intern(name));
 }
  
 ValuePtr Context::evaluate_function(const std::string &name, const EvalContext *evalctx) const
@@ -208,11 +288,22 @@ std::string Context::getAbsolutePath(const std::string &filename) const
 	}
 }
 
+std::vector<std::pair<std::string, ValuePtr>> Context::persistentVariables() const
+{
+	std::vector<std::pair<std::string, ValuePtr>> result;
+	result.reserve(std::distance(persist_variables.begin(), persist_variables.end()));
+	for (const auto &v : persist_variables)
+		result.emplace_back(Symbols::name(v.first), v.second);
+	std::sort(result.begin(), result.end(),
+		[](const std::pair<std::string, ValuePtr> &a, const std::pair<std::string, ValuePtr> &b) { return a.first < b.first; });
+	return result;
+}
+
 std::string Context::toString() const
 {
 	std::stringstream str;
 	bool first = true;
-	for (auto &arg : persist_variables) {
+	for (auto &arg : persistentVariables()) {
 		if (!arg.second->isDefined())
 			continue;
 		if (!first)
@@ -238,20 +329,16 @@ std::string Context::dump(const AbstractModule *mod, const ModuleInstantiation *
 		if (m) {
 			s << "  module args:";
 			for(const auto &arg : m->definition_arguments) {
-				s << boost::format("    %s = %s") % arg.name % variables[arg.name];
+				s << boost::format("    %s = %s") % arg.name % variables[arg.symbol];
 			}
 		}
 	}
-	typedef std::pair<std::string, ValuePtr> ValueMapType;
 	s << "  vars:";
-	for(const auto &v : constants) {
-		s << boost::format("    %s = %s") % v.first % v.second;
-	}
 	for(const auto &v : variables) {
-		s << boost::format("    %s = %s") % v.first % v.second;
+		s << boost::format("    %s = %s") % Symbols::name(v.first) % v.second;
 	}
 	for(const auto &v : config_variables) {
-		s << boost::format("    %s = %s") % v.first % v.second;
+		s << boost::format("    %s = %s") % Symbols::name(v.first) % v.second;
 	}
 	return s.str();
 }
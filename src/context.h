@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include "value.h"
 #include "Assignment.h"
+#include "Symbol.h"
 #include "memory.h"
 
 class Context
@@ -13,11 +14,34 @@ class Context
 	// prevent coding errors - Context is not copy-constructable
 	Context(const Context &copy) = delete;
 public:
-	typedef std::vector<const Context*> Stack;
-
-	Context(std::nullptr_t) noexcept : parent(nullptr), ctx_stack(nullptr) { }
+	/*!
+		The contexts alive during an evaluation, shared by a root context and
+		all its descendants. Config variables have dynamic scope, so the stack
+		also keeps, per config symbol, the values set by live contexts ordered
+		by stack depth; the innermost value is the last one.
+	*/
+	struct Stack {
+		std::vector<const Context*> contexts;
+		typedef std::vector<std::pair<size_t, ValuePtr>> Bindings; // (depth, value)
+		std::vector<Bindings> config; // by Symbols::index()
+		std::vector<const class UserContext*> modules; // user module calls, innermost last
+		Stack *outer = nullptr; // detached stack replaced by this one on its thread
+	};
+
+	// tag for the detaching constructor
+	struct Detach { };
+
+	Context(std::nullptr_t) noexcept : parent(nullptr), ctx_stack(nullptr), depth(0) { }
 
 	Context(const Context *parent = nullptr);
+	/*!
+		A child of parent on a new stack, so it can be evaluated on another
+		thread while parent's stack keeps changing. The new stack starts out
+		with the innermost config values and the user module calls of parent's.
+		All contexts created on this thread join it until it is destroyed.
+		parent must outlive this context.
+	*/
+	Context(const Context *parent, Detach);
 	virtual ~Context();
 
 	static std::string contextType() { return "Context"; }
@@ -35,6 +59,7 @@ public:
 	}
 
 	const Context *getParent() const { return this->parent; }
+	const std::vector<const class UserContext*> &moduleStack() const { return this->ctx_stack->modules; }
 
 	virtual ValuePtr evaluate_function(const std::string &name, const class EvalContext *evalctx) const;
 	virtual class AbstractNode *instantiate_module(const class ModuleContext *evalctx) const;
@@ -44,12 +69,15 @@ public:
 
 	void setVariables(const AssignmentList &args, const class EvalArguments *evalargs);
 
+	void set_variable(SymbolId symbol, const ValuePtr &value, bool persistent = true);
 	void set_variable(const std::string &name, const ValuePtr &value, bool persistent = true);
 	void set_variable(const std::string &name, const Value &value, bool persistent = true);
 
 	void apply_variables(const Context &other);
+	ValuePtr lookup_variable(SymbolId symbol, bool silent = false) const;
 	ValuePtr lookup_variable(const std::string &name, bool silent = false) const;
 	ValuePtr lookup(const std::string &name, bool silent = false) const;
+	bool has_local_variable(SymbolId symbol) const;
 	bool has_local_variable(const std::string &name) const;
 
 	void setDocumentPath(const std::string &path) { this->document_path = path; }
@@ -59,17 +87,41 @@ public:
 public:
 	std::string toString() const;
 
+protected:
+	// persistent variables sorted by name
+	std::vector<std::pair<std::string, ValuePtr>> persistentVariables() const;
+
 protected:
 	std::string typeName;
 	std::string name;
 	std::string what;
 	const Context *parent;
 	Stack *ctx_stack;
+	size_t depth; // position in ctx_stack
+
+	/*!
+		Variables of one context, sorted by symbol. Contexts hold only a few
+		variables each, so a flat vector beats a node based map.
+	*/
+	class ValueMap
+	{
+	public:
+		typedef std::vector<std::pair<SymbolId, ValuePtr>> Entries;
+		typedef Entries::const_iterator const_iterator;
+
+		const_iterator begin() const { return entries.begin(); }
+		const_iterator end() const { return entries.end(); }
+		bool empty() const { return entries.empty(); }
+
+		const ValuePtr *find(SymbolId symbol) const;
+		ValuePtr &operator[](SymbolId symbol);
 
-	typedef std::map<std::string, ValuePtr> ValueMap;
+	private:
+		Entries entries;
+	};
 	ValueMap variables;
 	ValueMap config_variables;
-	ValueMap persist_variables;
+	ValueMap persist_variables; // toString() and persist() sort these by name
 
 	std::string document_path; // FIXME: This is a remnant only needed by dxfdim
 
@@ -35,7 +35,11 @@
 #include "expressions.h"
 #include "builtin.h"
 #include "printutils.h"
+#include "feature.h"
+#include "WorkStealingPool.h"
 #include <cstdint>
+#include <algorithm>
+#include <exception>
 #include <sstream>
 
 class ControlModule : public AbstractModule
@@ -59,8 +63,11 @@ public: // methods
 
 	virtual AbstractNode *instantiate(const Context *ctx, const ModuleContext *evalctx) const;
 
-	static void for_eval(AbstractNode &node, size_t l, 
+	static void for_eval(NodeHandles &children, size_t l, 
 						 const Context *ctx, const ModuleContext *evalctx);
+	static void for_eval_threaded(NodeHandles &children, const std::string &what,
+								  const Value::VectorType &values,
+								  const Context *ctx, const ModuleContext *evalctx);
 
 	static const ModuleContext* getLastModuleCtx(const ModuleContext *evalctx);
 	
@@ -71,42 +78,115 @@ private: // data
 
 }; // class ControlModule
 
-void ControlModule::for_eval(AbstractNode &node, size_t l, 
+void ControlModule::for_eval(NodeHandles &children, size_t l, 
 							const Context *ctx, const ModuleContext *evalctx)
 {
 	if (evalctx->numArgs() > l) {
 		const std::string &it_name = evalctx->getArgName(l);
+		SymbolId it_symbol = evalctx->getArgSymbol(l);
 		ValuePtr it_values = evalctx->getArgValue(l, ctx);
+		// only the outermost loop is threaded, its iterations run the nested ones
+		bool threaded = l == 0 && Feature::ExperimentalThreadedFor.is_enabled() && WorkStealingPool::instance()->size() > 1;
+		std::string what = it_name + " = " + it_values->toString();
 		Context c(ctx);
-		c.setName("for", it_name + " = " + it_values->toString());
+		c.setName("for", what);
 		if (it_values->type() == Value::RANGE) {
 			RangeType range = it_values->toRange();
 			uint32_t steps = range.numValues();
 			if (steps >= 10000) {
 				PRINTB("WARNING: Bad range parameter in for statement: too many elements (%lu).", steps);
+			} else if (threaded && steps > 1) {
+				Value::VectorType values;
+				values.reserve(steps);
+				for (RangeType::iterator it = range.begin();it != range.end();it++)
+					values.push_back(ValuePtr(*it));
+				for_eval_threaded(children, what, values, ctx, evalctx);
 			} else {
 				for (RangeType::iterator it = range.begin();it != range.end();it++) {
-					c.set_variable(it_name, ValuePtr(*it));
-					for_eval(node, l+1, &c, evalctx);
+					c.set_variable(it_symbol, ValuePtr(*it));
+					for_eval(children, l+1, &c, evalctx);
 				}
 			}
 		}
 		else if (it_values->type() == Value::VECTOR) {
-			for (size_t i = 0; i < it_values->toVector().size(); i++) {
-				c.set_variable(it_name, it_values->toVector()[i]);
-				for_eval(node, l+1, &c, evalctx);
+			if (threaded && it_values->toVector().size() > 1) {
+				for_eval_threaded(children, what, it_values->toVector(), ctx, evalctx);
+			} else {
+				for (size_t i = 0; i < it_values->toVector().size(); i++) {
+					c.set_variable(it_symbol, it_values->toVector()[i]);
+					for_eval(children, l+1, &c, evalctx);
+				}
 			}
 		}
 		else if (it_values->type() != Value::UNDEFINED) {
-			c.set_variable(it_name, it_values);
-			for_eval(node, l+1, &c, evalctx);
+			c.set_variable(it_symbol, it_values);
+			for_eval(children, l+1, &c, evalctx);
 		}
 	} else if (l > 0) {
 		// At this point, the for loop variables have been set and we can initialize
 		// the local scope (as they may depend on the for loop variables
 		Context c(ctx);
 		c.setName("for", "evaluate");
-		evalctx->evaluate(c, node.getChildren());
+		evalctx->evaluate(c, children);
+	}
+}
+
+/*!
+	Runs the iterations of the outermost loop on the worker pool. The values
+	are split into a few contiguous chunks per worker. Each chunk evaluates
+	its iterations in order, in a context detached from ctx's stack, while
+	capturing its output and numbering its nodes from 0.
+	The chunks are then spliced back in order: output is replayed, nodes are
+	renumbered as if evaluated sequentially and the first error is rethrown.
+*/
+void ControlModule::for_eval_threaded(NodeHandles &children, const std::string &what,
+									const Value::VectorType &values,
+									const Context *ctx, const ModuleContext *evalctx)
+{
+	struct Chunk
+	{
+		size_t begin, end;
+		NodeHandles children;
+		PrintCapture output;
+		size_t numIndices = 0;
+		std::exception_ptr error;
+	};
+
+	auto pool = WorkStealingPool::instance();
+	SymbolId it_symbol = evalctx->getArgSymbol(0);
+	std::vector<Chunk> chunks(std::min(values.size(), pool->size() * 4));
+	{
+		WorkStealingPool::TaskGroup group(pool);
+		for (size_t i = 0; i < chunks.size(); ++i) {
+			Chunk &chunk = chunks[i];
+			chunk.begin = values.size() * i / chunks.size();
+			chunk.end = values.size() * (i + 1) / chunks.size();
+			group.run([&chunk, &what, &values, it_symbol, ctx, evalctx] {
+				PrintCapture::Scope capture(chunk.output);
+				AbstractNode::IndexScope indices;
+				try {
+					Context c(ctx, Context::Detach());
+					c.setName("for", what);
+					for (size_t j = chunk.begin; j < chunk.end; ++j) {
+						c.set_variable(it_symbol, values[j]);
+						for_eval(chunk.children, 1, &c, evalctx);
+					}
+				}
+				catch (...) {
+					chunk.error = std::current_exception();
+				}
+				chunk.numIndices = indices.count();
+			});
+		}
+		group.wait();
+	}
+
+	for (auto &chunk : chunks) {
+		chunk.output.replay();
+		if (chunk.error)
+			std::rethrow_exception(chunk.error);
+		AbstractNode::offsetIndices(chunk.children, AbstractNode::reserveIndices(chunk.numIndices));
+		children.insert(children.end(), chunk.children.begin(), chunk.children.end());
 	}
 }
 
@@ -274,12 +354,12 @@ AbstractNode *ControlModule::instantiate(const Context* ctx, const ModuleContext
 
 	case FOR:
 		node = GroupNode::create(evalctx->flags());
-		for_eval(*node, 0, evalctx, evalctx);
+		for_eval(node->getChildren(), 0, evalctx, evalctx);
 		break;
 
 	case INT_FOR:
 		node = AbstractIntersectionNode::create(evalctx->flags());
-		for_eval(*node, 0, evalctx, evalctx);
+		for_eval(node->getChildren(), 0, evalctx, evalctx);
 		break;
 
 	case IF: {
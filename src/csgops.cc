@@ -44,6 +44,8 @@
 
 #include "FactoryModule.h"
 #include "FactoryNode.h"
+#include "WorkStealingPool.h"
+#include "feature.h"
 
 template <OpenSCADOperator OP>
 class CsgOpFactoryNode : public CsgOpNode
@@ -106,156 +108,178 @@ FactoryModule<IntersectionNode> IntersectionNodeFactory("intersection");
 
 namespace PMP = CGAL::Polygon_mesh_processing;
 
-class CorefineUnionNode : public FactoryNode
+/*!
+	Base class for the corefine operations.
+
+	An OperandCollector gathers the child PolySets (converting Nefs). The
+	operands are then converted to PolyMeshes and unioned pairwise in a
+	balanced tree instead of being folded into one growing mesh, which keeps
+	each corefinement small and, with --enable=thread-union, spreads the
+	independent pairs over the worker pool.
+
+	The operands live only for one processChildren call, so the node doesn't
+	keep its children's geometry alive.
+*/
+class CorefineNode : public FactoryNode
 {
-public:
-	CorefineUnionNode() : first(nullptr) { }
+protected:
+	// collects the child PolySets in order, converting Nefs
+	class OperandCollector : public GeometryVisitor
+	{
+	public:
+		using GeometryVisitor::visitChild;
+
+		ResultObject visitChild(const ConstNefHandle &nef) override
+		{
+			if (auto ps = CGALUtils::getPolySet(nef))
+				return visitChild(ps);
+			return ResultObject(new EmptyGeometry());
+		}
+
+		ResultObject visitChild(const ConstPolySetHandle &ps) override
+		{
+			operands.push_back(ps);
+			return ResultObject(ps);
+		}
+
+		std::vector<ConstPolySetHandle> operands;
+	};
 
-	virtual ResultObject visitChild(shared_ptr<const CGAL_Nef_polyhedron> nef) const
+	// the operands of the children in order
+	static std::vector<ConstPolySetHandle> collectOperands(const NodeGeometries &children)
 	{
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*nef))
-			return visitChild(PolySetHandle(ps));
-		return ResultObject(new EmptyGeometry());
+		OperandCollector collector;
+		collector.visitChildren(children);
+		return std::move(collector.operands);
 	}
 
-	virtual ResultObject visitChild(shared_ptr<const PolySet> ps) const
+	// runs the task on the worker pool if threaded unions are enabled
+	static void runTask(WorkStealingPool::TaskGroup &group, const std::function<void()> &task)
 	{
-		auto mesh = std::make_shared<PolyMesh>(*ps);
-		// main object
-		if (!first) {
-			first = mesh;
-			return ResultObject(first);
-		}
-		// difference objects
-		PolyMesh::Mesh temp;
-		if (PMP::corefine_and_compute_union(first->getMesh(), mesh->getMesh(), temp)) {
-			auto ptemp = new PolyMesh(temp);
-			first.reset(ptemp);
-		}
+		if (Feature::ExperimentalThreadedUnion.is_enabled())
+			group.run(task);
 		else
-			PRINT("WARNING: Error computing corefine union");
-		return ResultObject(first);
+			task();
 	}
 
-	virtual ResultObject processChildren(const NodeGeometries &children) const
+	// converts the operands to meshes; each mesh is owned by one operation
+	// since corefinement modifies its inputs
+	static std::vector<shared_ptr<PolyMesh>> createMeshes(const std::vector<ConstPolySetHandle> &operands, bool validate)
 	{
-		visitChildren(children);
-		if (first)
-			return ResultObject(new PolyMesh(*first));
-		return ResultObject(new PolySet(3));
+		std::vector<shared_ptr<PolyMesh>> meshes(operands.size());
+		WorkStealingPool::TaskGroup group;
+		for (size_t i = 0; i < operands.size(); ++i) {
+			runTask(group, [&operands, &meshes, i, validate] {
+				auto mesh = std::make_shared<PolyMesh>(*operands[i]);
+				if (validate) mesh->validate();
+				meshes[i] = mesh;
+			});
+		}
+		group.wait();
+		return meshes;
 	}
 
-	mutable shared_ptr<PolyMesh> first;
-};
-
-FactoryModule<CorefineUnionNode> CorefineUnionNodeFactory("cunion");
+	// unions meshes [begin, end) pairwise in a balanced tree; failed pairs are
+	// counted rather than reported, since this may run on a pool thread
+	static shared_ptr<PolyMesh> unionMeshes(const std::vector<shared_ptr<PolyMesh>> &meshes, size_t begin, size_t end, std::atomic<size_t> &failures)
+	{
+		if (end - begin == 1)
+			return meshes[begin];
 
-class CorefineDifferenceNode : public FactoryNode
-{
-public:
-	CorefineDifferenceNode() : first(nullptr) { }
+		size_t mid = begin + (end - begin) / 2;
+		shared_ptr<PolyMesh> left;
+		WorkStealingPool::TaskGroup group;
+		runTask(group, [&meshes, &left, &failures, begin, mid] { left = unionMeshes(meshes, begin, mid, failures); });
+		auto right = unionMeshes(meshes, mid, end, failures);
+		group.wait();
 
-	virtual ResultObject visitChild(shared_ptr<const CGAL_Nef_polyhedron> nef) const
-	{
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*nef))
-			return visitChild(PolySetHandle(ps));
-		return ResultObject(new EmptyGeometry());
+		PolyMesh::Mesh temp;
+		if (PMP::corefine_and_compute_union(left->getMesh(), right->getMesh(), temp))
+			return std::make_shared<PolyMesh>(temp);
+		failures++;
+		return left;
 	}
 
-	virtual ResultObject visitChild(shared_ptr<const PolySet> ps) const
+	// unions meshes [begin, end), reporting failures on the calling thread
+	static shared_ptr<PolyMesh> unionMeshes(const std::vector<shared_ptr<PolyMesh>> &meshes, size_t begin, size_t end)
 	{
-		auto mesh = std::make_shared<PolyMesh>(*ps);
-		mesh->validate();
-		// main object
-		if (first) {
-			// difference objects
-			if (CGAL::Polygon_mesh_processing::does_self_intersect(first->getMesh()))
-				PRINT("WARNING: first mesh is self intersecting");
-			if (CGAL::Polygon_mesh_processing::does_self_intersect(mesh->getMesh()))
-				PRINT("WARNING: difference mesh is self intersecting");
-			if (!CGAL::Polygon_mesh_processing::does_bound_a_volume(first->getMesh()))
-				PRINT("WARNING: first mesh does not bound a volume");
-			if (!CGAL::Polygon_mesh_processing::does_bound_a_volume(mesh->getMesh()))
-				PRINT("WARNING: difference mesh does not bound a volume");
-			PolyMesh::Mesh temp;
-			if (PMP::corefine_and_compute_difference(first->getMesh(), mesh->getMesh(), temp)) {
-				auto ptemp = new PolyMesh(temp);
-				first.reset(ptemp);
-			}
-			else
-				PRINT("WARNING: Error computing corefine difference");
-		}
-		else
-			first = mesh;
-		return ResultObject(first);
+		std::atomic<size_t> failures(0);
+		auto result = unionMeshes(meshes, begin, end, failures);
+		for (size_t i = 0; i < failures; ++i)
+			PRINT("WARNING: Error computing corefine union");
+		return result;
 	}
+};
 
+class CorefineUnionNode : public CorefineNode
+{
+public:
 	virtual ResultObject processChildren(const NodeGeometries &children) const
 	{
-		visitChildren(children);
-		if (first)
-			return ResultObject(new PolyMesh(*first));
-		return ResultObject(new PolySet(3));
+		auto operands = collectOperands(children);
+		if (operands.empty())
+			return ResultObject(new PolySet(3));
+		auto meshes = createMeshes(operands, false);
+		return ResultObject(unionMeshes(meshes, 0, meshes.size()));
 	}
-
-	mutable shared_ptr<PolyMesh> first;
 };
 
-FactoryModule<CorefineDifferenceNode> CorefineDifferenceNodeFactory("cdifference");
+FactoryModule<CorefineUnionNode> CorefineUnionNodeFactory("cunion");
 
-class CorefineIntersectionNode : public FactoryNode
+class CorefineDifferenceNode : public CorefineNode
 {
 public:
-	CorefineIntersectionNode() { }
-
-	virtual ResultObject visitChild(shared_ptr<const CGAL_Nef_polyhedron> nef) const
-	{
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*nef))
-			return visitChild(PolySetHandle(ps));
-		return ResultObject(new EmptyGeometry());
-	}
-
-	virtual ResultObject visitChild(shared_ptr<const PolySet> ps) const
+	virtual ResultObject processChildren(const NodeGeometries &children) const
 	{
-		auto mesh = std::make_shared<PolyMesh>(*ps);
-		// main object
-		if (!first) {
-			first = mesh;
+		auto operands = collectOperands(children);
+		if (operands.empty())
+			return ResultObject(new PolySet(3));
+		auto meshes = createMeshes(operands, true);
+		shared_ptr<PolyMesh> first = meshes[0];
+		if (meshes.size() == 1)
 			return ResultObject(first);
-		}
-		// first intersected object
-		if (!second) {
-			second = mesh;
-			return ResultObject(second);
-		}
-		// union subsequent intersected objects
-		PolyMesh::Mesh temp;
-		if (PMP::corefine_and_compute_union(second->getMesh(), mesh->getMesh(), temp)) {
-			auto ptemp = new PolyMesh(temp);
-			second.reset(ptemp);
-		}
-		else
-			PRINT("WARNING: Error computing corefine union for intersection");
-		return ResultObject(second);
+
+		// subtract the union of all difference objects once
+		shared_ptr<PolyMesh> second = unionMeshes(meshes, 1, meshes.size());
+		if (PMP::does_self_intersect(first->getMesh()))
+			PRINT("WARNING: first mesh is self intersecting");
+		if (PMP::does_self_intersect(second->getMesh()))
+			PRINT("WARNING: difference mesh is self intersecting");
+		if (!PMP::does_bound_a_volume(first->getMesh()))
+			PRINT("WARNING: first mesh does not bound a volume");
+		if (!PMP::does_bound_a_volume(second->getMesh()))
+			PRINT("WARNING: difference mesh does not bound a volume");
+		PolyMesh::Mesh result;
+		if (PMP::corefine_and_compute_difference(first->getMesh(), second->getMesh(), result))
+			return ResultObject(new PolyMesh(result));
+		PRINT("WARNING: Error computing corefine difference");
+		return ResultObject(first);
 	}
+};
+
+FactoryModule<CorefineDifferenceNode> CorefineDifferenceNodeFactory("cdifference");
 
+class CorefineIntersectionNode : public CorefineNode
+{
+public:
 	virtual ResultObject processChildren(const NodeGeometries &children) const
 	{
-		visitChildren(children);
-		if (!second) {
-			return ResultObject(new PolyMesh(*first));
-		}
+		auto operands = collectOperands(children);
+		if (operands.empty())
+			return ResultObject(new PolySet(3));
+		auto meshes = createMeshes(operands, false);
+		shared_ptr<PolyMesh> first = meshes[0];
+		if (meshes.size() == 1)
+			return ResultObject(first);
+
+		// intersect with the union of all subsequent objects
+		shared_ptr<PolyMesh> second = unionMeshes(meshes, 1, meshes.size());
 		PolyMesh::Mesh result;
-		if (PMP::corefine_and_compute_intersection(first->getMesh(), second->getMesh(), result)) {
+		if (PMP::corefine_and_compute_intersection(first->getMesh(), second->getMesh(), result))
 			return ResultObject(new PolyMesh(result));
-		}
-		else
-			PRINT("WARNING: Error computing corefine intersection");
+		PRINT("WARNING: Error computing corefine intersection");
 		return ResultObject(new PolySet(3));
 	}
-
-	mutable shared_ptr<PolyMesh> first;
-	mutable shared_ptr<PolyMesh> second;
 };
 
 FactoryModule<CorefineIntersectionNode> CorefineIntersectionNodeFactory("cintersection");
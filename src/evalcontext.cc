@@ -14,6 +14,12 @@ const std::string &EvalArguments::getArgName(size_t i) const
 	return eval_arguments[i].name;
 }
 
+SymbolId EvalArguments::getArgSymbol(size_t i) const
+{
+	assert(i < eval_arguments.size());
+	return eval_arguments[i].symbol;
+}
+
 ValuePtr EvalArguments::getArgValue(size_t i, const Context *ctx) const
 {
 	assert(i < eval_arguments.size());
@@ -27,7 +33,7 @@ ValuePtr EvalArguments::getArgValue(size_t i, const Context *ctx) const
 
 /*!
   Resolves arguments specified by evalctx, using args to lookup positional arguments.
-  Returns an AssignmentMap (string -> Expression*)
+  Returns an AssignmentMap (SymbolId -> Expression*)
 */
 AssignmentMap EvalArguments::resolveArguments(const AssignmentList &args) const
 {
@@ -35,13 +41,13 @@ AssignmentMap EvalArguments::resolveArguments(const AssignmentList &args) const
   size_t posarg = 0;
   // Iterate over positional args
   for (size_t i=0; i<this->numArgs(); i++) {
-    const std::string &name = this->getArgName(i); // name is optional
+    SymbolId symbol = this->getArgSymbol(i); // name is optional
     const Expression *expr = this->getArgs()[i].expr.get();
-    if (!name.empty()) {
-      resolvedArgs[name] = expr;
+    if (symbol) {
+      resolvedArgs[symbol] = expr;
     }
     // If positional, find name of arg with this position
-    else if (posarg < args.size()) resolvedArgs[args[posarg++].name] = expr;
+    else if (posarg < args.size()) resolvedArgs[args[posarg++].symbol] = expr;
   }
   return resolvedArgs;
 }
@@ -58,11 +64,11 @@ void EvalContext::assignTo(Context &target) const
 		if (!assignment.name.empty()) {
 			ValuePtr v;
 			if (assignment.expr) v = assignment.expr->evaluate(&target);
-			if (target.has_local_variable(assignment.name)) {
+			if (target.has_local_variable(assignment.symbol)) {
 				PRINTB("WARNING: Ignoring duplicate variable assignment %s = %s", assignment.name % v->toString());
 			}
 			else {
-				target.set_variable(assignment.name, v);
+				target.set_variable(assignment.symbol, v);
 			}
 		}
 	}
@@ -104,7 +110,7 @@ std::string EvalContext::dump(const AbstractModule *mod, const ModuleInstantiati
 		if (m) {
 			s << boost::format("  module args:");
 			for(const auto &arg : m->definition_arguments) {
-				s << boost::format("    %s = %s") % arg.name % *(variables[arg.name]);
+				s << boost::format("    %s = %s") % arg.name % *(variables[arg.symbol]);
 			}
 		}
 	}
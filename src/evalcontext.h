@@ -20,6 +20,7 @@ public:
 
 	size_t numArgs() const { return eval_arguments.size(); }
 	const std::string &getArgName(size_t i) const;
+	SymbolId getArgSymbol(size_t i) const;
 	ValuePtr getArgValue(size_t i, const Context *ctx = nullptr) const;
 	const AssignmentList & getArgs() const { return eval_arguments; }
 
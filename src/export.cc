@@ -27,6 +27,7 @@
 #include "export.h"
 #include "printutils.h"
 #include "Geometry.h"
+#include "Profiler.h"
 
 #include <fstream>
 
@@ -39,6 +40,9 @@ void exportFile(const shared_ptr<const Geometry> &root_geom, std::ostream &outpu
 	case OPENSCAD_STL:
 		export_stl(root_geom, output);
 		break;
+	case OPENSCAD_BINSTL:
+		export_stl_binary(root_geom, output);
+		break;
 	case OPENSCAD_OFF:
 		export_off(root_geom, output);
 		break;
@@ -57,6 +61,9 @@ void exportFile(const shared_ptr<const Geometry> &root_geom, std::ostream &outpu
 	case OPENSCAD_NEF3:
 		export_nef3(root_geom, output);
 		break;
+	case OPENSCAD_MESH:
+		export_mesh(root_geom, output);
+		break;
 	default:
 		assert(false && "Unknown file format");
 	}
@@ -65,7 +72,14 @@ void exportFile(const shared_ptr<const Geometry> &root_geom, std::ostream &outpu
 void exportFileByName(const shared_ptr<const Geometry> &root_geom, FileFormat format,
 	const char *name2open, const char *name2display)
 {
-	std::ofstream fstream(name2open);
+	Profiler::Span span("export", name2display);
+	if (Profiler::enabled()) span.setGeometryBytes(root_geom->memsize());
+	if (format == OPENSCAD_3MF) {
+		export_3mf(root_geom, name2open, name2display);
+		return;
+	}
+	bool binary = format == OPENSCAD_BINSTL || format == OPENSCAD_MESH;
+	std::ofstream fstream(name2open, binary ? std::ios::out | std::ios::binary : std::ios::out);
 	if (!fstream.is_open()) {
 		PRINTB(_("Can't open file \"%s\" for export"), name2display);
 	} else {
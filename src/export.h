@@ -7,24 +7,31 @@
 
 enum FileFormat {
 	OPENSCAD_STL,
+	OPENSCAD_BINSTL,
 	OPENSCAD_OFF,
 	OPENSCAD_AMF,
+	OPENSCAD_3MF,
 	OPENSCAD_DXF,
 	OPENSCAD_SVG,
 	OPENSCAD_NEFDBG,
-	OPENSCAD_NEF3
+	OPENSCAD_NEF3,
+	OPENSCAD_MESH
 };
 
 void exportFileByName(const shared_ptr<const class Geometry> &root_geom, FileFormat format,
 											const char *name2open, const char *name2display);
 
 void export_stl(const shared_ptr<const Geometry> &geom, std::ostream &output);
+void export_stl_binary(const shared_ptr<const Geometry> &geom, std::ostream &output);
 void export_off(const shared_ptr<const Geometry> &geom, std::ostream &output);
 void export_amf(const shared_ptr<const Geometry> &geom, std::ostream &output);
+// 3MF is a zip archive, which is written to the file directly
+void export_3mf(const shared_ptr<const Geometry> &geom, const char *filename, const char *name2display);
 void export_dxf(const shared_ptr<const Geometry> &geom, std::ostream &output);
 void export_svg(const shared_ptr<const Geometry> &geom, std::ostream &output);
 void export_nefdbg(const shared_ptr<const Geometry> &geom, std::ostream &output);
 void export_nef3(const shared_ptr<const Geometry> &geom, std::ostream &output);
+void export_mesh(const shared_ptr<const Geometry> &geom, std::ostream &output);
 
 // void exportFile(const class Geometry *root_geom, std::ostream &output, FileFormat format);
 
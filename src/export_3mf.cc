@@ -0,0 +1,394 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2011 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "export.h"
+#include "polyset.h"
+#include "polyset-utils.h"
+#include "printutils.h"
+#include "Reindexer.h"
+#include "GeometryUtils.h"
+#include "Decimal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#define QUOTE(x__) # x__
+#define QUOTED(x__) QUOTE(x__)
+
+#ifdef ENABLE_CGAL
+#include "CGAL_Nef_polyhedron.h"
+#include "cgal.h"
+#include "cgalutils.h"
+
+#if ENABLE_LIBZIP
+#include <zip.h>
+
+namespace {
+
+/*!
+	The mesh of one 3MF object. Vertices are rounded to the digits written
+	and merged, and triangles which become degenerate by rounding are dropped.
+*/
+struct ModelObject
+{
+	std::vector<Vector3d> vertices;
+	std::vector<IndexedTriangle> triangles;
+};
+
+class ModelObjectBuilder
+{
+public:
+	void add(const shared_ptr<const Geometry> &geom)
+	{
+		if (const GeometryGroup *G = dynamic_cast<const GeometryGroup*>(geom.get())) {
+			for (const auto &child : G->getChildren()) {
+				if (child.second) add(child.second);
+			}
+		}
+		else if (const CGAL_Nef_polyhedron *N = dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get())) {
+			if (N->isEmpty()) return;
+			if (!(*N)->is_simple()) {
+				PRINT("WARNING: Exported object may not be a valid 2-manifold and may need repair");
+			}
+			if (auto ps = CGALUtils::getPolySet(*N))
+				add(*ps);
+			else
+				PRINT("ERROR: Nef->PolySet failed");
+		}
+		else if (const PolySet *ps = dynamic_cast<const PolySet *>(geom.get())) {
+			add(*ps);
+		}
+		else if (const Polygon2d *poly = dynamic_cast<const Polygon2d *>(geom.get())) {
+			assert(false && "Unsupported file format");
+		} else {
+			assert(false && "Not implemented");
+		}
+	}
+
+	bool empty() const { return triangles.empty(); }
+
+	void finish(ModelObject &object)
+	{
+		const Vector3d *array = vertices.getArray();
+		object.vertices.assign(array, array + vertices.size());
+		object.triangles.swap(triangles);
+	}
+
+private:
+	void add(const PolySet &ps)
+	{
+		// triangle meshes are used without tessellating them again; like every
+		// mesh, their vertices are written with the 6 significant digits of Decimal
+		if (ps.poly_dim() > 3) {
+			PolySet triangulated(3);
+			PolysetUtils::tessellate_faces(ps, triangulated);
+			addTriangles(triangulated);
+		}
+		else {
+			addTriangles(ps);
+		}
+	}
+
+	void addTriangles(const PolySet &ps)
+	{
+		const auto &psVertices = ps.getVertices();
+		std::vector<int> vertexMap(psVertices.size(), -1);
+		triangles.reserve(triangles.size() + ps.numPolygons());
+		for (const auto &poly : ps.getPolygons()) {
+			if (poly.open || poly.size() != 3) continue;
+			IndexedTriangle t;
+			for (int i = 0; i < 3; i++) {
+				int &mapped = vertexMap[poly.index(i)];
+				if (mapped < 0) {
+					const Vector3d &v = psVertices[poly.index(i)];
+					// adding 0 turns -0 into 0, which is written the same
+					mapped = vertices.lookup(Vector3d(Decimal(v[0]).value() + 0.0,
+						Decimal(v[1]).value() + 0.0, Decimal(v[2]).value() + 0.0));
+				}
+				t[i] = mapped;
+			}
+			if (t[0] != t[1] && t[0] != t[2] && t[1] != t[2]) triangles.push_back(t);
+		}
+	}
+
+	Reindexer<Vector3d> vertices;
+	std::vector<IndexedTriangle> triangles;
+};
+
+// vertices or triangles formatted per call to ModelStream::fill()
+const size_t MODEL_CHUNK_ELEMENTS = 1024;
+
+/*!
+	Formats the 3D model part of the archive on demand, as libzip reads it
+	while compressing, so only one chunk of the XML text is held at a time.
+*/
+class ModelStream
+{
+public:
+	ModelStream(const std::vector<ModelObject> &objects) : objects(objects) { rewind(); }
+
+	void rewind()
+	{
+		section = HEADER;
+		object = 0;
+		element = 0;
+		buffer.clear();
+		bufferPos = 0;
+	}
+
+	size_t read(char *data, size_t len)
+	{
+		size_t n = 0;
+		while (n < len) {
+			if (bufferPos == buffer.size() && !fill()) break;
+			size_t count = std::min(len - n, buffer.size() - bufferPos);
+			memcpy(data + n, buffer.data() + bufferPos, count);
+			bufferPos += count;
+			n += count;
+		}
+		return n;
+	}
+
+private:
+	enum Section { HEADER, OBJECT, VERTICES, TRIANGLES, BUILD, DONE };
+
+	// replaces the buffer with the next chunk, false at the end
+	bool fill()
+	{
+		buffer.clear();
+		bufferPos = 0;
+		switch (section) {
+		case HEADER:
+			buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+				"<model unit=\"millimeter\" xml:lang=\"en-US\" "
+				"xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+				" <metadata name=\"Application\">OpenSCAD " QUOTED(OPENSCAD_VERSION) "</metadata>\n"
+				" <resources>\n";
+			section = objects.empty() ? BUILD : OBJECT;
+			break;
+		case OBJECT:
+			buffer += "  <object id=\"";
+			appendInt(object + 1);
+			buffer += "\" type=\"model\">\n   <mesh>\n    <vertices>\n";
+			section = VERTICES;
+			element = 0;
+			break;
+		case VERTICES: {
+			const auto &vertices = objects[object].vertices;
+			size_t end = std::min(vertices.size(), element + MODEL_CHUNK_ELEMENTS);
+			for (; element < end; element++) {
+				const Vector3d &v = vertices[element];
+				buffer += "     <vertex x=\"";
+				appendDecimal(v[0]);
+				buffer += "\" y=\"";
+				appendDecimal(v[1]);
+				buffer += "\" z=\"";
+				appendDecimal(v[2]);
+				buffer += "\"/>\n";
+			}
+			if (element == vertices.size()) {
+				buffer += "    </vertices>\n    <triangles>\n";
+				section = TRIANGLES;
+				element = 0;
+			}
+			break;
+		}
+		case TRIANGLES: {
+			const auto &triangles = objects[object].triangles;
+			size_t end = std::min(triangles.size(), element + MODEL_CHUNK_ELEMENTS);
+			for (; element < end; element++) {
+				const IndexedTriangle &t = triangles[element];
+				buffer += "     <triangle v1=\"";
+				appendInt(t[0]);
+				buffer += "\" v2=\"";
+				appendInt(t[1]);
+				buffer += "\" v3=\"";
+				appendInt(t[2]);
+				buffer += "\"/>\n";
+			}
+			if (element == triangles.size()) {
+				buffer += "    </triangles>\n   </mesh>\n  </object>\n";
+				section = ++object < objects.size() ? OBJECT : BUILD;
+			}
+			break;
+		}
+		case BUILD:
+			buffer += " </resources>\n <build>\n";
+			for (size_t i = 0; i < objects.size(); i++) {
+				buffer += "  <item objectid=\"";
+				appendInt(i + 1);
+				buffer += "\"/>\n";
+			}
+			buffer += " </build>\n</model>\n";
+			section = DONE;
+			break;
+		case DONE:
+			return false;
+		}
+		return true;
+	}
+
+	void appendDecimal(double x)
+	{
+		char text[16];
+		buffer.append(text, Decimal(x).write(text));
+	}
+
+	void appendInt(size_t x)
+	{
+		char text[20];
+		buffer.append(text, write_unsigned(text, x));
+	}
+
+	const std::vector<ModelObject> &objects;
+	Section section;
+	size_t object;
+	size_t element;
+	std::string buffer;
+	size_t bufferPos;
+};
+
+zip_int64_t model_source(void *userdata, void *data, zip_uint64_t len, enum zip_source_cmd cmd)
+{
+	ModelStream *stream = static_cast<ModelStream *>(userdata);
+	switch (cmd) {
+	case ZIP_SOURCE_OPEN:
+		stream->rewind();
+		return 0;
+	case ZIP_SOURCE_READ:
+		return stream->read(static_cast<char *>(data), len);
+	case ZIP_SOURCE_CLOSE:
+		return 0;
+	case ZIP_SOURCE_STAT: {
+		// the size is unknown until the stream ends
+		struct zip_stat *st = static_cast<struct zip_stat *>(data);
+		zip_stat_init(st);
+		st->mtime = time(nullptr);
+		st->valid |= ZIP_STAT_MTIME;
+		return sizeof(*st);
+	}
+	case ZIP_SOURCE_ERROR: {
+		int *error = static_cast<int *>(data);
+		error[0] = error[1] = 0;
+		return 2 * sizeof(int);
+	}
+	case ZIP_SOURCE_FREE:
+		return 0;
+#if defined(LIBZIP_VERSION_MAJOR) && LIBZIP_VERSION_MAJOR >= 1
+	case ZIP_SOURCE_SUPPORTS:
+		return ZIP_SOURCE_SUPPORTS_READABLE;
+#endif
+	default:
+		return -1;
+	}
+}
+
+const char content_types[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">\n"
+	" <Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>\n"
+	" <Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n"
+	"</Types>\n";
+
+const char relationships[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">\n"
+	" <Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" "
+	"Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>\n"
+	"</Relationships>\n";
+
+bool add_file(struct zip *archive, const char *name, struct zip_source *source)
+{
+	if (!source) return false;
+	if (zip_file_add(archive, name, source, ZIP_FL_OVERWRITE) < 0) {
+		zip_source_free(source);
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+/*!
+	Writes a 3MF package. Each top-level child of the design becomes an
+	object of its own; the mesh XML is formatted while the archive is
+	compressed instead of being built in memory first.
+*/
+void export_3mf(const shared_ptr<const Geometry> &geom, const char *filename, const char *name2display)
+{
+	std::vector<ModelObject> objects;
+	auto addObject = [&objects](const shared_ptr<const Geometry> &g) {
+		ModelObjectBuilder builder;
+		builder.add(g);
+		if (builder.empty()) return;
+		objects.push_back(ModelObject());
+		builder.finish(objects.back());
+	};
+	if (const GeometryGroup *G = dynamic_cast<const GeometryGroup*>(geom.get())) {
+		for (const auto &child : G->getChildren()) {
+			if (child.second) addObject(child.second);
+		}
+	}
+	else {
+		addObject(geom);
+	}
+
+	int error = 0;
+	struct zip *archive = zip_open(filename, ZIP_CREATE | ZIP_TRUNCATE, &error);
+	if (!archive) {
+		PRINTB(_("Can't open file \"%s\" for export"), name2display);
+		return;
+	}
+
+	ModelStream stream(objects);
+	bool ok = add_file(archive, "[Content_Types].xml", zip_source_buffer(archive, content_types, sizeof(content_types) - 1, 0)) &&
+		add_file(archive, "_rels/.rels", zip_source_buffer(archive, relationships, sizeof(relationships) - 1, 0)) &&
+		add_file(archive, "3D/3dmodel.model", zip_source_function(archive, model_source, &stream));
+	if (!ok) {
+		PRINTB("ERROR: Can't write 3MF file \"%s\": %s", name2display % zip_strerror(archive));
+		zip_discard(archive);
+		return;
+	}
+	// the model is read and compressed here
+	if (zip_close(archive) < 0) {
+		PRINTB(_("ERROR: \"%s\" write error. (Disk full?)"), name2display);
+		zip_discard(archive);
+	}
+}
+
+#else // ENABLE_LIBZIP
+
+void export_3mf(const shared_ptr<const Geometry> &, const char *, const char *name2display)
+{
+	PRINTB("ERROR: Can't export \"%s\": this build has no 3MF support (requires libzip)", name2display);
+}
+
+#endif // ENABLE_LIBZIP
+
+#endif // ENABLE_CGAL
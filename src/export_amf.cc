@@ -28,6 +28,12 @@
 #include "polyset.h"
 #include "polyset-utils.h"
 #include "dxfdata.h"
+#include "GeometryUtils.h"
+#include "Decimal.h"
+#include "ParallelFormat.h"
+
+#include <cstring>
+#include <unordered_map>
 
 #ifdef ENABLE_CGAL
 #include "CGAL_Nef_polyhedron.h"
@@ -37,12 +43,40 @@
 #define QUOTE(x__) # x__
 #define QUOTED(x__) QUOTE(x__)
 
-struct triangle {
-    std::string vs1;
-    std::string vs2;
-    std::string vs3;
+namespace {
+
+// vertices or triangles formatted per chunk, chunks are formatted concurrently
+const size_t AMF_CHUNK_ELEMENTS = 1024;
+
+// a vertex as written to the file, which identifies it
+struct AmfVertex
+{
+	Decimal coords[3];
+
+	AmfVertex(const CGAL_Polyhedron::Vertex &v)
+		: coords{ CGAL::to_double(v.point().x()), CGAL::to_double(v.point().y()), CGAL::to_double(v.point().z()) } { }
+
+	bool operator==(const AmfVertex &other) const {
+		return coords[0] == other.coords[0] && coords[1] == other.coords[1] && coords[2] == other.coords[2];
+	}
+};
+
+struct AmfVertexHash
+{
+	size_t operator()(const AmfVertex &v) const {
+		return (v.coords[0].hash() * 31 + v.coords[1].hash()) * 31 + v.coords[2].hash();
+	}
 };
 
+char *append(char *out, const char *str)
+{
+	size_t len = strlen(str);
+	memcpy(out, str, len);
+	return out + len;
+}
+
+}
+
 static int objectid;
 
 /*!
@@ -60,56 +94,32 @@ static void append_amf(const CGAL_Nef_polyhedron &root_N, std::ostream &output)
 		CGAL_Polyhedron P;
 		root_N->convert_to_Polyhedron(P);
 
-		typedef CGAL_Polyhedron::Vertex Vertex;
 		typedef CGAL_Polyhedron::Vertex_const_iterator VCI;
 		typedef CGAL_Polyhedron::Facet_const_iterator FCI;
 		typedef CGAL_Polyhedron::Halfedge_around_facet_const_circulator HFCC;
 
-		std::vector<std::string> vertices;
-		std::vector<triangle> triangles;
+		// vertices are numbered in the order facets first use them
+		std::unordered_map<AmfVertex, int, AmfVertexHash> vertexIndex;
+		std::vector<AmfVertex> vertices;
+		std::vector<IndexedTriangle> triangles;
+		auto lookup = [&vertexIndex, &vertices](const AmfVertex &v) {
+			auto it = vertexIndex.emplace(v, int(vertices.size()));
+			if (it.second) vertices.push_back(v);
+			return it.first->second;
+		};
 
 		for (FCI fi = P.facets_begin(); fi != P.facets_end(); ++fi) {
 			HFCC hc = fi->facet_begin();
 			HFCC hc_end = hc;
-			Vertex v1, v2, v3;
-			v1 = *VCI((hc++)->vertex());
-			v3 = *VCI((hc++)->vertex());
+			int v1, v2, v3;
+			v1 = lookup(AmfVertex(*VCI((hc++)->vertex())));
+			v3 = lookup(AmfVertex(*VCI((hc++)->vertex())));
 			do {
 				v2 = v3;
-				v3 = *VCI((hc++)->vertex());
-				double x1 = CGAL::to_double(v1.point().x());
-				double y1 = CGAL::to_double(v1.point().y());
-				double z1 = CGAL::to_double(v1.point().z());
-				double x2 = CGAL::to_double(v2.point().x());
-				double y2 = CGAL::to_double(v2.point().y());
-				double z2 = CGAL::to_double(v2.point().z());
-				double x3 = CGAL::to_double(v3.point().x());
-				double y3 = CGAL::to_double(v3.point().y());
-				double z3 = CGAL::to_double(v3.point().z());
-				std::stringstream stream;
-				stream << x1 << " " << y1 << " " << z1;
-				std::string vs1 = stream.str();
-				stream.str("");
-				stream << x2 << " " << y2 << " " << z2;
-				std::string vs2 = stream.str();
-				stream.str("");
-				stream << x3 << " " << y3 << " " << z3;
-				std::string vs3 = stream.str();
-				if (std::find(vertices.begin(), vertices.end(), vs1) == vertices.end())
-					vertices.push_back(vs1);
-				if (std::find(vertices.begin(), vertices.end(), vs2) == vertices.end())
-					vertices.push_back(vs2);
-				if (std::find(vertices.begin(), vertices.end(), vs3) == vertices.end())
-					vertices.push_back(vs3);
-
-				if (vs1 != vs2 && vs1 != vs3 && vs2 != vs3) {
-					// The above condition ensures that there are 3 distinct vertices, but
-					// they may be collinear. If they are, the unit normal is meaningless
-					// so the default value of "1 0 0" can be used. If the vertices are not
-					// collinear then the unit normal must be calculated from the
-					// components.
-					triangle tri = {vs1, vs2, vs3};
-					triangles.push_back(tri);
+				v3 = lookup(AmfVertex(*VCI((hc++)->vertex())));
+				// The vertices are distinct as written, but may still be collinear.
+				if (v1 != v2 && v1 != v3 && v2 != v3) {
+					triangles.push_back(IndexedTriangle(v1, v2, v3));
 				}
 			} while (hc != hc_end);
 		}
@@ -117,34 +127,42 @@ static void append_amf(const CGAL_Nef_polyhedron &root_N, std::ostream &output)
 		output << " <object id=\"" << objectid++ << "\">\r\n"
 					 << "  <mesh>\r\n";
 		output << "   <vertices>\r\n";
-		for (size_t i = 0; i < vertices.size(); i++) {
-			std::string s = vertices[i];
-			output << "    <vertex><coordinates>\r\n";
-			char* chrs = new char[s.length() + 1];
-			strcpy(chrs, s.c_str());
-			std::string coords = strtok(chrs, " ");
-			output << "     <x>" << coords << "</x>\r\n";
-			coords = strtok(NULL, " ");
-			output << "     <y>" << coords << "</y>\r\n";
-			coords = strtok(NULL, " ");
-			output << "     <z>" << coords << "</z>\r\n";
-			output << "    </coordinates></vertex>\r\n";
-			delete[] chrs;
-		}
+		write_formatted(output, vertices.size(), AMF_CHUNK_ELEMENTS,
+			[&vertices](size_t begin, size_t end, std::string &text) {
+				static const char *tags[3][2] = {
+					{ "     <x>", "</x>\r\n" }, { "     <y>", "</y>\r\n" }, { "     <z>", "</z>\r\n" }
+				};
+				char element[256];
+				for (size_t i = begin; i < end; i++) {
+					char *pos = append(element, "    <vertex><coordinates>\r\n");
+					for (int j = 0; j < 3; j++) {
+						pos = append(pos, tags[j][0]);
+						pos = vertices[i].coords[j].write(pos);
+						pos = append(pos, tags[j][1]);
+					}
+					pos = append(pos, "    </coordinates></vertex>\r\n");
+					text.append(element, pos);
+				}
+			});
 		output << "   </vertices>\r\n";
 		output << "   <volume>\r\n";
-		for (size_t i = 0; i < triangles.size(); i++) {
-			triangle t = triangles[i];
-			output << "    <triangle>\r\n";
-			size_t index;
-			index = std::distance(vertices.begin(), std::find(vertices.begin(), vertices.end(), t.vs1));
-			output << "     <v1>" << index << "</v1>\r\n";
-			index = std::distance(vertices.begin(), std::find(vertices.begin(), vertices.end(), t.vs2));
-			output << "     <v2>" << index << "</v2>\r\n";
-			index = std::distance(vertices.begin(), std::find(vertices.begin(), vertices.end(), t.vs3));
-			output << "     <v3>" << index << "</v3>\r\n";
-			output << "    </triangle>\r\n";
-		}
+		write_formatted(output, triangles.size(), AMF_CHUNK_ELEMENTS,
+			[&triangles](size_t begin, size_t end, std::string &text) {
+				static const char *tags[3][2] = {
+					{ "     <v1>", "</v1>\r\n" }, { "     <v2>", "</v2>\r\n" }, { "     <v3>", "</v3>\r\n" }
+				};
+				char element[256];
+				for (size_t i = begin; i < end; i++) {
+					char *pos = append(element, "    <triangle>\r\n");
+					for (int j = 0; j < 3; j++) {
+						pos = append(pos, tags[j][0]);
+						pos = write_unsigned(pos, triangles[i][j]);
+						pos = append(pos, tags[j][1]);
+					}
+					pos = append(pos, "    </triangle>\r\n");
+					text.append(element, pos);
+				}
+			});
 		output << "   </volume>\r\n";
 		output << "  </mesh>\r\n"
 					 << " </object>\r\n";
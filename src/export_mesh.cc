@@ -0,0 +1,69 @@
+#include "export.h"
+#include "polyset.h"
+#include "printutils.h"
+#include "MeshFormat.h"
+
+#ifdef ENABLE_CGAL
+#include "CGAL_Nef_polyhedron.h"
+#include "cgal.h"
+#include "cgalutils.h"
+#include <CGAL/IO/Nef_polyhedron_iostream_3.h>
+#endif
+
+#include <sstream>
+
+static void append_mesh(const shared_ptr<const Geometry> &geom, PolySet &mesh)
+{
+	if (const GeometryGroup *G = dynamic_cast<const GeometryGroup *>(geom.get())) {
+		for (const auto &child : G->getChildren()) {
+			append_mesh(child.second, mesh);
+		}
+	}
+#ifdef ENABLE_CGAL
+	else if (const CGAL_Nef_polyhedron *N = dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get())) {
+		if (auto ps = CGALUtils::getPolySet(*N))
+			mesh.append(*ps);
+		else
+			PRINT("ERROR: Nef->PolySet failed");
+	}
+#endif
+	else if (const PolySet *ps = dynamic_cast<const PolySet *>(geom.get())) {
+		mesh.append(*ps);
+	}
+	else if (dynamic_cast<const Polygon2d *>(geom.get())) {
+		assert(false && "Unsupported file format");
+	} else {
+		assert(false && "Not implemented");
+	}
+}
+
+/*!
+	Writes geom in the native binary mesh format. A single Nef polyhedron
+	additionally stores its exact representation, so importing the file gives
+	back the same Nef.
+*/
+void export_mesh(const shared_ptr<const Geometry> &geom, std::ostream &output)
+{
+	std::string exact;
+#ifdef ENABLE_CGAL
+	if (const CGAL_Nef_polyhedron *N = dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get())) {
+		if (N->get()) {
+			std::ostringstream nef;
+			nef << **N;
+			exact = nef.str();
+		}
+	}
+#endif
+
+	bool ok;
+	if (const PolySet *ps = dynamic_cast<const PolySet *>(geom.get())) {
+		ok = MeshFormat::write(output, *ps);
+	}
+	else {
+		PolySet mesh(3);
+		append_mesh(geom, mesh);
+		mesh.setConvexity(geom->getConvexity());
+		ok = MeshFormat::write(output, mesh, exact);
+	}
+	if (!ok) PRINT("ERROR: Export failed, the mesh has too many vertices.");
+}
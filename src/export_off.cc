@@ -28,6 +28,8 @@
 #include "polyset.h"
 #include "polyset-utils.h"
 #include "dxfdata.h"
+#include "Decimal.h"
+#include "ParallelFormat.h"
 
 #ifdef ENABLE_CGAL
 #include "CGAL_Nef_polyhedron.h"
@@ -38,30 +40,40 @@
 #include "grid.h"
 
 struct IndexedMesh {
-	IndexedMesh() : numfaces(0) {}
+	IndexedMesh() : faceStart(1, 0) {}
 
 	Reindexer<Vector3d> vertices;
 	std::vector<int> indices;
-	size_t numfaces;
+	// the faces' offsets into indices, followed by indices.size()
+	std::vector<size_t> faceStart;
 };
 
+// vertices or faces formatted per chunk, chunks are formatted concurrently
+const size_t OFF_CHUNK_LINES = 4096;
+
 
 static void append_geometry(const PolySet &ps, IndexedMesh &mesh)
 {
+	// merge each shared vertex once, then remap the face indices
+	const std::vector<Vector3d> &vertices = ps.getVertices();
+	std::vector<int> vertexMap(vertices.size(), -1);
+	mesh.indices.reserve(mesh.indices.size() + ps.getIndices().size());
+	mesh.faceStart.reserve(mesh.faceStart.size() + ps.numPolygons());
 	for(const auto &p : ps.getPolygons()) {
-		for(const auto &v : p) {
-			mesh.indices.push_back(mesh.vertices.lookup(v));
+		for (size_t i = 0; i < p.size(); i++) {
+			int &idx = vertexMap[p.index(i)];
+			if (idx < 0) idx = mesh.vertices.lookup(vertices[p.index(i)]);
+			mesh.indices.push_back(idx);
 		}
-		mesh.numfaces++;
-		mesh.indices.push_back(-1);
+		mesh.faceStart.push_back(mesh.indices.size());
 	}
 }
 
 void append_geometry(const shared_ptr<const Geometry> &geom, IndexedMesh &mesh)
 {
 	if (const CGAL_Nef_polyhedron *N = dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get())) {
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*N)) {
-			append_geometry(*PolySetHandle(ps), mesh);
+		if (auto ps = CGALUtils::getPolySet(*N)) {
+			append_geometry(*ps, mesh);
 		}
 		else { 
 			PRINT("ERROR: Nef->PolySet failed"); 
@@ -82,23 +94,36 @@ void export_off(const shared_ptr<const Geometry> &geom, std::ostream &output)
 	IndexedMesh mesh;
 	append_geometry(geom, mesh);
 
-	output << "OFF " << mesh.vertices.size() << " " << mesh.numfaces << " 0\n";
+	size_t numfaces = mesh.faceStart.size() - 1;
+	output << "OFF " << mesh.vertices.size() << " " << numfaces << " 0\n";
 	const Vector3d *v = mesh.vertices.getArray();
-	size_t numverts = mesh.vertices.size();
-	for (size_t i=0;i<numverts;i++) {
-		output << v[i][0] << " " << v[i][1] << " " << v[i][2] << " " << "\n";
-	}
-	size_t cnt = 0;
-	for (size_t i=0;i<mesh.numfaces;i++) {
-		size_t nverts = 0;
-		while (mesh.indices[cnt++] != -1) nverts++;
-		output << nverts;
-		cnt -= nverts + 1;
-		for (size_t n=0;n<nverts;n++) output << " " << mesh.indices[cnt++];
-		output << "\n";
-        cnt++; // Skip the -1 marker
-	}
-
+	write_formatted(output, mesh.vertices.size(), OFF_CHUNK_LINES,
+		[v](size_t begin, size_t end, std::string &text) {
+			// 3 numbers of at most 13 chars and their separators
+			char line[48];
+			for (size_t i = begin; i < end; i++) {
+				char *pos = line;
+				for (int j = 0; j < 3; j++) {
+					pos = Decimal(v[i][j]).write(pos);
+					*pos++ = ' ';
+				}
+				*pos++ = '\n';
+				text.append(line, pos);
+			}
+		});
+	write_formatted(output, numfaces, OFF_CHUNK_LINES,
+		[&mesh](size_t begin, size_t end, std::string &text) {
+			char number[20];
+			for (size_t i = begin; i < end; i++) {
+				size_t first = mesh.faceStart[i], last = mesh.faceStart[i + 1];
+				text.append(number, write_unsigned(number, last - first));
+				for (size_t n = first; n < last; n++) {
+					text += ' ';
+					text.append(number, write_unsigned(number, mesh.indices[n]));
+				}
+				text += '\n';
+			}
+		});
 }
 
 #endif // ENABLE_CGAL
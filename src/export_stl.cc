@@ -28,54 +28,190 @@
 #include "polyset.h"
 #include "polyset-utils.h"
 #include "dxfdata.h"
+#include "Decimal.h"
+#include "ParallelFormat.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <vector>
 
 #ifdef ENABLE_CGAL
 #include "CGAL_Nef_polyhedron.h"
 #include "cgal.h"
 #include "cgalutils.h"
 
+namespace {
+
+// facets are formatted and written in chunks of this many; ASCII chunks
+// are formatted concurrently
+const size_t STL_CHUNK_FACETS = 1024;
+
+/*!
+	Formats ASCII STL facets, appending them to a string.
+*/
+class AsciiStlWriter
+{
+public:
+	// 4 lines of 3 numbers and the fixed text
+	static const size_t MAX_FACET_SIZE = 4 * (3 * 14 + 14) + 64;
+
+	AsciiStlWriter(std::string &text) : text(text) { }
+
+	// returns false for facets which are degenerate after rounding
+	bool add(const Vector3d &normal, const Vector3d &v1, const Vector3d &v2, const Vector3d &v3)
+	{
+		Decimal p[3][3] = {
+			{ v1[0], v1[1], v1[2] },
+			{ v2[0], v2[1], v2[2] },
+			{ v3[0], v3[1], v3[2] }
+		};
+		if (equal(p[0], p[1]) || equal(p[0], p[2]) || equal(p[1], p[2])) return false;
+
+		size_t size = text.size();
+		text.resize(size + MAX_FACET_SIZE);
+		char *pos = &text[size];
+		pos = append(pos, "  facet normal ");
+		pos = append(pos, Decimal(normal[0]), Decimal(normal[1]), Decimal(normal[2]));
+		pos = append(pos, "    outer loop\n");
+		for (const auto &v : p) {
+			pos = append(pos, "      vertex ");
+			pos = append(pos, v[0], v[1], v[2]);
+		}
+		pos = append(pos, "    endloop\n  endfacet\n");
+		text.resize(pos - text.data());
+		return true;
+	}
+
+private:
+	static bool equal(const Decimal *a, const Decimal *b) {
+		return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+	}
+
+	static char *append(char *out, const char *str)
+	{
+		size_t len = strlen(str);
+		memcpy(out, str, len);
+		return out + len;
+	}
+
+	static char *append(char *out, const Decimal &x, const Decimal &y, const Decimal &z)
+	{
+		out = x.write(out);
+		*out++ = ' ';
+		out = y.write(out);
+		*out++ = ' ';
+		out = z.write(out);
+		*out++ = '\n';
+		return out;
+	}
+
+	std::string &text;
+};
+
+/*!
+	Writes little-endian binary STL facets through a fixed-size buffer.
+*/
+class BinaryStlWriter
+{
+public:
+	static const size_t FACET_SIZE = 50;
+
+	BinaryStlWriter(std::ostream &output)
+		: output(output), buffer(STL_CHUNK_FACETS * FACET_SIZE), pos(buffer.data()) { }
+
+	static bool isDegenerate(const Vector3d &v1, const Vector3d &v2, const Vector3d &v3)
+	{
+		return equal(v1, v2) || equal(v1, v3) || equal(v2, v3);
+	}
+
+	void add(const Vector3d &normal, const Vector3d &v1, const Vector3d &v2, const Vector3d &v3)
+	{
+		if (pos == buffer.data() + buffer.size()) flush();
+		pos = append(pos, normal);
+		pos = append(pos, v1);
+		pos = append(pos, v2);
+		pos = append(pos, v3);
+		*pos++ = 0; // attribute byte count
+		*pos++ = 0;
+	}
+
+	void writeHeader(uint32_t numFacets)
+	{
+		// must not start with "solid", which marks ASCII STL
+		char header[80];
+		memset(header, ' ', sizeof(header));
+		memcpy(header, "OpenSCAD Model", 14);
+		output.write(header, sizeof(header));
+		char count[4];
+		append(count, numFacets);
+		output.write(count, sizeof(count));
+	}
+
+	void flush()
+	{
+		output.write(buffer.data(), pos - buffer.data());
+		pos = buffer.data();
+	}
+
+private:
+	// compares the float values written to the file
+	static bool equal(const Vector3d &a, const Vector3d &b) {
+		return float(a[0]) == float(b[0]) && float(a[1]) == float(b[1]) && float(a[2]) == float(b[2]);
+	}
+
+	static char *append(char *out, uint32_t x)
+	{
+		*out++ = x & 0xff;
+		*out++ = (x >> 8) & 0xff;
+		*out++ = (x >> 16) & 0xff;
+		*out++ = (x >> 24) & 0xff;
+		return out;
+	}
+
+	static char *append(char *out, const Vector3d &v)
+	{
+		for (int i = 0; i < 3; ++i) {
+			float f = float(v[i]);
+			uint32_t bits;
+			memcpy(&bits, &f, sizeof(bits));
+			out = append(out, bits);
+		}
+		return out;
+	}
+
+	std::ostream &output;
+	std::vector<char> buffer;
+	char *pos;
+};
+
+// the unit normal of a triangle, 0 0 0 for collinear vertices
+Vector3d facet_normal(const Vector3d &v1, const Vector3d &v2, const Vector3d &v3)
+{
+	Vector3d normal = (v2 - v1).cross(v3 - v1);
+	normal.normalize();
+	if (is_finite(normal) && !is_nan(normal)) return normal;
+	return Vector3d(0, 0, 0);
+}
+
+}
+
 static void append_stl(const PolySet &ps, std::ostream &output)
 {
 	PolySet triangulated(3);
 	PolysetUtils::tessellate_faces(ps, triangulated);
 
-	setlocale(LC_NUMERIC, "C"); // Ensure radix is . (not ,) in output
-	for(const auto &p : triangulated.getPolygons()) {
-		assert(p.size() == 3); // STL only allows triangles
-		std::stringstream stream;
-		stream << p[0][0] << " " << p[0][1] << " " << p[0][2];
-		std::string vs1 = stream.str();
-		stream.str("");
-		stream << p[1][0] << " " << p[1][1] << " " << p[1][2];
-		std::string vs2 = stream.str();
-		stream.str("");
-		stream << p[2][0] << " " << p[2][1] << " " << p[2][2];
-		std::string vs3 = stream.str();
-		if (vs1 != vs2 && vs1 != vs3 && vs2 != vs3) {
-			// The above condition ensures that there are 3 distinct vertices, but
-			// they may be collinear. If they are, the unit normal is meaningless
-			// so the default value of "0 0 0" can be used. If the vertices are not
-			// collinear then the unit normal must be calculated from the
-			// components.
-			output << "  facet normal ";
-			Vector3d normal = (p[1] - p[0]).cross(p[2] - p[0]);
-			normal.normalize();
-			if (is_finite(normal) && !is_nan(normal)) {
-				output << normal[0] << " " << normal[1] << " " << normal[2] << "\n";
-			}
-			else {
-				output << "0 0 0\n";
+	write_formatted(output, triangulated.numPolygons(), STL_CHUNK_FACETS,
+		[&triangulated](size_t begin, size_t end, std::string &text) {
+			AsciiStlWriter writer(text);
+			for (size_t i = begin; i < end; i++) {
+				const PolygonView p = triangulated.getPolygon(i);
+				assert(p.size() == 3); // STL only allows triangles
+				// Facets with 3 distinct vertices may still be collinear. If they are,
+				// the unit normal is meaningless so the default value of "0 0 0" is used.
+				writer.add(facet_normal(p[0], p[1], p[2]), p[0], p[1], p[2]);
 			}
-			output << "    outer loop\n";
-		
-			for(const auto &v : p) {
-				output << "      vertex " << v[0] << " " << v[1] << " " << v[2] << "\n";
-			}
-			output << "    endloop\n";
-			output << "  endfacet\n";
-		}
-	}
-	setlocale(LC_NUMERIC, "");      // Set default locale
+		});
 }
 
 static void append_stl(const CGAL_Polyhedron &P, std::ostream &output)
@@ -85,6 +221,8 @@ static void append_stl(const CGAL_Polyhedron &P, std::ostream &output)
 	typedef CGAL_Polyhedron::Facet_const_iterator                   FCI;
 	typedef CGAL_Polyhedron::Halfedge_around_facet_const_circulator HFCC;
 
+	std::string text;
+	AsciiStlWriter writer(text);
 	for (FCI fi = P.facets_begin(); fi != P.facets_end(); ++fi) {
 		HFCC hc = fi->facet_begin();
 		HFCC hc_end = hc;
@@ -94,50 +232,27 @@ static void append_stl(const CGAL_Polyhedron &P, std::ostream &output)
 		do {
 			v2 = v3;
 			v3 = *VCI((hc++)->vertex());
-			double x1 = CGAL::to_double(v1.point().x());
-			double y1 = CGAL::to_double(v1.point().y());
-			double z1 = CGAL::to_double(v1.point().z());
-			double x2 = CGAL::to_double(v2.point().x());
-			double y2 = CGAL::to_double(v2.point().y());
-			double z2 = CGAL::to_double(v2.point().z());
-			double x3 = CGAL::to_double(v3.point().x());
-			double y3 = CGAL::to_double(v3.point().y());
-			double z3 = CGAL::to_double(v3.point().z());
-			std::stringstream stream;
-			stream << x1 << " " << y1 << " " << z1;
-			std::string vs1 = stream.str();
-			stream.str("");
-			stream << x2 << " " << y2 << " " << z2;
-			std::string vs2 = stream.str();
-			stream.str("");
-			stream << x3 << " " << y3 << " " << z3;
-			std::string vs3 = stream.str();
-			if (vs1 != vs2 && vs1 != vs3 && vs2 != vs3) {
-				// The above condition ensures that there are 3 distinct vertices, but
-				// they may be collinear. If they are, the unit normal is meaningless
-				// so the default value of "1 0 0" can be used. If the vertices are not
-				// collinear then the unit normal must be calculated from the
-				// components.
-				if (!CGAL::collinear(v1.point(),v2.point(),v3.point())) {
-					CGAL_Polyhedron::Traits::Vector_3 normal = CGAL::normal(v1.point(),v2.point(),v3.point());
-					output << "  facet normal "
-								 << CGAL::sign(normal.x()) * sqrt(CGAL::to_double(normal.x()*normal.x()/normal.squared_length()))
-								 << " "
-								 << CGAL::sign(normal.y()) * sqrt(CGAL::to_double(normal.y()*normal.y()/normal.squared_length()))
-								 << " "
-								 << CGAL::sign(normal.z()) * sqrt(CGAL::to_double(normal.z()*normal.z()/normal.squared_length()))
-								 << "\n";
-				}
-				else output << "  facet normal 1 0 0\n";
-				output << "    outer loop\n";
-				output << "      vertex " << vs1 << "\n";
-				output << "      vertex " << vs2 << "\n";
-				output << "      vertex " << vs3 << "\n";
-				output << "    endloop\n";
-				output << "  endfacet\n";
+			Vector3d p1(CGAL::to_double(v1.point().x()), CGAL::to_double(v1.point().y()), CGAL::to_double(v1.point().z()));
+			Vector3d p2(CGAL::to_double(v2.point().x()), CGAL::to_double(v2.point().y()), CGAL::to_double(v2.point().z()));
+			Vector3d p3(CGAL::to_double(v3.point().x()), CGAL::to_double(v3.point().y()), CGAL::to_double(v3.point().z()));
+			// Facets with 3 distinct vertices may still be collinear. If they are,
+			// the unit normal is meaningless so the default value of "1 0 0" is used.
+			Vector3d normal(1, 0, 0);
+			if (!CGAL::collinear(v1.point(),v2.point(),v3.point())) {
+				CGAL_Polyhedron::Traits::Vector_3 n = CGAL::normal(v1.point(),v2.point(),v3.point());
+				normal = Vector3d(
+					CGAL::sign(n.x()) * sqrt(CGAL::to_double(n.x()*n.x()/n.squared_length())),
+					CGAL::sign(n.y()) * sqrt(CGAL::to_double(n.y()*n.y()/n.squared_length())),
+					CGAL::sign(n.z()) * sqrt(CGAL::to_double(n.z()*n.z()/n.squared_length())));
 			}
+			writer.add(normal, p1, p2, p3);
 		} while (hc != hc_end);
+		if (text.size() >= STL_CHUNK_FACETS * AsciiStlWriter::MAX_FACET_SIZE) {
+			output.write(text.data(), text.size());
+			text.clear();
+		}
 	}
+	output.write(text.data(), text.size());
 }
 
 /*!
@@ -152,8 +267,8 @@ static void append_stl(const CGAL_Nef_polyhedron &root_N, std::ostream &output)
 
 	bool usePolySet = true;
 	if (usePolySet) {
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*root_N))
-			append_stl(*PolySetHandle(ps), output);
+		if (auto ps = CGALUtils::getPolySet(root_N))
+			append_stl(*ps, output);
 		else 
 			PRINT("ERROR: Nef->PolySet failed");
 	}
@@ -200,13 +315,66 @@ static void append_stl(const shared_ptr<const Geometry> &geom, std::ostream &out
 
 void export_stl(const shared_ptr<const Geometry> &geom, std::ostream &output)
 {
-	setlocale(LC_NUMERIC, "C"); // Ensure radix is . (not ,) in output
 	output << "solid OpenSCAD_Model\n";
-
 	append_stl(geom, output);
-
 	output << "endsolid OpenSCAD_Model\n";
-	setlocale(LC_NUMERIC, "");      // Set default locale
+}
+
+/*!
+	Collects the triangulated PolySets of geom for binary export, which
+	needs the number of facets up front.
+*/
+static void collect_stl_polysets(const shared_ptr<const Geometry> &geom, std::vector<PolySetHandle> &polysets)
+{
+	if (const GeometryGroup *G = dynamic_cast<const GeometryGroup*>(geom.get())) {
+		for (const auto &child : G->getChildren()) {
+			collect_stl_polysets(child.second, polysets);
+		}
+	}
+	else if (auto N = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
+		if (!(*N)->is_simple()) {
+			PRINT("WARNING: Exported object may not be a valid 2-manifold and may need repair");
+		}
+		// memoized, so exporting a cached Nef again doesn't convert it again
+		if (auto ps = CGALUtils::getPolySet(N))
+			collect_stl_polysets(ps, polysets);
+		else
+			PRINT("ERROR: Nef->PolySet failed");
+	}
+	else if (const PolySet *ps = dynamic_cast<const PolySet *>(geom.get())) {
+		auto triangulated = std::make_shared<PolySet>(3);
+		PolysetUtils::tessellate_faces(*ps, *triangulated);
+		polysets.push_back(triangulated);
+	}
+	else if (const Polygon2d *poly = dynamic_cast<const Polygon2d *>(geom.get())) {
+		assert(false && "Unsupported file format");
+	} else {
+		assert(false && "Not implemented");
+	}
+}
+
+void export_stl_binary(const shared_ptr<const Geometry> &geom, std::ostream &output)
+{
+	std::vector<PolySetHandle> polysets;
+	collect_stl_polysets(geom, polysets);
+
+	uint32_t numFacets = 0;
+	for (const auto &ps : polysets) {
+		for (const auto &p : ps->getPolygons()) {
+			if (!BinaryStlWriter::isDegenerate(p[0], p[1], p[2])) numFacets++;
+		}
+	}
+
+	BinaryStlWriter writer(output);
+	writer.writeHeader(numFacets);
+	for (const auto &ps : polysets) {
+		for (const auto &p : ps->getPolygons()) {
+			assert(p.size() == 3); // STL only allows triangles
+			if (!BinaryStlWriter::isDegenerate(p[0], p[1], p[2]))
+				writer.add(facet_normal(p[0], p[1], p[2]), p[0], p[1], p[2]);
+		}
+	}
+	writer.flush();
 }
 
 #endif // ENABLE_CGAL
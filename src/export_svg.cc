@@ -27,26 +27,49 @@
 #include "export.h"
 #include "polyset.h"
 #include "polyset-utils.h"
+#include "Decimal.h"
+#include "ParallelFormat.h"
+
+#include <algorithm>
+
+// path points formatted per chunk, chunks are formatted concurrently
+static const size_t SVG_CHUNK_POINTS = 4096;
 
 static void append_svg(const Polygon2d &poly, std::ostream &output)
 {
 	output << "<path d=\"\n";
-	for(const auto &o : poly.outlines()) {
-		if (o.vertices.empty()) {
-			continue;
-		}
-		
-		const Eigen::Vector2d& p0 = o.vertices[0];
-		output << "M " << p0.x() << "," << -p0.y();
-		for (unsigned int idx = 1;idx < o.vertices.size();idx++) {
-			const Eigen::Vector2d& p = o.vertices[idx];
-			output << " L " << p.x() << "," << -p.y();
-			if ((idx % 6) == 5) {
-				output << "\n";
-			}
-		}
-		output << " z\n";
+	// the points of all outlines are numbered in one range, which is split into chunks
+	const Polygon2d::Outlines2d &outlines = poly.outlines();
+	std::vector<size_t> outlineStart(1, 0);
+	for (const auto &o : outlines) {
+		outlineStart.push_back(outlineStart.back() + o.vertices.size());
 	}
+	write_formatted(output, outlineStart.back(), SVG_CHUNK_POINTS,
+		[&outlines, &outlineStart](size_t begin, size_t end, std::string &text) {
+			// the outline containing begin, skipping empty ones
+			size_t o = std::upper_bound(outlineStart.begin(), outlineStart.end(), begin) - outlineStart.begin() - 1;
+			// " L " and 2 numbers of at most 13 chars, a line break and " z\n"
+			char point[48];
+			for (size_t i = begin; i < end; i++) {
+				while (i == outlineStart[o + 1]) o++;
+				size_t idx = i - outlineStart[o];
+				const Eigen::Vector2d &p = outlines[o].vertices[idx];
+				char *pos = point;
+				*pos++ = idx == 0 ? 'M' : ' ';
+				if (idx > 0) *pos++ = 'L';
+				*pos++ = ' ';
+				pos = Decimal(p.x()).write(pos);
+				*pos++ = ',';
+				pos = Decimal(-p.y()).write(pos);
+				if ((idx % 6) == 5) *pos++ = '\n';
+				if (i + 1 == outlineStart[o + 1]) {
+					*pos++ = ' ';
+					*pos++ = 'z';
+					*pos++ = '\n';
+				}
+				text.append(point, pos);
+			}
+		});
 	output << "\" stroke=\"black\" fill=\"lightgray\" stroke-width=\"0.5\"/>\n";
 
 }
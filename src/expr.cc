@@ -48,7 +48,11 @@ namespace {
 		return dynamic_cast<const ListComprehension *>(e.get());
 	}
 
-	Value::VectorType flatten(Value::VectorType const& vec) {
+	ValuePtr flatten(Value::VectorType const& vec) {
+		// nested comprehensions of packed vectors are joined without boxing
+		NumericVector packed;
+		if (NumericVector::concat(vec, packed)) return ValuePtr(packed);
+
 		int n = 0;
 		for (unsigned int i = 0; i < vec.size(); i++) {
 			assert(vec[i]->type() == Value::VECTOR);
@@ -58,7 +62,7 @@ namespace {
 		for (unsigned int i = 0; i < vec.size(); i++) {
 			std::copy(vec[i]->toVector().begin(),vec[i]->toVector().end(),std::back_inserter(ret));
 		}
-		return ret;
+		return ValuePtr(ret);
 	}
 
 	void evaluate_sequential_assignment(const AssignmentList &assignment_list, Context *context) {
@@ -357,6 +361,15 @@ void Vector::push_back(Expression *expr)
 
 ValuePtr Vector::evaluate(const Context *context) const
 {
+	// [for (...) ...] is already the complete (possibly packed) vector
+	if (this->children.size() == 1 && isListComprehension(this->children[0])) {
+		ValuePtr tmpval = this->children[0]->evaluate(context);
+		if (tmpval->type() == Value::VECTOR) return tmpval;
+		// not evaluated again, which would repeat any echo() in it
+		Value::VectorType vec = tmpval->toVector();
+		return ValuePtr(vec);
+	}
+
 	Value::VectorType vec;
 	for(const auto &e : this->children) {
 		ValuePtr tmpval = e->evaluate(context);
@@ -412,13 +425,14 @@ void UserStruct::print(std::ostream &stream) const
 	stream << "}";
 }
 
-Lookup::Lookup(const std::string &name, const Location &loc) : Expression(loc), name(name)
+Lookup::Lookup(const std::string &name, const Location &loc)
+	: Expression(loc), name(name), symbol(Symbols::intern(name))
 {
 }
 
 ValuePtr Lookup::evaluate(const Context *context) const
 {
-	return context->lookup_variable(this->name);
+	return context->lookup_variable(this->symbol);
 }
 
 void Lookup::print(std::ostream &stream) const
@@ -427,14 +441,13 @@ void Lookup::print(std::ostream &stream) const
 }
 
 MemberLookup::MemberLookup(const std::string &dotname, const std::string &member, const Location &loc)
-	: Expression(loc), dotname(dotname), member(member)
+	: Expression(loc), dotname(dotname), dotsymbol(Symbols::intern(dotname)), member(member)
 {
 }
 
 ValuePtr MemberLookup::evaluate(const Context *context) const
 {
-	Lookup expr(dotname, loc);
-	ValuePtr v = expr.evaluate(context);
+	ValuePtr v = context->lookup_variable(this->dotsymbol);
 
 	if (v->type() == Value::VECTOR) {
 		if (this->member == "x") return v[0];
@@ -496,7 +509,7 @@ Expression * FunctionCall::create(const std::string &funcname, const AssignmentL
 
 MemberFunctionCall::MemberFunctionCall(const std::string &dotname, const std::string &name,
 	const AssignmentList &args, const Location &loc)
-	: Expression(loc), dotname(dotname), name(name), arguments(args)
+	: Expression(loc), dotname(dotname), dotsymbol(Symbols::intern(dotname)), name(name), arguments(args)
 {
 }
 
@@ -508,8 +521,7 @@ ValuePtr MemberFunctionCall::evaluate(const Context *context) const
 		throw RecursionException::create("function", str.str());
 	}
 
-	Lookup expr(dotname, loc);
-	ValuePtr v = expr.evaluate(context);
+	ValuePtr v = context->lookup_variable(this->dotsymbol);
 	if (v->isDefinedAs(Value::STRUCT)) {
 		auto &scope = v->toStruct();
 		EvalContext ec(context, this->arguments);
@@ -661,7 +673,7 @@ ValuePtr LcEach::evaluate(const Context *context) const
     }
 
     if (isListComprehension(this->expr)) {
-        return ValuePtr(flatten(vec));
+        return flatten(vec);
     } else {
         return ValuePtr(vec);
     }
@@ -686,7 +698,7 @@ ValuePtr LcFor::evaluate(const Context *context) const
     Context assign_context(context);
 
     // comprehension for statements are by the parser reduced to only contain one single element
-    const std::string &it_name = for_context.getArgName(0);
+    SymbolId it_symbol = for_context.getArgSymbol(0);
     ValuePtr it_values = for_context.getArgValue(0, &assign_context);
 
     Context c(context);
@@ -698,22 +710,22 @@ ValuePtr LcFor::evaluate(const Context *context) const
             PRINTB("WARNING: Bad range parameter in for statement: too many elements (%lu).", steps);
         } else {
             for (RangeType::iterator it = range.begin();it != range.end();it++) {
-                c.set_variable(it_name, ValuePtr(*it));
+                c.set_variable(it_symbol, ValuePtr(*it));
                 vec.push_back(this->expr->evaluate(&c));
             }
         }
     } else if (it_values->type() == Value::VECTOR) {
         for (size_t i = 0; i < it_values->toVector().size(); i++) {
-            c.set_variable(it_name, it_values->toVector()[i]);
+            c.set_variable(it_symbol, it_values->toVector()[i]);
             vec.push_back(this->expr->evaluate(&c));
         }
     } else if (it_values->type() != Value::UNDEFINED) {
-        c.set_variable(it_name, it_values);
+        c.set_variable(it_symbol, it_values);
         vec.push_back(this->expr->evaluate(&c));
     }
 
     if (isListComprehension(this->expr)) {
-        return ValuePtr(flatten(vec));
+        return flatten(vec);
     } else {
         return ValuePtr(vec);
     }
@@ -750,7 +762,7 @@ ValuePtr LcForC::evaluate(const Context *context) const
     }    
 
     if (isListComprehension(this->expr)) {
-        return ValuePtr(flatten(vec));
+        return flatten(vec);
     } else {
         return ValuePtr(vec);
     }
@@ -799,9 +811,9 @@ void evaluate_assert(const Context &context, const EvalArguments *evalctx, const
 
 	AssignmentMap assignments = evalctx->resolveArguments(args);
 	for (const auto &arg : args) {
-		auto it = assignments.find(arg.name);
+		auto it = assignments.find(arg.symbol);
 		if (it != assignments.end()) {
-			c.set_variable(arg.name, assignments[arg.name]->evaluate(evalctx->getEvalContext()));
+			c.set_variable(arg.symbol, it->second->evaluate(evalctx->getEvalContext()));
 		}
 	}
 	
@@ -810,7 +822,7 @@ void evaluate_assert(const Context &context, const EvalArguments *evalctx, const
 	if (!condition->toBool()) {
 		std::stringstream msg;
 		msg << "ERROR: Assertion";
-		const Expression *expr = assignments["condition"];
+		const Expression *expr = assignments[args[0].symbol];
 		if (expr) msg << " '" << *expr << "'";
 		msg << " failed, line " << loc.firstLine();
 		const ValuePtr message = c.lookup_variable("message", true);
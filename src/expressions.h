@@ -8,6 +8,7 @@
 #include "value.h"
 #include "memory.h"
 #include "localscope.h"
+#include "Symbol.h"
 
 typedef std::vector<class Assignment> AssignmentList;
 
@@ -143,6 +144,7 @@ public:
 	virtual void print(std::ostream &stream) const;
 private:
 	std::string name;
+	SymbolId symbol;
 };
 
 class MemberLookup : public Expression
@@ -153,6 +155,7 @@ public:
 	virtual void print(std::ostream &stream) const;
 private:
 	std::string dotname;
+	SymbolId dotsymbol;
 	std::string member;
 };
 
@@ -176,6 +179,7 @@ public:
 	virtual void print(std::ostream &stream) const;
 public:
 	std::string dotname;
+	SymbolId dotsymbol;
 	std::string name;
 	AssignmentList arguments;
 };
@@ -29,6 +29,7 @@ const Feature Feature::ExperimentalSvgImport("svg-import", "Enable SVG import.")
 const Feature Feature::ExperimentalCustomizer("customizer", "Enable Customizer");
 const Feature Feature::ExperimentalThreadedTraversal("thread-traversal", "Enable threaded traversal.");
 const Feature Feature::ExperimentalThreadedUnion("thread-union", "Enable threaded unions.");
+const Feature Feature::ExperimentalThreadedFor("thread-for", "Enable threaded <code>for</code> loop instantiation.");
 
 Feature::Feature(const std::string &name, const std::string &description)
 	: enabled(false), name(name), description(description)
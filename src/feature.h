@@ -23,6 +23,7 @@ public:
         static const Feature ExperimentalCustomizer;
 	static const Feature ExperimentalThreadedTraversal;
 	static const Feature ExperimentalThreadedUnion;
+	static const Feature ExperimentalThreadedFor;
 
 	const std::string& get_name() const;
 	const std::string& get_description() const;
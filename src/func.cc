@@ -45,6 +45,7 @@
 #include <cmath>
 #include <limits>
 #include <algorithm>
+#include <mutex>
 
 /*
  Random numbers
@@ -72,6 +73,7 @@ int process_id = getpid();
 
 boost::mt19937 deterministic_rng;
 boost::mt19937 lessdeterministic_rng( std::time(0) + process_id );
+static std::mutex rng_mutex;
 
 static inline double deg2rad(double x)
 {
@@ -140,11 +142,11 @@ ValuePtr builtin_rands(const Context *, const EvalContext *evalctx)
 		size_t numresults = boost_numeric_cast<size_t,double>( numresultsd );
 
 		bool deterministic = false;
+		uint32_t seed = 0;
 		if (n > 3) {
 			ValuePtr v3 = evalctx->getArgValue(3);
 			if (v3->type() != Value::NUMBER) goto quit;
-			uint32_t seed = static_cast<uint32_t>(hash_floating_point( v3->toDouble() ));
-			deterministic_rng.seed( seed );
+			seed = static_cast<uint32_t>(hash_floating_point( v3->toDouble() ));
 			deterministic = true;
 		}
 		Value::VectorType vec;
@@ -152,6 +154,9 @@ ValuePtr builtin_rands(const Context *, const EvalContext *evalctx)
 			for (size_t i=0; i < numresults; i++)
 				vec.push_back(ValuePtr(min));
 		} else {
+			// the generators are shared by threaded for loops
+			std::lock_guard<std::mutex> lock(rng_mutex);
+			if ( deterministic ) deterministic_rng.seed( seed );
 			boost::uniform_real<> distributor( min, max );
 			for (size_t i=0; i < numresults; i++) {
 				if ( deterministic ) {
@@ -441,6 +446,7 @@ ValuePtr builtin_length(const Context *, const EvalContext *evalctx)
 {
 	if (evalctx->numArgs() == 1) {
 		ValuePtr v = evalctx->getArgValue(0);
+		if (auto packed = v->toNumericVector()) return ValuePtr(int(packed->size()));
 		if (v->type() == Value::VECTOR) return ValuePtr(int(v->toVector().size()));
 		if (v->type() == Value::STRING) {
 			//Unicode glyph count for the length -- rather than the string (num. of bytes) length.
@@ -503,10 +509,17 @@ ValuePtr builtin_chr(const Context *, const EvalContext *evalctx)
 
 ValuePtr builtin_concat(const Context *, const EvalContext *evalctx)
 {
+	Value::VectorType args;
+	for (size_t i = 0; i < evalctx->numArgs(); i++) {
+		args.push_back(evalctx->getArgValue(i));
+	}
+	// packed vectors (e.g. point lists) are joined as plain numbers
+	NumericVector packed;
+	if (NumericVector::concat(args, packed)) return ValuePtr(packed);
+
 	Value::VectorType result;
 
-	for (size_t i = 0; i < evalctx->numArgs(); i++) {
-		ValuePtr val = evalctx->getArgValue(i);
+	for (const auto &val : args) {
 		if (val->type() == Value::VECTOR) {
 			for(const auto &v : val->toVector()) { 
 				result.push_back(v);
@@ -796,7 +809,7 @@ ValuePtr builtin_parent_module(const Context *, const EvalContext *evalctx)
 {
 	int n;
 	double d;
-	int s = UserContext::stack_size();
+	int s = UserContext::stack_size(evalctx);
 	if (evalctx->numArgs() == 0)
 		d=1; // parent module
 	else if (evalctx->numArgs() == 1) {
@@ -814,7 +827,7 @@ ValuePtr builtin_parent_module(const Context *, const EvalContext *evalctx)
 		PRINTB("WARNING: Parent module index (%d) greater than the number of modules on the stack", n);
 		return ValuePtr::undefined;
 	}
-	return ValuePtr(UserContext::stack_element(s - 1 - n)->getUserModule()->name);
+	return ValuePtr(UserContext::stack_element(evalctx, s - 1 - n)->getUserModule()->name);
 }
 
 ValuePtr builtin_norm(const Context *, const EvalContext *evalctx)
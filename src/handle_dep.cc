@@ -3,12 +3,15 @@
 #include <sstream>
 #include <stdlib.h> // for system()
 #include <unordered_set>
+#include <mutex>
 #include <boost/regex.hpp>
 #include <boost/filesystem.hpp>
 namespace fs = boost::filesystem;
 
 std::unordered_set<std::string> dependencies;
 const char *make_command = NULL;
+// files may be read by threaded evaluation
+static std::mutex dependencies_mutex;
 
 void handle_dep(const std::string &filename)
 {
@@ -16,6 +19,7 @@ void handle_dep(const std::string &filename)
 	std::string dep;
 	if (filepath.is_absolute()) dep = filename;
 	else dep = (fs::current_path() / filepath).string();
+	std::lock_guard<std::mutex> lock(dependencies_mutex);
 	dependencies.insert(boost::regex_replace(filename, boost::regex("\\ "), "\\\\ "));
 
 	if (!fs::exists(filepath) && make_command) {
@@ -1,5 +1,89 @@
 #include "hash.h"
 #include <boost/functional/hash.hpp>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+	inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+	inline uint64_t fmix64(uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdULL;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ULL;
+		k ^= k >> 33;
+		return k;
+	}
+}
+
+/*!
+	MurmurHash3 x64_128 seeded with the current id, so combining a sequence
+	of inputs chains them in order.
+*/
+void NodeId::combine(const void *data, size_t len)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+	const size_t nblocks = len / 16;
+	const uint64_t c1 = 0x87c37b91114253d5ULL;
+	const uint64_t c2 = 0x4cf5ad432745937fULL;
+	uint64_t h1 = this->hi;
+	uint64_t h2 = this->lo;
+
+	for (size_t i = 0; i < nblocks; ++i) {
+		uint64_t k1, k2;
+		memcpy(&k1, bytes + i * 16, 8);
+		memcpy(&k2, bytes + i * 16 + 8, 8);
+
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	const uint8_t *tail = bytes + nblocks * 16;
+	uint64_t k1 = 0, k2 = 0;
+	switch (len & 15) {
+	case 15: k2 ^= uint64_t(tail[14]) << 48;
+	case 14: k2 ^= uint64_t(tail[13]) << 40;
+	case 13: k2 ^= uint64_t(tail[12]) << 32;
+	case 12: k2 ^= uint64_t(tail[11]) << 24;
+	case 11: k2 ^= uint64_t(tail[10]) << 16;
+	case 10: k2 ^= uint64_t(tail[9]) << 8;
+	case 9: k2 ^= uint64_t(tail[8]);
+		k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+	case 8: k1 ^= uint64_t(tail[7]) << 56;
+	case 7: k1 ^= uint64_t(tail[6]) << 48;
+	case 6: k1 ^= uint64_t(tail[5]) << 40;
+	case 5: k1 ^= uint64_t(tail[4]) << 32;
+	case 4: k1 ^= uint64_t(tail[3]) << 24;
+	case 3: k1 ^= uint64_t(tail[2]) << 16;
+	case 2: k1 ^= uint64_t(tail[1]) << 8;
+	case 1: k1 ^= uint64_t(tail[0]);
+		k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+	}
+
+	h1 ^= len; h2 ^= len;
+	h1 += h2; h2 += h1;
+	h1 = fmix64(h1); h2 = fmix64(h2);
+	h1 += h2; h2 += h1;
+
+	this->hi = h1;
+	this->lo = h2;
+}
+
+std::string NodeId::toString() const
+{
+	std::stringstream str;
+	str << std::hex << std::setfill('0') << std::setw(16) << hi << std::setw(16) << lo;
+	return str.str();
+}
+
+std::ostream &operator<<(std::ostream &stream, const NodeId &id)
+{
+	return stream << id.toString();
+}
 
 namespace std {
 	std::size_t hash<Vector3f>::operator()(const Vector3f &s) const {
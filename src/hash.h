@@ -1,10 +1,43 @@
 #pragma once
 
 #include "linalg.h"
+#include <string>
+#include <ostream>
 
 typedef Eigen::Matrix<int64_t, 3, 1> Vector3l;
 
+/*!
+	A 128-bit structural hash of a node subtree.
+
+	Computed bottom-up from each node's own string and its children's ids,
+	so equal subtrees get equal ids regardless of where they appear.
+	Used as the key of the geometry caches.
+*/
+struct NodeId
+{
+	uint64_t hi;
+	uint64_t lo;
+
+	NodeId() : hi(0), lo(0) { }
+
+	// mixes the given bytes into the id
+	void combine(const void *data, size_t len);
+	void combine(const std::string &str) { combine(str.data(), str.size()); }
+	void combine(const NodeId &id) { combine(&id.hi, sizeof(id.hi)); combine(&id.lo, sizeof(id.lo)); }
+
+	bool isNull() const { return hi == 0 && lo == 0; }
+	bool operator==(const NodeId &other) const { return hi == other.hi && lo == other.lo; }
+	bool operator!=(const NodeId &other) const { return !(*this == other); }
+	bool operator<(const NodeId &other) const { return hi < other.hi || (hi == other.hi && lo < other.lo); }
+
+	// 32 hex digits
+	std::string toString() const;
+};
+
+std::ostream &operator<<(std::ostream &stream, const NodeId &id);
+
 namespace std {
+	template<> struct hash<NodeId> { std::size_t operator()(const NodeId &id) const { return (std::size_t)(id.hi ^ id.lo); } };
 	template<> struct hash<Vector3f> { std::size_t operator()(const Vector3f &s) const; };
 	template<> struct hash<Vector3d> { std::size_t operator()(const Vector3d &s) const; };
 	template<> struct hash<Vector3l> { std::size_t operator()(const Vector3l &s) const; };
@@ -97,6 +97,7 @@ public:
 			else if (ext == ".dxf") actualtype = TYPE_DXF;
 			else if (ext == ".nef3") actualtype = TYPE_NEF3;
 			else if (ext == ".obj") actualtype = TYPE_OBJ;
+			else if (ext == ".osmesh") actualtype = TYPE_MESH;
 			else if (Feature::ExperimentalAmfImport.is_enabled() && ext == ".amf") actualtype = TYPE_AMF;
 			else if (Feature::ExperimentalSvgImport.is_enabled() && ext == ".svg") actualtype = TYPE_SVG;
 		}
@@ -202,6 +203,18 @@ public:
 			g = new GeometryGroup(geoms);
 			break;
 		}
+		case TYPE_MESH: {
+			auto temp = import_mesh(this->filename);
+			if (center) {
+				Transform3d t(Eigen::Translation3d(-temp->getBoundingBox().center()));
+				if (auto ps = dynamic_cast<PolySet *>(temp)) ps->transform(t);
+#ifdef ENABLE_CGAL
+				else if (auto N = dynamic_cast<CGAL_Nef_polyhedron *>(temp)) N->transform(t);
+#endif
+			}
+			g = temp;
+			break;
+		}
 #ifdef ENABLE_CGAL
 		case TYPE_NEF3: {
 			auto temp = import_nef3(this->filename);
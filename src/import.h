@@ -10,3 +10,4 @@ class Polygon2d *import_svg(const std::string &filename);
 class CGAL_Nef_polyhedron *import_nef3(const std::string &filename);
 #endif
 std::vector<PolySet*> import_obj(const std::string &filename);
+class Geometry *import_mesh(const std::string &filename);
@@ -0,0 +1,64 @@
+#include "import.h"
+#include "polyset.h"
+#include "handle_dep.h" // handle_dep()
+#include "printutils.h"
+#include "MappedFile.h"
+#include "MeshFormat.h"
+
+#ifdef ENABLE_CGAL
+#include "CGAL_Nef_polyhedron.h"
+#include "cgal.h"
+#include <CGAL/IO/Nef_polyhedron_iostream_3.h>
+#include <streambuf>
+
+namespace {
+	//! Reads a range of the mapped file without copying it
+	class MemoryBuffer : public std::streambuf
+	{
+	public:
+		MemoryBuffer(const char *begin, const char *end) {
+			char *b = const_cast<char *>(begin);
+			setg(b, b, b + (end - begin));
+		}
+	};
+}
+#endif
+
+/*!
+	Reads a native binary mesh (.osmesh). Files written from a Nef polyhedron
+	are read back as the same exact Nef when CGAL is available, others as a
+	PolySet.
+*/
+Geometry *import_mesh(const std::string &filename)
+{
+	handle_dep(filename);
+	MappedFile file(filename);
+	if (!file.isOpen()) {
+		PRINTB("WARNING: Can't open import file '%s'.", filename);
+		return new PolySet(3);
+	}
+
+	MeshFormat::Header header;
+	if (!MeshFormat::readHeader(file.begin(), file.size(), header)) {
+		PRINTB("WARNING: '%s' is not a valid OpenSCAD mesh file.", filename);
+		return new PolySet(3);
+	}
+
+#ifdef ENABLE_CGAL
+	if (header.flags & MeshFormat::EXACT) {
+		const char *exact = file.begin() + header.exactOffset();
+		MemoryBuffer buffer(exact, exact + header.numExactBytes);
+		std::istream in(&buffer);
+		CGAL_Nef_polyhedron *N = new CGAL_Nef_polyhedron;
+		N->reset(new CGAL_Nef_polyhedron3);
+		in >> **N;
+		if (!in.fail()) {
+			N->setConvexity(header.convexity);
+			return N;
+		}
+		PRINTB("WARNING: Can't read the exact geometry in '%s', using its mesh.", filename);
+		delete N;
+	}
+#endif
+	return MeshFormat::readPolySet(file.begin(), header);
+}
@@ -2,97 +2,120 @@
 #include "polyset.h"
 #include "handle_dep.h" // handle_dep()
 #include "printutils.h"
+#include "MappedFile.h"
+#include "TextScanner.h"
 
-#include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
-#include <boost/lexical_cast.hpp>
-#include <fstream>
+/*!
+	Counts vertices, and faces per group, so the import can reserve its
+	storage up front. Faces before the first group go to an implicit group.
+*/
+static size_t count_obj_elements(const MappedFile &file, std::vector<size_t> &groupFaces)
+{
+	size_t vertices = 0;
+	groupFaces.assign(1, 0);
+	const char *p = file.begin(), *end = file.end();
+	while (p != end) {
+		while (p != end && TextScanner::isBlank(*p)) ++p;
+		if (p != end && (end - p == 1 || TextScanner::isSpace(p[1]))) {
+			if (p[0] == 'v') vertices++;
+			else if (p[0] == 'f') groupFaces.back()++;
+			else if (p[0] == 'g') groupFaces.push_back(0);
+		}
+		const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+		p = nl ? nl + 1 : end;
+	}
+	return vertices;
+}
 
 std::vector<PolySet*> import_obj(const std::string &filename)
 {
 	std::vector<PolySet*> result;
 
 	handle_dep(filename);
-	// Open file and position at the end
-	std::ifstream f(filename.c_str(), std::ios::in);
-	if (!f.good()) {
+	MappedFile file(filename);
+	if (!file.isOpen()) {
 		PRINTB("WARNING: Can't open import file '%s'.", filename);
 		return result;
 	}
 
-	boost::regex ex_obj("\\s*#\\s+object\\s+([^\\s]+)");
-	boost::regex ex_group("\\s*g\\s+([^\\s]+)");
-	boost::regex ex_vertex("\\s*v\\s+([^\\s]+)\\s+([^\\s]+)\\s+([^\\s]+)");
-	std::string faceIdxStr = "\\s+([\\d]+)/([\\d]*)/([\\d]*)";
-	boost::regex ex_face("\\s*f" + faceIdxStr + faceIdxStr + faceIdxStr);
+	std::vector<size_t> groupFaces;
+	std::vector<Vector3d> vertices;
+	vertices.reserve(count_obj_elements(file, groupFaces));
+	size_t groupIdx = 0;
 
 	Grid3d<size_t> grid(GRID_FINE);
-	std::vector<Vector3d> vertices;
-	std::vector<std::string> vlines;
 	PolySet *p = nullptr;
-	std::string obj;
-	std::string group;
-	std::string line;
-	std::getline(f, line);
-	while (!f.eof()) {
-		boost::trim(line);
-		boost::smatch results;
-		if (boost::regex_search(line, results, ex_obj)) {
-			obj = results[1];
-			PRINTB("Object: %s", obj);
-		}
-		else if (boost::regex_search(line, results, ex_group)) {
-			if (p != nullptr) {
-				//PRINTB("Validating PolySet: %s", group);
-				//p->validate();
+	// maps file vertices to the vertices of the current group's PolySet
+	std::vector<int> vertexMap;
+	IndexedFace face;
+	TextScanner scanner(file.begin(), file.end());
+	while (!scanner.atEnd()) {
+		scanner.skipBlanks();
+		if (scanner.keyword("#")) {
+			scanner.skipBlanks();
+			if (scanner.keyword("object")) {
+				scanner.skipBlanks();
+				PRINTB("Object: %s", scanner.token());
 			}
-			group = results[1];
+		}
+		else if (scanner.keyword("g")) {
+			scanner.skipBlanks();
+			std::string group = scanner.token();
 			PRINTB("Creating PolySet: %s", group);
 			p = new PolySet(3);
+			p->reserve(groupFaces[++groupIdx]);
 			result.push_back(p);
+			vertexMap.clear();
 			grid = Grid3d<size_t>(GRID_FINE);
 		}
-		else if (boost::regex_search(line, results, ex_vertex)) {
-			Vector3d vdata;
-			try {
-				for (int v = 0; v < 3; v++) {
-					vdata[v] = boost::lexical_cast<double>(results[v + 1]);
+		else if (scanner.keyword("v")) {
+			Vector3d vdata(0, 0, 0);
+			for (int v = 0; v < 3; v++) {
+				scanner.skipBlanks();
+				if (!scanner.parseDouble(vdata[v])) {
+					PRINTB("WARNING: Can't parse vertex line '%s'.", scanner.line());
+					break;
 				}
 			}
-			catch (const boost::bad_lexical_cast &blc) {
-				PRINTB("WARNING: Can't parse vertex line '%s'.", line);
-			}
 			grid.align(vdata);
 			vertices.push_back(vdata);
-			vlines.push_back(line);
 		}
-		else if (boost::regex_search(line, results, ex_face)) {
-			int idata[3] = { 0 };
-			try {
-				for (int i = 0; i < 3; ++i) {
-					idata[i] = boost::lexical_cast<int>(results[i * 3 + 1]) - 1;
+		else if (scanner.keyword("f")) {
+			// vertex references are v, v/vt, v//vn or v/vt/vn; negative ones count back
+			face.clear();
+			bool ok = true;
+			while (ok) {
+				scanner.skipBlanks();
+				if (scanner.atEol()) break;
+				long idx;
+				ok = scanner.parseInt(idx);
+				if (ok) {
+					if (idx < 0) idx += vertices.size() + 1;
+					ok = idx >= 1 && size_t(idx) <= vertices.size();
 				}
+				if (ok) face.push_back(idx - 1);
+				scanner.token(); // texture and normal references
 			}
-			catch (const boost::bad_lexical_cast &blc) {
-				PRINTB("WARNING: Can't parse face line '%s'.", line);
+			if (!ok || face.size() < 3) {
+				PRINTB("WARNING: Can't parse face line '%s'.", scanner.line());
+			}
+			else {
+				if (!p) {
+					p = new PolySet(3);
+					p->reserve(groupFaces[0]);
+					result.push_back(p);
+				}
+				// vertices are added to the group when a face first uses them
+				vertexMap.resize(vertices.size(), -1);
+				for (auto &idx : face) {
+					int &mapped = vertexMap[idx];
+					if (mapped < 0) mapped = p->add_vertex(vertices[idx]);
+					idx = mapped;
+				}
+				p->append_face(face);
 			}
-			//if (vertices[idata[0]].squaredNorm() == 0 || vertices[idata[1]].squaredNorm() == 0 || vertices[idata[2]].squaredNorm() == 0) {
-			//	PRINTB("Adding face with zero-point: %s", line);
-			//	PRINTB("  %d: %s", idata[0] % vlines[idata[0]]);
-			//	PRINTB("  %d: %s", idata[1] % vlines[idata[1]]);
-			//	PRINTB("  %d: %s", idata[2] % vlines[idata[2]]);
-			//}
-			p->append_poly();
-			p->append_vertex(vertices[idata[0]]);
-			p->append_vertex(vertices[idata[1]]);
-			p->append_vertex(vertices[idata[2]]);
 		}
-		std::getline(f, line);
-	}
-
-	if (p != nullptr) {
-		//PRINTB("Validating PolySet: %s", group);
-		//p->validate();
+		scanner.nextLine();
 	}
 
 	return result;
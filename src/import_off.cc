@@ -1,27 +1,116 @@
 #include "import.h"
 #include "polyset.h"
+#include "handle_dep.h" // handle_dep()
 #include "printutils.h"
-#ifdef ENABLE_CGAL
-#include "cgalutils.h"
-#endif
+#include "MappedFile.h"
+#include "TextScanner.h"
 
+/*!
+	Skips whitespace and '#' comments, including line breaks.
+*/
+static void skip_off_space(TextScanner &scanner)
+{
+	for (;;) {
+		scanner.skipSpace();
+		if (scanner.atEnd() || *scanner.position() != '#') break;
+		scanner.nextLine();
+	}
+}
+
+static bool read_off_count(TextScanner &scanner, long &count)
+{
+	skip_off_space(scanner);
+	return scanner.parseInt(count) && count >= 0;
+}
+
+/*!
+	Reads ASCII OFF files. The optional ST, C and N header prefixes are
+	accepted; texture coordinates, colors and normals are ignored.
+*/
 PolySet *import_off(const std::string &filename)
 {
 	PolySet *p = new PolySet(3);
-#ifdef ENABLE_CGAL
-	CGAL_Polyhedron poly;
-	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
-	if (!file.good()) {
+
+	handle_dep(filename);
+	MappedFile file(filename);
+	if (!file.isOpen()) {
 		PRINTB("WARNING: Can't open import file '%s'.", filename);
+		return p;
 	}
-	else {
-		file >> poly;
-		file.close();
-		bool err = CGALUtils::createPolySetFromPolyhedron(poly, *p);
+
+	TextScanner scanner(file.begin(), file.end());
+	skip_off_space(scanner);
+	std::string header = scanner.token();
+	size_t prefix = header.size() < 3 ? std::string::npos : header.size() - 3;
+	if (prefix == std::string::npos || header.compare(prefix, 3, "OFF") != 0 ||
+			header.find_first_not_of("STCN") < prefix) {
+		PRINTB("WARNING: '%s' is not an ASCII OFF file.", filename);
+		return p;
+	}
+	scanner.skipBlanks();
+	if (scanner.keyword("BINARY")) {
+		PRINTB("WARNING: Binary OFF import is not supported: '%s'.", filename);
+		return p;
+	}
+
+	long numVertices, numFaces, numEdges;
+	if (!read_off_count(scanner, numVertices) || !read_off_count(scanner, numFaces) ||
+			!read_off_count(scanner, numEdges)) {
+		PRINTB("WARNING: Can't parse OFF header in '%s'.", filename);
+		return p;
+	}
+	// reject counts the file is too short to hold before allocating for them
+	long size = long(file.size());
+	if (numVertices > size / 6 || numFaces > size / 8) {
+		PRINTB("WARNING: Can't parse OFF header in '%s'.", filename);
+		return p;
+	}
+
+	std::vector<Vector3d> vertices(numVertices);
+	for (auto &v : vertices) {
+		// OFF is whitespace-tokenized, so coordinates may wrap across lines;
+		// anything after the last one (colors, normals) is skipped
+		for (int j = 0; j < 3; j++) {
+			skip_off_space(scanner);
+			if (!scanner.parseDouble(v[j])) {
+				PRINTB("WARNING: Can't parse vertex line '%s'.", scanner.line());
+				return p;
+			}
+		}
+		scanner.nextLine();
+	}
+
+	// vertices are added to the PolySet when a face first uses them
+	std::vector<int> vertexMap(numVertices, -1);
+	p->reserve(numFaces);
+	IndexedFace face;
+	for (long i = 0; i < numFaces; i++) {
+		long n;
+		if (!read_off_count(scanner, n)) {
+			PRINTB("WARNING: Can't parse face line '%s'.", scanner.line());
+			return p;
+		}
+		face.clear();
+		bool ok = true;
+		for (long j = 0; j < n && ok; j++) {
+			long idx;
+			skip_off_space(scanner);
+			ok = scanner.parseInt(idx) && idx >= 0 && idx < numVertices;
+			if (ok) face.push_back(idx);
+		}
+		if (!ok || n < 3) {
+			PRINTB("WARNING: Can't parse face line '%s'.", scanner.line());
+		}
+		else {
+			for (auto &idx : face) {
+				int &mapped = vertexMap[idx];
+				if (mapped < 0) mapped = p->add_vertex(vertices[idx]);
+				idx = mapped;
+			}
+			p->append_face(face);
+		}
+		// skips face colors
+		scanner.nextLine();
 	}
-#else
-  PRINT("WARNING: OFF import requires CGAL.");
-#endif
 	return p;
 }
-	
@@ -2,53 +2,82 @@
 #include "polyset.h"
 #include "handle_dep.h" // handle_dep()
 #include "printutils.h"
+#include "MappedFile.h"
+#include "TextScanner.h"
 
-#include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
-#include <boost/lexical_cast.hpp>
-#include <fstream>
+#include <cstring>
 
+#define STL_HEADER_NUMBYTES 80
 #define STL_FACET_NUMBYTES 4*3*4+2
+// a rough lower bound on the size of an ASCII facet, used to reserve polygons
+#define STL_ASCII_FACET_NUMBYTES 160
+
 // as there is no 'float32_t' standard, we assume the systems 'float'
 // is a 'binary32' aka 'single' standard IEEE 32-bit floating point type
-union stl_facet {
-	uint8_t data8[ STL_FACET_NUMBYTES ];
-	uint32_t data32[4*3];
-	struct facet_data {
-	  float i, j, k;
-	  float x1, y1, z1;
-	  float x2, y2, z2;
-	  float x3, y3, z3;
-	  uint16_t attribute_byte_count;
-	} data;
-};
+static uint32_t read_uint32_le(const char *data)
+{
+	const unsigned char *b = reinterpret_cast<const unsigned char *>(data);
+	return uint32_t(b[0]) | (uint32_t(b[1]) << 8) | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+}
 
-static void uint32_byte_swap(uint32_t &x)
+static double read_float_le(const char *data)
 {
-#if __GNUC__ >= 4 && __GNUC_MINOR__ >= 3
-	x = __builtin_bswap32( x );
-#elif defined(__clang__)
-	x = __builtin_bswap32( x );
-#elif defined(_MSC_VER)
-	x = _byteswap_ulong( x );
-#else
-	uint32_t b1 = ( 0x000000FF & x ) << 24;
-	uint32_t b2 = ( 0x0000FF00 & x ) << 8;
-	uint32_t b3 = ( 0x00FF0000 & x ) >> 8;
-	uint32_t b4 = ( 0xFF000000 & x ) >> 24;
-	x = b1 | b2 | b3 | b4;
-#endif
+	uint32_t bits = read_uint32_le(data);
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
 }
 
-static void read_stl_facet(std::ifstream &f, stl_facet &facet)
+static void import_stl_binary(const char *data, uint32_t facenum, PolySet &p)
 {
-	f.read( (char*)facet.data8, STL_FACET_NUMBYTES );
-#ifdef BOOST_BIG_ENDIAN
-	for ( int i = 0; i < 12; i++ ) {
-		uint32_byte_swap( facet.data32[ i ] );
+	p.reserve(facenum);
+	for (uint32_t i = 0; i < facenum; i++, data += STL_FACET_NUMBYTES) {
+		// skip the normal; we ignore the attribute byte count
+		const char *v = data + 12;
+		Polygon poly;
+		poly.resize(3);
+		for (int j = 0; j < 3; j++, v += 12) {
+			poly[j] = Vector3d(read_float_le(v), read_float_le(v + 4), read_float_le(v + 8));
+		}
+		p.append_poly(std::move(poly));
+	}
+}
+
+static void import_stl_ascii(const MappedFile &file, PolySet &p)
+{
+	p.reserve(file.size() / STL_ASCII_FACET_NUMBYTES);
+
+	TextScanner scanner(file.begin(), file.end());
+	// skip the "solid" line
+	scanner.nextLine();
+
+	int i = 0;
+	Polygon poly;
+	poly.resize(3);
+	while (!scanner.atEnd()) {
+		scanner.skipSpace();
+		if (scanner.keyword("outer")) {
+			i = 0;
+		}
+		else if (scanner.keyword("vertex")) {
+			Vector3d &v = poly[i < 3 ? i : 0];
+			bool ok = i < 10;
+			for (int j = 0; ok && j < 3; j++) {
+				scanner.skipBlanks();
+				ok = scanner.parseDouble(v[j]);
+			}
+			if (!ok) {
+				if (i < 10) PRINTB("WARNING: Can't parse vertex line '%s'.", scanner.line());
+				i = 10;
+			}
+			else if (++i == 3) {
+				p.append_poly(std::move(poly));
+				poly = Polygon();
+				poly.resize(3);
+			}
+		}
+		scanner.nextLine();
 	}
-	// we ignore attribute byte count
-#endif
 }
 
 PolySet *import_stl(const std::string &filename)
@@ -56,83 +85,23 @@ PolySet *import_stl(const std::string &filename)
 	PolySet *p = new PolySet(3);
 
 	handle_dep(filename);
-	// Open file and position at the end
-	std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
-	if (!f.good()) {
+	MappedFile file(filename);
+	if (!file.isOpen()) {
 		PRINTB("WARNING: Can't open import file '%s'.", filename);
 		return p;
 	}
-	
-	boost::regex ex_sfe("solid|facet|endloop");
-	boost::regex ex_outer("outer loop");
-	boost::regex ex_vertex("vertex");
-	boost::regex ex_vertices("\\s*vertex\\s+([^\\s]+)\\s+([^\\s]+)\\s+([^\\s]+)");
-	
-	bool binary = false;
-	std::streampos file_size = f.tellg();
-	f.seekg(80);
-	if (f.good() && !f.eof()) {
-		uint32_t facenum = 0;
-		f.read((char *)&facenum, sizeof(uint32_t));
-#ifdef BOOST_BIG_ENDIAN
-		uint32_byte_swap( facenum );
-#endif
-		if (file_size ==  static_cast<std::streamoff>(80 + 4 + 50*facenum)) {
-			binary = true;
-		}
-	}
-	f.seekg(0);
-	
-	char data[5];
-	f.read(data, 5);
-	if (!binary && !f.eof() && f.good() && !memcmp(data, "solid", 5)) {
-		int i = 0;
-		double vdata[3][3];
-		std::string line;
-		std::getline(f, line);
-		while (!f.eof()) {
-			std::getline(f, line);
-			boost::trim(line);
-			if (boost::regex_search(line, ex_sfe)) {
-				continue;
-			}
-			if (boost::regex_search(line, ex_outer)) {
-				i = 0;
-				continue;
-			}
-			boost::smatch results;
-			if (boost::regex_search(line, results, ex_vertices)) {
-				try {
-					for (int v=0;v<3;v++) {
-						vdata[i][v] = boost::lexical_cast<double>(results[v+1]);
-					}
-				}
-				catch (const boost::bad_lexical_cast &blc) {
-					PRINTB("WARNING: Can't parse vertex line '%s'.", line);
-					i = 10;
-					continue;
-				}
-				if (++i == 3) {
-					p->append_poly();
-					p->append_vertex(vdata[0][0], vdata[0][1], vdata[0][2]);
-					p->append_vertex(vdata[1][0], vdata[1][1], vdata[1][2]);
-					p->append_vertex(vdata[2][0], vdata[2][1], vdata[2][2]);
-				}
-			}
+
+	const char *data = file.begin();
+	size_t file_size = file.size();
+	if (file_size >= STL_HEADER_NUMBYTES + 4) {
+		uint32_t facenum = read_uint32_le(data + STL_HEADER_NUMBYTES);
+		if (file_size == STL_HEADER_NUMBYTES + 4 + uint64_t(STL_FACET_NUMBYTES) * facenum) {
+			import_stl_binary(data + STL_HEADER_NUMBYTES + 4, facenum, *p);
+			return p;
 		}
 	}
-	else if (binary && !f.eof() && f.good())
-	{
-		f.ignore(80-5+4);
-		while (1) {
-			stl_facet facet;
-			read_stl_facet( f, facet );
-			if (f.eof()) break;
-			p->append_poly();
-			p->append_vertex(facet.data.x1, facet.data.y1, facet.data.z1);
-			p->append_vertex(facet.data.x2, facet.data.y2, facet.data.z2);
-			p->append_vertex(facet.data.x3, facet.data.y3, facet.data.z3);
-		}
+	if (file_size >= 5 && !memcmp(data, "solid", 5)) {
+		import_stl_ascii(file, *p);
 	}
 	return p;
 }
@@ -12,4 +12,5 @@ enum import_type_e {
 	TYPE_DXF,
 	TYPE_NEF3,
 	TYPE_OBJ,
+	TYPE_MESH,
 };
@@ -272,9 +272,7 @@ public:
 			ps_bot->translate(originBot);
 
 			// Flip vertex ordering for bottom polygon
-			for (Polygon &p : ps_bot->getPolygons()) {
-				std::reverse(p.begin(), p.end());
-			}
+			ps_bot->reverse_faces();
 
 			ps->append(*ps_bot);
 			delete ps_bot;
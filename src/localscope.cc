@@ -13,36 +13,42 @@
 
 NamedASTNode::NamedASTNode(const Assignment &ass)
 	: name(ass.name)
+	, symbol(ass.symbol)
 	, node(ass.expr)
 {
 }
 
 NamedASTNode::NamedASTNode(std::string name, UserStruct *s)
 	: name(name)
+	, symbol(0)
 	, node(s)
 {
 }
 
 NamedASTNode::NamedASTNode(std::string name, UserFunction *f)
 	: name(name)
+	, symbol(0)
 	, node(f)
 {
 }
 
 NamedASTNode::NamedASTNode(std::string name, UserModule *m)
 	: name(name)
+	, symbol(0)
 	, node(m)
 {
 }
 
 NamedASTNode::NamedASTNode(std::string name, ModuleInstantiation *mi)
 	: name(name)
+	, symbol(0)
 	, node(mi)
 {
 }
 
 NamedASTNode::NamedASTNode(std::string name, class Expression *e)
 	: name(name)
+	, symbol(Symbols::intern(name))
 	, node(e)
 {
 }
@@ -172,7 +178,7 @@ void LocalScope::apply(Context &ctx) const
 {
 	for (const auto &aos : this->orderedDefinitions) {
 		if (auto e = dynamic_pointer_cast<Expression>(aos.node)) {
-			ctx.set_variable(aos.name, e->evaluate(&ctx));
+			ctx.set_variable(aos.symbol, e->evaluate(&ctx));
 		}
 	}
 }
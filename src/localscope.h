@@ -3,10 +3,12 @@
 #include <unordered_map>
 #include <vector>
 #include "Handles.h"
+#include "Symbol.h"
 
 struct NamedASTNode
 {
 	std::string name;
+	SymbolId symbol; // of value definitions, for Context
 	std::shared_ptr<class ASTNode> node;
 
 	NamedASTNode(const class Assignment &ass);
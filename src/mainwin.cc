@@ -27,6 +27,7 @@
 #include "comment.h"
 #include "openscad.h"
 #include "GeometryCache.h"
+#include "MemoryBudget.h"
 #include "ModuleCache.h"
 #include "MainWindow.h"
 #include "OpenSCADApp.h"
@@ -394,6 +395,7 @@ MainWindow::MainWindow(const QString &filename)
 	connect(this->fileActionExportSTL, SIGNAL(triggered()), this, SLOT(actionExportSTL()));
 	connect(this->fileActionExportOFF, SIGNAL(triggered()), this, SLOT(actionExportOFF()));
 	connect(this->fileActionExportAMF, SIGNAL(triggered()), this, SLOT(actionExportAMF()));
+	connect(this->fileActionExport3MF, SIGNAL(triggered()), this, SLOT(actionExport3MF()));
 	connect(this->fileActionExportDXF, SIGNAL(triggered()), this, SLOT(actionExportDXF()));
 	connect(this->fileActionExportSVG, SIGNAL(triggered()), this, SLOT(actionExportSVG()));
 	connect(this->fileActionExportCSG, SIGNAL(triggered()), this, SLOT(actionExportCSG()));
@@ -1930,6 +1932,7 @@ void MainWindow::compileCSG(bool procevents)
 #ifdef ENABLE_CGAL
 		CGALCache::instance()->print();
 #endif
+		MemoryBudget::instance()->print();
 		if (procevents) QApplication::processEvents();
 	}
 	catch (const ProgressCancelException &e) {
@@ -2111,6 +2114,7 @@ void MainWindow::actionRenderDone(shared_ptr<const Geometry> root_geom)
 #ifdef ENABLE_CGAL
 		CGALCache::instance()->print();
 #endif
+		MemoryBudget::instance()->print();
 			
 		if (root_geom && !root_geom->isEmpty())
 			printGeometry(root_geom.get());
@@ -2339,6 +2343,11 @@ void MainWindow::actionExportAMF()
 	actionExport(OPENSCAD_AMF, "AMF", ".amf", 3);
 }
 
+void MainWindow::actionExport3MF()
+{
+	actionExport(OPENSCAD_3MF, "3MF", ".3mf", 3);
+}
+
 void MainWindow::actionExportDXF()
 {
 	actionExport(OPENSCAD_DXF, "DXF", ".dxf", 2);
@@ -28,7 +28,7 @@ ScopeContext::ScopeContext(const Context *parent, const LocalScope &scope, const
 
 void ScopeContext::persist(LocalScope &scope) const
 {
-	for (auto &v : this->persist_variables)
+	for (auto &v : this->persistentVariables())
 		scope.addValue(v.first, v.second);
 	for (auto &f : *this->functions_p) {
 		if (auto uf = dynamic_cast<UserFunction*>(f.second))
@@ -181,37 +181,31 @@ std::string ModuleContext::dump(const AbstractModule *mod, const ModuleInstantia
 	 	if (m) {
 			s << "  module args:";
 			for(const auto &arg : m->definition_arguments) {
-				s << boost::format("    %s = %s") % arg.name % variables[arg.name];
+				s << boost::format("    %s = %s") % arg.name % variables[arg.symbol];
 			}
 		}
 	}
-	typedef std::pair<std::string, ValuePtr> ValueMapType;
 	s << "  vars:";
-	for(const auto &v : constants) {
-		s << boost::format("    %s = %s") % v.first % v.second;
-	}
 	for(const auto &v : variables) {
-		s << boost::format("    %s = %s") % v.first % v.second;
+		s << boost::format("    %s = %s") % Symbols::name(v.first) % v.second;
 	}
 	for(const auto &v : config_variables) {
-		s << boost::format("    %s = %s") % v.first % v.second;
+		s << boost::format("    %s = %s") % Symbols::name(v.first) % v.second;
 	}
 	return s.str();
 }
 #endif
 
-std::vector<UserContext*> UserContext::moduleStack;
-
 UserContext::UserContext(const Context *ctx, const UserModule *module, const ModuleContext *evalctx)
 	: ScopeContext(ctx)
 	, module(module)
 	, evalctx(evalctx)
 {
 	setType<UserContext>();
-	moduleStack.push_back(this);
+	this->ctx_stack->modules.push_back(this);
 	setVariables(module->definition_arguments, evalctx);
 	set_variable("$children", ValuePtr(double(evalctx->numChildren())));
-	set_variable("$parent_modules", ValuePtr(double(moduleStack.size())));
+	set_variable("$parent_modules", ValuePtr(double(this->ctx_stack->modules.size())));
 	// FIXME: Don't access module members directly
 	this->functions_p = &module->scope.functions;
 	this->modules_p = &module->scope.modules;
@@ -221,7 +215,7 @@ UserContext::UserContext(const Context *ctx, const UserModule *module, const Mod
 
 UserContext::~UserContext()
 {
-	moduleStack.pop_back();
+	this->ctx_stack->modules.pop_back();
 }
 
 FileContext::FileContext(const Context *parent, const FileModule &module) 
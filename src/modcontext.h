@@ -72,10 +72,10 @@ private:
 */
 class UserContext : public ScopeContext
 {
-	static std::vector<UserContext*> moduleStack;
 public:
-	static const UserContext* stack_element(int n) { return moduleStack[n]; };
-	static int stack_size() { return moduleStack.size(); };
+	// the user module calls on ctx's stack, see Context::moduleStack()
+	static const UserContext* stack_element(const Context *ctx, int n) { return ctx->moduleStack()[n]; };
+	static int stack_size(const Context *ctx) { return ctx->moduleStack().size(); };
 public:
 	static std::string contextType() { return "UserContext"; }
 
@@ -43,10 +43,46 @@
 
 size_t AbstractNode::idx_counter(1);
 
+// the counter of the active IndexScope of this thread
+static thread_local size_t *scope_idx_counter = nullptr;
+
+size_t AbstractNode::nextIndex()
+{
+	return scope_idx_counter ? (*scope_idx_counter)++ : idx_counter++;
+}
+
+AbstractNode::IndexScope::IndexScope()
+	: counter(0)
+	, previous(scope_idx_counter)
+{
+	scope_idx_counter = &this->counter;
+}
+
+AbstractNode::IndexScope::~IndexScope()
+{
+	scope_idx_counter = previous;
+}
+
+size_t AbstractNode::reserveIndices(size_t count)
+{
+	size_t &counter = scope_idx_counter ? *scope_idx_counter : idx_counter;
+	size_t first = counter;
+	counter += count;
+	return first;
+}
+
+void AbstractNode::offsetIndices(const NodeHandles &nodes, size_t offset)
+{
+	for (const auto &node : nodes) {
+		node->idx += offset;
+		offsetIndices(node->children, offset);
+	}
+}
+
 AbstractNode::AbstractNode()
 	: /*parent(nullptr)
 	, */nodeFlags(NodeFlags::None)
-	, idx(idx_counter++)
+	, idx(nextIndex())
 {
 }
 
@@ -26,6 +26,7 @@ class AbstractNode : public BaseVisitable
   //  -> remove and
 	// use smth. else to display node identifier in CSG tree output?
 	static size_t idx_counter;   // Node instantiation index
+	static size_t nextIndex();
 public:
 	VISITABLE();
 
@@ -45,6 +46,28 @@ public:
 
 	static void resetIndexCounter() { idx_counter = 0; }
 
+	/*!
+		Numbers the nodes created by the calling thread from 0 while alive,
+		for subtrees instantiated concurrently. Once the subtrees are put in
+		order, reserveIndices() and offsetIndices() move them to the indices
+		they would have had if they were instantiated one after another.
+	*/
+	class IndexScope
+	{
+	public:
+		IndexScope();
+		~IndexScope();
+		size_t count() const { return counter; }
+	private:
+		size_t counter;
+		size_t *previous;
+	};
+
+	// reserves count indices from the current counter, returns the first one
+	static size_t reserveIndices(size_t count);
+	// adds offset to the indices of nodes and all their descendants
+	static void offsetIndices(const NodeHandles &nodes, size_t offset);
+
 	bool isBackground() const { return (this->nodeFlags & NodeFlags::Background) != 0; }
 	bool isHighlight() const { return (this->nodeFlags & NodeFlags::Highlight) != 0; }
 	bool isRoot() const { return (this->nodeFlags & NodeFlags::Root) != 0; }
@@ -46,6 +46,9 @@
 #include "FontCache.h"
 #include "OffscreenView.h"
 #include "GeometryEvaluator.h"
+#include "DiskCache.h"
+#include "MemoryBudget.h"
+#include "Profiler.h"
 
 #ifdef PARAMETER_UI
 #include"parameter/parameterset.h"
@@ -93,6 +96,7 @@ std::string commandline_commands;
 std::string currentdir;
 static bool arg_info = false;
 static std::string arg_colorscheme;
+static std::string arg_export_format;
 
 #define QUOTE(x__) # x__
 #define QUOTED(x__) QUOTE(x__)
@@ -148,7 +152,9 @@ static void help(const char *progname, bool failure = false)
          "%2%[ --imgsize=width,height ] [ --projection=(o)rtho|(p)ersp] \\\n"
          "%2%[ --render | --preview[=throwntogether] ] \\\n"
          "%2%[ --colorscheme=[Cornfield|Sunset|Metallic|Starnight|BeforeDawn|Nature|DeepOcean] ] \\\n"
-         "%2%[ --csglimit=num ]"
+         "%2%[ --csglimit=num ] [ --cache-dir=directory ] [ --memory-budget=MB ] \\\n"
+         "%2%[ --export-format=asciistl|binstl ] \\\n"
+         "%2%[ --profile=file.json ] [ --profile-format=trace|flat ]"
 #ifdef ENABLE_EXPERIMENTAL
          " [ --enable=<feature> ] \\\n"
          "%2%[ -p <Parameter Filename>] [-P <Parameter Set>] "
@@ -359,6 +365,7 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	const char *stl_output_file = NULL;
 	const char *off_output_file = NULL;
 	const char *amf_output_file = NULL;
+	const char *threemf_output_file = NULL;
 	const char *dxf_output_file = NULL;
 	const char *svg_output_file = NULL;
 	const char *csg_output_file = NULL;
@@ -368,6 +375,7 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	const char *echo_output_file = NULL;
 	const char *nefdbg_output_file = NULL;
 	const char *nef3_output_file = NULL;
+	const char *mesh_output_file = NULL;
 
 	std::string suffix = fs::path(output_file).extension().generic_string();
 	boost::algorithm::to_lower( suffix );
@@ -375,6 +383,7 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	if (suffix == ".stl") stl_output_file = output_file;
 	else if (suffix == ".off") off_output_file = output_file;
 	else if (suffix == ".amf") amf_output_file = output_file;
+	else if (suffix == ".3mf") threemf_output_file = output_file;
 	else if (suffix == ".dxf") dxf_output_file = output_file;
 	else if (suffix == ".svg") svg_output_file = output_file;
 	else if (suffix == ".csg") csg_output_file = output_file;
@@ -384,6 +393,7 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	else if (suffix == ".echo") echo_output_file = output_file;
 	else if (suffix == ".nefdbg") nefdbg_output_file = output_file;
 	else if (suffix == ".nef3") nef3_output_file = output_file;
+	else if (suffix == ".osmesh") mesh_output_file = output_file;
 	else {
 		PRINTB("Unknown suffix for output file %s\n", output_file);
 		return 1;
@@ -415,9 +425,12 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
 	text += "\n" + commandline_commands;
 	fs::path abspath = fs::absolute(filename);
-	if(!parse(root_module, text.c_str(), abspath, false)) {
-		delete root_module;  // parse failed
-		root_module = NULL;
+	{
+		Profiler::Span span("parse");
+		if(!parse(root_module, text.c_str(), abspath, false)) {
+			delete root_module;  // parse failed
+			root_module = NULL;
+		}
 	}
 	if (!root_module) {
 		PRINTB("Can't parse file '%s'!\n", filename.c_str());
@@ -446,7 +459,11 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 	AbstractNode::resetIndexCounter();
 
 	FileContext fc(&top_ctx, *root_module);
-	const AbstractNode *absolute_root_node = root_module->evaluate(fc);
+	const AbstractNode *absolute_root_node;
+	{
+		Profiler::Span span("instantiate");
+		absolute_root_node = root_module->evaluate(fc);
+	}
 	// Do we have an explicit root node (! modifier)?
 	const AbstractNode *root_node;
 	if (auto explicitRoot = find_root_tag(absolute_root_node))
@@ -505,7 +522,10 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 			// echo or OpenCSG png -> don't necessarily need geometry evaluation
 		} else {
 			// Force creation of CGAL objects (for testing)
-			root_geom = geomevaluator.evaluateGeometry(*tree.root());
+			{
+				Profiler::Span span("evaluate");
+				root_geom = geomevaluator.evaluateGeometry(*tree.root());
+			}
 			if (!root_geom) root_geom.reset(new CGAL_Nef_polyhedron());
 			if (renderer == Render::CGAL && root_geom->getDimension() == 3) {
 				const CGAL_Nef_polyhedron *N = dynamic_cast<const CGAL_Nef_polyhedron*>(root_geom.get());
@@ -525,6 +545,8 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 			if ( stl_output_file ) geom_out = std::string(stl_output_file);
 			else if ( off_output_file ) geom_out = std::string(off_output_file);
 			else if ( amf_output_file ) geom_out = std::string(amf_output_file);
+			else if ( threemf_output_file ) geom_out = std::string(threemf_output_file);
+			else if ( mesh_output_file ) geom_out = std::string(mesh_output_file);
 			else if ( dxf_output_file ) geom_out = std::string(dxf_output_file);
 			else if ( svg_output_file ) geom_out = std::string(svg_output_file);
 			else if ( png_output_file ) geom_out = std::string(png_output_file);
@@ -541,7 +563,7 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 		}
 
 		if (stl_output_file) {
-			if (!checkAndExport(root_geom, 3, OPENSCAD_STL, stl_output_file))
+			if (!checkAndExport(root_geom, 3, arg_export_format == "binstl" ? OPENSCAD_BINSTL : OPENSCAD_STL, stl_output_file))
 				return 1;
 		}
 
@@ -555,6 +577,11 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 				return 1;
 		}
 
+		if (threemf_output_file) {
+			if (!checkAndExport(root_geom, 3, OPENSCAD_3MF, threemf_output_file))
+				return 1;
+		}
+
 		if (dxf_output_file) {
 			if (!checkAndExport(root_geom, 2, OPENSCAD_DXF, dxf_output_file))
 				return 1;
@@ -594,6 +621,11 @@ int cmdline(const char *deps_output_file, const std::string &filename, Camera &c
 			if (!checkAndExport(root_geom, 3, OPENSCAD_NEF3, nef3_output_file))
 				return 1;
 		}
+
+		if (mesh_output_file) {
+			if (!checkAndExport(root_geom, 3, OPENSCAD_MESH, mesh_output_file))
+				return 1;
+		}
 #else
 		PRINT("OpenSCAD has been compiled without CGAL support!\n");
 		return 1;
@@ -850,6 +882,11 @@ int main(int argc, char **argv)
 		("projection", po::value<string>(), "(o)rtho or (p)erspective when exporting png")
 		("colorscheme", po::value<string>(), "colorscheme")
 		("debug", po::value<string>(), "special debug info")
+		("cache-dir", po::value<string>(), "directory for the persistent geometry cache")
+		("memory-budget", po::value<unsigned int>(), "megabytes of cached geometry to keep in memory, 0 for unlimited (default: half of the physical memory)")
+		("export-format", po::value<string>(), "format of exported .stl files: asciistl (default) or binstl")
+		("profile", po::value<string>(), "write the time, allocations and geometry size of each phase to a .json file")
+		("profile-format", po::value<string>(), "format of the profile: trace (default, Chrome trace events) or flat")
 		("quiet,q", "quiet mode (don't print anything *except* errors)")
 		("o,o", po::value<string>(), "out-file")
 		("p,p", po::value<string>(), "parameter file")
@@ -909,6 +946,38 @@ int main(int argc, char **argv)
 		RenderSettings::inst()->openCSGTermLimit = vm["csglimit"].as<unsigned int>();
 	}
 
+	if (vm.count("cache-dir")) {
+		DiskCache::instance()->setDirectory(vm["cache-dir"].as<string>());
+	}
+	uint64_t budget = PlatformUtils::physicalMemory() / 2;
+	if (vm.count("memory-budget")) {
+		budget = uint64_t(vm["memory-budget"].as<unsigned int>()) * 1024 * 1024;
+	}
+	MemoryBudget::instance()->setLimit(budget);
+	// evictions spill to disk, up to a multiple of the budget
+	if (budget) DiskCache::instance()->setSpillLimit(budget * 4);
+	if (vm.count("export-format")) {
+		arg_export_format = vm["export-format"].as<string>();
+		if (arg_export_format != "asciistl" && arg_export_format != "binstl") {
+			PRINTB("Unknown export format '%s'", arg_export_format);
+			help(argv[0], true);
+		}
+	}
+
+	if (vm.count("profile")) {
+		Profiler::Format format = Profiler::TRACE;
+		if (vm.count("profile-format")) {
+			std::string name = vm["profile-format"].as<string>();
+			if (name == "flat") format = Profiler::FLAT;
+			else if (name != "trace") {
+				PRINTB("Unknown profile format '%s'", name);
+				help(argv[0], true);
+			}
+		}
+		// the document's directory is the current path while it's evaluated
+		Profiler::instance()->start(fs::absolute(vm["profile"].as<string>()).string(), format);
+	}
+
 	if (vm.count("o")) {
 		// FIXME: Allow for multiple output files?
 		if (output_file) help(argv[0], true);
@@ -1008,6 +1077,9 @@ int main(int argc, char **argv)
 		help(argv[0], true);
 	}
 
+	if (Profiler::enabled() && !Profiler::instance()->finish() && rc == 0)
+		rc = 1;
+
 	Builtins::release();
 
 	return rc;
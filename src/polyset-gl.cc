@@ -43,41 +43,41 @@ void PolySet::render_surface(Renderer::csgmode_e csgmode, bool mirrored) const
 		double zbase = 1 + ((csgmode & CSGMODE_DIFFERENCE_FLAG) ? 0.1 : 0);
 		glBegin(GL_TRIANGLES);
 
-		for (size_t i = 0; i < polygons.size(); i++) {
-			const Polygon *poly = &polygons[i];
-			if (poly->open)
+		for (size_t i = 0; i < numPolygons(); i++) {
+			const PolygonView poly = getPolygon(i);
+			if (poly.open)
 				continue;
 			// Render top+bottom
 			for (double z = -zbase/2; z < zbase; z += zbase) {
-				if (poly->size() == 3) {
+				if (poly.size() == 3) {
 					if (z < 0) {
-						gl_draw_triangle(poly->at(0), poly->at(2), poly->at(1), z, mirrored);
+						gl_draw_triangle(poly.at(0), poly.at(2), poly.at(1), z, mirrored);
 					} else {
-						gl_draw_triangle(poly->at(0), poly->at(1), poly->at(2), z, mirrored);
+						gl_draw_triangle(poly.at(0), poly.at(1), poly.at(2), z, mirrored);
 					}
 				}
-				else if (poly->size() == 4) {
+				else if (poly.size() == 4) {
 					if (z < 0) {
-						gl_draw_triangle(poly->at(0), poly->at(3), poly->at(1), z, mirrored);
-						gl_draw_triangle(poly->at(2), poly->at(1), poly->at(3), z, mirrored);
+						gl_draw_triangle(poly.at(0), poly.at(3), poly.at(1), z, mirrored);
+						gl_draw_triangle(poly.at(2), poly.at(1), poly.at(3), z, mirrored);
 					} else {
-						gl_draw_triangle(poly->at(0), poly->at(1), poly->at(3), z, mirrored);
-						gl_draw_triangle(poly->at(2), poly->at(3), poly->at(1), z, mirrored);
+						gl_draw_triangle(poly.at(0), poly.at(1), poly.at(3), z, mirrored);
+						gl_draw_triangle(poly.at(2), poly.at(3), poly.at(1), z, mirrored);
 					}
 				}
 				else {
 					Vector3d center = Vector3d::Zero();
-					for (size_t j = 0; j < poly->size(); j++) {
-						center[0] += poly->at(j)[0];
-						center[1] += poly->at(j)[1];
+					for (size_t j = 0; j < poly.size(); j++) {
+						center[0] += poly.at(j)[0];
+						center[1] += poly.at(j)[1];
 					}
-					center[0] /= poly->size();
-					center[1] /= poly->size();
-					for (size_t j = 1; j <= poly->size(); j++) {
+					center[0] /= poly.size();
+					center[1] /= poly.size();
+					for (size_t j = 1; j <= poly.size(); j++) {
 						if (z < 0) {
-							gl_draw_triangle(center, poly->at(j % poly->size()), poly->at(j - 1), z, mirrored);
+							gl_draw_triangle(center, poly.at(j % poly.size()), poly.at(j - 1), z, mirrored);
 						} else {
-							gl_draw_triangle(center, poly->at(j - 1), poly->at(j % poly->size()), z, mirrored);
+							gl_draw_triangle(center, poly.at(j - 1), poly.at(j % poly.size()), z, mirrored);
 						}
 					}
 				}
@@ -102,12 +102,11 @@ void PolySet::render_surface(Renderer::csgmode_e csgmode, bool mirrored) const
 		else {
 			// If we don't have borders, use the polygons as borders.
 			// FIXME: When is this used?
-			const Polygons *borders_p = &polygons;
-			for (size_t i = 0; i < borders_p->size(); i++) {
-				const Polygon *poly = &borders_p->at(i);
-				for (size_t j = 1; j <= poly->size(); j++) {
-					Vector3d p1 = poly->at(j - 1), p2 = poly->at(j - 1);
-					Vector3d p3 = poly->at(j % poly->size()), p4 = poly->at(j % poly->size());
+			for (size_t i = 0; i < numPolygons(); i++) {
+				const PolygonView poly = getPolygon(i);
+				for (size_t j = 1; j <= poly.size(); j++) {
+					Vector3d p1 = poly.at(j - 1), p2 = poly.at(j - 1);
+					Vector3d p3 = poly.at(j % poly.size()), p4 = poly.at(j % poly.size());
 					p1[2] -= zbase/2, p2[2] += zbase/2;
 					p3[2] -= zbase/2, p4[2] += zbase/2;
 					gl_draw_triangle(p2, p1, p3, 0, mirrored);
@@ -118,9 +117,9 @@ void PolySet::render_surface(Renderer::csgmode_e csgmode, bool mirrored) const
 		glEnd();
 	} 
 	else if (this->dim == 3) {
-		for (size_t i = 0; i < polygons.size(); i++) {
-			const Polygon *poly = &polygons[i];
-			if (poly->open)
+		for (size_t i = 0; i < numPolygons(); i++) {
+			const PolygonView poly = getPolygon(i);
+			if (poly.open)
 				continue;
 			// don't generate normals when called from OpenCSG
 			bool normals = csgmode != Renderer::CSGMODE_NONE;
@@ -128,25 +127,25 @@ void PolySet::render_surface(Renderer::csgmode_e csgmode, bool mirrored) const
 			if (csgmode == Renderer::CSGMODE_NONE)
 				glFrontFace(GL_CW);
 			glBegin(GL_TRIANGLES);
-			if (poly->size() == 3) {
-				gl_draw_triangle(poly->at(0), poly->at(1), poly->at(2), 0, mirrored, normals);
+			if (poly.size() == 3) {
+				gl_draw_triangle(poly.at(0), poly.at(1), poly.at(2), 0, mirrored, normals);
 			}
-			else if (poly->size() == 4) {
-				gl_draw_triangle(poly->at(0), poly->at(1), poly->at(3), 0, mirrored, normals);
-				gl_draw_triangle(poly->at(2), poly->at(3), poly->at(1), 0, mirrored, normals);
+			else if (poly.size() == 4) {
+				gl_draw_triangle(poly.at(0), poly.at(1), poly.at(3), 0, mirrored, normals);
+				gl_draw_triangle(poly.at(2), poly.at(3), poly.at(1), 0, mirrored, normals);
 			}
 			else {
 				Vector3d center = Vector3d::Zero();
-				for (size_t j = 0; j < poly->size(); j++) {
-					center[0] += poly->at(j)[0];
-					center[1] += poly->at(j)[1];
-					center[2] += poly->at(j)[2];
+				for (size_t j = 0; j < poly.size(); j++) {
+					center[0] += poly.at(j)[0];
+					center[1] += poly.at(j)[1];
+					center[2] += poly.at(j)[2];
 				}
-				center[0] /= poly->size();
-				center[1] /= poly->size();
-				center[2] /= poly->size();
-				for (size_t j = 1; j <= poly->size(); j++) {
-					gl_draw_triangle(center, poly->at(j - 1), poly->at(j % poly->size()), 0, mirrored, normals);
+				center[0] /= poly.size();
+				center[1] /= poly.size();
+				center[2] /= poly.size();
+				for (size_t j = 1; j <= poly.size(); j++) {
+					gl_draw_triangle(center, poly.at(j - 1), poly.at(j % poly.size()), 0, mirrored, normals);
 				}
 			}
 			glEnd();
@@ -284,11 +283,11 @@ void PolySet::render_edges(Renderer::csgmode_e csgmode) const
 			}
 		}
 	} else if (dim == 3) {
-		for (size_t i = 0; i < polygons.size(); i++) {
-			const Polygon *poly = &polygons[i];
-			glBegin(poly->open ? GL_LINE_STRIP : GL_LINE_LOOP);
-			for (size_t j = 0; j < poly->size(); j++) {
-				const Vector3d &p = poly->at(j);
+		for (size_t i = 0; i < numPolygons(); i++) {
+			const PolygonView poly = getPolygon(i);
+			glBegin(poly.open ? GL_LINE_STRIP : GL_LINE_LOOP);
+			for (size_t j = 0; j < poly.size(); j++) {
+				const Vector3d &p = poly.at(j);
 				glVertex3d(p[0], p[1], p[2]);
 			}
 			glEnd();
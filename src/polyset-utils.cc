@@ -58,6 +58,9 @@ namespace PolysetUtils {
 		// polylines pass thru
 		std::vector<Polygon> polylines;
 
+		// shared input vertices are looked up once
+		std::vector<int> vertexMap(inps.getVertices().size(), -1);
+
 		for (const auto &pgon : inps.getPolygons()) {
 			// don't tesselate polylines
 			if (pgon.open) {
@@ -74,9 +77,10 @@ namespace PolysetUtils {
 			std::vector<IndexedFace> &faces = polygons.back();
 			faces.push_back(IndexedFace());
 			IndexedFace &currface = faces.back();
-			for (const auto &v : pgon) {
+			for (size_t i = 0; i < pgon.size(); i++) {
 				// Create vertex indices and remove consecutive duplicate vertices
-				int idx = allVertices.lookup(v.cast<float>());
+				int &idx = vertexMap[pgon.index(i)];
+				if (idx < 0) idx = allVertices.lookup(pgon[i].cast<float>());
 				if (currface.empty() || idx != currface.back()) 
 					currface.push_back(idx);
 			}
@@ -93,9 +97,13 @@ namespace PolysetUtils {
 			outps = PolySet(inps.getDimension(), inps.convexValue());
 		}
 
-		// Tessellate indexed mesh
+		// Tessellate indexed mesh; the triangles share the output vertices
 		const Vector3f *verts = allVertices.getArray();
-		std::vector<IndexedTriangle> allTriangles;
+		int offset = int(outps.getVertices().size());
+		outps.reserve_vertices(offset + allVertices.size());
+		for (size_t i = 0; i < allVertices.size(); i++) {
+			outps.add_vertex(verts[i].cast<double>());
+		}
 		for(const auto &faces : polygons) {
 			std::vector<IndexedTriangle> triangles;
 			bool err = false;
@@ -107,10 +115,7 @@ namespace PolysetUtils {
 			}
 			if (!err) {
 				for(const auto &t : triangles) {
-					outps.append_poly();
-					outps.append_vertex(verts[t[0]]);
-					outps.append_vertex(verts[t[1]]);
-					outps.append_vertex(verts[t[2]]);
+					outps.append_face(offset + t[0], offset + t[1], offset + t[2]);
 				}
 			}
 		}
@@ -57,21 +57,22 @@
  */
 
 PolySet::PolySet(const PolySet &ps)
-	: polygons(ps.polygons), polygon(ps.polygon), dim(ps.dim), convex(ps.convex), bbox(ps.bbox), polyDim(ps.polyDim)
+	: vertices(ps.vertices), indices(ps.indices), faceStart(ps.faceStart), faceOpen(ps.faceOpen),
+		polygon(ps.polygon), dim(ps.dim), convex(ps.convex), bbox(ps.bbox), polyDim(ps.polyDim)
 {
 	type = "PolySet from PolySet";
 	data.polySet = this;
 }
 
 PolySet::PolySet(unsigned int dim, boost::tribool convex)
-	: dim(dim), convex(convex), polyDim(0)
+	: faceStart(1, 0), dim(dim), convex(convex), polyDim(0)
 {
 	type = "PolySet";
 	data.polySet = this;
 }
 
 PolySet::PolySet(const Polygon2d &origin) 
-	: polygon((Polygon2d*)origin.copy()), dim(2), convex(unknown), polyDim(0)
+	: faceStart(1, 0), polygon((Polygon2d*)origin.copy()), dim(2), convex(unknown), polyDim(0)
 {
 	type = "PolySet from Polygon";
 	data = polygon->data; // copy polygon's data so poly/skele is preserved
@@ -100,13 +101,11 @@ std::string PolySet::dump() const
 	out << "PolySet:"
 		<< "\n dimensions:" << this->dim
 		<< "\n convexity:" << this->convexity
-		<< "\n num polygons: " << polygons.size();
+		<< "\n num polygons: " << numPolygons();
 	out << "\n polygons data:";
-	for (size_t i = 0; i < polygons.size(); i++) {
+	for (const auto &poly : getPolygons()) {
 		out << "\n  polygon begin:";
-		const Polygon *poly = &polygons[i];
-		for (size_t j = 0; j < poly->size(); j++) {
-			Vector3d v = poly->at(j);
+		for (const auto &v : poly) {
 			out << "\n   vertex:" << v.transpose();
 		}
 	}
@@ -119,20 +118,65 @@ std::string PolySet::dump() const
 	return out.str();
 }
 
+void PolySet::reserve(size_t numPolygons, size_t numIndices)
+{
+	faceStart.reserve(numPolygons + 1);
+	faceOpen.reserve(numPolygons);
+	indices.reserve(numIndices);
+}
+
+/*!
+	Adds a vertex to the shared vertex buffer and returns its index, for use
+	with append_face(). Vertices are not merged.
+*/
+int PolySet::add_vertex(const Vector3d &v)
+{
+	vertices.push_back(v);
+	bbox.extend(v);
+	return int(vertices.size() - 1);
+}
+
+void PolySet::append_face(const IndexedFace &face, bool open)
+{
+	indices.insert(indices.end(), face.begin(), face.end());
+	faceStart.push_back(indices.size());
+	faceOpen.push_back(open);
+	this->polyDim = std::max(this->polyDim, face.size());
+	this->resetDisplayLists();
+}
+
+void PolySet::append_face(int v0, int v1, int v2)
+{
+	indices.push_back(v0);
+	indices.push_back(v1);
+	indices.push_back(v2);
+	faceStart.push_back(indices.size());
+	faceOpen.push_back(false);
+	this->polyDim = std::max(this->polyDim, size_t(3));
+	this->resetDisplayLists();
+}
+
 void PolySet::append_poly()
 {
-	polygons.push_back(Polygon());
+	faceStart.push_back(indices.size());
+	faceOpen.push_back(false);
 }
 
 void PolySet::append_poly(const Polygon &poly)
 {
-	polygons.push_back(poly);
-	this->polyDim = std::max(this->polyDim, polygons.back().size());
 	for (const auto &v : poly)
-		bbox.extend(v);
+		indices.push_back(add_vertex(v));
+	faceStart.push_back(indices.size());
+	faceOpen.push_back(poly.open);
+	this->polyDim = std::max(this->polyDim, poly.size());
 	this->resetDisplayLists();
 }
 
+void PolySet::append_poly(Polygon &&poly)
+{
+	append_poly(static_cast<const Polygon &>(poly));
+}
+
 void PolySet::append_vertex(double x, double y, double z)
 {
 	append_vertex(Vector3d(x, y, z));
@@ -140,9 +184,9 @@ void PolySet::append_vertex(double x, double y, double z)
 
 void PolySet::append_vertex(const Vector3d &v)
 {
-	polygons.back().push_back(v);
-	this->polyDim = std::max(this->polyDim, polygons.back().size());
-	bbox.extend(v);
+	indices.push_back(add_vertex(v));
+	size_t size = ++faceStart.back() - faceStart[faceStart.size() - 2];
+	this->polyDim = std::max(this->polyDim, size);
 	this->resetDisplayLists();
 }
 
@@ -158,9 +202,10 @@ void PolySet::insert_vertex(double x, double y, double z)
 
 void PolySet::insert_vertex(const Vector3d &v)
 {
-	polygons.back().insert(polygons.back().begin(), v);
-	this->polyDim = std::max(this->polyDim, polygons.back().size());
-	bbox.extend(v);
+	size_t first = faceStart[faceStart.size() - 2];
+	indices.insert(indices.begin() + first, add_vertex(v));
+	size_t size = ++faceStart.back() - first;
+	this->polyDim = std::max(this->polyDim, size);
 	this->resetDisplayLists();
 }
 
@@ -177,8 +222,10 @@ BoundingBox PolySet::getBoundingBox() const
 size_t PolySet::memsize() const
 {
 	size_t mem = 0;
-	for(const auto &p : this->polygons) 
-		mem += p.size() * sizeof(Vector3d);
+	mem += this->vertices.size() * sizeof(Vector3d);
+	mem += this->indices.size() * sizeof(int);
+	mem += this->faceStart.size() * sizeof(size_t);
+	mem += this->faceOpen.size() / 8;
 	if (polygon)
 		mem += this->polygon->memsize() - sizeof(*this->polygon);
 	mem += sizeof(PolySet);
@@ -187,7 +234,13 @@ size_t PolySet::memsize() const
 
 void PolySet::append(const PolySet &ps)
 {
-	this->polygons.insert(this->polygons.end(), ps.polygons.begin(), ps.polygons.end());
+	int offset = int(this->vertices.size());
+	size_t base = this->indices.size();
+	this->vertices.insert(this->vertices.end(), ps.vertices.begin(), ps.vertices.end());
+	this->indices.reserve(base + ps.indices.size());
+	for (int idx : ps.indices) this->indices.push_back(idx + offset);
+	for (size_t i = 1; i < ps.faceStart.size(); i++) this->faceStart.push_back(base + ps.faceStart[i]);
+	this->faceOpen.insert(this->faceOpen.end(), ps.faceOpen.begin(), ps.faceOpen.end());
 	this->polyDim = std::max(this->polyDim, ps.polyDim);
 	this->bbox.extend(ps.getBoundingBox());
 	this->resetDisplayLists();
@@ -196,27 +249,32 @@ void PolySet::append(const PolySet &ps)
 void PolySet::translate(const Vector3d &translation)
 {
 	this->bbox.setNull();
-	for (auto &p : polygons) {
-		for (auto &v : p) {
-			v += translation;
-			this->bbox.extend(v);
-		}
+	for (auto &v : vertices) {
+		v += translation;
+		this->bbox.extend(v);
 	}
 }
 
+//! Flips the orientation of all polygons
+void PolySet::reverse_faces()
+{
+	for (size_t i = 0; i + 1 < faceStart.size(); i++) {
+		std::reverse(indices.begin() + faceStart[i], indices.begin() + faceStart[i + 1]);
+	}
+	this->resetDisplayLists();
+}
+
 void PolySet::transform(const Transform3d &mat)
 {
 	// If mirroring transform, flip faces to avoid the object to end up being inside-out
 	bool mirrored = mat.matrix().determinant() < 0;
 
 	this->bbox.setNull();
-	for(auto &p : this->polygons){
-		for(auto &v : p) {
-			v = mat * v;
-			this->bbox.extend(v);
-		}
-		if (mirrored) std::reverse(p.begin(), p.end());
+	for (auto &v : this->vertices) {
+		v = mat * v;
+		this->bbox.extend(v);
 	}
+	if (mirrored) reverse_faces();
 	this->resetDisplayLists();
 }
 
@@ -260,40 +318,43 @@ void PolySet::resize(const Vector3d &newsize, const Eigen::Matrix<bool,3,1> &aut
 */
 void QuantizedPolySet::quantizeVertices()
 {
-	int numverts = 0;
-	for (std::vector<Polygon>::iterator iter = this->polygons.begin(); iter != this->polygons.end(); ++iter)
-		numverts += iter->size();
-	int removeCount = 0;
-	PRINTB("Quantize PolySet: %d vertices, %d faces, res=%f", numverts % this->polygons.size() % grid.res);
-	for (std::vector<Polygon>::iterator iter = this->polygons.begin(); iter != this->polygons.end(); ) {
-		Polygon &p = *iter;
-		// Quantize all vertices. Build index list
-		std::vector<int> indices(p.size());
-		for (int i = 0; i < p.size(); i++) {
-			indices[i] = grid.align(p[i]);
-		}
-		// Remove consequtive duplicate vertices
-		Polygon::iterator currp = p.begin();
-		for (int i = 0; i < indices.size(); i++) {
-			if (i == 0 || indices[i - 1] != indices[i]) {
-				(*currp++) = p[i];
+	size_t numverts = this->indices.size();
+	size_t numfaces = this->numPolygons();
+	PRINTB("Quantize PolySet: %d vertices, %d faces, res=%f", numverts % numfaces % grid.res);
+
+	// Quantize each shared vertex once
+	std::vector<int> gridIndices(this->vertices.size());
+	for (size_t i = 0; i < this->vertices.size(); i++) {
+		gridIndices[i] = grid.align(this->vertices[i]);
+	}
+
+	// Remove consecutive duplicate vertices and compact the index buffer in place
+	size_t out = 0, faces = 0, next = 0;
+	for (size_t f = 0; f < numfaces; f++) {
+		// faceStart is rewritten behind the read position
+		size_t first = next, last = faceStart[f + 1];
+		next = last;
+		size_t begin = out;
+		for (size_t i = first; i < last; i++) {
+			int idx = this->indices[i];
+			if (out == begin || gridIndices[this->indices[out - 1]] != gridIndices[idx]) {
+				this->indices[out++] = idx;
 			}
 		}
-		// Erase unused vertices
-		if (currp != p.end()) {
-			p.erase(currp, p.end());
-			numverts -= (p.end() - currp);
-		}
-		// update the iterator
-		if ((p.size() < 3 && !p.open) || p.size() < 2) {
-			removeCount++;
-			iter = this->polygons.erase(iter);
+		size_t size = out - begin;
+		if ((size < 3 && !faceOpen[f]) || size < 2) {
+			out = begin;
 		}
 		else {
-			iter++;
+			faceOpen[faces] = faceOpen[f];
+			faceStart[++faces] = out;
 		}
 	}
-	PRINTB("Quantize result: %d vertices, %d faces (removed %d)", numverts % this->polygons.size() % removeCount);
+	this->indices.resize(out);
+	this->faceStart.resize(faces + 1);
+	this->faceOpen.resize(faces);
+	this->resetDisplayLists();
+	PRINTB("Quantize result: %d vertices, %d faces (removed %d)", out % faces % (numfaces - faces));
 }
 
 typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
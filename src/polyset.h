@@ -8,13 +8,160 @@
 #include "Polygon2d.h"
 #include <vector>
 #include <string>
+#include <iterator>
 
 #include <boost/logic/tribool.hpp>
 BOOST_TRIBOOL_THIRD_STATE(unknown)
 
+/*!
+	A read-only view of one polygon of a PolySet. The vertices are shared
+	between polygons and are reached through the polygon's vertex indices.
+*/
+class PolygonView
+{
+public:
+	class const_iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef Vector3d value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Vector3d *pointer;
+		typedef const Vector3d &reference;
+
+		const_iterator() : vertices(nullptr), idx(nullptr) { }
+		const_iterator(const Vector3d *vertices, const int *idx) : vertices(vertices), idx(idx) { }
+
+		reference operator*() const { return vertices[*idx]; }
+		pointer operator->() const { return &vertices[*idx]; }
+		reference operator[](difference_type n) const { return vertices[idx[n]]; }
+		const_iterator &operator++() { ++idx; return *this; }
+		const_iterator operator++(int) { const_iterator it(*this); ++idx; return it; }
+		const_iterator &operator--() { --idx; return *this; }
+		const_iterator operator--(int) { const_iterator it(*this); --idx; return it; }
+		const_iterator &operator+=(difference_type n) { idx += n; return *this; }
+		const_iterator &operator-=(difference_type n) { idx -= n; return *this; }
+		const_iterator operator+(difference_type n) const { return const_iterator(vertices, idx + n); }
+		const_iterator operator-(difference_type n) const { return const_iterator(vertices, idx - n); }
+		difference_type operator-(const const_iterator &other) const { return idx - other.idx; }
+		bool operator==(const const_iterator &other) const { return idx == other.idx; }
+		bool operator!=(const const_iterator &other) const { return idx != other.idx; }
+		bool operator<(const const_iterator &other) const { return idx < other.idx; }
+
+	private:
+		const Vector3d *vertices;
+		const int *idx;
+	};
+	typedef const_iterator iterator;
+
+	PolygonView() : open(false), vertices(nullptr), first(nullptr), last(nullptr) { }
+	PolygonView(const Vector3d *vertices, const int *first, const int *last, bool open)
+		: open(open), vertices(vertices), first(first), last(last) { }
+
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	const Vector3d &operator[](size_t i) const { return vertices[first[i]]; }
+	const Vector3d &at(size_t i) const { return vertices[first[i]]; }
+	const Vector3d &front() const { return vertices[*first]; }
+	const Vector3d &back() const { return vertices[last[-1]]; }
+	const_iterator begin() const { return const_iterator(vertices, first); }
+	const_iterator end() const { return const_iterator(vertices, last); }
+
+	//! Index of the i'th vertex in the PolySet's vertex buffer
+	int index(size_t i) const { return first[i]; }
+	const int *indices() const { return first; }
+
+	operator Polygon() const {
+		Polygon poly;
+		poly.assign(begin(), end());
+		poly.open = open;
+		return poly;
+	}
+
+	bool open;
+
+private:
+	const Vector3d *vertices;
+	const int *first;
+	const int *last;
+};
+
+class PolySet;
+class CGAL_Nef_polyhedron;
+
+/*!
+	A read-only view of all polygons of a PolySet, for code that walks a
+	PolySet polygon by polygon.
+*/
+class PolygonsView
+{
+public:
+	class const_iterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef PolygonView value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const PolygonView *pointer;
+		typedef const PolygonView &reference;
+
+		const_iterator() : ps(nullptr), i(0) { }
+		const_iterator(const PolySet *ps, size_t i) : ps(ps), i(i) { }
+
+		// the view is rebuilt on each dereference, so references to it are
+		// only valid until the iterator moves
+		inline reference operator*() const;
+		pointer operator->() const { return &**this; }
+		const_iterator &operator++() { ++i; return *this; }
+		const_iterator operator++(int) { const_iterator it(*this); ++i; return it; }
+		const_iterator &operator--() { --i; return *this; }
+		const_iterator operator--(int) { const_iterator it(*this); --i; return it; }
+		const_iterator &operator+=(difference_type n) { i += n; return *this; }
+		const_iterator &operator-=(difference_type n) { i -= n; return *this; }
+		const_iterator operator+(difference_type n) const { return const_iterator(ps, i + n); }
+		const_iterator operator-(difference_type n) const { return const_iterator(ps, i - n); }
+		difference_type operator-(const const_iterator &other) const { return difference_type(i) - difference_type(other.i); }
+		bool operator==(const const_iterator &other) const { return i == other.i; }
+		bool operator!=(const const_iterator &other) const { return i != other.i; }
+		bool operator<(const const_iterator &other) const { return i < other.i; }
+
+	private:
+		const PolySet *ps;
+		size_t i;
+		mutable PolygonView view;
+	};
+	typedef const_iterator iterator;
+
+	explicit PolygonsView(const PolySet &ps) : ps(&ps) { }
+
+	inline size_t size() const;
+	bool empty() const { return size() == 0; }
+	inline PolygonView operator[](size_t i) const;
+	PolygonView at(size_t i) const { return (*this)[i]; }
+	PolygonView front() const { return (*this)[0]; }
+	PolygonView back() const { return (*this)[size() - 1]; }
+	const_iterator begin() const { return const_iterator(ps, 0); }
+	const_iterator end() const { return const_iterator(ps, size()); }
+
+private:
+	const PolySet *ps;
+};
+
+/*!
+	Polygon mesh made of a shared vertex buffer and a flat buffer of vertex
+	indices. faceStart holds the offset of each polygon's first index, plus
+	a final entry for the end of the last polygon.
+
+	Producers either build polygons vertex by vertex through append_poly() and
+	append_vertex(), which adds one vertex per corner, or add shared vertices
+	with add_vertex() and reference them through append_face().
+*/
 class PolySet : public Geometry
 {
 public:
+	// the Nef polyhedron of this PolySet, see CGALUtils::getNefPolyhedron()
+	ConvertedGeometry<CGAL_Nef_polyhedron> nefConversion;
+
 	PolySet(const PolySet &ps);
 	PolySet(unsigned int dim, boost::tribool convex = unknown);
 	PolySet(const Polygon2d &origin);
@@ -24,15 +171,26 @@ public:
 	virtual BoundingBox getBoundingBox() const;
 	virtual std::string dump() const;
 	virtual unsigned int getDimension() const { return this->dim; }
-	virtual bool isEmpty() const { return polygons.size() == 0; }
+	virtual bool isEmpty() const { return numPolygons() == 0; }
 	virtual Geometry *copy() const { return new PolySet(*this); }
 
-	Polygons &getPolygons() { return polygons; }
-	const Polygons &getPolygons() const { return polygons; }
-	size_t numPolygons() const { return polygons.size(); }
+	PolygonsView getPolygons() const { return PolygonsView(*this); }
+	PolygonView getPolygon(size_t i) const {
+		return PolygonView(vertices.data(), indices.data() + faceStart[i], indices.data() + faceStart[i + 1], faceOpen[i]);
+	}
+	size_t numPolygons() const { return faceOpen.size(); }
+	const std::vector<Vector3d> &getVertices() const { return vertices; }
+	const std::vector<int> &getIndices() const { return indices; }
+	void reserve(size_t numPolygons, size_t numIndices = 0);
+	void reserve_vertices(size_t numVertices) { vertices.reserve(numVertices); }
+
+	int add_vertex(const Vector3d &v);
+	void append_face(const IndexedFace &face, bool open = false);
+	void append_face(int v0, int v1, int v2);
 
 	void append_poly();
 	void append_poly(const Polygon &poly);
+	void append_poly(Polygon &&poly);
 	void append_vertex(double x, double y, double z = 0.0);
 	void append_vertex(const Vector3d &v);
 	void append_vertex(const Vector3f &v);
@@ -40,6 +198,7 @@ public:
 	void insert_vertex(const Vector3d &v);
 	void insert_vertex(const Vector3f &v);
 	void append(const PolySet &ps);
+	void reverse_faces();
 
 	void render_surface(Renderer::csgmode_e csgmode, bool mirrored) const;
 	void render_edges(Renderer::csgmode_e csgmode) const;
@@ -54,7 +213,10 @@ public:
 	size_t poly_dim() const { return polyDim; }
 
 protected:
-	Polygons polygons;
+	std::vector<Vector3d> vertices;
+	std::vector<int> indices;
+	std::vector<size_t> faceStart;
+	std::vector<bool> faceOpen;
 	std::shared_ptr<Polygon2d> polygon;
 	unsigned int dim;
 	boost::tribool convex;
@@ -78,6 +240,15 @@ protected:
 	void resetDisplayLists();
 };
 
+PolygonsView::const_iterator::reference PolygonsView::const_iterator::operator*() const
+{
+	view = ps->getPolygon(i);
+	return view;
+}
+
+size_t PolygonsView::size() const { return ps->numPolygons(); }
+PolygonView PolygonsView::operator[](size_t i) const { return ps->getPolygon(i); }
+
 class QuantizedPolySet : public PolySet
 {
 	void quantizeVertices();
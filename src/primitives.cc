@@ -53,6 +53,79 @@ enum primitive_type_e {
 	LINE
 };
 
+namespace {
+	/*
+		Random access to a list of points. Point lists packed as a matrix of 2D
+		or 3D points are read directly from the contiguous buffer.
+	*/
+	class PointList
+	{
+	public:
+		PointList(const Value &points) : packed(points.toNumericVector()), boxed(nullptr)
+		{
+			if (packed && !packed->isPoints()) packed = nullptr;
+			if (!packed) boxed = &points.toVector();
+		}
+
+		size_t size() const { return packed ? packed->size() : boxed->size(); }
+
+		bool getVec2(size_t i, double &x, double &y) const
+		{
+			if (!packed) return (*boxed)[i]->getVec2(x, y);
+			if (packed->columns() != 2) return false;
+			const double *p = packed->row(i);
+			x = p[0];
+			y = p[1];
+			return true;
+		}
+
+		bool getVec3(size_t i, double &x, double &y, double &z) const
+		{
+			if (!packed) return (*boxed)[i]->getVec3(x, y, z);
+			const double *p = packed->row(i);
+			x = p[0];
+			y = p[1];
+			z = packed->columns() == 3 ? p[2] : 0.0;
+			return true;
+		}
+
+		std::string toString(size_t i) const
+		{
+			return packed ? packed->element(i)->toString() : (*boxed)[i]->toString();
+		}
+
+	private:
+		const NumericVector *packed;
+		const Value::VectorType *boxed;
+	};
+
+	/*
+		Random access to a list of faces or paths, i.e. of vectors of point
+		indices. Lists where every entry has the same length are packed.
+	*/
+	class IndexList
+	{
+	public:
+		IndexList(const Value &lists) : packed(lists.toNumericVector()), boxed(nullptr)
+		{
+			if (packed && !packed->isMatrix()) packed = nullptr;
+			if (!packed) boxed = &lists.toVector();
+		}
+
+		size_t size() const { return packed ? packed->size() : boxed->size(); }
+
+		void get(size_t i, std::vector<double> &indices) const
+		{
+			if (packed) indices.assign(packed->row(i), packed->row(i) + packed->columns());
+			else (*boxed)[i]->getNumbers(indices);
+		}
+
+	private:
+		const NumericVector *packed;
+		const Value::VectorType *boxed;
+	};
+}
+
 class PrimitiveNode : public FactoryNode
 {
 public:
@@ -458,24 +531,34 @@ public:
 			PolySet *p = new PolySet(3);
 			g = p;
 			p->setConvexity(this->convexity);
-			for (size_t i = 0; i < this->faces->toVector().size(); i++)
+			PointList points(*this->points);
+			IndexList faces(*this->faces);
+			std::vector<double> face;
+			// points are added to the PolySet when a face first uses them
+			std::vector<int> pointIndices(points.size(), -1);
+			IndexedFace indices;
+			p->reserve(faces.size());
+			for (size_t i = 0; i < faces.size(); i++)
 			{
-				Polygon poly;
-				poly.open = this->open;
-				const Value::VectorType &vec = this->faces->toVector()[i]->toVector();
-				for (size_t j = 0; j < vec.size(); j++) {
-					size_t pt = vec[j]->toDouble();
-					if (pt < this->points->toVector().size()) {
-						double px, py, pz;
-						if (!this->points->toVector()[pt]->getVec3(px, py, pz) ||
-							std::isinf(px) || std::isinf(py) || std::isinf(pz)) {
-							PRINTB("ERROR: Unable to convert point at index %d to a vec3 of numbers", j);
-							return ResultObject(p);
+				indices.clear();
+				faces.get(i, face);
+				for (size_t j = 0; j < face.size(); j++) {
+					size_t pt = face[j];
+					if (pt < points.size()) {
+						int &idx = pointIndices[pt];
+						if (idx < 0) {
+							double px, py, pz;
+							if (!points.getVec3(pt, px, py, pz) ||
+								std::isinf(px) || std::isinf(py) || std::isinf(pz)) {
+								PRINTB("ERROR: Unable to convert point at index %d to a vec3 of numbers", j);
+								return ResultObject(p);
+							}
+							idx = p->add_vertex(Vector3d(px, py, pz));
 						}
-						poly.push_back(Vector3d(px, py, pz));
+						indices.push_back(idx);
 					}
 				}
-				p->append_poly(poly);
+				p->append_face(indices, this->open);
 			}
 		}
 						 break;
@@ -528,26 +611,29 @@ public:
 			Outline2d outline;
 			outline.open = this->open;
 			double x, y;
-			const Value::VectorType &vec = this->points->toVector();
-			for (unsigned int i = 0; i < vec.size(); i++) {
-				const Value &val = *vec[i];
-				if (!val.getVec2(x, y) || std::isinf(x) || std::isinf(y)) {
+			PointList points(*this->points);
+			outline.vertices.reserve(points.size());
+			for (unsigned int i = 0; i < points.size(); i++) {
+				if (!points.getVec2(i, x, y) || std::isinf(x) || std::isinf(y)) {
 					PRINTB("ERROR: Unable to convert point %s at index %d to a vec2 of numbers",
-						val.toString() % i);
+						points.toString(i) % i);
 					return ResultObject(p);
 				}
 				outline.vertices.push_back(Vector2d(x, y));
 			}
 
-			if (this->paths->toVector().size() == 0 && outline.vertices.size() > 2) {
+			IndexList paths(*this->paths);
+			if (paths.size() == 0 && outline.vertices.size() > 2) {
 				p->addOutline(outline);
 			}
 			else {
-				for (const auto &polygon : this->paths->toVector()) {
+				std::vector<double> path;
+				for (size_t i = 0; i < paths.size(); i++) {
 					Outline2d curroutline;
 					curroutline.open = this->open;
-					for (const auto &index : polygon->toVector()) {
-						unsigned int idx = index->toDouble();
+					paths.get(i, path);
+					for (double index : path) {
+						unsigned int idx = index;
 						if (idx < outline.vertices.size()) {
 							curroutline.vertices.push_back(outline.vertices[idx]);
 						}
@@ -568,16 +654,15 @@ public:
 			p->setConvexity(this->convexity);
 			Polygon poly;
 			poly.open = true;
-			int j = 0;
-			for (auto &point : this->points->toVector()) {
+			PointList points(*this->points);
+			for (size_t j = 0; j < points.size(); j++) {
 				double px, py, pz;
-				if (!point->getVec3(px, py, pz) ||
+				if (!points.getVec3(j, px, py, pz) ||
 					std::isinf(px) || std::isinf(py) || std::isinf(pz)) {
 					PRINTB("ERROR: Unable to convert point at index %d to a vec3 of numbers", j);
 					return ResultObject(p);
 				}
 				poly.push_back(Vector3d(px, py, pz));
-				++j;
 			}
 			p->append_poly(poly);
 			break;
@@ -787,10 +872,8 @@ public:
 
 		ResultObject visitChild(const ConstPolySetHandle &child) override
 		{
-			for (auto &p : child->getPolygons()) {
-				for (auto &v : p)
-					addPoint(v);
-			}
+			for (const auto &v : child->getVertices())
+				addPoint(v);
 			return ResultObject(nullptr);
 		}
 
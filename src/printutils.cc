@@ -21,6 +21,36 @@ void set_output_handler(OutputHandlerFunc *newhandler, void *userdata)
 	outputhandler_data = userdata;
 }
 
+// the active PrintCapture of this thread
+static thread_local PrintCapture *currentCapture = nullptr;
+
+PrintCapture *PrintCapture::current()
+{
+	return currentCapture;
+}
+
+PrintCapture::Scope::Scope(PrintCapture &capture)
+	: previous(currentCapture)
+{
+	currentCapture = &capture;
+}
+
+PrintCapture::Scope::~Scope()
+{
+	currentCapture = previous;
+}
+
+void PrintCapture::replay() const
+{
+	for (const auto &msg : messages) {
+		switch (msg.first) {
+		case MESSAGE: PRINT(msg.second); break;
+		case NOCACHE: PRINT_NOCACHE(msg.second); break;
+		case DEPRECATION: printDeprecation(msg.second); break;
+		}
+	}
+}
+
 void print_messages_push()
 {
 	print_messages_stack.push_back(std::string());
@@ -41,6 +71,10 @@ void print_messages_pop()
 void PRINT(const std::string &msg)
 {
 	if (msg.empty()) return;
+	if (auto capture = PrintCapture::current()) {
+		capture->add(PrintCapture::MESSAGE, msg);
+		return;
+	}
 	if (print_messages_stack.size() > 0) {
 		if (!print_messages_stack.back().empty()) {
 			print_messages_stack.back() += "\n";
@@ -53,6 +87,10 @@ void PRINT(const std::string &msg)
 void PRINT_NOCACHE(const std::string &msg)
 {
 	if (msg.empty()) return;
+	if (auto capture = PrintCapture::current()) {
+		capture->add(PrintCapture::NOCACHE, msg);
+		return;
+	}
 
 	if (boost::starts_with(msg, "WARNING") || boost::starts_with(msg, "ERROR")) {
 		size_t i;
@@ -112,6 +150,11 @@ std::set<std::string> printedDeprecations;
 
 void printDeprecation(const std::string &str)
 {
+	// deduplicated when replayed, so the first one in evaluation order is kept
+	if (auto capture = PrintCapture::current()) {
+		capture->add(PrintCapture::DEPRECATION, str);
+		return;
+	}
 	if (printedDeprecations.find(str) == printedDeprecations.end()) {
 		printedDeprecations.insert(str);
 		std::string msg = "DEPRECATED: " + str;
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <iostream>
 #include <boost/format.hpp>
 
@@ -35,6 +36,36 @@ void PRINT(const std::string &msg);
 void PRINT_NOCACHE(const std::string &msg);
 #define PRINTB_NOCACHE(_fmt, _arg) do { PRINT_NOCACHE(str(boost::format(_fmt) % _arg)); } while (0)
 
+/*!
+	Collects the messages printed by a thread while a PrintCapture::Scope is
+	active on it instead of printing them, so that work done concurrently
+	(e.g. threaded for loops) can be reported in order. replay() prints them
+	as if they were printed now, into the enclosing capture if there is one.
+*/
+class PrintCapture
+{
+public:
+	enum Kind { MESSAGE, NOCACHE, DEPRECATION };
+
+	void add(Kind kind, const std::string &msg) { messages.emplace_back(kind, msg); }
+	void replay() const;
+
+	// the capture of the calling thread, if any
+	static PrintCapture *current();
+
+	class Scope
+	{
+	public:
+		Scope(PrintCapture &capture);
+		~Scope();
+	private:
+		PrintCapture *previous;
+	};
+
+private:
+	std::vector<std::pair<Kind, std::string>> messages;
+};
+
 void PRINT_CONTEXT(const class Context *ctx, const class Module *mod, const class ModuleInstantiation *inst);
 
 /*PRINTD: debugging/verbose output. Usage in code:
@@ -104,8 +104,9 @@ public:
 
 public:
 	CpuProgress(Progress *progress, int cpuId, const std::string &name) 
-		: progress(progress), cpuId(cpuId)
+		: progress(progress), cpuId(cpuId), previous(progressForThread.release())
 	{
+		// pool threads may nest progress objects; keep the outer one to restore it
 		progressForThread.reset(this);
 		CpuProgressData state(cpuId, name, 0, 0);
 		stateStack.push_back(state);
@@ -116,6 +117,9 @@ public:
 	{
 		progress->setCpuProgress(cpuId, nullptr);
 		progressForThread.release();
+		progressForThread.reset(previous);
+		if (previous)
+			previous->update();
 	}
 
 	void update(bool throwIfCanceled = false)
@@ -159,6 +163,7 @@ public:
 
 	Progress *progress;
 	int cpuId;
+	CpuProgress *previous;
 	std::list<CpuProgressData> stateStack;
 };
 
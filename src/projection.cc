@@ -225,8 +225,8 @@ public:
 
 	virtual ResultObject visitChild(const ConstNefHandle &child) const
 	{
-		if (auto ps = CGALUtils::createPolySetFromNefPolyhedron(*child))
-			return visitChild(PolySetHandle(ps));
+		if (auto ps = CGALUtils::getPolySet(child))
+			return visitChild(ps);
 		return ResultObject(new EmptyGeometry());
 	}
 
@@ -157,9 +157,7 @@ class RotateExtrudeNode : public FactoryNode
 				ps_start->transform(rot);
 				// Flip vertex ordering
 				if (!flip_faces) {
-					for (Polygon &p : ps_start->getPolygons()) {
-						std::reverse(p.begin(), p.end());
-					}
+					ps_start->reverse_faces();
 				}
 				ps->append(*ps_start);
 				delete ps_start;
@@ -179,9 +177,7 @@ class RotateExtrudeNode : public FactoryNode
 					Transform3d(Eigen::AngleAxisd(M_PI / 2, Vector3d::UnitX()));					// rotate XY -> XZ
 				ps_end->transform(endTransform);
 				if (flip_faces) {
-					for (Polygon &p : ps_end->getPolygons()) {
-						std::reverse(p.begin(), p.end());
-					}
+					ps_end->reverse_faces();
 				}
 				ps->append(*ps_end);
 				delete ps_end;
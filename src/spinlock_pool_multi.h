@@ -9,7 +9,7 @@
 #include <boost/smart_ptr/detail/spinlock_pool.hpp>
 #include <boost/thread/tss.hpp>
 
-#include <list>
+#include <vector>
 #include <string>
 #include <sstream>
 #include <thread>
@@ -26,7 +26,7 @@ namespace CGAL {
 	// A custom spinlock pool class to provide locking on multiple addresses.
 	// This is based on boost's spinlock_pool class.
 	// The template parameters are:
-	//	M = The unique pool index: 0 = reserved for Gmpqx, 1 = reserved for Handle_for
+	//	M = The unique pool index: 2 = reserved for CGAL_Nef_polyhedron
 	//	N = The number of spinlocks in the pool. This [plus G] can affect cache usage?!?!
 	//	G = The number of extra global/static locks for the pool which can be accessed by 
 	//      index. All other locks are modulated across the pool: address % N.
@@ -37,7 +37,7 @@ namespace CGAL {
 		// the pool of spinlocks
 		static boost::detail::spinlock pool_[N + G];
 		// a thread-local "stack" of locks to provide thread-safe recursion
-		static boost::thread_specific_ptr<std::list<size_t>> lock_stack;
+		static boost::thread_specific_ptr<std::vector<size_t>> lock_stack;
 
 		// gets the index of the spinlock for the given address
 		template <class T>
@@ -57,20 +57,11 @@ namespace CGAL {
 			return &pool_[si];
 		}
 
-		// initialize the thread-local data (lock_stack)
+		// initialize the thread-local data (lock_stack); it is kept until the
+		// thread exits so taking a lock doesn't allocate
 		static void init_tls(){
 			if (!lock_stack.get())
-				lock_stack.reset(new std::list<size_t>());
-		}
-
-		// finalize the thread-local data (lock_stack)
-		static void end_tls() {
-			if (auto s = lock_stack.get()) {
-				if (s->empty()) {
-					delete s;
-					lock_stack.release();
-				}
-			}
+				lock_stack.reset(new std::vector<size_t>());
 		}
 
 		// check if the given spinlock index is on the stack
@@ -208,7 +199,6 @@ namespace CGAL {
 				if (count > 2) pop_unlock(locks[2]);
 				if (count > 1) pop_unlock(locks[1]);
 				if (count > 0) pop_unlock(locks[0]);
-				end_tls();
 			}
 		};
 	};
@@ -217,15 +207,7 @@ namespace CGAL {
 	boost::detail::spinlock spinlock_pool_multi<M, N, G>::pool_[N + G] = { BOOST_DETAIL_SPINLOCK_INIT };
 
 	template <size_t M, size_t N, size_t G>
-	boost::thread_specific_ptr<std::list<size_t>> spinlock_pool_multi<M, N, G>::lock_stack;
-
-	// the reserved spinlock pool for Gmp operations
-	typedef spinlock_pool_multi<0> Gmp_lock_pool;
-	// the scoped_lock type for Gmp spinlock pooled operations
-	typedef Gmp_lock_pool::scoped_lock Gmp_lock;
-
-	// the reserved spinlock pool for Handle_for operations
-	typedef spinlock_pool_multi<1> Handle_for_lock_pool;
+	boost::thread_specific_ptr<std::vector<size_t>> spinlock_pool_multi<M, N, G>::lock_stack;
 }
 
 #endif // spinmultilock_pool_h
@@ -5,7 +5,11 @@
 
 StackCheck * StackCheck::self = 0;
 
-StackCheck::StackCheck() : ptr(0)
+// the stack base of each thread; threads other than the one calling init()
+// (e.g. threaded for loops) start counting at their first check
+static thread_local unsigned char *ptr = 0;
+
+StackCheck::StackCheck()
 {
 }
 
@@ -27,6 +31,7 @@ unsigned long StackCheck::size()
 
 bool StackCheck::check()
 {
+    if (!ptr) init();
     return size() >= PlatformUtils::stackLimit();
 }
 
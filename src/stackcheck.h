@@ -13,7 +13,5 @@ public:
     unsigned long size();
     
 private:
-    unsigned char * ptr;
-    
     static StackCheck *self;
 };
@@ -36,6 +36,7 @@
 #include "clipper-utils.h"
 #include "cgal.h"
 #include "CGAL_Nef_polyhedron.h"
+#include "TransformedGeometry.h"
 #include "progress.h"
 #include "function.h"
 #include <sstream>
@@ -88,18 +89,22 @@ public:
 			TransformNode::addChild(c, child);
 	}
 
+	// 3D children are transformed lazily; consecutive transforms only compose matrices
+	bool acceptsTransformed() const override { return true; }
+
 	ResultObject visitChild(const ConstPolySetHandle &child) const override
 	{
-		PolySet *newps = (PolySet*)child->copy();
-		newps->transform(this->matrix);
-		return ResultObject(newps);
+		return ResultObject(TransformedGeometry::create(child, this->matrix));
 	}
 
 	ResultObject visitChild(const ConstNefHandle &child) const override
 	{
-		CGAL_Nef_polyhedron *newN = (CGAL_Nef_polyhedron*)child->copy();
-		newN->transform(this->matrix);
-		return ResultObject(newN);
+		return ResultObject(TransformedGeometry::create(child, this->matrix));
+	}
+
+	ResultObject visitChild(const TransformedGeometryHandle &child) const override
+	{
+		return ResultObject(TransformedGeometry::create(child, this->matrix));
 	}
 
 	ResultObject visitChild(const Polygon2dHandle &child) const override
@@ -382,11 +387,20 @@ public:
 		ValuePtr v = c.lookup_variable("m");
 		if (v->type() == Value::VECTOR) {
 			Matrix4d rawmatrix = Matrix4d::Identity();
-			for (int i = 0; i < 16; i++) {
-				size_t x = i / 4, y = i % 4;
-				if (y < v->toVector().size() && v->toVector()[y]->type() ==
-					Value::VECTOR && x < v->toVector()[y]->toVector().size())
-					v->toVector()[y]->toVector()[x]->getDouble(rawmatrix(y, x));
+			const NumericVector *packed = v->toNumericVector();
+			if (packed && packed->isMatrix()) {
+				for (size_t y = 0; y < 4 && y < packed->size(); y++) {
+					for (size_t x = 0; x < 4 && x < packed->columns(); x++)
+						rawmatrix(y, x) = packed->row(y)[x];
+				}
+			}
+			else {
+				for (int i = 0; i < 16; i++) {
+					size_t x = i / 4, y = i % 4;
+					if (y < v->toVector().size() && v->toVector()[y]->type() ==
+						Value::VECTOR && x < v->toVector()[y]->toVector().size())
+						v->toVector()[y]->toVector()[x]->getDouble(rawmatrix(y, x));
+				}
 			}
 			double w = rawmatrix(3, 3);
 			if (w != 1.0) this->matrix = rawmatrix / w;
@@ -97,111 +97,104 @@ std::ostream &operator<<(std::ostream &stream, const QuotedString &s)
 Value::Value() : value(boost::blank())
 {
   //  std::cout << "creating undef\n";
-	debugValue = this->toString();
 }
 
 Value::Value(bool v) : value((bool)v)
 {
   //  std::cout << "creating bool\n";
-	debugValue = this->toString();
 }
 
 Value::Value(int v) : value(double(v))
 {
   //  std::cout << "creating int\n";
-	debugValue = this->toString();
 }
 
 Value::Value(double v) : value((double)v)
 {
   //  std::cout << "creating double " << v << "\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const std::string &v) : value(v)
 {
   //  std::cout << "creating string\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const char *v) : value(std::string(v))
 {
   //  std::cout << "creating string from char *\n";
-	debugValue = this->toString();
 }
 
 Value::Value(char v) : value(std::string(1, v))
 {
   //  std::cout << "creating string from char\n";
-	debugValue = this->toString();
 }
 
-Value::Value(const VectorType &v) : value(v)
+Value::Value(const VectorType &v)
 {
   //  std::cout << "creating vector\n";
-	debugValue = this->toString();
+	NumericVector packed;
+	if (NumericVector::pack(v, packed)) this->value = packed;
+	else this->value = v;
 }
 
 Value::Value(const RangeType &v) : value(v)
 {
 	//  std::cout << "creating range\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const ScopeType &v) : value(v)
 {
 	//  std::cout << "creating range\n";
-	debugValue = this->toString();
+}
+
+Value::Value(const NumericVector &v) : value(v)
+{
+	//  std::cout << "creating numeric vector\n";
 }
 
 template <typename VT, int N>
-Value::VectorType makeVectorType(const Eigen::Matrix<VT, N, 1> &v)
+NumericVector makeVectorType(const Eigen::Matrix<VT, N, 1> &v)
 {
-	Value::VectorType result;
+	std::vector<double> result(N);
 	for (auto r = 0; r < N; ++r)
-		result.push_back(v[r]);
-	return result;
+		result[r] = v[r];
+	return NumericVector(std::move(result));
 }
 
 Value::Value(const Vector3d &v) : value(makeVectorType(v))
 {
 	//  std::cout << "creating vector3d\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const Vector4d &v) : value(makeVectorType(v))
 {
 	//  std::cout << "creating vector4d\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const Vector3f &v) : value(makeVectorType(v))
 {
 	//  std::cout << "creating vector3f\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const Vector4f &v) : value(makeVectorType(v))
 {
 	//  std::cout << "creating vector4f\n";
-	debugValue = this->toString();
 }
 
 Value::Value(const Transform3d &v)
 {
-	VectorType rows;
+	std::vector<double> rows(16);
 	for (int r = 0; r < 4; ++r) {
-		VectorType row;
 		for (int c = 0; c < 4; ++c)
-			row.push_back(v(r, c));
-		rows.push_back(row);
+			rows[r * 4 + c] = v(r, c);
 	}
-	value = rows;
-	debugValue = this->toString();
+	value = NumericVector(std::move(rows), 4);
 }
 
 Value::ValueType Value::type() const
 {
+  // packed vectors are vectors as far as scripts are concerned
+  if (boost::get<NumericVector>(&this->value)) return VECTOR;
   return static_cast<ValueType>(this->value.which());
 }
 
@@ -233,6 +226,7 @@ bool Value::toBool() const
     return boost::get<std::string>(this->value).size() > 0;
     break;
   case VECTOR:
+	  if (auto packed = toNumericVector()) return packed->size() > 0;
 	  return boost::get<VectorType>(this->value).size() > 0;
 	  break;
   case STRUCT:
@@ -319,6 +313,28 @@ public:
 	  return stream.str();
   }
 
+  std::string operator()(const NumericVector &v) const {
+	  std::stringstream stream;
+	  stream << '[';
+	  for (size_t i = 0; i < v.size(); i++) {
+		  if (i > 0) stream << ", ";
+		  if (v.isMatrix()) {
+			  const double *row = v.row(i);
+			  stream << '[';
+			  for (size_t c = 0; c < v.columns(); c++) {
+				  if (c > 0) stream << ", ";
+				  stream << (*this)(row[c]);
+			  }
+			  stream << ']';
+		  }
+		  else {
+			  stream << (*this)(v.data()[i]);
+		  }
+	  }
+	  stream << ']';
+	  return stream.str();
+  }
+
   std::string operator()(const Value::ScopeType &v) const {
 	  std::stringstream stream;
 	  stream << "{ ";
@@ -381,6 +397,16 @@ public:
 			return stream.str();
 		}
 
+	std::string operator()(const NumericVector &v) const
+		{
+			// rows of a matrix contribute all their numbers, in order
+			std::stringstream stream;
+			for (double d : v.data()) {
+				stream << (*this)(d);
+			}
+			return stream.str();
+		}
+
 	std::string operator()(const RangeType &v) const
 		{
 			const uint32_t steps = v.numValues();
@@ -410,13 +436,41 @@ const Value::VectorType &Value::toVector() const
 
 	const VectorType *v = boost::get<VectorType>(&this->value);
 	if (v) return *v;
+	if (auto packed = toNumericVector()) return packed->boxed();
 	else return empty;
 }
 
+const NumericVector *Value::toNumericVector() const
+{
+	return boost::get<NumericVector>(&this->value);
+}
+
+void Value::getNumbers(std::vector<double> &result) const
+{
+	if (auto packed = toNumericVector()) {
+		if (packed->isMatrix()) result.assign(packed->size(), 0);
+		else result = packed->data();
+		return;
+	}
+	result.clear();
+	for (const auto &v : toVector()) {
+		result.push_back(v->toDouble());
+	}
+}
+
 bool Value::getVec2(double &x, double &y, bool ignoreInfinite) const
 {
   if (this->type() != VECTOR) return false;
 
+  if (auto packed = toNumericVector()) {
+    if (packed->isMatrix() || packed->size() != 2) return false;
+    const double *d = packed->data().data();
+    if (ignoreInfinite && (!std::isfinite(d[0]) || !std::isfinite(d[1]))) return false;
+    x = d[0];
+    y = d[1];
+    return true;
+  }
+
   const VectorType &v = toVector();
   
   if (v.size() != 2) return false;
@@ -438,6 +492,15 @@ bool Value::getVec3(double &x, double &y, double &z, double defaultval) const
 {
 	if (this->type() != VECTOR) return false;
 
+	if (auto packed = toNumericVector()) {
+		if (packed->isMatrix() || packed->size() < 2 || packed->size() > 3) return false;
+		const double *d = packed->data().data();
+		x = d[0];
+		y = d[1];
+		z = packed->size() == 3 ? d[2] : defaultval;
+		return true;
+	}
+
 	const VectorType &v = toVector();
 
 	if (v.size() == 2) {
@@ -456,6 +519,16 @@ bool Value::getVec4(double &x, double &y, double &z, double &w, double defaultva
 {
 	if (this->type() != VECTOR) return false;
 
+	if (auto packed = toNumericVector()) {
+		if (packed->isMatrix() || packed->size() < 2 || packed->size() > 4) return false;
+		const double *d = packed->data().data();
+		x = d[0];
+		y = d[1];
+		z = packed->size() >= 3 ? d[2] : defaultval;
+		w = packed->size() == 4 ? d[3] : defaultval;
+		return true;
+	}
+
 	const VectorType &v = toVector();
 
 	if (v.size() == 2) {
@@ -465,7 +538,7 @@ bool Value::getVec4(double &x, double &y, double &z, double &w, double defaultva
 		return true;
 	}
 	else if (v.size() == 3) {
-		getVec2(x, y, z);
+		getVec3(x, y, z);
 		w = defaultval;
 		return true;
 	} 
@@ -480,6 +553,18 @@ bool Value::getTransform(Transform3d &m) const
 {
 	if (this->type() != VECTOR) return false;
 
+	if (auto packed = toNumericVector()) {
+		// rows are read like getVec4() does, missing columns are 0
+		const size_t columns = packed->columns();
+		if (packed->size() != 4 || columns < 2 || columns > 4) return false;
+		for (int r = 0; r < 4; ++r) {
+			const double *row = packed->row(r);
+			for (size_t c = 0; c < 4; ++c)
+				m(r, c) = c < columns ? row[c] : 0.0;
+		}
+		return true;
+	}
+
 	const VectorType &v = toVector();
 		
 	if (v.size() != 4) return false;
@@ -533,6 +618,14 @@ public:
   template <typename T> bool operator()(const T &op1, const T &op2) const {
     return op1 == op2;
   }
+
+  bool operator()(const NumericVector &op1, const Value::VectorType &op2) const {
+    return op1.boxed() == op2;
+  }
+
+  bool operator()(const Value::VectorType &op1, const NumericVector &op2) const {
+    return op1 == op2.boxed();
+  }
 };
 
 bool Value::operator==(const Value &v) const
@@ -599,6 +692,83 @@ bool Value::operator<=(const Value &v) const
 	return boost::apply_visitor(lessequal_visitor(), this->value, v.value);
 }
 
+namespace {
+	// applies op to every number of a packed vector, keeping its shape
+	template <typename Op>
+	Value map(const NumericVector &vec, Op op)
+	{
+		std::vector<double> result(vec.data().size());
+		for (size_t i = 0; i < result.size(); i++) {
+			result[i] = op(vec.data()[i]);
+		}
+		return Value(NumericVector(std::move(result), vec.columns()));
+	}
+
+	// applies op elementwise to packed vectors of the same shape, truncated
+	// to the shorter one like the boxed vector operators
+	template <typename Op>
+	Value elementwise(const NumericVector &op1, const NumericVector &op2, Op op)
+	{
+		size_t n = std::min(op1.data().size(), op2.data().size());
+		if (n == 0) return Value(Value::VectorType());
+		std::vector<double> result(n);
+		for (size_t i = 0; i < n; i++) {
+			result[i] = op(op1.data()[i], op2.data()[i]);
+		}
+		return Value(NumericVector(std::move(result), op1.columns()));
+	}
+
+	// dot, matrix * vector, vector * matrix and matrix * matrix products of
+	// packed operands; returns false when the shapes don't match
+	bool multiply(const NumericVector &a, const NumericVector &b, Value &result)
+	{
+		const std::vector<double> &da = a.data();
+		const std::vector<double> &db = b.data();
+		if (!a.isMatrix() && !b.isMatrix()) {
+			// Vector dot product
+			if (a.size() != b.size()) return false;
+			double r = 0.0;
+			for (size_t i = 0; i < da.size(); i++) {
+				r += da[i] * db[i];
+			}
+			result = Value(r);
+		}
+		else if (a.isMatrix() && !b.isMatrix()) {
+			// Matrix * vector
+			if (a.columns() != b.size()) return false;
+			std::vector<double> dst(a.size());
+			for (size_t i = 0; i < a.size(); i++) {
+				const double *row = a.row(i);
+				double r_e = 0.0;
+				for (size_t j = 0; j < a.columns(); j++) {
+					r_e += row[j] * db[j];
+				}
+				dst[i] = r_e;
+			}
+			result = Value(NumericVector(std::move(dst)));
+		}
+		else {
+			// Vector * matrix, row by row for Matrix * matrix
+			const size_t rows = a.isMatrix() ? a.size() : 1;
+			const size_t inner = a.isMatrix() ? a.columns() : a.size();
+			if (inner != b.size()) return false;
+			std::vector<double> dst(rows * b.columns(), 0.0);
+			for (size_t r = 0; r < rows; r++) {
+				const double *vec = a.isMatrix() ? a.row(r) : da.data();
+				double *out = dst.data() + r * b.columns();
+				for (size_t j = 0; j < inner; j++) {
+					const double *row = b.row(j);
+					for (size_t i = 0; i < b.columns(); i++) {
+						out[i] += vec[j] * row[i];
+					}
+				}
+			}
+			result = Value(NumericVector(std::move(dst), a.isMatrix() ? b.columns() : 0));
+		}
+		return true;
+	}
+}
+
 class plus_visitor : public boost::static_visitor<Value>
 {
 public:
@@ -618,6 +788,19 @@ public:
 		return Value(sum);
 	}
 
+	Value operator()(const NumericVector &op1, const NumericVector &op2) const {
+		if (op1.columns() != op2.columns()) return (*this)(op1.boxed(), op2.boxed());
+		return elementwise(op1, op2, [](double a, double b) { return a + b; });
+	}
+
+	Value operator()(const NumericVector &op1, const Value::VectorType &op2) const {
+		return (*this)(op1.boxed(), op2);
+	}
+
+	Value operator()(const Value::VectorType &op1, const NumericVector &op2) const {
+		return (*this)(op1, op2.boxed());
+	}
+
 	// combine two scopes
 	Value operator()(const Value::ScopeType &op1, const Value::ScopeType &op2) const {
 		return Value(op1 + op2);
@@ -647,6 +830,19 @@ public:
 		}
 		return Value(sum);
 	}
+
+	Value operator()(const NumericVector &op1, const NumericVector &op2) const {
+		if (op1.columns() != op2.columns()) return (*this)(op1.boxed(), op2.boxed());
+		return elementwise(op1, op2, [](double a, double b) { return a - b; });
+	}
+
+	Value operator()(const NumericVector &op1, const Value::VectorType &op2) const {
+		return (*this)(op1.boxed(), op2);
+	}
+
+	Value operator()(const Value::VectorType &op1, const NumericVector &op2) const {
+		return (*this)(op1, op2.boxed());
+	}
 };
 
 Value Value::operator-(const Value &v) const
@@ -710,6 +906,21 @@ Value Value::operator*(const Value &v) const
 	if (this->type() == NUMBER && v.type() == NUMBER) {
 		return Value(this->toDouble() * v.toDouble());
 	}
+	// packed vectors and matrices are multiplied without boxing their elements
+	const NumericVector *packed1 = this->toNumericVector();
+	const NumericVector *packed2 = v.toNumericVector();
+	if (packed1 && v.type() == NUMBER) {
+		double num = v.toDouble();
+		return map(*packed1, [num](double d) { return d * num; });
+	}
+	if (packed2 && this->type() == NUMBER) {
+		double num = this->toDouble();
+		return map(*packed2, [num](double d) { return d * num; });
+	}
+	Value product;
+	if (packed1 && packed2 && multiply(*packed1, *packed2, product)) {
+		return product;
+	}
 	else if (this->type() == VECTOR && v.type() == NUMBER) {
 		return multvecnum(*this, v);
 	}
@@ -763,6 +974,10 @@ Value Value::operator/(const Value &v) const
   }
   else if (this->type() == VECTOR && v.type() == NUMBER) {
 	  // vector / scalar
+    if (auto packed = this->toNumericVector()) {
+      double num = v.toDouble();
+      return map(*packed, [num](double d) { return d / num; });
+    }
     const VectorType &vec = this->toVector();
     VectorType dstv;
     for(const auto &vecval : vec) {
@@ -772,6 +987,10 @@ Value Value::operator/(const Value &v) const
   }
   else if (this->type() == NUMBER && v.type() == VECTOR) {
 	  // scalar / vector
+    if (auto packed = v.toNumericVector()) {
+      double num = this->toDouble();
+      return map(*packed, [num](double d) { return num / d; });
+    }
     const VectorType &vec = v.toVector();
     VectorType dstv;
     for(const auto &vecval : vec) {
@@ -796,6 +1015,9 @@ Value Value::operator-() const
     return Value(-this->toDouble());
   }
   else if (this->type() == VECTOR) {
+    if (auto packed = this->toNumericVector()) {
+      return map(*packed, [](double d) { return -d; });
+    }
     const VectorType &vec = this->toVector();
     VectorType dstv;
     for(const auto &vecval : vec) {
@@ -850,6 +1072,16 @@ public:
     return Value::undefined;
   }
 
+  Value operator()(const NumericVector &vec, const double &idx) const {
+    const uint32_t i = convert_to_uint32(idx);
+    if (i < vec.size()) {
+      if (!vec.isMatrix()) return Value(vec.data()[i]);
+      const double *row = vec.row(i);
+      return Value(NumericVector(std::vector<double>(row, row + vec.columns())));
+    }
+    return Value::undefined;
+  }
+
   Value operator()(const RangeType &range, const double &idx) const {
     const uint32_t i = convert_to_uint32(idx);
     switch(i) {
@@ -974,100 +1206,191 @@ bool RangeType::iterator::operator!=(const self_type &other) const
 	return !(*this == other);
 }
 
+const std::vector<double> NumericVector::noData;
+
+NumericVector::NumericVector(std::vector<double> &&data, size_t columns)
+{
+	auto rep = std::make_shared<Rep>();
+	rep->data = std::move(data);
+	rep->columns = columns;
+	this->rep = rep;
+}
+
+bool NumericVector::pack(const std::vector<ValuePtr> &vec, NumericVector &result)
+{
+	if (vec.empty()) return false;
+
+	std::vector<double> data;
+	if (const NumericVector *first = vec[0]->toNumericVector()) {
+		// rows of a matrix or point list
+		const size_t columns = first->size();
+		if (first->isMatrix() || columns == 0) return false;
+		data.reserve(vec.size() * columns);
+		for (const auto &v : vec) {
+			const NumericVector *row = v->toNumericVector();
+			if (!row || row->isMatrix() || row->size() != columns) return false;
+			data.insert(data.end(), row->data().begin(), row->data().end());
+		}
+		result = NumericVector(std::move(data), columns);
+	}
+	else {
+		data.reserve(vec.size());
+		for (const auto &v : vec) {
+			double d;
+			if (!v->getDouble(d)) return false;
+			data.push_back(d);
+		}
+		result = NumericVector(std::move(data));
+	}
+	return true;
+}
+
+bool NumericVector::concat(const std::vector<ValuePtr> &parts, NumericVector &result)
+{
+	size_t columns = 0, total = 0;
+	bool shaped = false;
+	for (const auto &part : parts) {
+		size_t partColumns = 0;
+		if (const NumericVector *packed = part->toNumericVector()) {
+			partColumns = packed->columns();
+			total += packed->data().size();
+		}
+		else if (part->type() == Value::NUMBER) {
+			total++;
+		}
+		else if (part->type() == Value::VECTOR && part->toVector().empty()) {
+			continue;
+		}
+		else return false;
+		if (shaped && partColumns != columns) return false;
+		columns = partColumns;
+		shaped = true;
+	}
+	if (total == 0) return false;
+
+	std::vector<double> data;
+	data.reserve(total);
+	for (const auto &part : parts) {
+		if (const NumericVector *packed = part->toNumericVector()) {
+			data.insert(data.end(), packed->data().begin(), packed->data().end());
+		}
+		else if (part->type() == Value::NUMBER) {
+			data.push_back(part->toDouble());
+		}
+	}
+	result = NumericVector(std::move(data), columns);
+	return true;
+}
+
+ValuePtr NumericVector::element(size_t i) const
+{
+	if (!isMatrix()) return ValuePtr(data()[i]);
+	const double *r = row(i);
+	return ValuePtr(NumericVector(std::vector<double>(r, r + columns())));
+}
+
+const std::vector<ValuePtr> &NumericVector::boxed() const
+{
+	static const std::vector<ValuePtr> empty;
+	if (!rep) return empty;
+	std::call_once(rep->boxedFlag, [this] {
+		rep->boxed.reserve(size());
+		for (size_t i = 0; i < size(); i++) {
+			rep->boxed.push_back(element(i));
+		}
+	});
+	return rep->boxed;
+}
+
+bool NumericVector::operator==(const NumericVector &other) const
+{
+	if (size() == 0 && other.size() == 0) return true;
+	return columns() == other.columns() && data() == other.data();
+}
+
 ValuePtr::ValuePtr()
 {
 	this->reset(new Value());
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Value &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(bool v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(int v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(double v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const std::string &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const char *v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const char v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Value::VectorType &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const RangeType &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Value::ScopeType &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
+}
+
+ValuePtr::ValuePtr(const NumericVector &v)
+{
+	this->reset(new Value(v));
 }
 
 ValuePtr::ValuePtr(const Vector3d &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Vector4d &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Vector3f &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Vector4f &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 ValuePtr::ValuePtr(const Transform3d &v)
 {
 	this->reset(new Value(v));
-	this->debugValue = get()->toString();
 }
 
 bool ValuePtr::operator==(const ValuePtr &v) const
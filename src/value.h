@@ -5,6 +5,7 @@
 #include <string>
 #include <algorithm>
 #include <limits>
+#include <mutex>
 
 // Workaround for https://bugreports.qt-project.org/browse/QTBUG-22829
 #ifndef Q_MOC_RUN
@@ -115,6 +116,7 @@ public:
   ValuePtr(const class std::vector<ValuePtr> &v);
   ValuePtr(const class RangeType &v);
   ValuePtr(const class LocalScope &v);
+  ValuePtr(const class NumericVector &v);
   ValuePtr(const Vector3d &v);
   ValuePtr(const Vector4d &v);
   ValuePtr(const Vector3f &v);
@@ -139,9 +141,56 @@ public:
   ValuePtr operator%(const ValuePtr &v) const;
 
   const Value &operator*() const;
+};
+
+/*!
+	Contiguous storage for homogeneous numeric vectors and matrices.
+
+	Vectors of numbers ([1, 2, 3]) and vectors of equally long number vectors
+	(point lists, transformation matrices) are stored as one array of doubles
+	instead of one ValuePtr per element. A flat vector has columns() == 0, a
+	matrix stores size() rows of columns() numbers back to back.
+
+	Such values still have the type Value::VECTOR. The data is immutable and
+	shared between copies; callers of Value::toVector() get ValuePtr elements
+	which are boxed once, on first use.
+*/
+class NumericVector
+{
+public:
+	NumericVector() { }
+	NumericVector(std::vector<double> &&data, size_t columns = 0);
+
+	// packs vec if it holds only numbers or only packed flat vectors of the same size
+	static bool pack(const std::vector<ValuePtr> &vec, NumericVector &result);
+	// concatenates packed vectors of the same shape (and numbers, for flat vectors)
+	static bool concat(const std::vector<ValuePtr> &parts, NumericVector &result);
+
+	// number of elements, i.e. numbers or rows
+	size_t size() const { return rep ? (rep->columns ? rep->data.size() / rep->columns : rep->data.size()) : 0; }
+	size_t columns() const { return rep ? rep->columns : 0; }
+	bool isMatrix() const { return columns() != 0; }
+	// a matrix of 2D or 3D points
+	bool isPoints() const { return columns() == 2 || columns() == 3; }
+
+	const std::vector<double> &data() const { return rep ? rep->data : noData; }
+	const double *row(size_t i) const { return rep->data.data() + i * rep->columns; }
+
+	// element i as a number or, for matrices, as a packed row
+	ValuePtr element(size_t i) const;
+	const std::vector<ValuePtr> &boxed() const;
+
+	bool operator==(const NumericVector &other) const;
 
 private:
-	std::string debugValue;
+	struct Rep {
+		std::vector<double> data;
+		size_t columns;
+		mutable std::once_flag boxedFlag;
+		mutable std::vector<ValuePtr> boxed;
+	};
+	shared_ptr<const Rep> rep;
+	static const std::vector<double> noData;
 };
 
 class Value
@@ -172,6 +221,7 @@ public:
   Value(const VectorType &v);
   Value(const RangeType &v);
   Value(const ScopeType &v);
+  Value(const NumericVector &v);
   Value(const Vector3d &v);
   Value(const Vector4d &v);
   Value(const Vector3f &v);
@@ -192,6 +242,10 @@ public:
   std::string toEchoString() const;
   std::string chrString() const;
   const VectorType &toVector() const;
+  // the packed storage of a VECTOR, or nullptr if its elements are boxed
+  const NumericVector *toNumericVector() const;
+  // copies the numbers of a vector into result; other elements become 0
+  void getNumbers(std::vector<double> &result) const;
   bool getVec2(double &x, double &y, bool ignoreInfinite = false) const;
   bool getVec3(double &x, double &y, double &z, double defaultval = 0.0) const;
   bool getVec4(double &x, double &y, double &z, double &w, double defaultval = 0.0) const;
@@ -222,14 +276,16 @@ public:
     return stream;
   }
 
-  typedef boost::variant< boost::blank, bool, double, std::string, VectorType, RangeType, ScopeType > Variant;
+  // NumericVector has to stay last, type() reports it as VECTOR
+  typedef boost::variant< boost::blank, bool, double, std::string, VectorType, RangeType, ScopeType, NumericVector > Variant;
 
 private:
   static Value multvecnum(const Value &vecval, const Value &numval);
   static Value multmatvec(const VectorType &matrixvec, const VectorType &vectorvec);
   static Value multvecmat(const VectorType &vectorvec, const VectorType &matrixvec);
 
+  // Values are created in large numbers (e.g. point lists), so they don't
+  // keep a string representation around. Use toString() from a debugger.
   Variant value;
-  std::string debugValue;
 };
 
@@ -0,0 +1,173 @@
+#!/usr/bin/env python
+#
+# Performance regression test: renders a benchmark model and compares its
+# run time and peak memory with a stored baseline.
+#
+# Usage: benchmark.py --openscad=<executable> --baseline=<file.json> [options] <file.scad> [openscad args]
+#
+# The model is rendered to STL --runs times. The fastest run's wall time and
+# the largest peak resident set size are compared with the model's entry in
+# the baseline file, which looks like:
+#
+#   {
+#     "tolerance": {"time": 0.5, "rss": 0.25},
+#     "models": {
+#       "union-many": {"time": 12.5, "rss": 310000000, "tolerance": {"time": 1.0}}
+#     }
+#   }
+#
+# Times are seconds and sizes bytes. A tolerance is the allowed relative
+# increase; a model's own tolerances override the global ones, and
+# --time-tolerance and --rss-tolerance override both. A model without a
+# baseline entry fails, printing its measurements, so a benchmark that was
+# never recorded doesn't pass unnoticed.
+#
+# Baselines only make sense for the machine they were recorded on. With
+# --update (or TEST_GENERATE=1) the measurements are written to the baseline
+# file instead of being compared; record them with
+#   TEST_GENERATE=1 ctest -C Perf -L perf
+#
+# --mesh=<file> generates a large binary STL torus at <file> if it doesn't
+# exist yet and passes it to the model as -D mesh="<file>".
+#
+# Peak memory is measured on POSIX systems only.
+#
+# Returns 0 if the model is within its tolerances, 1 otherwise.
+#
+
+from __future__ import print_function
+
+import sys, os, json, math, struct, subprocess, tempfile, time, argparse
+
+def failquit(*args):
+	if len(args) != 0: print(*args)
+	print('benchmark args:', str(sys.argv))
+	print('exiting benchmark.py with failure')
+	sys.exit(1)
+
+def generate_mesh(filename, rings=400, sides=500):
+	"""Writes a binary STL torus with 2 * rings * sides triangles."""
+	R, r = 40.0, 15.0
+	def vertex(i, j):
+		u = 2 * math.pi * (i % rings) / rings
+		v = 2 * math.pi * (j % sides) / sides
+		return ((R + r * math.cos(v)) * math.cos(u), (R + r * math.cos(v)) * math.sin(u), r * math.sin(v))
+	facet = struct.Struct('<12fH')
+	tmpname = filename + '.tmp'
+	with open(tmpname, 'wb') as f:
+		f.write(b'benchmark torus'.ljust(80, b' '))
+		f.write(struct.pack('<I', 2 * rings * sides))
+		for i in range(rings):
+			for j in range(sides):
+				a, b, c, d = vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1), vertex(i, j + 1)
+				f.write(facet.pack(*((0, 0, 0) + a + b + c + (0,))))
+				f.write(facet.pack(*((0, 0, 0) + a + c + d + (0,))))
+	os.rename(tmpname, filename)
+
+def run_once(cmd):
+	"""Runs cmd, returning its wall time and peak RSS in bytes (None if unknown)."""
+	start = time.time()
+	proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+	output = proc.communicate()[0]
+	wall = time.time() - start
+	if proc.returncode != 0:
+		print(output.decode('utf-8', 'replace'))
+		failquit('openscad exited with', proc.returncode)
+	return wall, None
+
+def run_once_posix(cmd):
+	start = time.time()
+	with tempfile.TemporaryFile() as log:
+		proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+		# wait4 gives the usage of this child alone
+		status, usage = os.wait4(proc.pid, 0)[1:]
+		wall = time.time() - start
+		proc.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+		if proc.returncode != 0:
+			log.seek(0)
+			print(log.read().decode('utf-8', 'replace'))
+			failquit('openscad exited with', proc.returncode)
+	# ru_maxrss is in kilobytes, except on macOS
+	rss = usage.ru_maxrss if sys.platform == 'darwin' else usage.ru_maxrss * 1024
+	return wall, rss
+
+def within(name, measured, expected, tolerance, unit):
+	limit = expected * (1 + tolerance)
+	ok = measured <= limit
+	print('%s: %.3f%s, baseline %.3f%s, limit %.3f%s (+%d%%) %s' %
+		  (name, measured / unit[0], unit[1], expected / unit[0], unit[1], limit / unit[0], unit[1],
+		   round(tolerance * 100), 'ok' if ok else 'REGRESSION'))
+	return ok
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable')
+parser.add_argument('--baseline', required=True, help='Baseline file (.json)')
+parser.add_argument('--runs', type=int, default=3, help='Number of runs, the fastest one counts')
+parser.add_argument('--time-tolerance', type=float, help='Allowed relative increase of the time')
+parser.add_argument('--rss-tolerance', type=float, help='Allowed relative increase of the peak memory')
+parser.add_argument('--mesh', help='Generate a large STL mesh at this path and pass it as mesh')
+parser.add_argument('--update', action='store_true', help='Record the measurements in the baseline')
+args, remaining_args = parser.parse_known_args()
+if not remaining_args: failquit('no benchmark model given')
+
+scadfile = remaining_args[0]
+model = os.path.splitext(os.path.basename(scadfile))[0]
+update = args.update or bool(os.getenv('TEST_GENERATE'))
+
+cmd = [args.openscad, scadfile]
+if args.mesh:
+	if not os.path.exists(args.mesh):
+		meshdir = os.path.dirname(args.mesh)
+		if meshdir and not os.path.exists(meshdir): os.makedirs(meshdir)
+		print('generating', args.mesh)
+		generate_mesh(args.mesh)
+	cmd += ['-D', 'mesh="%s"' % os.path.abspath(args.mesh).replace('\\', '/')]
+outputfile = os.path.join(tempfile.gettempdir(), 'benchmark-%s-%d.stl' % (model, os.getpid()))
+cmd += remaining_args[1:] + ['-o', outputfile]
+print('running', ' '.join(cmd))
+
+measure = run_once_posix if hasattr(os, 'wait4') else run_once
+times, peak = [], None
+try:
+	for i in range(max(1, args.runs)):
+		wall, rss = measure(cmd)
+		times.append(wall)
+		if rss is not None: peak = max(peak or 0, rss)
+finally:
+	if os.path.exists(outputfile): os.remove(outputfile)
+best = min(times)
+print('%s: runs %s' % (model, ', '.join('%.3fs' % t for t in times)))
+
+baseline = {'tolerance': {'time': 0.5, 'rss': 0.25}, 'models': {}}
+if os.path.exists(args.baseline):
+	try:
+		with open(args.baseline) as f: baseline = json.load(f)
+	except ValueError as e:
+		failquit('can\'t read baseline', args.baseline + ':', str(e))
+
+if update:
+	entry = baseline.setdefault('models', {}).setdefault(model, {})
+	entry['time'] = round(best, 3)
+	if peak is not None: entry['rss'] = peak
+	with open(args.baseline, 'w') as f:
+		json.dump(baseline, f, indent=2, sort_keys=True)
+		f.write('\n')
+	print('recorded %s in %s' % (model, args.baseline))
+	sys.exit(0)
+
+entry = baseline.get('models', {}).get(model)
+if entry is None:
+	failquit('%s: %.3fs, peak %s, no baseline in %s; record it with --update or TEST_GENERATE=1' %
+		(model, best, '%.1fMB' % (peak / 1e6) if peak else 'unknown', args.baseline))
+
+tolerance = dict(baseline.get('tolerance', {}))
+tolerance.update(entry.get('tolerance', {}))
+if args.time_tolerance is not None: tolerance['time'] = args.time_tolerance
+if args.rss_tolerance is not None: tolerance['rss'] = args.rss_tolerance
+
+ok = True
+if 'time' in entry:
+	ok &= within('time', best, entry['time'], tolerance.get('time', 0.5), (1.0, 's'))
+if 'rss' in entry and peak is not None:
+	ok &= within('peak memory', peak, entry['rss'], tolerance.get('rss', 0.25), (1e6, 'MB'))
+sys.exit(0 if ok else 1)
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+#
+# 3MF export test: exports a model to 3MF and to STL, unpacks the 3MF
+# package and checks its model.
+#
+# Usage: export3mftest.py --openscad=<executable> <file.scad> [openscad args]
+#
+# The package must hold the content types, the relationships and the 3D
+# model. Every object's mesh must be closed and consistently oriented, with
+# valid, non-degenerate triangles, and the vertices used by all objects must
+# be the vertices of the STL export, which is written with the same digits.
+#
+# Returns 0 if the package is valid, 1 otherwise.
+#
+
+from __future__ import print_function
+
+import sys, os, subprocess, tempfile, zipfile, argparse
+import xml.etree.ElementTree as ElementTree
+from collections import Counter
+from validatestl import read_stl
+
+CORE = '{http://schemas.microsoft.com/3dmanufacturing/core/2015/02}'
+
+def failquit(*args):
+	if len(args) != 0: print(*args)
+	print('export3mftest args:', str(sys.argv))
+	print('exiting export3mftest.py with failure')
+	sys.exit(1)
+
+def export(openscad, scadfile, outfile, args):
+	cmd = [openscad, scadfile, '-o', outfile] + args
+	print('Running', ' '.join(cmd))
+	if subprocess.call(cmd) != 0:
+		failquit('openscad failed')
+
+def check_object(obj):
+	mesh = obj.find(CORE + 'mesh')
+	if mesh is None: failquit('object', obj.get('id'), 'has no mesh')
+	vertices = [(float(v.get('x')), float(v.get('y')), float(v.get('z')))
+		for v in mesh.find(CORE + 'vertices')]
+	triangles = [(int(t.get('v1')), int(t.get('v2')), int(t.get('v3')))
+		for t in mesh.find(CORE + 'triangles')]
+	if not triangles: failquit('object', obj.get('id'), 'has no triangles')
+	for t in triangles:
+		if min(t) < 0 or max(t) >= len(vertices):
+			failquit('object', obj.get('id'), 'has a triangle with an invalid index:', t)
+		if len(set(vertices[i] for i in t)) != 3:
+			failquit('object', obj.get('id'), 'has a degenerate triangle:', t)
+	edges = Counter((t[i], t[(i+1)%3]) for i in range(0,3) for t in triangles)
+	edges.subtract(Counter((t[(i+1)%3], t[i]) for i in range(0,3) for t in triangles))
+	edges += Counter()
+	if len(edges) > 0:
+		failquit('object', obj.get('id'), 'is not a closed mesh:', str(edges))
+	return set(vertices[i] for t in triangles for i in t)
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('--openscad', required=True, help='the openscad executable')
+	parser.add_argument('scadfile')
+	args, openscad_args = parser.parse_known_args()
+
+	tmpdir = tempfile.mkdtemp()
+	threemffile = os.path.join(tmpdir, 'out.3mf')
+	stlfile = os.path.join(tmpdir, 'out.stl')
+	export(args.openscad, args.scadfile, threemffile, openscad_args)
+	export(args.openscad, args.scadfile, stlfile, openscad_args)
+
+	try:
+		package = zipfile.ZipFile(threemffile)
+	except zipfile.BadZipfile as e:
+		failquit('not a zip file:', e)
+	names = package.namelist()
+	for name in ['[Content_Types].xml', '_rels/.rels', '3D/3dmodel.model']:
+		if name not in names: failquit('the package has no', name)
+	try:
+		model = ElementTree.fromstring(package.read('3D/3dmodel.model'))
+	except ElementTree.ParseError as e:
+		failquit("can't parse the model:", e)
+
+	objects = model.find(CORE + 'resources').findall(CORE + 'object')
+	if not objects: failquit('the model has no objects')
+	vertices = set()
+	for obj in objects:
+		vertices |= check_object(obj)
+	items = model.find(CORE + 'build').findall(CORE + 'item')
+	if len(items) != len(objects):
+		failquit('the build has', len(items), 'items for', len(objects), 'objects')
+
+	mesh = read_stl(stlfile)
+	stlvertices = set(tuple(mesh.points[i]) for t in mesh.triangles for i in t)
+	if vertices != stlvertices:
+		failquit('the 3MF has', len(vertices - stlvertices), 'vertices which the STL has not, and lacks',
+			len(stlvertices - vertices))
+	print('3MF package OK:', len(objects), 'objects,', len(vertices), 'vertices')
+
+if __name__ == '__main__':
+	main()
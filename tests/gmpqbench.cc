@@ -0,0 +1,87 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2011 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Microbenchmark for the reference counted Gmpq handles.
+//
+// Every thread copies handles out of one shared table of numbers (the
+// pattern Nef operations produce when many threads read the same points)
+// and does a little exact arithmetic on the copies. The throughput is
+// reported for 1, 4 and 16 threads, or for the thread counts given on the
+// command line.
+//
+// usage: gmpqbench [iterations] [threads...]
+
+#include "cgal.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static double run(const std::vector<CGAL::Gmpq> &table, size_t iterations, size_t numThreads)
+{
+	std::vector<std::thread> threads;
+	std::vector<double> sums(numThreads);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < numThreads; ++t) {
+		threads.emplace_back([&table, &sums, iterations, t] {
+			CGAL::Gmpq acc(0);
+			for (size_t i = 0; i < iterations; ++i) {
+				// two handle copies of shared reps plus one fresh result
+				CGAL::Gmpq a = table[(i + t) % table.size()];
+				CGAL::Gmpq b = table[(i * 7 + t) % table.size()];
+				acc += a * b;
+				if (acc > 1000000) acc = 0;
+			}
+			sums[t] = CGAL::to_double(acc);
+		});
+	}
+	for (auto &thread : threads) thread.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return (double)(iterations * numThreads) / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+	size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+	std::vector<size_t> threadCounts;
+	for (int i = 2; i < argc; ++i) threadCounts.push_back(strtoul(argv[i], nullptr, 10));
+	if (threadCounts.empty()) threadCounts = { 1, 4, 16 };
+
+	std::vector<CGAL::Gmpq> table;
+	for (int i = 1; i <= 64; ++i) table.push_back(CGAL::Gmpq(i, 64 - i + 1));
+
+	std::cout << "Gmpq handle copy + arithmetic, " << iterations << " iterations per thread" << std::endl;
+	double base = 0;
+	for (size_t numThreads : threadCounts) {
+		double opsPerSec = run(table, iterations, numThreads);
+		if (base == 0) base = opsPerSec;
+		std::cout << "  " << numThreads << " threads: " << (size_t)opsPerSec << " ops/s"
+							<< " (" << opsPerSec / base << "x)" << std::endl;
+	}
+	return 0;
+}
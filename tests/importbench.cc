@@ -0,0 +1,184 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2011 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Benchmark for the mesh importers.
+//
+// Writes the same triangulated height field as ASCII STL, binary STL, OBJ,
+// OFF and .osmesh, imports each file and reports the import throughput in
+// MB/s. Files given on the command line are imported instead, by extension.
+//
+// usage: importbench [facets | file...]
+
+#include "import.h"
+#include "polyset.h"
+#include "MeshFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+namespace fs = boost::filesystem;
+
+std::string commandline_commands;
+std::string currentdir;
+
+static double height(size_t i, size_t j)
+{
+	return 10 * sin(i * 0.37) * cos(j * 0.23) + 1e-4 * ((i * 7919 + j * 104729) % 1000);
+}
+
+static void write_meshes(size_t numFacets, const fs::path &dir)
+{
+	size_t n = std::max<size_t>(2, size_t(sqrt(numFacets / 2.0)) + 1);
+	auto vertex = [n](size_t k) {
+		size_t i = k / n, j = k % n;
+		return Vector3d(i * 0.5, j * 0.5, height(i, j));
+	};
+	std::vector<std::array<size_t, 3>> tris;
+	for (size_t i = 0; i + 1 < n; i++) {
+		for (size_t j = 0; j + 1 < n; j++) {
+			size_t k = i * n + j;
+			tris.push_back({{k, k + n, k + 1}});
+			tris.push_back({{k + 1, k + n, k + n + 1}});
+		}
+	}
+
+	FILE *stl = fopen((dir / "bench.stl").string().c_str(), "w");
+	fprintf(stl, "solid bench\n");
+	for (const auto &t : tris) {
+		fprintf(stl, "  facet normal 0 0 1\n    outer loop\n");
+		for (size_t k : t) {
+			Vector3d v = vertex(k);
+			fprintf(stl, "      vertex %.9g %.9g %.9g\n", v[0], v[1], v[2]);
+		}
+		fprintf(stl, "    endloop\n  endfacet\n");
+	}
+	fprintf(stl, "endsolid bench\n");
+	fclose(stl);
+
+	FILE *binstl = fopen((dir / "bench-binary.stl").string().c_str(), "wb");
+	char header[80] = "importbench";
+	fwrite(header, 1, sizeof(header), binstl);
+	uint32_t count = uint32_t(tris.size());
+	fwrite(&count, 4, 1, binstl);
+	for (const auto &t : tris) {
+		float facet[12] = { 0, 0, 1 };
+		for (int v = 0; v < 3; v++) {
+			Vector3d p = vertex(t[v]);
+			for (int c = 0; c < 3; c++) facet[3 + v * 3 + c] = float(p[c]);
+		}
+		uint16_t attr = 0;
+		fwrite(facet, sizeof(facet), 1, binstl);
+		fwrite(&attr, 2, 1, binstl);
+	}
+	fclose(binstl);
+
+	FILE *obj = fopen((dir / "bench.obj").string().c_str(), "w");
+	FILE *off = fopen((dir / "bench.off").string().c_str(), "w");
+	fprintf(obj, "# object bench\ng bench\n");
+	fprintf(off, "OFF\n%zu %zu 0\n", n * n, tris.size());
+	for (size_t k = 0; k < n * n; k++) {
+		Vector3d v = vertex(k);
+		fprintf(obj, "v %.9g %.9g %.9g\n", v[0], v[1], v[2]);
+		fprintf(off, "%.9g %.9g %.9g\n", v[0], v[1], v[2]);
+	}
+	for (const auto &t : tris) {
+		fprintf(obj, "f %zu//1 %zu//1 %zu//1\n", t[0] + 1, t[1] + 1, t[2] + 1);
+		fprintf(off, "3 %zu %zu %zu\n", t[0], t[1], t[2]);
+	}
+	fclose(obj);
+	fclose(off);
+
+	std::unique_ptr<PolySet> ps(import_off((dir / "bench.off").string()));
+	std::ofstream mesh((dir / "bench.osmesh").string().c_str(), std::ios::out | std::ios::binary);
+	MeshFormat::write(mesh, *ps);
+}
+
+static void bench(const fs::path &file)
+{
+	std::string ext = boost::algorithm::to_lower_copy(file.extension().string());
+	auto start = std::chrono::steady_clock::now();
+	size_t facets = 0;
+	if (ext == ".stl") {
+		PolySet *p = import_stl(file.string());
+		facets = p->numPolygons();
+		delete p;
+	}
+	else if (ext == ".obj") {
+		for (PolySet *p : import_obj(file.string())) {
+			facets += p->numPolygons();
+			delete p;
+		}
+	}
+	else if (ext == ".off") {
+		PolySet *p = import_off(file.string());
+		facets = p->numPolygons();
+		delete p;
+	}
+	else if (ext == ".osmesh") {
+		Geometry *g = import_mesh(file.string());
+		if (const PolySet *p = dynamic_cast<const PolySet *>(g)) facets = p->numPolygons();
+		delete g;
+	}
+	else {
+		std::cerr << "importbench: unknown format: " << file.string() << std::endl;
+		return;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double mb = fs::file_size(file) / (1024.0 * 1024.0);
+	std::cout << file.filename().string() << ": " << facets << " facets, " << mb << " MB in "
+						<< elapsed.count() << " s, " << mb / elapsed.count() << " MB/s" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	currentdir = fs::current_path().generic_string();
+
+	if (argc > 1 && !isdigit(argv[1][0])) {
+		for (int i = 1; i < argc; i++) bench(argv[i]);
+		return 0;
+	}
+
+	size_t numFacets = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+	fs::path dir = fs::temp_directory_path() / fs::unique_path("importbench-%%%%-%%%%");
+	fs::create_directories(dir);
+	write_meshes(numFacets, dir);
+	for (const char *name : { "bench.stl", "bench-binary.stl", "bench.obj", "bench.off", "bench.osmesh" }) {
+		bench(dir / name);
+	}
+	fs::remove_all(dir);
+	return 0;
+}
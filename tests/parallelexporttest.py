@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+#
+# Checks that the exports formatted on the worker pool don't depend on its
+# size: exports a model with one worker and with several, and compares the
+# files byte by byte.
+#
+# Usage: parallelexporttest.py --openscad=<executable> --format=<suffix> [--workers=<n>] <file.scad> [openscad args]
+#
+# Both files must also be what the stream based exporters wrote: every
+# decimal number is checked to be written as printf("%g") would write it.
+# A model too small to be split into several chunks fails the test, as it
+# wouldn't exercise the pool.
+#
+# The pool size is set through the OPENSCAD_WORKERS environment variable.
+#
+# Returns 0 if the exports match, 1 otherwise.
+#
+
+from __future__ import print_function
+
+import sys, os, re, subprocess, tempfile, argparse
+
+# the items per formatting chunk of each export, see the exporters
+CHUNK_ITEMS = {'stl': 1024, 'off': 4096, 'amf': 1024, 'svg': 4096}
+# a line per item: facet normals, vertex or face lines, vertex and triangle elements, path points
+ITEM_PATTERNS = {
+	'stl': r'^\s*facet normal',
+	'off': r'^[-0-9]',
+	'amf': r'<(vertex|triangle)>',
+	'svg': r'[ML] [-0-9]'
+}
+# the lines holding the formatted numbers
+NUMBER_LINES = {
+	'stl': r'^\s*(facet normal|vertex) ',
+	'off': r'^[-0-9]',
+	'amf': r'^\s*<[xyz]>',
+	'svg': r'^ ?[ML] '
+}
+NUMBER = re.compile(r'(?<![\w.])-?[0-9]+(\.[0-9]+)?(e[-+][0-9]+)?(?![\w.])')
+
+def failquit(*args):
+	if len(args) != 0: print(*args)
+	print('parallelexporttest args:', str(sys.argv))
+	print('exiting parallelexporttest.py with failure')
+	sys.exit(1)
+
+def export(openscad, scadfile, outfile, workers, args):
+	env = dict(os.environ)
+	env['OPENSCAD_WORKERS'] = str(workers)
+	cmd = [openscad, scadfile, '-o', outfile] + args
+	print('Running', ' '.join(cmd), 'with', workers, 'workers')
+	if subprocess.call(cmd, env=env) != 0:
+		failquit('openscad failed')
+	with open(outfile, 'rb') as f:
+		return f.read().decode('utf-8')
+
+def check_numbers(text, format):
+	lines = '\n'.join(l for l in text.splitlines() if re.match(NUMBER_LINES[format], l))
+	for match in NUMBER.finditer(lines):
+		number = match.group(0)
+		# integers such as indices and counts aren't formatted as decimals
+		if match.group(1) is None and match.group(2) is None: continue
+		if '%g' % float(number) != number:
+			failquit('%s is not written like printf("%%g"): %s' % (number, '%g' % float(number)))
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('--openscad', required=True, help='the openscad executable')
+	parser.add_argument('--format', required=True, choices=sorted(CHUNK_ITEMS.keys()))
+	parser.add_argument('--workers', type=int, default=4, help='the size of the larger pool')
+	parser.add_argument('scadfile')
+	args, openscad_args = parser.parse_known_args()
+
+	tmpdir = tempfile.mkdtemp()
+	single = export(args.openscad, args.scadfile, os.path.join(tmpdir, 'single.' + args.format), 1, openscad_args)
+	several = export(args.openscad, args.scadfile, os.path.join(tmpdir, 'several.' + args.format), args.workers, openscad_args)
+
+	items = len(re.findall(ITEM_PATTERNS[args.format], single, re.MULTILINE))
+	if items <= CHUNK_ITEMS[args.format]:
+		failquit('the model has %d items, which fit in one chunk of %d' % (items, CHUNK_ITEMS[args.format]))
+	if single != several:
+		lines = zip(single.splitlines(), several.splitlines())
+		line = next((i for i, (a, b) in enumerate(lines) if a != b), min(len(single.splitlines()), len(several.splitlines())))
+		failquit('the exports with 1 and %d workers differ from line %d' % (args.workers, line + 1))
+	check_numbers(single, args.format)
+	print('%s export of %d items is the same with 1 and %d workers' % (args.format.upper(), items, args.workers))
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,54 @@
+#!/usr/bin/env python
+#
+# Checks how often a phase ran while rendering a model, e.g. that a
+# conversion kept with its source is done only once.
+#
+# Usage: profilecount.py --openscad=<executable> --phase=<phase> [--name=<name>] --count=<n> <file.scad> [openscad args]
+#
+# The model is rendered to a .nef3 file with --profile-format=flat, and the
+# number of spans of the phase (and name) in the profile's summary is
+# compared with --count.
+#
+# Returns 0 if the counts match, 1 otherwise.
+#
+
+from __future__ import print_function
+
+import sys, os, json, subprocess, tempfile, argparse
+
+def failquit(*args):
+	if len(args) != 0: print(*args)
+	print('profilecount args:', str(sys.argv))
+	print('exiting profilecount.py with failure')
+	sys.exit(1)
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('--openscad', required=True, help='the openscad executable')
+	parser.add_argument('--phase', required=True, help='the phase of the spans to count')
+	parser.add_argument('--name', help='the name of the spans to count, any if not given')
+	parser.add_argument('--count', type=int, required=True, help='the expected number of spans')
+	parser.add_argument('scadfile')
+	args, openscad_args = parser.parse_known_args()
+
+	tmpdir = tempfile.mkdtemp()
+	outfile = os.path.join(tmpdir, 'out.nef3')
+	profile = os.path.join(tmpdir, 'profile.json')
+	cmd = [args.openscad, args.scadfile, '-o', outfile, '--profile=' + profile, '--profile-format=flat'] + openscad_args
+	print('Running', ' '.join(cmd))
+	if subprocess.call(cmd) != 0:
+		failquit('openscad failed')
+	try:
+		with open(profile) as f:
+			summary = json.load(f)['summary']
+	except (IOError, ValueError, KeyError) as e:
+		failquit("can't read the profile:", e)
+
+	count = sum(s['count'] for s in summary
+		if s['phase'] == args.phase and (args.name is None or s['name'] == args.name))
+	print('%s %s: %d, expected %d' % (args.phase, args.name or '', count, args.count))
+	if count != args.count:
+		failquit()
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,113 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2011 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Benchmark for Value construction.
+//
+// Evaluates a polyhedron() whose points and faces come from large list
+// comprehensions and reports the evaluation time and the peak resident set
+// size of the process. Run it on two builds to compare Value layouts.
+//
+// usage: valuebench [points]
+
+#include "tests-common.h"
+#include "openscad.h"
+#include "parsersettings.h"
+#include "node.h"
+#include "module.h"
+#include "modcontext.h"
+#include "builtin.h"
+#include "stackcheck.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <boost/filesystem.hpp>
+namespace fs = boost::filesystem;
+#include "PlatformUtils.h"
+
+std::string commandline_commands;
+std::string currentdir;
+
+// peak RSS in kilobytes, 0 if unknown
+static long peakRSS()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	size_t numPoints = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+
+	StackCheck::inst()->init();
+	currentdir = fs::current_path().generic_string();
+	PlatformUtils::registerApplicationPath(fs::path(argv[0]).branch_path().generic_string());
+	parser_init();
+
+	std::stringstream text;
+	text << "n = " << numPoints << ";\n"
+			 << "pts = [for (i = [0:n-1]) [cos(i), sin(i), i / n]];\n"
+			 << "faces = [for (i = [0:3:n-3]) [i, i + 1, i + 2]];\n"
+			 << "polyhedron(points = pts, faces = faces);\n";
+
+	FileModule *root_module;
+	if (!parse(root_module, text.str().c_str(), fs::current_path(), false) || !root_module) {
+		std::cerr << "valuebench: parse error" << std::endl;
+		return 1;
+	}
+
+	ScopeContext top_ctx(nullptr, Builtins::getGlobalScope());
+
+	long baseRSS = peakRSS();
+	auto start = std::chrono::steady_clock::now();
+	AbstractNode::resetIndexCounter();
+	FileContext fc(&top_ctx, *root_module);
+	const AbstractNode *root_node = root_module->evaluate(fc);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "polyhedron() from list comprehensions, " << numPoints << " points" << std::endl;
+	std::cout << "  evaluation: " << elapsed.count() << " s" << std::endl;
+	std::cout << "  peak RSS: " << peakRSS() << " kB (" << baseRSS << " kB before evaluation)" << std::endl;
+
+	delete root_node;
+	delete root_module;
+	Builtins::release();
+	return 0;
+}